@@ -211,6 +211,15 @@ ZMQ_EXPORT int zmq_ctx_destroy (void *context_);
 /*  0MQ message definition.                                                   */
 /******************************************************************************/
 
+/* Size of zmq_msg_t in bytes. Larger messages let longer message bodies be
+ * stored inline rather than on the heap. Must match the value libzmq was
+ * built with, which builds with a non-default size export to applications.
+ * The size libzmq was built with can be queried with ZMQ_MSG_T_SIZE.
+ */
+#ifndef ZMQ_MSG_T_BYTES
+#define ZMQ_MSG_T_BYTES 64
+#endif
+
 /* Some architectures, like sparc64 and some variants of aarch64, enforce pointer
  * alignment and raise sigbus on violations. Make sure applications allocate
  * zmq_msg_t on addresses aligned on a pointer-size boundary to avoid this issue.
@@ -218,16 +227,17 @@ ZMQ_EXPORT int zmq_ctx_destroy (void *context_);
 typedef struct zmq_msg_t
 {
 #if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
-    __declspec(align (8)) unsigned char _[64];
+    __declspec(align (8)) unsigned char _[ZMQ_MSG_T_BYTES];
 #elif defined(_MSC_VER)                                                        \
   && (defined(_M_IX86) || defined(_M_ARM_ARMV7VE) || defined(_M_ARM))
-    __declspec(align (4)) unsigned char _[64];
+    __declspec(align (4)) unsigned char _[ZMQ_MSG_T_BYTES];
 #elif defined(__GNUC__) || defined(__INTEL_COMPILER)                           \
   || (defined(__SUNPRO_C) && __SUNPRO_C >= 0x590)                              \
   || (defined(__SUNPRO_CC) && __SUNPRO_CC >= 0x590)
-    unsigned char _[64] __attribute__ ((aligned (sizeof (void *))));
+    unsigned char _[ZMQ_MSG_T_BYTES]
+      __attribute__ ((aligned (sizeof (void *))));
 #else
-    unsigned char _[64];
+    unsigned char _[ZMQ_MSG_T_BYTES];
 #endif
 } zmq_msg_t;
 
@@ -662,6 +672,16 @@ ZMQ_EXPORT void zmq_threadclose (void *thread_);
 #define ZMQ_NORM_NUM_PARITY 122
 #define ZMQ_NORM_NUM_AUTOPARITY 123
 #define ZMQ_NORM_PUSH 124
+#define ZMQ_TCP_ZEROCOPY 125
+#define ZMQ_RCVSPIN 126
+#define ZMQ_LATENCY_STATS 127
+#define ZMQ_PUB_SHARDS 128
+#define ZMQ_IO_THREAD_LOCALITY 129
+#define ZMQ_TCP_ACCEPT_SHARDS 130
+#define ZMQ_CURVE_BATCH 131
+
+/*  DRAFT Send/recv options.                                                  */
+#define ZMQ_SNDDEFER 4
 
 /*  DRAFT ZMQ_NORM_MODE options                                               */
 #define ZMQ_NORM_FIXED 0
@@ -677,6 +697,11 @@ ZMQ_EXPORT void zmq_threadclose (void *thread_);
 
 /*  DRAFT Context options                                                     */
 #define ZMQ_ZERO_COPY_RECV 10
+#define ZMQ_MSG_POOL 11
+#define ZMQ_HUGE_PAGES 12
+#define ZMQ_NUMA_LOCAL 13
+#define ZMQ_CURVE_THREADS 14
+#define ZMQ_IO_URING 15
 
 /*  DRAFT Context methods.                                                    */
 ZMQ_EXPORT int zmq_ctx_set_ext (void *context_,
@@ -692,6 +717,10 @@ ZMQ_EXPORT int zmq_ctx_get_ext (void *context_,
 ZMQ_EXPORT int zmq_join (void *s, const char *group);
 ZMQ_EXPORT int zmq_leave (void *s, const char *group);
 ZMQ_EXPORT uint32_t zmq_connect_peer (void *s_, const char *addr_);
+ZMQ_EXPORT int
+zmq_sendmmsg (void *s_, zmq_msg_t *msgs_, size_t count_, int flags_);
+ZMQ_EXPORT int
+zmq_recvmmsg (void *s_, zmq_msg_t *msgs_, size_t count_, int flags_);
 
 /*  DRAFT Msg methods.                                                        */
 ZMQ_EXPORT int zmq_msg_set_routing_id (zmq_msg_t *msg, uint32_t routing_id);
@@ -739,6 +768,10 @@ ZMQ_EXPORT int zmq_poller_wait_all (void *poller,
                                     int n_events,
                                     long timeout);
 ZMQ_EXPORT int zmq_poller_fd (void *poller, zmq_fd_t *fd);
+ZMQ_EXPORT int zmq_poller_poll (void *poller,
+                                zmq_pollitem_t *items,
+                                int nitems,
+                                long timeout);
 
 ZMQ_EXPORT int
 zmq_poller_add_fd (void *poller, zmq_fd_t fd, void *user_data, short events);
@@ -751,12 +784,14 @@ ZMQ_EXPORT int zmq_socket_get_peer_state (void *socket,
 
 /*  DRAFT Socket monitoring events                                            */
 #define ZMQ_EVENT_PIPES_STATS 0x10000
+#define ZMQ_EVENT_PIPES_LATENCY 0x20000
 
 #define ZMQ_CURRENT_EVENT_VERSION 1
 #define ZMQ_CURRENT_EVENT_VERSION_DRAFT 2
 
 #define ZMQ_EVENT_ALL_V1 ZMQ_EVENT_ALL
-#define ZMQ_EVENT_ALL_V2 ZMQ_EVENT_ALL_V1 | ZMQ_EVENT_PIPES_STATS
+#define ZMQ_EVENT_ALL_V2                                                       \
+    ZMQ_EVENT_ALL_V1 | ZMQ_EVENT_PIPES_STATS | ZMQ_EVENT_PIPES_LATENCY
 
 ZMQ_EXPORT int zmq_socket_monitor_versioned (
   void *s_, const char *addr_, uint64_t events_, int event_version_, int type_);
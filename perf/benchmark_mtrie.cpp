@@ -0,0 +1,126 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#if __cplusplus >= 201103L
+
+#include "generic_mtrie_impl.hpp"
+#include "generic_radix_mtrie_impl.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <random>
+#include <ratio>
+#include <vector>
+
+const std::size_t nprefixes = 200000;
+const std::size_t nsubscribers = 5000;
+const std::size_t nqueries = 1000000;
+const std::size_t warmup_runs = 2;
+const std::size_t samples = 5;
+const std::size_t min_prefix_length = 4;
+const std::size_t max_prefix_length = 16;
+const std::size_t topic_length = 24;
+const char *chars = "abcdefghijklmnopqrstuvwxyz0123456789";
+const int chars_len = 36;
+
+static void count_match (int *subscriber_, std::size_t *matches_)
+{
+    (void) subscriber_;
+    ++*matches_;
+}
+
+template <class T>
+void benchmark_match (T &subscriptions_,
+                      std::vector<unsigned char *> &topics_)
+{
+    using namespace std::chrono;
+    std::size_t matches = 0;
+
+    for (std::size_t run = 0; run < warmup_runs; ++run) {
+        for (auto &topic : topics_)
+            subscriptions_.match (topic, topic_length, count_match, &matches);
+    }
+
+    duration<double, std::nano> total (0);
+    for (std::size_t run = 0; run < samples; ++run) {
+        matches = 0;
+        const auto start = steady_clock::now ();
+        for (auto &topic : topics_)
+            subscriptions_.match (topic, topic_length, count_match, &matches);
+        total += steady_clock::now () - start;
+    }
+
+    std::printf ("Average match time = %.1lf ns, %llu matches per run\n",
+                 total.count () / samples / topics_.size (),
+                 static_cast<unsigned long long> (matches));
+}
+
+int main ()
+{
+    // Generate the subscriptions, spread over the subscribers, and topics
+    // half of which extend one of the subscribed prefixes.
+    std::minstd_rand rng (123456789);
+    std::vector<unsigned char *> prefixes;
+    std::vector<std::size_t> prefix_lengths;
+    std::vector<unsigned char *> topics;
+    std::vector<int> subscribers (nsubscribers);
+    prefixes.reserve (nprefixes);
+    prefix_lengths.reserve (nprefixes);
+    topics.reserve (nqueries);
+
+    for (std::size_t i = 0; i < nprefixes; ++i) {
+        const std::size_t length =
+          min_prefix_length
+          + rng () % (max_prefix_length - min_prefix_length + 1);
+        unsigned char *prefix = new unsigned char[length];
+        for (std::size_t j = 0; j < length; j++)
+            prefix[j] = static_cast<unsigned char> (chars[rng () % chars_len]);
+        prefixes.emplace_back (prefix);
+        prefix_lengths.push_back (length);
+    }
+    for (std::size_t i = 0; i < nqueries; ++i) {
+        unsigned char *topic = new unsigned char[topic_length];
+        std::size_t j = 0;
+        if (rng () % 2) {
+            const std::size_t p = rng () % nprefixes;
+            for (; j < prefix_lengths[p]; j++)
+                topic[j] = prefixes[p][j];
+        }
+        for (; j < topic_length; j++)
+            topic[j] = static_cast<unsigned char> (chars[rng () % chars_len]);
+        topics.emplace_back (topic);
+    }
+
+    zmq::generic_mtrie_t<int> mtrie;
+    zmq::generic_radix_mtrie_t<int> radix_mtrie;
+    for (std::size_t i = 0; i < nprefixes; ++i) {
+        int *subscriber = &subscribers[i % nsubscribers];
+        mtrie.add (prefixes[i], prefix_lengths[i], subscriber);
+        radix_mtrie.add (prefixes[i], prefix_lengths[i], subscriber);
+    }
+
+    std::printf ("prefixes = %llu, subscribers = %llu, topics = %llu, "
+                 "topic size = %llu\n",
+                 static_cast<unsigned long long> (nprefixes),
+                 static_cast<unsigned long long> (nsubscribers),
+                 static_cast<unsigned long long> (nqueries),
+                 static_cast<unsigned long long> (topic_length));
+    std::puts ("[generic_mtrie]");
+    benchmark_match (mtrie, topics);
+
+    std::puts ("[generic_radix_mtrie]");
+    benchmark_match (radix_mtrie, topics);
+
+    for (auto &prefix : prefixes)
+        delete[] prefix;
+    for (auto &topic : topics)
+        delete[] topic;
+}
+
+#else
+
+int main ()
+{
+}
+
+#endif
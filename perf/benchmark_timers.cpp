@@ -0,0 +1,125 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#if __cplusplus >= 201103L
+
+#include "timer_wheel.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <ratio>
+#include <vector>
+
+const std::size_t ntimers = 100000;
+const std::size_t nrearms = 1000000;
+const std::size_t nrearms_linear = 1000;
+const int max_timeout = 60000;
+
+//  The timers of poller_base_t before the timer wheel, cancelling timers by
+//  searching for them.
+class multimap_timers_t
+{
+  public:
+    void add (uint64_t now_, uint64_t expiration_, void *sink_, int id_)
+    {
+        (void) now_;
+        timer_info_t info = {sink_, id_};
+        _timers.insert (timers_t::value_type (expiration_, info));
+    }
+
+    bool cancel (void *sink_, int id_)
+    {
+        for (auto it = _timers.begin (); it != _timers.end (); ++it)
+            if (it->second.sink == sink_ && it->second.id == id_) {
+                _timers.erase (it);
+                return true;
+            }
+        return false;
+    }
+
+    bool expire (uint64_t now_, void **sink_, int *id_)
+    {
+        if (_timers.empty () || _timers.begin ()->first > now_)
+            return false;
+        *sink_ = _timers.begin ()->second.sink;
+        *id_ = _timers.begin ()->second.id;
+        _timers.erase (_timers.begin ());
+        return true;
+    }
+
+  private:
+    struct timer_info_t
+    {
+        void *sink;
+        int id;
+    };
+    typedef std::multimap<uint64_t, timer_info_t> timers_t;
+    timers_t _timers;
+};
+
+template <class T>
+void benchmark_timers (T &timers_,
+                       std::vector<int> &sinks_,
+                       std::size_t nrearms_)
+{
+    using namespace std::chrono;
+    std::minstd_rand rng (123456789);
+    uint64_t now = 1000000;
+
+    //  Each connection runs a timer, e.g. for heartbeats.
+    auto start = steady_clock::now ();
+    for (std::size_t i = 0; i < ntimers; ++i)
+        timers_.add (now, now + 1 + rng () % max_timeout, &sinks_[i], 1);
+    duration<double, std::nano> elapsed = steady_clock::now () - start;
+    std::printf ("Average add time = %.1lf ns\n", elapsed.count () / ntimers);
+
+    //  Activity on a connection restarts its timer.
+    start = steady_clock::now ();
+    for (std::size_t i = 0; i < nrearms_; ++i) {
+        const std::size_t sink = rng () % ntimers;
+        timers_.cancel (&sinks_[sink], 1);
+        timers_.add (now, now + 1 + rng () % max_timeout, &sinks_[sink], 1);
+    }
+    elapsed = steady_clock::now () - start;
+    std::printf ("Average cancel and add time = %.1lf ns\n",
+                 elapsed.count () / nrearms_);
+
+    //  Time passes, one millisecond at a time, until all timers expired.
+    std::size_t expired = 0;
+    void *sink;
+    int id;
+    start = steady_clock::now ();
+    for (int ms = 0; ms <= max_timeout; ++ms) {
+        ++now;
+        while (timers_.expire (now, &sink, &id))
+            ++expired;
+    }
+    elapsed = steady_clock::now () - start;
+    std::printf ("Average expire time = %.1lf ns, %llu expired\n",
+                 elapsed.count () / expired,
+                 static_cast<unsigned long long> (expired));
+}
+
+int main ()
+{
+    std::vector<int> sinks (ntimers);
+
+    std::printf ("timers = %llu\n", static_cast<unsigned long long> (ntimers));
+    std::puts ("[std::multimap]");
+    multimap_timers_t multimap_timers;
+    benchmark_timers (multimap_timers, sinks, nrearms_linear);
+
+    std::puts ("[timer_wheel_t]");
+    zmq::timer_wheel_t timer_wheel;
+    benchmark_timers (timer_wheel, sinks, nrearms);
+}
+
+#else
+
+int main ()
+{
+}
+
+#endif
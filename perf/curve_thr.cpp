@@ -0,0 +1,189 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../include/zmq.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//  Measures the throughput of messages sent over TCP on the loopback
+//  interface, with the NULL mechanism and then with CURVE, so that the cost
+//  of encrypting and decrypting the messages shows. With the draft API,
+//  CURVE is measured with messages boxed in batches as well, and messages
+//  can be encrypted and decrypted by a number of CURVE threads.
+
+struct sender_t
+{
+    void *ctx;
+    char endpoint[256];
+    bool curve;
+    bool batch;
+    char server_public[41];
+    char client_public[41];
+    char client_secret[41];
+};
+
+static int message_count;
+static size_t message_size;
+
+static void check (int rc_, const char *call_)
+{
+    if (rc_ == -1) {
+        printf ("error in %s: %s\n", call_, zmq_strerror (errno));
+        exit (1);
+    }
+}
+
+static void set_batch (void *s_)
+{
+#if defined ZMQ_CURVE_BATCH
+    const int batch = 1;
+    check (zmq_setsockopt (s_, ZMQ_CURVE_BATCH, &batch, sizeof batch),
+           "zmq_setsockopt");
+#else
+    (void) s_;
+#endif
+}
+
+static void sender (void *sender_)
+{
+    const sender_t *const cfg = static_cast<sender_t *> (sender_);
+
+    void *s = zmq_socket (cfg->ctx, ZMQ_PUSH);
+    if (!s) {
+        printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+    if (cfg->curve) {
+        check (zmq_setsockopt (s, ZMQ_CURVE_SERVERKEY, cfg->server_public, 40),
+               "zmq_setsockopt");
+        check (zmq_setsockopt (s, ZMQ_CURVE_PUBLICKEY, cfg->client_public, 40),
+               "zmq_setsockopt");
+        check (zmq_setsockopt (s, ZMQ_CURVE_SECRETKEY, cfg->client_secret, 40),
+               "zmq_setsockopt");
+    }
+    if (cfg->batch)
+        set_batch (s);
+    check (zmq_connect (s, cfg->endpoint), "zmq_connect");
+
+    zmq_msg_t msg;
+    for (int i = 0; i != message_count; i++) {
+        check (zmq_msg_init_size (&msg, message_size), "zmq_msg_init_size");
+#if defined ZMQ_MAKE_VALGRIND_HAPPY
+        memset (zmq_msg_data (&msg), 0, message_size);
+#endif
+        check (zmq_sendmsg (s, &msg, 0), "zmq_sendmsg");
+    }
+
+    check (zmq_close (s), "zmq_close");
+}
+
+static void measure (void *ctx_, bool curve_, bool batch_)
+{
+    sender_t cfg;
+    cfg.ctx = ctx_;
+    cfg.curve = curve_;
+    cfg.batch = batch_;
+
+    void *s = zmq_socket (ctx_, ZMQ_PULL);
+    if (!s) {
+        printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+    if (curve_) {
+        char server_secret[41];
+        check (zmq_curve_keypair (cfg.server_public, server_secret),
+               "zmq_curve_keypair");
+        check (zmq_curve_keypair (cfg.client_public, cfg.client_secret),
+               "zmq_curve_keypair");
+        const int server = 1;
+        check (zmq_setsockopt (s, ZMQ_CURVE_SERVER, &server, sizeof server),
+               "zmq_setsockopt");
+        check (zmq_setsockopt (s, ZMQ_CURVE_SECRETKEY, server_secret, 40),
+               "zmq_setsockopt");
+    }
+    if (batch_)
+        set_batch (s);
+    check (zmq_bind (s, "tcp://127.0.0.1:*"), "zmq_bind");
+    size_t endpoint_size = sizeof cfg.endpoint;
+    check (zmq_getsockopt (s, ZMQ_LAST_ENDPOINT, cfg.endpoint, &endpoint_size),
+           "zmq_getsockopt");
+
+    void *thread = zmq_threadstart (sender, &cfg);
+
+    zmq_msg_t msg;
+    check (zmq_msg_init (&msg), "zmq_msg_init");
+
+    //  The clock starts once the connection is up.
+    check (zmq_recvmsg (s, &msg, 0), "zmq_recvmsg");
+    void *watch = zmq_stopwatch_start ();
+    for (int i = 0; i != message_count - 1; i++) {
+        check (zmq_recvmsg (s, &msg, 0), "zmq_recvmsg");
+        if (zmq_msg_size (&msg) != message_size) {
+            printf ("message of incorrect size received\n");
+            exit (1);
+        }
+    }
+    unsigned long elapsed = zmq_stopwatch_stop (watch);
+    if (elapsed == 0)
+        elapsed = 1;
+
+    check (zmq_msg_close (&msg), "zmq_msg_close");
+    zmq_threadclose (thread);
+    check (zmq_close (s), "zmq_close");
+
+    const double throughput =
+      static_cast<double> (message_count - 1) / elapsed * 1000000;
+    const double megabits = throughput * message_size * 8 / 1000000;
+
+    printf ("mechanism: %s\n",
+            !curve_ ? "NULL" : batch_ ? "CURVE (batched)" : "CURVE");
+    printf ("mean throughput: %d [msg/s]\n", static_cast<int> (throughput));
+    printf ("mean throughput: %.3f [Mb/s]\n", megabits);
+}
+
+int main (int argc, char *argv[])
+{
+    if (argc != 3 && argc != 4) {
+        printf ("usage: curve_thr <message-size> <message-count> "
+                "[curve-threads]\n");
+        return 1;
+    }
+    message_size = atoi (argv[1]);
+    message_count = atoi (argv[2]);
+    if (message_count < 2) {
+        printf ("message count must be at least 2\n");
+        return 1;
+    }
+
+    void *ctx = zmq_ctx_new ();
+    if (!ctx) {
+        printf ("error in zmq_ctx_new: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    if (argc == 4) {
+#if defined ZMQ_CURVE_THREADS
+        check (zmq_ctx_set (ctx, ZMQ_CURVE_THREADS, atoi (argv[3])),
+               "zmq_ctx_set");
+#else
+        printf ("CURVE threads require the draft API\n");
+        return 1;
+#endif
+    }
+
+    printf ("message size: %d [B]\n", static_cast<int> (message_size));
+    printf ("message count: %d\n", message_count);
+
+    measure (ctx, false, false);
+    if (zmq_has ("curve")) {
+        measure (ctx, true, false);
+#if defined ZMQ_CURVE_BATCH
+        measure (ctx, true, true);
+#endif
+    } else
+        printf ("CURVE is not available\n");
+
+    check (zmq_ctx_term (ctx), "zmq_ctx_term");
+    return 0;
+}
@@ -0,0 +1,111 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "platform.hpp"
+#include "../include/zmq.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+//  Measures how long it takes for zmq_poller_wait_all to report a message
+//  on one of the sockets polled, depending on the number of sockets. Large
+//  poll sets need as many file descriptors as sockets.
+
+//  Events reported at most by a wait. The events not reported are cleared.
+#define MAX_EVENTS 64
+
+#if defined ZMQ_HAVE_POLLER
+static void check (int rc_, const char *call_)
+{
+    if (rc_ == -1) {
+        printf ("error in %s: %s\n", call_, zmq_strerror (errno));
+        exit (1);
+    }
+}
+#endif
+
+int main (int argc, char *argv[])
+{
+#if defined ZMQ_HAVE_POLLER
+    if (argc != 3) {
+        printf ("usage: poller_wait <poll-set-size> <roundtrip-count>\n");
+        return 1;
+    }
+    const int size = atoi (argv[1]);
+    const int roundtrip_count = atoi (argv[2]);
+    if (size < 1 || roundtrip_count < 1) {
+        printf ("poll set size and roundtrip count must be positive\n");
+        return 1;
+    }
+
+    void *ctx = zmq_ctx_new ();
+    if (!ctx) {
+        printf ("error in zmq_ctx_new: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+    check (zmq_ctx_set (ctx, ZMQ_MAX_SOCKETS, size + 1), "zmq_ctx_set");
+
+    void *poller = zmq_poller_new ();
+    void **sockets = static_cast<void **> (malloc (size * sizeof (void *)));
+    if (!poller || !sockets) {
+        printf ("error in allocation: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    char endpoint[64];
+    for (int i = 0; i != size; i++) {
+        sockets[i] = zmq_socket (ctx, ZMQ_PULL);
+        if (!sockets[i]) {
+            printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+        sprintf (endpoint, "inproc://poller_wait_%d", i);
+        check (zmq_bind (sockets[i], endpoint), "zmq_bind");
+        check (zmq_poller_add (poller, sockets[i], NULL, ZMQ_POLLIN),
+               "zmq_poller_add");
+    }
+
+    //  Messages go to a socket in the middle of the poll set.
+    void *push = zmq_socket (ctx, ZMQ_PUSH);
+    if (!push) {
+        printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+    sprintf (endpoint, "inproc://poller_wait_%d", size / 2);
+    check (zmq_connect (push, endpoint), "zmq_connect");
+
+    zmq_poller_event_t events[MAX_EVENTS];
+    void *watch = zmq_stopwatch_start ();
+
+    for (int i = 0; i != roundtrip_count; i++) {
+        check (zmq_send (push, NULL, 0, 0), "zmq_send");
+        const int rc = zmq_poller_wait_all (poller, events, MAX_EVENTS, -1);
+        check (rc, "zmq_poller_wait_all");
+        if (rc != 1 || events[0].socket != sockets[size / 2]) {
+            printf ("unexpected events\n");
+            return -1;
+        }
+        check (zmq_recv (events[0].socket, NULL, 0, 0), "zmq_recv");
+    }
+
+    const unsigned long elapsed = zmq_stopwatch_stop (watch);
+    const double latency = static_cast<double> (elapsed) / roundtrip_count;
+
+    printf ("poll set size: %d\n", size);
+    printf ("roundtrip count: %d\n", roundtrip_count);
+    printf ("average send, wait and receive time: %.3f [us]\n", latency);
+
+    check (zmq_poller_destroy (&poller), "zmq_poller_destroy");
+    check (zmq_close (push), "zmq_close");
+    for (int i = 0; i != size; i++)
+        check (zmq_close (sockets[i]), "zmq_close");
+    free (sockets);
+    check (zmq_ctx_term (ctx), "zmq_ctx_term");
+
+    return 0;
+#else
+    (void) argc;
+    (void) argv;
+    printf ("poller_wait requires the draft API\n");
+    return 0;
+#endif
+}
@@ -0,0 +1,499 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include "chunk_pool.hpp"
+
+#include <stdlib.h>
+
+#include "atomic_counter.hpp"
+#include "config.hpp"
+#include "err.hpp"
+#include "likely.hpp"
+#include "macros.hpp"
+#include "mutex.hpp"
+#include "stdint.hpp"
+#include "thread.hpp"
+
+#if defined ZMQ_HAVE_LINUX
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define ZMQ_HAVE_CHUNK_POOL
+#endif
+
+//  Per-thread caches require thread_local storage with destructors.
+#if defined ZMQ_HAVE_CHUNK_POOL                                                \
+  && ((defined __cplusplus && __cplusplus >= 201103L)                          \
+      || (defined _MSC_VER && _MSC_VER >= 1900))
+#define ZMQ_HAVE_CHUNK_CACHE
+#endif
+
+namespace
+{
+//  Stored right before each chunk handed out. List is the index of the
+//  free list the chunk returns to, or -1 for chunks from the heap.
+struct header_t
+{
+    void *base;
+    int list;
+};
+
+#if defined ZMQ_HAVE_CHUNK_POOL
+//  Free chunks are chained through their first bytes.
+struct free_chunk_t
+{
+    free_chunk_t *next;
+};
+
+//  Regions are the size of a huge page on most platforms, and aligned to
+//  their size so that the region of a chunk is found by masking its address.
+//  Each region is split into chunks of a single size class, which follow
+//  this header.
+struct region_t
+{
+    //  Links in the list of regions with free chunks of the free list.
+    region_t *prev;
+    region_t *next;
+
+    free_chunk_t *free_chunks;
+    int free_count;
+    int chunk_count;
+};
+
+//  The regions of a size class on a node, mapped with or without huge
+//  pages, that have free chunks. Each list
+//  keeps at most one region with all its chunks free, so that regions are
+//  not mapped and unmapped over and over, while the pool is in use.
+struct free_list_t
+{
+    zmq::mutex_t sync;
+    region_t *regions;
+    bool has_idle_region;
+};
+
+const size_t region_size = 2 * 1024 * 1024;
+
+//  There are eight size classes per doubling, so that at most an eighth of
+//  a chunk is wasted, starting from min_class_size bytes. Chunk sizes are
+//  multiples of chunk_align, the largest alignment of pooled chunks. The
+//  largest class is 1MB.
+const size_t min_class_size = 4096;
+const int classes_per_doubling = 8;
+const int class_count = 8 * classes_per_doubling + 1;
+const size_t chunk_align = min_class_size / classes_per_doubling;
+
+const size_t region_header_size =
+  (sizeof (region_t) + chunk_align - 1) & ~(chunk_align - 1);
+
+//  Chunks bound to nodes above the limit are not pooled.
+const int max_nodes = 8;
+
+//  Free lists are keyed by mapping mode, node and size class.
+const int list_count = 2 * max_nodes * class_count;
+
+//  Preferred memory policy, as in numaif.h, which we don't depend on.
+const int mpol_preferred = 1;
+
+free_list_t free_lists[list_count];
+
+//  Number of contexts using each of the features.
+zmq::atomic_counter_t huge_page_users;
+zmq::atomic_counter_t numa_local_users;
+
+bool pool_in_use ()
+{
+    return huge_page_users.get () != 0 || numa_local_users.get () != 0;
+}
+
+size_t class_size (int size_class_)
+{
+    return (min_class_size + (size_class_ % classes_per_doubling) * chunk_align)
+           << (size_class_ / classes_per_doubling);
+}
+
+int class_of (size_t size_)
+{
+    if (size_ <= min_class_size)
+        return 0;
+    int doublings = 0;
+    while ((min_class_size << (doublings + 1)) < size_)
+        if (++doublings == class_count / classes_per_doubling)
+            return -1;
+    const size_t base = min_class_size << doublings;
+    const size_t step = base / classes_per_doubling;
+    const int size_class = doublings * classes_per_doubling
+                           + static_cast<int> ((size_ - base + step - 1) / step);
+    return size_class < class_count ? size_class : -1;
+}
+
+//  Returns the NUMA node of the CPU the calling thread runs on, which is
+//  also where an I/O thread affined to CPUs of a single node runs.
+int current_node ()
+{
+    const int cpu = zmq::get_current_cpu ();
+    return cpu == -1 ? -1 : zmq::get_cpu_node (cpu);
+}
+
+void *map_region (bool huge_pages_, int node_)
+{
+    void *region = MAP_FAILED;
+#if defined MAP_HUGETLB
+    if (huge_pages_) {
+        region = mmap (NULL, region_size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        //  Huge pages larger than regions don't keep them aligned.
+        if (region != MAP_FAILED
+            && reinterpret_cast<uintptr_t> (region) % region_size) {
+            munmap (region, region_size);
+            region = MAP_FAILED;
+        }
+    }
+#endif
+
+    //  Without reserved huge pages, map a region aligned to the size of a
+    //  huge page, so that transparent huge pages can back it.
+    if (region == MAP_FAILED) {
+        char *const area =
+          static_cast<char *> (mmap (NULL, 2 * region_size,
+                                     PROT_READ | PROT_WRITE,
+                                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (area == MAP_FAILED)
+            return NULL;
+        const size_t offset =
+          (region_size - reinterpret_cast<uintptr_t> (area) % region_size)
+          % region_size;
+        if (offset)
+            munmap (area, offset);
+        munmap (area + offset + region_size, region_size - offset);
+        region = area + offset;
+#if defined MADV_HUGEPAGE
+        if (huge_pages_)
+            madvise (region, region_size, MADV_HUGEPAGE);
+#endif
+    }
+
+    //  Binding is best effort: on kernels without NUMA support the pages
+    //  end up wherever they are first touched, which is the calling thread.
+#if defined SYS_mbind
+    if (node_ >= 0) {
+        unsigned long nodemask = 1UL << node_;
+        syscall (SYS_mbind, region, region_size, mpol_preferred, &nodemask,
+                 sizeof nodemask * 8 + 1, 0);
+    }
+#endif
+    return region;
+}
+
+region_t *region_of (void *chunk_)
+{
+    return reinterpret_cast<region_t *> (reinterpret_cast<uintptr_t> (chunk_)
+                                         & ~(region_size - 1));
+}
+
+void link_region (free_list_t &free_list_, region_t *region_)
+{
+    region_->prev = NULL;
+    region_->next = free_list_.regions;
+    if (free_list_.regions)
+        free_list_.regions->prev = region_;
+    free_list_.regions = region_;
+}
+
+void unlink_region (free_list_t &free_list_, region_t *region_)
+{
+    if (region_->prev)
+        region_->prev->next = region_->next;
+    else
+        free_list_.regions = region_->next;
+    if (region_->next)
+        region_->next->prev = region_->prev;
+}
+
+//  Maps a region and splits it into free chunks of the size class.
+region_t *create_region (int size_class_, bool huge_pages_, int node_)
+{
+    char *const area = static_cast<char *> (map_region (huge_pages_, node_));
+    if (!area)
+        return NULL;
+    region_t *const region = reinterpret_cast<region_t *> (area);
+    region->free_chunks = NULL;
+    region->free_count = 0;
+    const size_t chunk_size = class_size (size_class_);
+    for (size_t offset = region_header_size;
+         offset + chunk_size <= region_size; offset += chunk_size) {
+        free_chunk_t *const chunk =
+          reinterpret_cast<free_chunk_t *> (area + offset);
+        chunk->next = region->free_chunks;
+        region->free_chunks = chunk;
+        region->free_count++;
+    }
+    region->chunk_count = region->free_count;
+    return region;
+}
+
+//  Takes a chunk from the free list, mapping a new region if no region has
+//  free chunks. Returns NULL if no region can be mapped.
+void *pop_chunk (int list_, int size_class_, bool huge_pages_, int node_)
+{
+    free_list_t &free_list = free_lists[list_];
+    zmq::scoped_lock_t lock (free_list.sync);
+
+    region_t *region = free_list.regions;
+    if (!region) {
+        region = create_region (size_class_, huge_pages_, node_);
+        if (!region)
+            return NULL;
+        link_region (free_list, region);
+    }
+
+    if (region->free_count == region->chunk_count)
+        free_list.has_idle_region = false;
+    free_chunk_t *const chunk = region->free_chunks;
+    region->free_chunks = chunk->next;
+    if (--region->free_count == 0)
+        unlink_region (free_list, region);
+    return chunk;
+}
+
+void push_chunk (int list_, void *base_)
+{
+    free_list_t &free_list = free_lists[list_];
+    region_t *const region = region_of (base_);
+    free_chunk_t *const chunk = static_cast<free_chunk_t *> (base_);
+    zmq::scoped_lock_t lock (free_list.sync);
+
+    chunk->next = region->free_chunks;
+    region->free_chunks = chunk;
+    if (region->free_count++ == 0)
+        link_region (free_list, region);
+    if (region->free_count != region->chunk_count)
+        return;
+
+    //  Keep a single idle region for reuse, and none once the pool is no
+    //  longer in use.
+    if (!free_list.has_idle_region && pool_in_use ()) {
+        free_list.has_idle_region = true;
+        return;
+    }
+    unlink_region (free_list, region);
+    munmap (region, region_size);
+}
+
+//  Returns the idle regions to the system.
+void trim ()
+{
+    for (int list = 0; list != list_count; ++list) {
+        free_list_t &free_list = free_lists[list];
+        zmq::scoped_lock_t lock (free_list.sync);
+        if (!free_list.has_idle_region)
+            continue;
+        region_t *region = free_list.regions;
+        while (region->free_count != region->chunk_count)
+            region = region->next;
+        unlink_region (free_list, region);
+        munmap (region, region_size);
+        free_list.has_idle_region = false;
+    }
+}
+
+#if defined ZMQ_HAVE_CHUNK_CACHE
+//  Each thread keeps a few free chunks out of the free lists, so that a
+//  thread releasing and allocating chunks in turn, as the reader and the
+//  writer of a pipe do, does not take the lock of a list every time.
+struct cached_chunk_t
+{
+    void *base;
+    int list;
+};
+
+struct thread_cache_t
+{
+    cached_chunk_t chunks[zmq::chunk_pool_cache_size];
+    bool registered;
+    bool destroyed;
+};
+
+thread_local thread_cache_t cache;
+
+//  Returns the cached chunks to their free lists.
+void flush_cache ()
+{
+    for (int i = 0; i != zmq::chunk_pool_cache_size; ++i)
+        if (cache.chunks[i].base) {
+            push_chunk (cache.chunks[i].list, cache.chunks[i].base);
+            cache.chunks[i].base = NULL;
+        }
+}
+
+//  Flushes the cache when the thread exits.
+struct cache_guard_t
+{
+    ~cache_guard_t ()
+    {
+        flush_cache ();
+        cache.destroyed = true;
+    }
+
+    bool active;
+};
+
+thread_local cache_guard_t guard;
+
+thread_cache_t *get_cache ()
+{
+    if (unlikely (!cache.registered)) {
+        //  Using the guard makes sure its destructor runs at thread exit.
+        cache.registered = true;
+        guard.active = true;
+    }
+    return cache.destroyed ? NULL : &cache;
+}
+
+void *pop_cached_chunk (int list_)
+{
+    thread_cache_t *const thread_cache = get_cache ();
+    if (unlikely (!thread_cache))
+        return NULL;
+    for (int i = 0; i != zmq::chunk_pool_cache_size; ++i) {
+        cached_chunk_t &cached = thread_cache->chunks[i];
+        if (cached.base && cached.list == list_) {
+            void *const base = cached.base;
+            cached.base = NULL;
+            return base;
+        }
+    }
+    return NULL;
+}
+
+//  Returns false if the cache is full.
+bool push_cached_chunk (int list_, void *base_)
+{
+    thread_cache_t *const thread_cache = get_cache ();
+    if (unlikely (!thread_cache))
+        return false;
+    for (int i = 0; i != zmq::chunk_pool_cache_size; ++i) {
+        cached_chunk_t &cached = thread_cache->chunks[i];
+        if (!cached.base) {
+            cached.base = base_;
+            cached.list = list_;
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+#endif
+
+//  Offset of the chunk handed out from the start of the memory holding it.
+size_t header_offset (size_t align_)
+{
+    return (sizeof (header_t) + align_ - 1) & ~(align_ - 1);
+}
+
+void *init_chunk (void *base_, size_t offset_, int list_)
+{
+    char *const chunk = static_cast<char *> (base_) + offset_;
+    header_t *const header = reinterpret_cast<header_t *> (chunk) - 1;
+    header->base = base_;
+    header->list = list_;
+    return chunk;
+}
+}
+
+void zmq::chunk_pool_enable (int features_)
+{
+#if defined ZMQ_HAVE_CHUNK_POOL
+    if (features_ & chunk_pool_huge_pages)
+        huge_page_users.add (1);
+    if (features_ & chunk_pool_numa_local)
+        numa_local_users.add (1);
+#else
+    LIBZMQ_UNUSED (features_);
+#endif
+}
+
+void zmq::chunk_pool_disable (int features_)
+{
+    //  Once no context uses the pool, regions are unmapped as soon as all
+    //  their chunks are free.
+#if defined ZMQ_HAVE_CHUNK_POOL
+    if (features_ & chunk_pool_huge_pages)
+        huge_page_users.sub (1);
+    if (features_ & chunk_pool_numa_local)
+        numa_local_users.sub (1);
+    if (features_ && !pool_in_use ()) {
+        //  The chunks cached by other threads are released as the threads
+        //  exit.
+#if defined ZMQ_HAVE_CHUNK_CACHE
+        flush_cache ();
+#endif
+        trim ();
+    }
+#else
+    LIBZMQ_UNUSED (features_);
+#endif
+}
+
+void *zmq::chunk_pool_alloc (size_t size_, size_t align_)
+{
+    zmq_assert (align_ && (align_ & (align_ - 1)) == 0);
+    const size_t offset = header_offset (align_);
+
+#if defined ZMQ_HAVE_CHUNK_POOL
+    const bool huge_pages = huge_page_users.get () != 0;
+    const bool numa_local = numa_local_users.get () != 0;
+    if (unlikely (huge_pages || numa_local)) {
+        const int size_class = class_of (offset + size_);
+        const int node = numa_local ? current_node () : -1;
+        if (size_class != -1 && align_ <= chunk_align && node < max_nodes) {
+            const int list =
+              ((huge_pages ? max_nodes : 0) + (node == -1 ? 0 : node))
+                * class_count
+              + size_class;
+            void *base = NULL;
+#if defined ZMQ_HAVE_CHUNK_CACHE
+            base = pop_cached_chunk (list);
+#endif
+            if (!base)
+                base = pop_chunk (list, size_class, huge_pages, node);
+            if (base)
+                return init_chunk (base, offset, list);
+        }
+    }
+#endif
+
+    //  The heap only guarantees the alignment of basic types, so leave room
+    //  for aligning the chunk.
+    void *const base = malloc (offset + size_ + align_ - 1);
+    alloc_assert (base);
+    const size_t misalignment =
+      (reinterpret_cast<uintptr_t> (base) + offset) & (align_ - 1);
+    return init_chunk (base, misalignment ? offset + align_ - misalignment
+                                          : offset,
+                       -1);
+}
+
+void zmq::chunk_pool_free (void *chunk_)
+{
+    if (!chunk_)
+        return;
+
+    const header_t *const header = static_cast<header_t *> (chunk_) - 1;
+    void *const base = header->base;
+    const int list = header->list;
+    if (list == -1) {
+        free (base);
+        return;
+    }
+
+#if defined ZMQ_HAVE_CHUNK_POOL
+    //  The chunk may overlap its header, which was read already.
+#if defined ZMQ_HAVE_CHUNK_CACHE
+    if (pool_in_use () && push_cached_chunk (list, base))
+        return;
+#endif
+    push_chunk (list, base);
+#else
+    zmq_assert (false);
+#endif
+}
@@ -0,0 +1,39 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_CHUNK_POOL_HPP_INCLUDED__
+#define __ZMQ_CHUNK_POOL_HPP_INCLUDED__
+
+#include <stddef.h>
+
+namespace zmq
+{
+//  Process-wide allocator for the long-lived chunks of memory that messages
+//  pass through, such as the chunks of pipes and the buffers of decoders.
+//  When in use, chunks are carved from regions backed by huge pages, to
+//  reduce TLB misses, and/or bound to the NUMA node of the thread that
+//  allocates them, to avoid cross-node traffic. Otherwise, and for chunks
+//  too large to be pooled, chunks are allocated from the heap.
+
+enum
+{
+    chunk_pool_huge_pages = 1,
+    chunk_pool_numa_local = 2
+};
+
+//  Enables or disables features of the pool on behalf of a context.
+//  Refcounted, so that a feature is in use as long as any context has it
+//  enabled.
+void chunk_pool_enable (int features_);
+void chunk_pool_disable (int features_);
+
+//  Returns a chunk of size_ bytes aligned to align_, which must be a power
+//  of two. Never fails: out of memory is asserted as with the heap.
+void *chunk_pool_alloc (size_t size_, size_t align_ = 2 * sizeof (void *));
+
+//  Returns a chunk obtained from chunk_pool_alloc, or does nothing if the
+//  chunk is NULL. Can be called from any thread and regardless of whether
+//  the pool is still in use.
+void chunk_pool_free (void *chunk_);
+}
+
+#endif
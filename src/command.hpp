@@ -15,6 +15,7 @@ class own_t;
 struct i_engine;
 class pipe_t;
 class socket_base_t;
+struct pipe_latency_t;
 
 //  This structure defines the commands that can be sent between threads.
 
@@ -46,6 +47,7 @@ struct command_t
         conn_failed,
         pipe_peer_stats,
         pipe_stats_publish,
+        work_done,
         done
     } type;
 
@@ -165,6 +167,7 @@ struct command_t
             uint64_t queue_count;
             zmq::own_t *socket_base;
             endpoint_uri_pair_t *endpoint_pair;
+            pipe_latency_t *latency;
         } pipe_peer_stats;
 
         //  Collate application thread and I/O thread pipe counts and endpoints
@@ -174,8 +177,17 @@ struct command_t
             uint64_t outbound_queue_count;
             uint64_t inbound_queue_count;
             endpoint_uri_pair_t *endpoint_pair;
+            pipe_latency_t *latency;
         } pipe_stats_publish;
 
+        //  Sent by a worker of a pool to the I/O thread which handed it a
+        //  job, once all of the tasks of the job have run. The parameter is
+        //  actually of type worker_pool_t::job_t.
+        struct
+        {
+            void *job;
+        } work_done;
+
         //  Sent by reaper thread to the term thread when all the sockets
         //  are successfully deallocated.
         struct
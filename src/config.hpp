@@ -31,6 +31,51 @@ enum
     //  Maximum number of events the I/O thread can process in one go.
     max_io_events = 256,
 
+    //  Message data chunks of at least this many bytes are passed to the
+    //  socket by reference in a vectored write rather than being copied
+    //  into the engine's output batch.
+    out_ref_threshold = 1024,
+
+    //  Maximum number of buffers passed to a single vectored write.
+    max_out_iov = 16,
+
+    //  When zero-copy transmission is enabled, a batch is sent that way
+    //  if it references at least this many bytes of message data. Below
+    //  this size, tracking the completion costs more than copying.
+    out_zerocopy_threshold = 16384,
+
+    //  Maximum time, in milliseconds, an engine being destroyed waits for
+    //  its zero-copy writes to complete. The messages of the writes that
+    //  are still pending then are never released.
+    zerocopy_linger = 1000,
+
+    //  When CURVE batching is negotiated, messages of at least this many
+    //  bytes are boxed on their own: the box overhead saved by batching
+    //  them is small next to copying them into the batch.
+    curve_batch_max_msg_size = 1024,
+
+    //  Maximum number of datagrams sent or received by a UDP engine in
+    //  a single system call.
+    udp_batch_size = 32,
+
+    //  Number of blocks the message pool moves between a thread's cache
+    //  and the shared depot at once, and the maximum number of such
+    //  batches kept in the depot per size class.
+    msg_pool_batch_size = 32,
+    msg_pool_max_batches = 64,
+
+    //  Number of free chunks of the chunk pool each thread keeps for
+    //  itself, whatever their size and node.
+    chunk_pool_cache_size = 8,
+
+    //  Number of times a socket spinning in recv checks for commands
+    //  between readings of the clock.
+    rcvspin_checks = 64,
+
+    //  Number of send timestamps kept per pipe when latency statistics are
+    //  enabled. Messages queued beyond it are not accounted for properly.
+    latency_stamps_size = 1024,
+
     //  Maximal batch size of packets forwarded by a ZMQ proxy.
     //  Increasing this value improves throughput at the expense of
     //  latency and fairness.
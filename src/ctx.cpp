@@ -19,7 +19,10 @@
 #include "pipe.hpp"
 #include "err.hpp"
 #include "msg.hpp"
+#include "msg_pool.hpp"
+#include "chunk_pool.hpp"
 #include "random.hpp"
+#include "worker_pool.hpp"
 
 #ifdef ZMQ_HAVE_VMCI
 #include <vmci_sockets.h>
@@ -56,7 +59,13 @@ zmq::ctx_t::ctx_t () :
     _io_thread_count (ZMQ_IO_THREADS_DFLT),
     _blocky (true),
     _ipv6 (false),
-    _zero_copy (true)
+    _zero_copy (true),
+    _msg_pool (false),
+    _chunk_pool_features (0),
+    _curve_thread_count (0),
+    _curve_pool (NULL),
+    _io_uring (false),
+    _io_thread_locality (0)
 {
 #ifdef HAVE_FORK
     _pid = getpid ();
@@ -88,6 +97,10 @@ zmq::ctx_t::~ctx_t ()
     //  Check that there are no remaining _sockets.
     zmq_assert (_sockets.empty ());
 
+    //  The jobs of the CURVE pool are handed back to the I/O threads which
+    //  submitted them, so the pool is stopped before them.
+    LIBZMQ_DELETE (_curve_pool);
+
     //  Ask I/O threads to terminate. If stop signal wasn't sent to I/O
     //  thread subsequent invocation of destructor would hang-up.
     const io_threads_t::size_type io_threads_size = _io_threads.size ();
@@ -106,6 +119,11 @@ zmq::ctx_t::~ctx_t ()
     //  The mailboxes in _slots themselves were deallocated with their
     //  corresponding io_thread/socket objects.
 
+    if (_msg_pool)
+        zmq::msg_pool_disable ();
+    if (_chunk_pool_features)
+        zmq::chunk_pool_disable (_chunk_pool_features);
+
     //  De-initialise crypto library, if needed.
     zmq::random_close ();
 
@@ -284,6 +302,54 @@ int zmq::ctx_t::set (int option_, const void *optval_, size_t optvallen_)
             }
             break;
 
+        case ZMQ_MSG_POOL:
+            if (is_int && value >= 0) {
+                scoped_lock_t locker (_opt_sync);
+                if (_msg_pool != (value != 0)) {
+                    _msg_pool = (value != 0);
+                    if (_msg_pool)
+                        msg_pool_enable ();
+                    else
+                        msg_pool_disable ();
+                }
+                return 0;
+            }
+            break;
+
+        case ZMQ_HUGE_PAGES:
+            if (is_int && value >= 0) {
+                scoped_lock_t locker (_opt_sync);
+                set_chunk_pool_feature (chunk_pool_huge_pages, value != 0);
+                return 0;
+            }
+            break;
+
+        case ZMQ_NUMA_LOCAL:
+            if (is_int && value >= 0) {
+                scoped_lock_t locker (_opt_sync);
+                set_chunk_pool_feature (chunk_pool_numa_local, value != 0);
+                return 0;
+            }
+            break;
+
+        case ZMQ_CURVE_THREADS:
+            if (is_int && value >= 0) {
+                scoped_lock_t locker (_opt_sync);
+                _curve_thread_count = value;
+                return 0;
+            }
+            break;
+
+#if defined ZMQ_HAVE_IO_URING
+        case ZMQ_IO_URING:
+            if (is_int && value >= 0) {
+                scoped_lock_t locker (_opt_sync);
+                _io_uring = (value != 0);
+                return 0;
+            }
+            break;
+#endif
+
         default: {
             return thread_ctx_t::set (option_, optval_, optvallen_);
         }
@@ -362,6 +428,46 @@ int zmq::ctx_t::get (int option_, void *optval_, const size_t *optvallen_)
             }
             break;
 
+        case ZMQ_MSG_POOL:
+            if (is_int) {
+                scoped_lock_t locker (_opt_sync);
+                *value = _msg_pool;
+                return 0;
+            }
+            break;
+
+        case ZMQ_HUGE_PAGES:
+            if (is_int) {
+                scoped_lock_t locker (_opt_sync);
+                *value = (_chunk_pool_features & chunk_pool_huge_pages) != 0;
+                return 0;
+            }
+            break;
+
+        case ZMQ_NUMA_LOCAL:
+            if (is_int) {
+                scoped_lock_t locker (_opt_sync);
+                *value = (_chunk_pool_features & chunk_pool_numa_local) != 0;
+                return 0;
+            }
+            break;
+
+        case ZMQ_CURVE_THREADS:
+            if (is_int) {
+                scoped_lock_t locker (_opt_sync);
+                *value = _curve_thread_count;
+                return 0;
+            }
+            break;
+
+        case ZMQ_IO_URING:
+            if (is_int) {
+                scoped_lock_t locker (_opt_sync);
+                *value = _io_uring;
+                return 0;
+            }
+            break;
+
         default: {
             return thread_ctx_t::get (option_, optval_, optvallen_);
         }
@@ -383,6 +489,19 @@ int zmq::ctx_t::get (int option_)
     return -1;
 }
 
+void zmq::ctx_t::set_chunk_pool_feature (int feature_, bool enable_)
+{
+    if (((_chunk_pool_features & feature_) != 0) == enable_)
+        return;
+    if (enable_) {
+        _chunk_pool_features |= feature_;
+        chunk_pool_enable (feature_);
+    } else {
+        _chunk_pool_features &= ~feature_;
+        chunk_pool_disable (feature_);
+    }
+}
+
 bool zmq::ctx_t::start ()
 {
     //  Initialise the array of mailboxes. Additional two slots are for
@@ -391,6 +510,8 @@ bool zmq::ctx_t::start ()
     const int term_and_reaper_threads_count = 2;
     const int mazmq = _max_sockets;
     const int ios = _io_thread_count;
+    const int curve_threads = _curve_thread_count;
+    const bool io_uring = _io_uring;
     _opt_sync.unlock ();
     const int slot_count = mazmq + ios + term_and_reaper_threads_count;
     try {
@@ -422,7 +543,8 @@ bool zmq::ctx_t::start ()
 
     for (int i = term_and_reaper_threads_count;
          i != ios + term_and_reaper_threads_count; i++) {
-        io_thread_t *io_thread = new (std::nothrow) io_thread_t (this, i);
+        io_thread_t *io_thread =
+          new (std::nothrow) io_thread_t (this, i, io_uring);
         if (!io_thread) {
             errno = ENOMEM;
             goto fail_cleanup_reaper;
@@ -436,6 +558,13 @@ bool zmq::ctx_t::start ()
         io_thread->start ();
     }
 
+    //  Launch the threads sealing and opening CURVE boxes, if any.
+    if (curve_threads > 0) {
+        _curve_pool = new (std::nothrow) worker_pool_t;
+        alloc_assert (_curve_pool);
+        _curve_pool->start (*this, curve_threads);
+    }
+
     //  In the unused part of the slot array, create a list of empty slots.
     for (int32_t i = static_cast<int32_t> (_slots.size ()) - 1;
          i >= static_cast<int32_t> (ios) + term_and_reaper_threads_count; i--) {
@@ -519,6 +648,21 @@ zmq::object_t *zmq::ctx_t::get_reaper () const
     return _reaper;
 }
 
+zmq::worker_pool_t *zmq::ctx_t::get_curve_pool () const
+{
+    return _curve_pool;
+}
+
+void zmq::ctx_t::enable_io_thread_locality ()
+{
+    _io_thread_locality.store (1);
+}
+
+bool zmq::ctx_t::io_thread_locality () const
+{
+    return _io_thread_locality.load () != 0;
+}
+
 zmq::thread_ctx_t::thread_ctx_t () :
     _thread_priority (ZMQ_THREAD_PRIORITY_DFLT),
     _thread_sched_policy (ZMQ_THREAD_SCHED_POLICY_DFLT)
@@ -644,25 +788,65 @@ void zmq::ctx_t::send_command (uint32_t tid_, const command_t &command_)
     _slots[tid_]->send (command_);
 }
 
-zmq::io_thread_t *zmq::ctx_t::choose_io_thread (uint64_t affinity_)
+zmq::io_thread_t *zmq::ctx_t::choose_io_thread (uint64_t affinity_,
+                                                int cpu_,
+                                                unsigned int napi_id_)
 {
     if (_io_threads.empty ())
         return NULL;
 
-    //  Find the I/O thread with minimum load.
+    io_threads_t::size_type napi_io_thread = _io_threads.size ();
+    if (napi_id_) {
+        scoped_lock_t locker (_napi_io_threads_sync);
+        const napi_io_threads_t::const_iterator it =
+          _napi_io_threads.find (napi_id_);
+        if (it != _napi_io_threads.end ())
+            napi_io_thread = it->second;
+    }
+
+    //  Find the closest I/O thread, and the one with minimum load among
+    //  equally close ones. The node of the CPU is looked up only if needed.
+    int cpu_node = -2;
+    int max_rank = -1;
     int min_load = -1;
-    io_thread_t *selected_io_thread = NULL;
+    io_threads_t::size_type selected = _io_threads.size ();
     for (io_threads_t::size_type i = 0, size = _io_threads.size (); i != size;
          i++) {
         if (!affinity_ || (affinity_ & (uint64_t (1) << i))) {
+            int rank = 0;
+            if (i == napi_io_thread)
+                rank = 2;
+            if (cpu_ != -1) {
+                int thread_cpu;
+                int thread_node;
+                _io_threads[i]->get_cpu (&thread_cpu, &thread_node);
+                if (thread_cpu == cpu_)
+                    rank = 3;
+                else if (rank == 0 && thread_node != -1) {
+                    if (cpu_node == -2)
+                        cpu_node = get_cpu_node (cpu_);
+                    if (thread_node == cpu_node)
+                        rank = 1;
+                }
+            }
             const int load = _io_threads[i]->get_load ();
-            if (selected_io_thread == NULL || load < min_load) {
+            if (selected == size || rank > max_rank
+                || (rank == max_rank && load < min_load)) {
+                max_rank = rank;
                 min_load = load;
-                selected_io_thread = _io_threads[i];
+                selected = i;
             }
         }
     }
-    return selected_io_thread;
+    if (selected == _io_threads.size ())
+        return NULL;
+
+    //  Keep connections from the same receive queue together.
+    if (napi_id_ && selected != napi_io_thread) {
+        scoped_lock_t locker (_napi_io_threads_sync);
+        _napi_io_threads[napi_id_] = selected;
+    }
+    return _io_threads[selected];
 }
 
 int zmq::ctx_t::register_endpoint (const char *addr_,
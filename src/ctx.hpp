@@ -15,6 +15,7 @@
 #include "stdint.hpp"
 #include "options.hpp"
 #include "atomic_counter.hpp"
+#include "atomic_ptr.hpp"
 #include "thread.hpp"
 
 namespace zmq
@@ -24,6 +25,7 @@ class io_thread_t;
 class socket_base_t;
 class reaper_t;
 class pipe_t;
+class worker_pool_t;
 
 //  Information associated with inproc endpoint. Note that endpoint options
 //  are registered as well so that the peer can access them without a need
@@ -101,12 +103,26 @@ class ctx_t ZMQ_FINAL : public thread_ctx_t
 
     //  Returns the I/O thread that is the least busy at the moment.
     //  Affinity specifies which I/O threads are eligible (0 = all).
+    //  If a CPU or a NIC receive queue is given, I/O threads running on that
+    //  CPU, serving that queue already, or on the same NUMA node are
+    //  preferred, in that order, over less busy ones.
     //  Returns NULL if no I/O thread is available.
-    zmq::io_thread_t *choose_io_thread (uint64_t affinity_);
+    zmq::io_thread_t *choose_io_thread (uint64_t affinity_,
+                                        int cpu_ = -1,
+                                        unsigned int napi_id_ = 0);
 
     //  Returns reaper thread object.
     zmq::object_t *get_reaper () const;
 
+    //  Returns the pool of threads sealing and opening CURVE boxes on
+    //  behalf of I/O threads, or NULL if they do it themselves.
+    zmq::worker_pool_t *get_curve_pool () const;
+
+    //  Called when a socket sets ZMQ_IO_THREAD_LOCALITY. From then on, I/O
+    //  threads track the CPU they run on.
+    void enable_io_thread_locality ();
+    bool io_thread_locality () const;
+
     //  Management of inproc endpoints.
     int register_endpoint (const char *addr_, const endpoint_t &endpoint_);
     int unregister_endpoint (const std::string &addr_,
@@ -176,6 +192,11 @@ class ctx_t ZMQ_FINAL : public thread_ctx_t
     typedef std::vector<zmq::io_thread_t *> io_threads_t;
     io_threads_t _io_threads;
 
+    //  I/O threads chosen for connections from each NIC receive queue.
+    typedef std::map<unsigned int, io_threads_t::size_type> napi_io_threads_t;
+    napi_io_threads_t _napi_io_threads;
+    mutex_t _napi_io_threads_sync;
+
     //  Array of pointers to mailboxes for both application and I/O threads.
     std::vector<i_mailbox *> _slots;
 
@@ -215,6 +236,25 @@ class ctx_t ZMQ_FINAL : public thread_ctx_t
     // Should we use zero copy message decoding in this context?
     bool _zero_copy;
 
+    //  Has this context enabled the message pool?
+    bool _msg_pool;
+
+    //  Features of the chunk pool this context has enabled.
+    int _chunk_pool_features;
+
+    //  Number of threads of the CURVE pool to launch, and the pool.
+    int _curve_thread_count;
+    zmq::worker_pool_t *_curve_pool;
+
+    //  Do the engines submit their reads and writes to an io_uring?
+    bool _io_uring;
+
+    //  Whether any socket uses ZMQ_IO_THREAD_LOCALITY.
+    atomic_value_t _io_thread_locality;
+
+    //  Enables or disables a feature of the chunk pool for this context.
+    void set_chunk_pool_feature (int feature_, bool enable_);
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (ctx_t)
 
 #ifdef HAVE_FORK
@@ -151,11 +151,14 @@ int zmq::curve_client_t::process_welcome (const uint8_t *msg_data_,
 
 int zmq::curve_client_t::produce_initiate (msg_t *msg_)
 {
-    const size_t metadata_length = basic_properties_len ();
+    const size_t metadata_length =
+      basic_properties_len () + batch_property_len ();
     std::vector<unsigned char, secure_allocator_t<unsigned char> >
       metadata_plaintext (metadata_length);
 
-    add_basic_properties (&metadata_plaintext[0], metadata_length);
+    unsigned char *ptr = &metadata_plaintext[0];
+    ptr += add_basic_properties (ptr, metadata_length);
+    add_batch_property (ptr, metadata_length - (ptr - &metadata_plaintext[0]));
 
     const size_t msg_size =
       113 + 128 + crypto_box_BOXZEROBYTES + metadata_length;
@@ -216,9 +219,10 @@ int zmq::curve_client_t::process_ready (const uint8_t *msg_data_,
     rc = parse_metadata (&ready_plaintext[crypto_box_ZEROBYTES],
                          clen - crypto_box_ZEROBYTES);
 
-    if (rc == 0)
+    if (rc == 0) {
+        negotiate_batching ();
         _state = connected;
-    else {
+    } else {
         session->get_socket ()->event_handshake_failed_protocol (
           session->get_endpoint (), ZMQ_PROTOCOL_ERROR_ZMTP_INVALID_METADATA);
         errno = EPROTO;
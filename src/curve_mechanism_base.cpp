@@ -6,11 +6,15 @@
 #include "msg.hpp"
 #include "wire.hpp"
 #include "session_base.hpp"
+#include "ctx.hpp"
+
+#include <algorithm>
 
 #ifdef ZMQ_HAVE_CURVE
 
 #ifdef ZMQ_USE_LIBSODIUM
-//  libsodium added crypto_box_easy_afternm and crypto_box_open_easy_afternm with
+//  libsodium added crypto_box_easy_afternm and crypto_box_open_easy_afternm,
+//  along with their detached variants, with
 //  https: //github.com/jedisct1/libsodium/commit/aaf5fbf2e53a33b18d8ea9bdf2c6f73d7acc8c3e
 #if SODIUM_LIBRARY_VERSION_MAJOR > 7                                           \
   || (SODIUM_LIBRARY_VERSION_MAJOR == 7 && SODIUM_LIBRARY_VERSION_MINOR >= 4)
@@ -26,13 +30,80 @@ zmq::curve_mechanism_base_t::curve_mechanism_base_t (
   const bool downgrade_sub_) :
     mechanism_base_t (session_, options_),
     curve_encoding_t (
-      encode_nonce_prefix_, decode_nonce_prefix_, downgrade_sub_)
+      encode_nonce_prefix_, decode_nonce_prefix_, downgrade_sub_),
+    _peer_batches (false)
+{
+    set_pool (session_->get_ctx ()->get_curve_pool (),
+              session_->get_io_thread ());
+}
+
+size_t zmq::curve_mechanism_base_t::pool_boxes () const
 {
+    //  Each thread of the pool is handed two boxes, so that a round trip
+    //  through the pool is paid for by more than one box per thread.
+    return 2 * static_cast<size_t> (pool ()->workers ());
 }
 
 int zmq::curve_mechanism_base_t::encode (msg_t *msg_)
 {
-    return curve_encoding_t::encode (msg_);
+    //  Without a pool, the message is boxed in place, along with the ones
+    //  it is batched with.
+    if (!pool ()) {
+        if (batching () && msg_->size () < curve_batch_max_msg_size
+            && !batch_pulled (msg_))
+            return encode_batch (msg_);
+        return curve_encoding_t::encode (msg_);
+    }
+
+    //  Boxes queued or being sealed go out first, and the message is queued
+    //  behind them so that nonces keep increasing.
+    const bool ahead = boxes_queued () > 0 || sealing ();
+    queue_box (msg_);
+
+    if (!ahead) {
+        //  The messages ready to be sent are sealed along with this one, on
+        //  the threads of the pool.
+        msg_t msg;
+        int rc = msg.init ();
+        errno_assert (rc == 0);
+        while (boxes_queued () < pool_boxes ()
+               && session->pull_msg (&msg) == 0)
+            queue_box (&msg);
+        rc = msg.close ();
+        errno_assert (rc == 0);
+    }
+
+    if (seal_queued () == -1)
+        return -1;
+    const bool encoded = curve_encoding_t::encode_next (msg_);
+    zmq_assert (encoded);
+    return 0;
+}
+
+bool zmq::curve_mechanism_base_t::batch_pulled (msg_t *msg_)
+{
+    //  The small messages ready to be sent are batched along with this one,
+    //  up to the size of a batch of the engine. A large one ends the batch
+    //  and is boxed on its own.
+    add_to_batch (msg_);
+    const size_t max_batch_size = static_cast<size_t> (options.out_batch_size);
+    while (batch_size () < max_batch_size && session->pull_msg (msg_) == 0) {
+        if (msg_->size () >= curve_batch_max_msg_size)
+            return true;
+        add_to_batch (msg_);
+    }
+    return false;
+}
+
+void zmq::curve_mechanism_base_t::queue_box (msg_t *msg_)
+{
+    if (batching () && msg_->size () < curve_batch_max_msg_size) {
+        const bool large = batch_pulled (msg_);
+        queue_batch ();
+        if (!large)
+            return;
+    }
+    queue_message (msg_);
 }
 
 int zmq::curve_mechanism_base_t::decode (msg_t *msg_)
@@ -42,8 +113,55 @@ int zmq::curve_mechanism_base_t::decode (msg_t *msg_)
         return -1;
 
     int error_event_code;
-    rc = curve_encoding_t::decode (msg_, &error_event_code);
-    if (-1 == rc) {
+    if (!pool ())
+        rc = curve_encoding_t::decode (msg_, &error_event_code);
+    else {
+        //  Boxes are held back until there are enough of them to keep the
+        //  threads of the pool busy, or until the engine has no more input
+        //  to decode and calls flush_decode. Their messages are retrieved
+        //  by decode_next.
+        rc = hold (msg_, &error_event_code);
+        if (rc == 0 && (opening () || boxes_held () >= pool_boxes ()))
+            rc = open_held (&error_event_code);
+    }
+    if (-1 == rc && errno != EAGAIN) {
+        session->get_socket ()->event_handshake_failed_protocol (
+          session->get_endpoint (), error_event_code);
+    }
+
+    return rc;
+}
+
+bool zmq::curve_mechanism_base_t::encodes_ahead () const
+{
+    return pool () || batching ();
+}
+
+bool zmq::curve_mechanism_base_t::encode_next (msg_t *msg_)
+{
+    return curve_encoding_t::encode_next (msg_);
+}
+
+bool zmq::curve_mechanism_base_t::encoded_ahead () const
+{
+    return boxes_queued () > 0 || sealing ();
+}
+
+bool zmq::curve_mechanism_base_t::decode_next (msg_t *msg_)
+{
+    return curve_encoding_t::decode_next (msg_);
+}
+
+bool zmq::curve_mechanism_base_t::decode_deferred () const
+{
+    return pool () && holds_boxes ();
+}
+
+int zmq::curve_mechanism_base_t::flush_decode ()
+{
+    int error_event_code;
+    const int rc = open_held (&error_event_code);
+    if (-1 == rc && errno != EAGAIN) {
         session->get_socket ()->event_handshake_failed_protocol (
           session->get_endpoint (), error_event_code);
     }
@@ -51,6 +169,61 @@ int zmq::curve_mechanism_base_t::decode (msg_t *msg_)
     return rc;
 }
 
+void zmq::curve_mechanism_base_t::boxes_sealed ()
+{
+    session->restart_engine_output ();
+}
+
+void zmq::curve_mechanism_base_t::boxes_opened ()
+{
+    session->restart_engine_input ();
+}
+
+static const char batch_property_name[] = "Curve-Batch";
+
+int zmq::curve_mechanism_base_t::property (const std::string &name_,
+                                           const void *value_,
+                                           size_t length_)
+{
+    if (name_ == batch_property_name)
+        _peer_batches =
+          length_ == 1 && *static_cast<const char *> (value_) == '1';
+    return 0;
+}
+
+bool zmq::curve_mechanism_base_t::internal_property (
+  const std::string &name_) const
+{
+    return name_ == batch_property_name;
+}
+
+bool zmq::curve_mechanism_base_t::sends_batch_property () const
+{
+    //  The client offers batching, and the server only replies to offers.
+    return options.curve_batch && (!options.as_server || _peer_batches);
+}
+
+size_t zmq::curve_mechanism_base_t::batch_property_len () const
+{
+    return sends_batch_property () ? property_len (batch_property_name, 1)
+                                   : 0;
+}
+
+size_t
+zmq::curve_mechanism_base_t::add_batch_property (unsigned char *ptr_,
+                                                 size_t ptr_capacity_) const
+{
+    return sends_batch_property () ? add_property (ptr_, ptr_capacity_,
+                                                   batch_property_name, "1", 1)
+                                   : 0;
+}
+
+void zmq::curve_mechanism_base_t::negotiate_batching ()
+{
+    if (options.curve_batch && _peer_batches)
+        enable_batching (static_cast<size_t> (options.out_batch_size));
+}
+
 zmq::curve_encoding_t::curve_encoding_t (const char *encode_nonce_prefix_,
                                          const char *decode_nonce_prefix_,
                                          const bool downgrade_sub_) :
@@ -58,8 +231,61 @@ zmq::curve_encoding_t::curve_encoding_t (const char *encode_nonce_prefix_,
     _decode_nonce_prefix (decode_nonce_prefix_),
     _cn_nonce (1),
     _cn_peer_nonce (1),
-    _downgrade_sub (downgrade_sub_)
+    _downgrade_sub (downgrade_sub_),
+    _batching (false),
+    _batch_len (0),
+    _batch_capacity (0),
+    _batch_in_pos (0),
+    _batch_in_end (0),
+    _pool (NULL),
+    _thread (NULL),
+    _out_sealed (0),
+    _out_pos (0),
+    _sealing (NULL),
+    _in_opened (0),
+    _in_pos (0),
+    _opening (NULL),
+    _open_error (0)
+{
+    int rc = _batch_out.init ();
+    errno_assert (rc == 0);
+    rc = _batch_in.init ();
+    errno_assert (rc == 0);
+}
+
+void zmq::curve_encoding_t::close_boxes (std::vector<box_t> &boxes_,
+                                         size_t first_,
+                                         const job_t *job_)
 {
+    for (size_t i = first_; i != boxes_.size (); i++) {
+        if (job_ && i >= job_->first && i < job_->first + job_->boxes.size ())
+            continue;
+        const int rc = boxes_[i].msg.close ();
+        errno_assert (rc == 0);
+    }
+}
+
+zmq::curve_encoding_t::~curve_encoding_t ()
+{
+    int rc = _batch_out.close ();
+    errno_assert (rc == 0);
+    rc = _batch_in.close ();
+    errno_assert (rc == 0);
+
+    if (_sealing)
+        _sealing->owner = NULL;
+    if (_opening)
+        _opening->owner = NULL;
+    close_boxes (_out, _out_pos, _sealing);
+    close_boxes (_in, _in_pos, _opening);
+}
+
+void zmq::curve_encoding_t::set_pool (worker_pool_t *pool_,
+                                      io_thread_t *thread_)
+{
+    zmq_assert (pool_ == NULL || thread_ != NULL);
+    _pool = pool_;
+    _thread = thread_;
 }
 
 //  Right now, we only transport the lower two bit flags of zmq::msg_t, so they
@@ -77,6 +303,14 @@ static const size_t message_header_len =
 static const size_t crypto_box_MACBYTES = 16;
 #endif
 
+//  Each message of a batch is prefixed with the size of its flags and body.
+static const size_t batch_size_len = 4;
+
+//  Boxes are only handed over to the threads of a pool if there are at least
+//  that many bytes to seal or open, below which waking the threads up costs
+//  more than what they take off the calling thread.
+static const size_t pool_min_size = 32768;
+
 int zmq::curve_encoding_t::check_validity (msg_t *msg_, int *error_event_code_)
 {
     const size_t size = msg_->size ();
@@ -108,179 +342,584 @@ int zmq::curve_encoding_t::check_validity (msg_t *msg_, int *error_event_code_)
     return 0;
 }
 
-int zmq::curve_encoding_t::encode (msg_t *msg_)
+void zmq::curve_encoding_t::enable_batching (size_t batch_size_)
 {
-    size_t sub_cancel_len = 0;
-    uint8_t message_nonce[crypto_box_NONCEBYTES];
-    memcpy (message_nonce, _encode_nonce_prefix, nonce_prefix_len);
-    put_uint64 (message_nonce + nonce_prefix_len, get_and_inc_nonce ());
-
-    if (msg_->is_subscribe () || msg_->is_cancel ()) {
-        if (_downgrade_sub)
-            sub_cancel_len = 1;
-        else
-            sub_cancel_len = msg_->is_cancel ()
-                               ? zmq::msg_t::cancel_cmd_name_size
-                               : zmq::msg_t::sub_cmd_name_size;
-    }
-
-#ifdef ZMQ_HAVE_CRYPTO_BOX_EASY_FNS
-    const size_t mlen = flags_len + sub_cancel_len + msg_->size ();
-    std::vector<uint8_t> message_plaintext (mlen);
-#else
-    const size_t mlen =
-      crypto_box_ZEROBYTES + flags_len + sub_cancel_len + msg_->size ();
-    std::vector<uint8_t> message_plaintext_with_zerobytes (mlen);
-    uint8_t *const message_plaintext =
-      &message_plaintext_with_zerobytes[crypto_box_ZEROBYTES];
+    //  The last message batched, which is small, is the only one going past
+    //  the size the batch ends at.
+    _batching = true;
+    _batch_capacity = batch_size_ + batch_size_len + flags_len
+                      + zmq::msg_t::cancel_cmd_name_size
+                      + curve_batch_max_msg_size;
+}
 
-    std::fill (message_plaintext_with_zerobytes.begin (),
-               message_plaintext_with_zerobytes.begin () + crypto_box_ZEROBYTES,
-               0);
-#endif
+size_t zmq::curve_encoding_t::sub_cancel_len (const msg_t &msg_) const
+{
+    if (!msg_.is_subscribe () && !msg_.is_cancel ())
+        return 0;
+    if (_downgrade_sub)
+        return 1;
+    return msg_.is_cancel () ? zmq::msg_t::cancel_cmd_name_size
+                             : zmq::msg_t::sub_cmd_name_size;
+}
 
-    const uint8_t flags = msg_->flags () & flag_mask;
-    message_plaintext[0] = flags;
+void zmq::curve_encoding_t::write_plaintext (const msg_t &msg_,
+                                             size_t sub_cancel_len_,
+                                             uint8_t *plaintext_) const
+{
+    const uint8_t flags = msg_.flags () & flag_mask;
+    plaintext_[0] = flags;
 
     // For backward compatibility subscribe/cancel command messages are not stored with
     // the message flags, and are encoded in the encoder, so that messages for < 3.0 peers
     // can be encoded in the "old" 0/1 way rather than as commands.
-    if (sub_cancel_len == 1)
-        message_plaintext[flags_len] = msg_->is_subscribe () ? 1 : 0;
-    else if (sub_cancel_len == zmq::msg_t::sub_cmd_name_size) {
-        message_plaintext[0] |= zmq::msg_t::command;
-        memcpy (&message_plaintext[flags_len], zmq::sub_cmd_name,
+    if (sub_cancel_len_ == 1)
+        plaintext_[flags_len] = msg_.is_subscribe () ? 1 : 0;
+    else if (sub_cancel_len_ == zmq::msg_t::sub_cmd_name_size) {
+        plaintext_[0] |= zmq::msg_t::command;
+        memcpy (&plaintext_[flags_len], zmq::sub_cmd_name,
                 zmq::msg_t::sub_cmd_name_size);
-    } else if (sub_cancel_len == zmq::msg_t::cancel_cmd_name_size) {
-        message_plaintext[0] |= zmq::msg_t::command;
-        memcpy (&message_plaintext[flags_len], zmq::cancel_cmd_name,
+    } else if (sub_cancel_len_ == zmq::msg_t::cancel_cmd_name_size) {
+        plaintext_[0] |= zmq::msg_t::command;
+        memcpy (&plaintext_[flags_len], zmq::cancel_cmd_name,
                 zmq::msg_t::cancel_cmd_name_size);
     }
 
-    // this is copying the data from insecure memory, so there is no point in
-    // using secure_allocator_t for message_plaintext
-    if (msg_->size () > 0)
-        memcpy (&message_plaintext[flags_len + sub_cancel_len], msg_->data (),
-                msg_->size ());
+    if (msg_.size () > 0)
+        memcpy (&plaintext_[flags_len + sub_cancel_len_],
+                const_cast<msg_t &> (msg_).data (), msg_.size ());
+}
 
-#ifdef ZMQ_HAVE_CRYPTO_BOX_EASY_FNS
-    msg_t msg_box;
-    int rc =
-      msg_box.init_size (message_header_len + mlen + crypto_box_MACBYTES);
+uint8_t *zmq::curve_encoding_t::init_box (msg_t *msg_box_, size_t mlen_)
+{
+    //  Messages are boxed in place, in the command sent: the plaintext is
+    //  written after the room left for the header and the MAC, so that
+    //  neither a scratch buffer nor a second copy of it is needed.
+    const int rc =
+      msg_box_->init_size (message_header_len + crypto_box_MACBYTES + mlen_);
     zmq_assert (rc == 0);
 
-    rc = crypto_box_easy_afternm (
-      static_cast<uint8_t *> (msg_box.data ()) + message_header_len,
-      &message_plaintext[0], mlen, message_nonce, _cn_precom);
-    zmq_assert (rc == 0);
+    return static_cast<uint8_t *> (msg_box_->data ()) + message_header_len
+           + crypto_box_MACBYTES;
+}
 
-    msg_->move (msg_box);
+void zmq::curve_encoding_t::seal (msg_t *msg_box_,
+                                  size_t mlen_,
+                                  nonce_t nonce_,
+                                  const char *nonce_prefix_,
+                                  const uint8_t *precom_)
+{
+    uint8_t message_nonce[crypto_box_NONCEBYTES];
+    memcpy (message_nonce, nonce_prefix_, nonce_prefix_len);
+    put_uint64 (message_nonce + nonce_prefix_len, nonce_);
 
-    uint8_t *const message = static_cast<uint8_t *> (msg_->data ());
-#else
-    std::vector<uint8_t> message_box (mlen);
+    uint8_t *const message = static_cast<uint8_t *> (msg_box_->data ());
 
-    int rc =
-      crypto_box_afternm (&message_box[0], &message_plaintext_with_zerobytes[0],
-                          mlen, message_nonce, _cn_precom);
+#ifdef ZMQ_HAVE_CRYPTO_BOX_EASY_FNS
+    uint8_t *const message_plaintext =
+      message + message_header_len + crypto_box_MACBYTES;
+    const int rc = crypto_box_detached_afternm (
+      message_plaintext, message + message_header_len, message_plaintext,
+      mlen_, message_nonce, precom_);
+#else
+    //  The header and the MAC take the room of the zero bytes the plaintext
+    //  is prefixed with, and the header overwrites the zero bytes the box
+    //  comes out prefixed with.
+    memset (message, 0, crypto_box_ZEROBYTES);
+    const int rc =
+      crypto_box_afternm (message, message, crypto_box_ZEROBYTES + mlen_,
+                          message_nonce, precom_);
+#endif
     zmq_assert (rc == 0);
 
-    rc = msg_->close ();
-    zmq_assert (rc == 0);
+    memcpy (message, message_command, message_command_len);
+    memcpy (message + message_command_len, message_nonce + nonce_prefix_len,
+            sizeof (nonce_t));
+}
 
-    rc = msg_->init_size (16 + mlen - crypto_box_BOXZEROBYTES);
-    zmq_assert (rc == 0);
+size_t zmq::curve_encoding_t::init_message_box (const msg_t &msg_,
+                                                msg_t *msg_box_) const
+{
+    //  Once batching is negotiated, a message boxed on its own is a batch
+    //  of one.
+    const size_t sub_cancel_len = this->sub_cancel_len (msg_);
+    const size_t size = flags_len + sub_cancel_len + msg_.size ();
+    const size_t prefix_len = _batching ? batch_size_len : 0;
+    uint8_t *const plaintext = init_box (msg_box_, prefix_len + size);
+    if (_batching) {
+        zmq_assert (size <= UINT32_MAX);
+        put_uint32 (plaintext, static_cast<uint32_t> (size));
+    }
+    write_plaintext (msg_, sub_cancel_len, plaintext + prefix_len);
+    return prefix_len + size;
+}
 
-    uint8_t *const message = static_cast<uint8_t *> (msg_->data ());
+int zmq::curve_encoding_t::encode (msg_t *msg_)
+{
+    //  The message is boxed with the batch built so far, unless it is large
+    //  and goes in a box of its own after it.
+    if (_batch_len > 0 && msg_->size () < curve_batch_max_msg_size) {
+        add_to_batch (msg_);
+        return encode_batch (msg_);
+    }
 
-    memcpy (message + message_header_len, &message_box[crypto_box_BOXZEROBYTES],
-            mlen - crypto_box_BOXZEROBYTES);
-#endif
+    //  Unless boxes go out before it, the message is boxed in place.
+    if (_batch_len == 0 && boxes_queued () == 0 && !_sealing) {
+        msg_t msg_box;
+        const size_t mlen = init_message_box (*msg_, &msg_box);
+        seal (&msg_box, mlen, get_and_inc_nonce (), _encode_nonce_prefix,
+              _cn_precom);
+        const int rc = msg_->move (msg_box);
+        errno_assert (rc == 0);
+        return 0;
+    }
 
-    memcpy (message, message_command, message_command_len);
-    memcpy (message + message_command_len, message_nonce + nonce_prefix_len,
-            sizeof (nonce_t));
+    if (_batch_len > 0)
+        queue_batch ();
+    queue_message (msg_);
+    return encode_queued (msg_);
+}
+
+void zmq::curve_encoding_t::add_to_batch (msg_t *msg_)
+{
+    const size_t sub_cancel_len = this->sub_cancel_len (*msg_);
+    const size_t size = flags_len + sub_cancel_len + msg_->size ();
+    zmq_assert (size <= UINT32_MAX);
+
+    uint8_t *const frame = extend_batch (batch_size_len + size);
+    put_uint32 (frame, static_cast<uint32_t> (size));
+    write_plaintext (*msg_, sub_cancel_len, frame + batch_size_len);
+
+    int rc = msg_->close ();
+    errno_assert (rc == 0);
+    rc = msg_->init ();
+    errno_assert (rc == 0);
+}
+
+uint8_t *zmq::curve_encoding_t::extend_batch (size_t size_)
+{
+    //  The batch is written straight into the command sent. The rare batch
+    //  outgrowing it is moved to a larger one.
+    const size_t box_len = message_header_len + crypto_box_MACBYTES;
+    const size_t mlen = _batch_len + size_;
+    if (_batch_len == 0 || box_len + mlen > _batch_out.size ()) {
+        const size_t capacity =
+          std::max (mlen, std::max (2 * _batch_len, _batch_capacity));
+        msg_t msg_box;
+        uint8_t *const plaintext = init_box (&msg_box, capacity);
+        if (_batch_len > 0)
+            memcpy (plaintext,
+                    static_cast<uint8_t *> (_batch_out.data ()) + box_len,
+                    _batch_len);
+        const int rc = _batch_out.move (msg_box);
+        errno_assert (rc == 0);
+    }
+
+    uint8_t *const end =
+      static_cast<uint8_t *> (_batch_out.data ()) + box_len + _batch_len;
+    _batch_len = mlen;
+    return end;
+}
+
+int zmq::curve_encoding_t::encode_batch (msg_t *msg_)
+{
+    if (boxes_queued () > 0 || _sealing) {
+        queue_batch ();
+        return encode_queued (msg_);
+    }
 
+    const size_t mlen = _batch_len;
+    _batch_out.shrink (message_header_len + crypto_box_MACBYTES + mlen);
+    _batch_len = 0;
+    seal (&_batch_out, mlen, get_and_inc_nonce (), _encode_nonce_prefix,
+          _cn_precom);
+    const int rc = msg_->move (_batch_out);
+    errno_assert (rc == 0);
     return 0;
 }
 
-int zmq::curve_encoding_t::decode (msg_t *msg_, int *error_event_code_)
+int zmq::curve_encoding_t::encode_queued (msg_t *msg_)
 {
-    int rc = check_validity (msg_, error_event_code_);
-    if (0 != rc) {
-        return rc;
+    if (seal_queued () == -1)
+        return -1;
+    const bool encoded = encode_next (msg_);
+    zmq_assert (encoded);
+    return 0;
+}
+
+void zmq::curve_encoding_t::queue_message (msg_t *msg_)
+{
+    if (_out_pos == _out.size ()) {
+        _out.clear ();
+        _out_sealed = _out_pos = 0;
     }
 
-    uint8_t *const message = static_cast<uint8_t *> (msg_->data ());
+    box_t box;
+    box.mlen = init_message_box (*msg_, &box.msg);
+    box.nonce = get_and_inc_nonce ();
+    box.job = NULL;
+    _out.push_back (box);
+
+    int rc = msg_->close ();
+    errno_assert (rc == 0);
+    rc = msg_->init ();
+    errno_assert (rc == 0);
+}
+
+void zmq::curve_encoding_t::queue_batch ()
+{
+    if (_out_pos == _out.size ()) {
+        _out.clear ();
+        _out_sealed = _out_pos = 0;
+    }
+
+    box_t box;
+    box.mlen = _batch_len;
+    box.nonce = get_and_inc_nonce ();
+    box.job = NULL;
+    _batch_out.shrink (message_header_len + crypto_box_MACBYTES + box.mlen);
+    _batch_len = 0;
+    int rc = box.msg.init ();
+    errno_assert (rc == 0);
+    rc = box.msg.move (_batch_out);
+    errno_assert (rc == 0);
+    _out.push_back (box);
+}
+
+int zmq::curve_encoding_t::seal_queued ()
+{
+    if (!_sealing)
+        _sealing = submit (seal_task, _out, _out_sealed, _encode_nonce_prefix);
+    if (_sealing) {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    for (size_t i = _out_sealed; i != _out.size (); i++)
+        seal (&_out[i].msg, _out[i].mlen, _out[i].nonce, _encode_nonce_prefix,
+              _cn_precom);
+    _out_sealed = _out.size ();
+    return 0;
+}
+
+bool zmq::curve_encoding_t::encode_next (msg_t *msg_)
+{
+    if (_out_pos == _out_sealed)
+        return false;
+
+    const int rc = msg_->move (_out[_out_pos++].msg);
+    errno_assert (rc == 0);
+    return true;
+}
+
+void zmq::curve_encoding_t::seal_task (void *box_)
+{
+    box_t *const box = static_cast<box_t *> (box_);
+    seal (&box->msg, box->mlen, box->nonce, box->job->nonce_prefix,
+          box->job->precom);
+}
+
+void zmq::curve_encoding_t::open_task (void *box_)
+{
+    box_t *const box = static_cast<box_t *> (box_);
+    box->rc = open (&box->msg, box->job->nonce_prefix, box->job->precom);
+}
+
+zmq::curve_encoding_t::job_t *
+zmq::curve_encoding_t::submit (worker_pool_t::task_fn *task_,
+                               const std::vector<box_t> &boxes_,
+                               size_t first_,
+                               const char *nonce_prefix_)
+{
+    size_t size = 0;
+    for (size_t i = first_; i != boxes_.size (); i++)
+        size += boxes_[i].msg.size ();
+    if (_pool == NULL || boxes_.size () - first_ < 2 || size < pool_min_size)
+        return NULL;
+
+    //  The job gets copies of the commands, which the encoding leaves alone
+    //  until they are copied back.
+    job_t *const job = new (std::nothrow) job_t;
+    alloc_assert (job);
+    job->owner = this;
+    job->first = first_;
+    job->boxes.assign (boxes_.begin () + first_, boxes_.end ());
+    job->nonce_prefix = nonce_prefix_;
+    memcpy (job->precom, _cn_precom, crypto_box_BEFORENMBYTES);
+    for (size_t i = 0; i != job->boxes.size (); i++) {
+        job->boxes[i].job = job;
+        job->tasks.push_back (&job->boxes[i]);
+    }
+
+    job->fn = task_;
+    job->args = &job->tasks[0];
+    job->count = static_cast<int> (job->tasks.size ());
+    job->done = job_done;
+    job->thread = _thread;
+    _pool->submit (job);
+    return job;
+}
+
+void zmq::curve_encoding_t::job_done (void *job_)
+{
+    job_t *const job =
+      static_cast<job_t *> (static_cast<worker_pool_t::job_t *> (job_));
+
+    //  The owner may be destroyed when called back, so the job is deleted
+    //  beforehand.
+    curve_encoding_t *const owner = job->owner;
+    if (owner == NULL) {
+        close_boxes (job->boxes, 0, NULL);
+        delete job;
+    } else if (job->fn == seal_task)
+        owner->sealed (job);
+    else
+        owner->opened (job);
+}
+
+void zmq::curve_encoding_t::sealed (job_t *job_)
+{
+    zmq_assert (job_ == _sealing);
+    std::copy (job_->boxes.begin (), job_->boxes.end (),
+               _out.begin () + job_->first);
+    _out_sealed = job_->first + job_->boxes.size ();
+    _sealing = NULL;
+    delete job_;
+
+    //  The commands queued in the meantime are sealed in turn.
+    if (_out_sealed != _out.size ())
+        seal_queued ();
+    boxes_sealed ();
+}
+
+void zmq::curve_encoding_t::opened (job_t *job_)
+{
+    zmq_assert (job_ == _opening);
+    std::copy (job_->boxes.begin (), job_->boxes.end (),
+               _in.begin () + job_->first);
+    const size_t end = job_->first + job_->boxes.size ();
+    _opening = NULL;
+    delete job_;
+
+    check_opened (end);
+    boxes_opened ();
+}
+
+int zmq::curve_encoding_t::open (msg_t *msg_box_,
+                                 const char *nonce_prefix_,
+                                 const uint8_t *precom_)
+{
+    uint8_t *const message = static_cast<uint8_t *> (msg_box_->data ());
 
     uint8_t message_nonce[crypto_box_NONCEBYTES];
-    memcpy (message_nonce, _decode_nonce_prefix, nonce_prefix_len);
+    memcpy (message_nonce, nonce_prefix_, nonce_prefix_len);
     memcpy (message_nonce + nonce_prefix_len, message + message_command_len,
             sizeof (nonce_t));
 
 #ifdef ZMQ_HAVE_CRYPTO_BOX_EASY_FNS
-    const size_t clen = msg_->size () - message_header_len;
-
-    uint8_t *const message_plaintext = message + message_header_len;
-
-    rc = crypto_box_open_easy_afternm (message_plaintext,
-                                       message + message_header_len, clen,
-                                       message_nonce, _cn_precom);
+    uint8_t *const message_plaintext =
+      message + message_header_len + crypto_box_MACBYTES;
+    return crypto_box_open_detached_afternm (
+      message_plaintext, message_plaintext, message + message_header_len,
+      msg_box_->size () - message_header_len - crypto_box_MACBYTES,
+      message_nonce, precom_);
 #else
+    //  The header, not needed anymore, takes the room of the zero bytes the
+    //  box must be prefixed with.
+    memset (message, 0, crypto_box_BOXZEROBYTES);
+    return crypto_box_open_afternm (message, message, msg_box_->size (),
+                                    message_nonce, precom_);
+#endif
+}
+
+int zmq::curve_encoding_t::check_batch (const msg_t &msg_box_,
+                                        int *error_event_code_)
+{
+    //  The sizes of all the messages are checked before any of them is
+    //  decoded, so that decode_next cannot fail. A batch holds at least one
+    //  message.
+    const uint8_t *const plaintext =
+      static_cast<const uint8_t *> (const_cast<msg_t &> (msg_box_).data ())
+      + message_header_len + crypto_box_MACBYTES;
     const size_t clen =
-      crypto_box_BOXZEROBYTES + msg_->size () - message_header_len;
+      msg_box_.size () - message_header_len - crypto_box_MACBYTES;
+
+    size_t pos = 0;
+    do {
+        const size_t size =
+          clen - pos < batch_size_len ? 0 : get_uint32 (plaintext + pos);
+        if (size < flags_len || size > clen - pos - batch_size_len) {
+            *error_event_code_ =
+              ZMQ_PROTOCOL_ERROR_ZMTP_MALFORMED_COMMAND_MESSAGE;
+            errno = EPROTO;
+            return -1;
+        }
+        pos += batch_size_len + size;
+    } while (pos != clen);
 
-    std::vector<uint8_t> message_plaintext_with_zerobytes (clen);
-    std::vector<uint8_t> message_box (clen);
+    return 0;
+}
 
-    std::fill (message_box.begin (),
-               message_box.begin () + crypto_box_BOXZEROBYTES, 0);
-    memcpy (&message_box[crypto_box_BOXZEROBYTES], message + message_header_len,
-            msg_->size () - message_header_len);
+void zmq::curve_encoding_t::unbox (msg_t *msg_)
+{
+    //  The payload is moved to the start of the message.
+    uint8_t *const message = static_cast<uint8_t *> (msg_->data ());
+    const uint8_t *const message_plaintext =
+      message + message_header_len + crypto_box_MACBYTES;
+    const uint8_t flags = message_plaintext[0];
+    const size_t plaintext_size =
+      msg_->size () - message_header_len - crypto_box_MACBYTES - flags_len;
 
-    rc = crypto_box_open_afternm (&message_plaintext_with_zerobytes[0],
-                                  &message_box[0], clen, message_nonce,
-                                  _cn_precom);
+    if (plaintext_size > 0) {
+        memmove (message, &message_plaintext[flags_len], plaintext_size);
+    }
 
-    const uint8_t *const message_plaintext =
-      &message_plaintext_with_zerobytes[crypto_box_ZEROBYTES];
-#endif
+    msg_->shrink (plaintext_size);
+    msg_->set_flags (flags & flag_mask);
+}
 
-    if (rc == 0) {
-        const uint8_t flags = message_plaintext[0];
+void zmq::curve_encoding_t::start_batch (msg_t *msg_box_)
+{
+    _batch_in_pos = message_header_len + crypto_box_MACBYTES;
+    _batch_in_end = msg_box_->size ();
+    const int rc = _batch_in.move (*msg_box_);
+    errno_assert (rc == 0);
+}
 
-#ifdef ZMQ_HAVE_CRYPTO_BOX_EASY_FNS
-        const size_t plaintext_size = clen - flags_len - crypto_box_MACBYTES;
+int zmq::curve_encoding_t::decode (msg_t *msg_, int *error_event_code_)
+{
+    const int rc = check_validity (msg_, error_event_code_);
+    if (0 != rc) {
+        return rc;
+    }
 
-        if (plaintext_size > 0) {
-            memmove (msg_->data (), &message_plaintext[flags_len],
-                     plaintext_size);
-        }
+    if (open (msg_, _decode_nonce_prefix, _cn_precom) != 0) {
+        // CURVE I : connection key used for MESSAGE is wrong
+        *error_event_code_ = ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC;
+        errno = EPROTO;
+        return -1;
+    }
 
-        msg_->shrink (plaintext_size);
-#else
-        rc = msg_->close ();
-        zmq_assert (rc == 0);
+    if (!_batching) {
+        unbox (msg_);
+        return 0;
+    }
+
+    if (check_batch (*msg_, error_event_code_) == -1)
+        return -1;
+    start_batch (msg_);
+    const bool decoded = decode_next (msg_);
+    zmq_assert (decoded);
+    return 0;
+}
+
+int zmq::curve_encoding_t::hold (msg_t *msg_, int *error_event_code_)
+{
+    if (check_validity (msg_, error_event_code_) != 0)
+        return -1;
 
-        rc = msg_->init_size (clen - flags_len - crypto_box_ZEROBYTES);
-        zmq_assert (rc == 0);
+    if (_in_pos == _in.size ()) {
+        _in.clear ();
+        _in_opened = _in_pos = 0;
+    }
+
+    box_t box;
+    box.rc = 0;
+    box.job = NULL;
+    int rc = box.msg.init ();
+    errno_assert (rc == 0);
+    rc = box.msg.move (*msg_);
+    errno_assert (rc == 0);
+    _in.push_back (box);
+    return 0;
+}
 
-        // this is copying the data to insecure memory, so there is no point in
-        // using secure_allocator_t for message_plaintext
-        if (msg_->size () > 0) {
-            memcpy (msg_->data (), &message_plaintext[flags_len],
-                    msg_->size ());
+int zmq::curve_encoding_t::open_held (int *error_event_code_)
+{
+    if (!_opening && !_open_error && _in_opened != _in.size ()) {
+        _opening = submit (open_task, _in, _in_opened, _decode_nonce_prefix);
+        if (!_opening) {
+            for (size_t i = _in_opened; i != _in.size (); i++)
+                _in[i].rc =
+                  open (&_in[i].msg, _decode_nonce_prefix, _cn_precom);
+            check_opened (_in.size ());
         }
-#endif
+    }
+    if (_opening) {
+        errno = EAGAIN;
+        return -1;
+    }
 
-        msg_->set_flags (flags & flag_mask);
-    } else {
-        // CURVE I : connection key used for MESSAGE is wrong
-        *error_event_code_ = ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC;
+    //  A command failing to open is reported once the messages of the ones
+    //  before it are retrieved.
+    if (_open_error && _in_pos == _in_opened
+        && _batch_in_pos == _batch_in_end) {
+        *error_event_code_ = _open_error;
         errno = EPROTO;
+        return -1;
     }
+    return 0;
+}
 
-    return rc;
+void zmq::curve_encoding_t::check_opened (size_t end_)
+{
+    //  The commands are checked in order, so that the messages before the
+    //  first one failing are still decoded.
+    while (_in_opened != end_) {
+        const box_t &box = _in[_in_opened];
+        if (box.rc != 0) {
+            // CURVE I : connection key used for MESSAGE is wrong
+            _open_error = ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC;
+            return;
+        }
+        if (_batching && check_batch (box.msg, &_open_error) == -1)
+            return;
+        _in_opened++;
+    }
+}
+
+bool zmq::curve_encoding_t::holds_boxes () const
+{
+    return _in_pos != _in.size () || _batch_in_pos != _batch_in_end;
+}
+
+bool zmq::curve_encoding_t::decode_next (msg_t *msg_)
+{
+    if (_batch_in_pos == _batch_in_end) {
+        //  Moves on to the next of the boxes opened, if any.
+        if (_in_pos == _in_opened)
+            return false;
+        msg_t &msg_box = _in[_in_pos++].msg;
+        if (!_batching) {
+            const int rc = msg_->move (msg_box);
+            errno_assert (rc == 0);
+            unbox (msg_);
+            return true;
+        }
+        start_batch (&msg_box);
+    }
+
+    const uint8_t *const plaintext =
+      static_cast<uint8_t *> (_batch_in.data ()) + _batch_in_pos;
+    const size_t size = get_uint32 (plaintext);
+
+    int rc = msg_->close ();
+    errno_assert (rc == 0);
+    rc = msg_->init_size (size - flags_len);
+    errno_assert (rc == 0);
+    if (size > flags_len)
+        memcpy (msg_->data (), plaintext + batch_size_len + flags_len,
+                size - flags_len);
+    msg_->set_flags (plaintext[batch_size_len] & flag_mask);
+
+    //  The batch is released along with its last message.
+    _batch_in_pos += batch_size_len + size;
+    if (_batch_in_pos == _batch_in_end) {
+        rc = _batch_in.close ();
+        errno_assert (rc == 0);
+        rc = _batch_in.init ();
+        errno_assert (rc == 0);
+    }
+    return true;
 }
 
 #endif
@@ -18,8 +18,11 @@
 
 #include "mechanism_base.hpp"
 #include "options.hpp"
+#include "msg.hpp"
+#include "worker_pool.hpp"
 
 #include <memory>
+#include <vector>
 
 namespace zmq
 {
@@ -29,10 +32,74 @@ class curve_encoding_t
     curve_encoding_t (const char *encode_nonce_prefix_,
                       const char *decode_nonce_prefix_,
                       const bool downgrade_sub_);
+    virtual ~curve_encoding_t ();
 
+    //  Boxes the message into a MESSAGE command, in place. A large message
+    //  boxed after the batch built so far is retrieved by encode_next, as
+    //  are messages encoded while MESSAGE commands are queued, which go out
+    //  first. Fails with EAGAIN if these are being sealed by the pool.
     int encode (msg_t *msg_);
     int decode (msg_t *msg_, int *error_event_code_);
 
+    //  Once batching is enabled, each MESSAGE command carries a batch of
+    //  messages, each prefixed with the size of its flags and body. Room is
+    //  made up front for batches ended once they reach batch_size_ bytes,
+    //  a batch outgrowing it being moved to a larger command.
+    void enable_batching (size_t batch_size_ = 0);
+    bool batching () const { return _batching; }
+
+    //  Adds the message to the batch, leaving it empty.
+    void add_to_batch (msg_t *msg_);
+    size_t batch_size () const { return _batch_len; }
+
+    //  Boxes the batch into a MESSAGE command in msg_, which is empty, as
+    //  encode does.
+    int encode_batch (msg_t *msg_);
+
+    //  Once given a pool, boxes are sealed and opened on its threads when
+    //  there are several of them, large enough to be worth it. The jobs of
+    //  the pool are handed back through the mailbox of the I/O thread.
+    void set_pool (worker_pool_t *pool_, io_thread_t *thread_);
+    worker_pool_t *pool () const { return _pool; }
+
+    //  Queues the message, or the batch, to be sealed into a MESSAGE command
+    //  by seal_queued. The message or the batch is emptied.
+    void queue_message (msg_t *msg_);
+    void queue_batch ();
+
+    //  Number of MESSAGE commands queued and not retrieved yet.
+    size_t boxes_queued () const { return _out.size () - _out_pos; }
+
+    //  Seals the MESSAGE commands queued. Fails with EAGAIN if they are
+    //  sealed by the pool, boxes_sealed being called once they are.
+    int seal_queued ();
+    bool sealing () const { return _sealing != NULL; }
+
+    //  Retrieves the next MESSAGE command sealed, in the order they were
+    //  queued. Returns false if there is none.
+    bool encode_next (msg_t *msg_);
+
+    //  Checks the MESSAGE command and holds it back, leaving msg_ empty, for
+    //  open_held to open it along with the ones following it.
+    int hold (msg_t *msg_, int *error_event_code_);
+
+    size_t boxes_held () const { return _in.size () - _in_opened; }
+
+    //  Opens the MESSAGE commands held back, the messages of which are then
+    //  retrieved by decode_next. Fails with EAGAIN if they are opened by the
+    //  pool, boxes_opened being called once they are. A command failing to
+    //  open fails the call after the messages before it are retrieved.
+    int open_held (int *error_event_code_);
+    bool opening () const { return _opening != NULL; }
+
+    //  True iff MESSAGE commands are held back, or their messages are not
+    //  all retrieved yet.
+    bool holds_boxes () const;
+
+    //  Retrieves the next message of the batch decoded last, or of the
+    //  MESSAGE commands opened by open_held.
+    bool decode_next (msg_t *msg_);
+
     uint8_t *get_writable_precom_buffer () { return _cn_precom; }
     const uint8_t *get_precom_buffer () const { return _cn_precom; }
 
@@ -41,9 +108,107 @@ class curve_encoding_t
     nonce_t get_and_inc_nonce () { return _cn_nonce++; }
     void set_peer_nonce (nonce_t peer_nonce_) { _cn_peer_nonce = peer_nonce_; };
 
+  protected:
+    //  Called by the I/O thread once the pool has sealed or opened the
+    //  MESSAGE commands handed to it.
+    virtual void boxes_sealed () {}
+    virtual void boxes_opened () {}
+
   private:
     int check_validity (msg_t *msg_, int *error_event_code_);
 
+    //  Seals the MESSAGE commands queued, and retrieves the first one.
+    int encode_queued (msg_t *msg_);
+
+    //  Length of the subscribe or cancel command name the message is
+    //  prefixed with when boxed, and writing of its flags and body.
+    size_t sub_cancel_len (const msg_t &msg_) const;
+    void write_plaintext (const msg_t &msg_,
+                          size_t sub_cancel_len_,
+                          uint8_t *plaintext_) const;
+
+    //  Initializes a MESSAGE command with room for mlen_ bytes of plaintext,
+    //  returning where these go, and boxes them in place. Sealing and
+    //  opening only read the key and nonce prefix given, so that boxes can
+    //  be sealed or opened on several threads at once.
+    static uint8_t *init_box (msg_t *msg_box_, size_t mlen_);
+    static void seal (msg_t *msg_box_,
+                      size_t mlen_,
+                      nonce_t nonce_,
+                      const char *nonce_prefix_,
+                      const uint8_t *precom_);
+    static int open (msg_t *msg_box_,
+                     const char *nonce_prefix_,
+                     const uint8_t *precom_);
+
+    //  Makes room for size_ more bytes of plaintext at the end of the
+    //  batch, returning where these go.
+    uint8_t *extend_batch (size_t size_);
+
+    //  Initializes a MESSAGE command with the message as plaintext, a batch
+    //  of one once batching is enabled, returning the plaintext's size.
+    size_t init_message_box (const msg_t &msg_, msg_t *msg_box_) const;
+
+    //  Checks the sizes of the messages of the batch opened.
+    static int check_batch (const msg_t &msg_box_, int *error_event_code_);
+
+    //  Moves the payload of the message opened to the start of it, or
+    //  starts decoding the batch it holds.
+    static void unbox (msg_t *msg_);
+    void start_batch (msg_t *msg_box_);
+
+    struct job_t;
+
+    //  MESSAGE command queued to be sealed, or held back to be opened.
+    struct box_t
+    {
+        msg_t msg;
+        size_t mlen;
+        nonce_t nonce;
+        int rc;
+
+        //  Job sealing or opening the command on the threads of the pool.
+        const job_t *job;
+    };
+
+    //  MESSAGE commands handed to the threads of the pool, from the first
+    //  one on, along with the key they are sealed or opened with, so that
+    //  the job can outlive the encoding. The commands are copied back to
+    //  the encoding once the job is back, unless it is gone.
+    struct job_t : worker_pool_t::job_t
+    {
+        curve_encoding_t *owner;
+        size_t first;
+        std::vector<box_t> boxes;
+        std::vector<void *> tasks;
+        const char *nonce_prefix;
+        uint8_t precom[crypto_box_BEFORENMBYTES];
+    };
+
+    //  Closes the commands from first_ on, but for the ones handed to the
+    //  job, which closes them once back.
+    static void close_boxes (std::vector<box_t> &boxes_,
+                             size_t first_,
+                             const job_t *job_);
+
+    static void seal_task (void *box_);
+    static void open_task (void *box_);
+
+    //  Hands the boxes from first_ on to the pool, if worth it.
+    job_t *submit (worker_pool_t::task_fn *task_,
+                   const std::vector<box_t> &boxes_,
+                   size_t first_,
+                   const char *nonce_prefix_);
+
+    //  Called by the I/O thread with the job handed back by the pool.
+    static void job_done (void *job_);
+    void sealed (job_t *job_);
+    void opened (job_t *job_);
+
+    //  Checks the MESSAGE commands opened, in order, up to the first one
+    //  failing.
+    void check_opened (size_t end_);
+
     const char *_encode_nonce_prefix;
     const char *_decode_nonce_prefix;
 
@@ -55,6 +220,40 @@ class curve_encoding_t
 
     const bool _downgrade_sub;
 
+    bool _batching;
+
+    //  MESSAGE command the batch being encoded is written into, in place,
+    //  the size of its plaintext so far, and the room first made for it.
+    msg_t _batch_out;
+    size_t _batch_len;
+    size_t _batch_capacity;
+
+    //  Batch being decoded, and the range of its plaintext left to decode.
+    msg_t _batch_in;
+    size_t _batch_in_pos;
+    size_t _batch_in_end;
+
+    worker_pool_t *_pool;
+    io_thread_t *_thread;
+
+    //  MESSAGE commands queued, the first _out_sealed of which are sealed,
+    //  and the first _out_pos of which are retrieved. The ones after these
+    //  are being sealed by the pool, or waiting for it.
+    std::vector<box_t> _out;
+    size_t _out_sealed;
+    size_t _out_pos;
+    job_t *_sealing;
+
+    //  MESSAGE commands held back, the first _in_opened of which are
+    //  opened, and the first _in_pos of which are decoded.
+    std::vector<box_t> _in;
+    size_t _in_opened;
+    size_t _in_pos;
+    job_t *_opening;
+
+    //  Error event code of the MESSAGE command that failed to open, if any.
+    int _open_error;
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (curve_encoding_t)
 };
 
@@ -71,6 +270,49 @@ class curve_mechanism_base_t : public virtual mechanism_base_t,
     // mechanism implementation
     int encode (msg_t *msg_) ZMQ_OVERRIDE;
     int decode (msg_t *msg_) ZMQ_OVERRIDE;
+    bool encodes_ahead () const ZMQ_OVERRIDE;
+    bool encode_next (msg_t *msg_) ZMQ_OVERRIDE;
+    bool encoded_ahead () const ZMQ_OVERRIDE;
+    bool decode_next (msg_t *msg_) ZMQ_OVERRIDE;
+    bool decode_deferred () const ZMQ_OVERRIDE;
+    int flush_decode () ZMQ_OVERRIDE;
+
+  protected:
+    int property (const std::string &name_,
+                  const void *value_,
+                  size_t length_) ZMQ_OVERRIDE;
+    bool internal_property (const std::string &name_) const ZMQ_OVERRIDE;
+
+    //  Metadata property by which a client with ZMQ_CURVE_BATCH set offers
+    //  to batch messages, and a server with it set accepts the offer.
+    //  Returns 0 if the property is not to be sent.
+    size_t batch_property_len () const;
+    size_t add_batch_property (unsigned char *ptr_,
+                               size_t ptr_capacity_) const;
+
+    //  Enables batching if both peers agreed on it.
+    void negotiate_batching ();
+
+    void boxes_sealed () ZMQ_OVERRIDE;
+    void boxes_opened () ZMQ_OVERRIDE;
+
+  private:
+    bool sends_batch_property () const;
+
+    //  Adds the message to the batch, along with the messages ready to be
+    //  sent it is batched with. Returns true if a large message ended the
+    //  batch, which is then left in msg_.
+    bool batch_pulled (msg_t *msg_);
+
+    //  Queues the message to be sealed, along with the messages ready to
+    //  be sent it is batched with.
+    void queue_box (msg_t *msg_);
+
+    //  Number of MESSAGE commands sealed or opened at once with the pool.
+    size_t pool_boxes () const;
+
+    //  Whether the peer sent the batching property.
+    bool _peer_batches;
 };
 }
 
@@ -418,7 +418,8 @@ int zmq::curve_server_t::process_initiate (msg_t *msg_)
 
 int zmq::curve_server_t::produce_ready (msg_t *msg_)
 {
-    const size_t metadata_length = basic_properties_len ();
+    const size_t metadata_length =
+      basic_properties_len () + batch_property_len ();
     uint8_t ready_nonce[crypto_box_NONCEBYTES];
 
     std::vector<uint8_t, secure_allocator_t<uint8_t> > ready_plaintext (
@@ -430,6 +431,8 @@ int zmq::curve_server_t::produce_ready (msg_t *msg_)
     uint8_t *ptr = &ready_plaintext[crypto_box_ZEROBYTES];
 
     ptr += add_basic_properties (ptr, metadata_length);
+    ptr += add_batch_property (
+      ptr, metadata_length - (ptr - &ready_plaintext[crypto_box_ZEROBYTES]));
     const size_t mlen = ptr - &ready_plaintext[0];
 
     memcpy (ready_nonce, "CurveZMQREADY---", 16);
@@ -454,6 +457,9 @@ int zmq::curve_server_t::produce_ready (msg_t *msg_)
     memcpy (ready + 14, &ready_box[crypto_box_BOXZEROBYTES],
             mlen - crypto_box_BOXZEROBYTES);
 
+    //  Messages are boxed as agreed from the first one following READY.
+    negotiate_batching ();
+
     return 0;
 }
 
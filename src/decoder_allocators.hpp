@@ -7,6 +7,7 @@
 #include <cstdlib>
 
 #include "atomic_counter.hpp"
+#include "chunk_pool.hpp"
 #include "msg.hpp"
 #include "err.hpp"
 
@@ -18,12 +19,11 @@ class c_single_allocator
   public:
     explicit c_single_allocator (std::size_t bufsize_) :
         _buf_size (bufsize_),
-        _buf (static_cast<unsigned char *> (std::malloc (_buf_size)))
+        _buf (static_cast<unsigned char *> (chunk_pool_alloc (_buf_size)))
     {
-        alloc_assert (_buf);
     }
 
-    ~c_single_allocator () { std::free (_buf); }
+    ~c_single_allocator () { chunk_pool_free (_buf); }
 
     unsigned char *allocate () { return _buf; }
 
@@ -6,6 +6,7 @@
 #include "err.hpp"
 #include "msg.hpp"
 #include "likely.hpp"
+#include "v2_encoder.hpp"
 
 zmq::dist_t::dist_t () :
     _matching (0), _active (0), _eligible (0), _more (false)
@@ -165,6 +166,11 @@ void zmq::dist_t::distribute (msg_t *msg_)
         return;
     }
 
+    //  Encode the frame header once, so that the engines can send the shared
+    //  content as it is.
+    if (_matching > 1)
+        encode_header (msg_);
+
     //  Add matching-1 references to the message. We already hold one reference,
     //  that's why -1.
     msg_->add_refs (static_cast<int> (_matching) - 1);
@@ -193,6 +199,14 @@ bool zmq::dist_t::has_out ()
     return true;
 }
 
+void zmq::dist_t::encode_header (msg_t *msg_)
+{
+    unsigned char header[v2_encoder_t::max_data_header_size];
+    const size_t header_size = v2_encoder_t::encode_data_header (msg_, header);
+    if (header_size)
+        msg_->set_wire_header (header, header_size);
+}
+
 bool zmq::dist_t::write (pipe_t *pipe_, msg_t *msg_)
 {
     if (!pipe_->write (msg_)) {
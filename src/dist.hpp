@@ -51,6 +51,10 @@ class dist_t
 
     static bool has_out ();
 
+    //  Encodes the frame header of the message once for all the pipes it
+    //  is sent to, rather than in the engine of each peer.
+    static void encode_header (zmq::msg_t *msg_);
+
     // check HWM of all pipes matching
     bool check_hwm ();
 
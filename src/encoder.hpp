@@ -99,6 +99,56 @@ template <typename T> class encoder_base_t : public i_encoder
         return pos;
     }
 
+    size_t encode_vec (unsigned char **data_,
+                       size_t size_,
+                       size_t threshold_,
+                       unsigned char **ref_,
+                       size_t *ref_size_) ZMQ_FINAL
+    {
+        unsigned char *buffer = !*data_ ? _buf : *data_;
+        const size_t buffersize = !*data_ ? _buf_size : size_;
+
+        *ref_ = NULL;
+        *ref_size_ = 0;
+
+        if (in_progress () == NULL)
+            return 0;
+
+        size_t pos = 0;
+        while (pos < buffersize) {
+            if (!_to_write) {
+                if (_new_msg_flag) {
+                    int rc = _in_progress->close ();
+                    errno_assert (rc == 0);
+                    rc = _in_progress->init ();
+                    errno_assert (rc == 0);
+                    _in_progress = NULL;
+                    break;
+                }
+                (static_cast<T *> (this)->*_next) ();
+            }
+
+            //  Large chunks are handed out by reference, so that the
+            //  caller can pass them to a vectored write without copying.
+            if (_to_write >= threshold_) {
+                *ref_ = _write_pos;
+                *ref_size_ = _to_write;
+                _write_pos = NULL;
+                _to_write = 0;
+                break;
+            }
+
+            const size_t to_copy = std::min (_to_write, buffersize - pos);
+            memcpy (buffer + pos, _write_pos, to_copy);
+            pos += to_copy;
+            _write_pos += to_copy;
+            _to_write -= to_copy;
+        }
+
+        *data_ = buffer;
+        return pos;
+    }
+
     void load_msg (msg_t *msg_) ZMQ_FINAL
     {
         zmq_assert (in_progress () == NULL);
@@ -0,0 +1,118 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_GENERIC_RADIX_MTRIE_HPP_INCLUDED__
+#define __ZMQ_GENERIC_RADIX_MTRIE_HPP_INCLUDED__
+
+#include <stddef.h>
+#include <vector>
+
+#include "macros.hpp"
+#include "stdint.hpp"
+#include "atomic_counter.hpp"
+
+namespace zmq
+{
+//  Multi-trie with the interface of generic_mtrie_t, optimised for matching.
+//  Chains of nodes with a single child are compressed into one node, as in
+//  radix_tree_t, and each node is a single allocation holding the first
+//  bytes of its edges, the pointers to its children and its prefix, so that
+//  matching touches one cache line or two per node instead of a node, a
+//  table and a set per byte of the message.
+template <typename T> class generic_radix_mtrie_t
+{
+  public:
+    typedef T value_t;
+    typedef const unsigned char *prefix_t;
+
+    enum rm_result
+    {
+        not_found,
+        last_value_removed,
+        values_remain
+    };
+
+    generic_radix_mtrie_t ();
+    ~generic_radix_mtrie_t ();
+
+    //  Add key to the trie. Returns true iff no entry with the same prefix_
+    //  and size_ existed before.
+    bool add (prefix_t prefix_, size_t size_, value_t *value_);
+
+    //  Remove all entries with a specific value from the trie.
+    //  The call_on_uniq_ flag controls if the callback is invoked
+    //  when there are no entries left on a prefix only (true)
+    //  or on every removal (false). The arg_ argument is passed
+    //  through to the callback function.
+    template <typename Arg>
+    void rm (value_t *value_,
+             void (*func_) (const unsigned char *data_, size_t size_, Arg arg_),
+             Arg arg_,
+             bool call_on_uniq_);
+
+    //  Removes a specific entry from the trie.
+    //  Returns the result of the operation.
+    rm_result rm (prefix_t prefix_, size_t size_, value_t *value_);
+
+    //  Calls a callback function for all matching entries, i.e. any node
+    //  corresponding to data_ or a prefix of it. The arg_ argument
+    //  is passed through to the callback function.
+    template <typename Arg>
+    void match (prefix_t data_,
+                size_t size_,
+                void (*func_) (value_t *value_, Arg arg_),
+                Arg arg_);
+
+    //  Retrieve the number of prefixes stored in this trie (added - removed)
+    //  Note this is a multithread safe function.
+    uint32_t num_prefixes () const { return _num_prefixes.get (); }
+
+  private:
+    //  Values attached to a node, sorted so that they can be looked up
+    //  with a binary search and iterated without chasing pointers.
+    typedef std::vector<value_t *> values_t;
+
+    //  Header of a node. It is followed by the first bytes of the prefixes
+    //  of the children, padded to a multiple of 16 bytes so that they can
+    //  be compared in one go, by the pointers to the children and by the
+    //  node's own prefix. The root's prefix is empty.
+    struct node_t
+    {
+        values_t *values;
+        uint32_t prefix_length;
+        uint16_t edgecount;
+        uint16_t capacity;
+
+        unsigned char *first_bytes ();
+        node_t **children ();
+        unsigned char *prefix ();
+    };
+
+    static size_t first_bytes_size (size_t capacity_);
+    static node_t *make_node (size_t prefix_length_, size_t capacity_);
+    static void free_node (node_t *node_);
+
+    //  Returns the index of the edge starting with the byte, or -1.
+    static int find_edge (node_t *node_, unsigned char byte_);
+
+    //  Appends an edge to the node at the slot, growing it if needed.
+    static void add_edge (node_t **slot_, unsigned char byte_, node_t *child_);
+
+    //  Removes the edge at the index, without shrinking the node.
+    static void rm_edge (node_t *node_, int index_);
+
+    //  Removes the node at the slot, or merges it with its only child, if
+    //  it holds no values anymore. The root is never compacted.
+    void compact (node_t **slot_, node_t **parent_slot_);
+
+    //  Merges the node at the slot with its only child.
+    static void merge (node_t **slot_);
+
+    node_t *_root;
+
+    atomic_counter_t _num_prefixes;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (generic_radix_mtrie_t)
+};
+}
+
+#endif
@@ -0,0 +1,425 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_GENERIC_RADIX_MTRIE_IMPL_HPP_INCLUDED__
+#define __ZMQ_GENERIC_RADIX_MTRIE_IMPL_HPP_INCLUDED__
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <new>
+#include <vector>
+
+#include "err.hpp"
+#include "macros.hpp"
+#include "generic_radix_mtrie.hpp"
+
+#if defined __SSE2__ || defined _M_X64                                         \
+  || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#define ZMQ_RADIX_MTRIE_SSE2
+#include <emmintrin.h>
+#if defined _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace zmq
+{
+template <typename T>
+unsigned char *generic_radix_mtrie_t<T>::node_t::first_bytes ()
+{
+    return reinterpret_cast<unsigned char *> (this + 1);
+}
+
+template <typename T>
+typename generic_radix_mtrie_t<T>::node_t **
+generic_radix_mtrie_t<T>::node_t::children ()
+{
+    return reinterpret_cast<node_t **> (first_bytes ()
+                                        + first_bytes_size (capacity));
+}
+
+template <typename T>
+unsigned char *generic_radix_mtrie_t<T>::node_t::prefix ()
+{
+    return reinterpret_cast<unsigned char *> (children () + capacity);
+}
+
+template <typename T>
+size_t generic_radix_mtrie_t<T>::first_bytes_size (size_t capacity_)
+{
+    return (capacity_ + 15) & ~static_cast<size_t> (15);
+}
+
+template <typename T>
+typename generic_radix_mtrie_t<T>::node_t *
+generic_radix_mtrie_t<T>::make_node (size_t prefix_length_, size_t capacity_)
+{
+    zmq_assert (capacity_ <= 256);
+    node_t *node = static_cast<node_t *> (
+      malloc (sizeof (node_t) + first_bytes_size (capacity_)
+              + capacity_ * sizeof (node_t *) + prefix_length_));
+    alloc_assert (node);
+    node->values = NULL;
+    node->prefix_length = static_cast<uint32_t> (prefix_length_);
+    node->edgecount = 0;
+    node->capacity = static_cast<uint16_t> (capacity_);
+
+    //  The unused first bytes are compared too, though never matched.
+    memset (node->first_bytes (), 0, first_bytes_size (capacity_));
+    return node;
+}
+
+template <typename T> void generic_radix_mtrie_t<T>::free_node (node_t *node_)
+{
+    free (node_);
+}
+
+template <typename T>
+generic_radix_mtrie_t<T>::generic_radix_mtrie_t () :
+    _root (make_node (0, 0)), _num_prefixes (0)
+{
+}
+
+template <typename T> generic_radix_mtrie_t<T>::~generic_radix_mtrie_t ()
+{
+    std::vector<node_t *> stack (1, _root);
+    while (!stack.empty ()) {
+        node_t *node = stack.back ();
+        stack.pop_back ();
+        for (uint16_t i = 0; i != node->edgecount; ++i)
+            stack.push_back (node->children ()[i]);
+        LIBZMQ_DELETE (node->values);
+        free_node (node);
+    }
+}
+
+template <typename T>
+int generic_radix_mtrie_t<T>::find_edge (node_t *node_, unsigned char byte_)
+{
+    const unsigned char *const first_bytes = node_->first_bytes ();
+    const int edgecount = node_->edgecount;
+
+#if defined ZMQ_RADIX_MTRIE_SSE2
+    //  Compare 16 first bytes at a time.
+    const __m128i needle = _mm_set1_epi8 (static_cast<char> (byte_));
+    for (int i = 0; i < edgecount; i += 16) {
+        const __m128i bytes = _mm_loadu_si128 (
+          reinterpret_cast<const __m128i *> (first_bytes + i));
+        unsigned int mask = static_cast<unsigned int> (
+          _mm_movemask_epi8 (_mm_cmpeq_epi8 (bytes, needle)));
+        if (edgecount - i < 16)
+            mask &= (1u << (edgecount - i)) - 1;
+        if (mask) {
+#if defined _MSC_VER
+            unsigned long index;
+            _BitScanForward (&index, mask);
+            return i + static_cast<int> (index);
+#else
+            return i + __builtin_ctz (mask);
+#endif
+        }
+    }
+    return -1;
+#else
+    const void *const found = memchr (first_bytes, byte_, edgecount);
+    return found ? static_cast<int> (static_cast<const unsigned char *> (found)
+                                     - first_bytes)
+                 : -1;
+#endif
+}
+
+template <typename T>
+void generic_radix_mtrie_t<T>::add_edge (node_t **slot_,
+                                         unsigned char byte_,
+                                         node_t *child_)
+{
+    node_t *node = *slot_;
+    if (node->edgecount == node->capacity) {
+        //  Grow the node, which moves the prefix along with the children.
+        node_t *grown = make_node (node->prefix_length,
+                                   node->capacity ? node->capacity * 2 : 2);
+        grown->values = node->values;
+        grown->edgecount = node->edgecount;
+        memcpy (grown->first_bytes (), node->first_bytes (), node->edgecount);
+        memcpy (grown->children (), node->children (),
+                node->edgecount * sizeof (node_t *));
+        memcpy (grown->prefix (), node->prefix (), node->prefix_length);
+        free_node (node);
+        *slot_ = node = grown;
+    }
+
+    node->first_bytes ()[node->edgecount] = byte_;
+    node->children ()[node->edgecount] = child_;
+    ++node->edgecount;
+}
+
+template <typename T>
+void generic_radix_mtrie_t<T>::rm_edge (node_t *node_, int index_)
+{
+    //  Order of the edges does not matter, move the last one in its place.
+    const int last = node_->edgecount - 1;
+    node_->first_bytes ()[index_] = node_->first_bytes ()[last];
+    node_->children ()[index_] = node_->children ()[last];
+    node_->first_bytes ()[last] = 0;
+    --node_->edgecount;
+}
+
+template <typename T> void generic_radix_mtrie_t<T>::merge (node_t **slot_)
+{
+    node_t *node = *slot_;
+    zmq_assert (node->edgecount == 1 && !node->values);
+    node_t *child = node->children ()[0];
+
+    node_t *merged =
+      make_node (node->prefix_length + child->prefix_length, child->capacity);
+    merged->values = child->values;
+    merged->edgecount = child->edgecount;
+    memcpy (merged->first_bytes (), child->first_bytes (), child->edgecount);
+    memcpy (merged->children (), child->children (),
+            child->edgecount * sizeof (node_t *));
+    memcpy (merged->prefix (), node->prefix (), node->prefix_length);
+    memcpy (merged->prefix () + node->prefix_length, child->prefix (),
+            child->prefix_length);
+
+    free_node (child);
+    free_node (node);
+    *slot_ = merged;
+}
+
+template <typename T>
+void generic_radix_mtrie_t<T>::compact (node_t **slot_, node_t **parent_slot_)
+{
+    node_t *node = *slot_;
+    if (node == _root || node->values)
+        return;
+
+    if (node->edgecount == 0) {
+        node_t *parent = *parent_slot_;
+        rm_edge (parent, static_cast<int> (slot_ - parent->children ()));
+        free_node (node);
+
+        //  The parent may have become a link of a chain.
+        if (parent != _root && !parent->values && parent->edgecount == 1)
+            merge (parent_slot_);
+    } else if (node->edgecount == 1)
+        merge (slot_);
+}
+
+template <typename T>
+bool generic_radix_mtrie_t<T>::add (prefix_t prefix_,
+                                    size_t size_,
+                                    value_t *value_)
+{
+    node_t **slot = &_root;
+    while (size_) {
+        node_t *node = *slot;
+        const int index = find_edge (node, *prefix_);
+        if (index == -1) {
+            //  Store the rest of the key in a new leaf.
+            node_t *leaf = make_node (size_, 0);
+            memcpy (leaf->prefix (), prefix_, size_);
+            leaf->values = new (std::nothrow) values_t (1, value_);
+            alloc_assert (leaf->values);
+            add_edge (slot, *prefix_, leaf);
+            _num_prefixes.add (1);
+            return true;
+        }
+
+        node_t **child_slot = &node->children ()[index];
+        node_t *child = *child_slot;
+        const size_t max_common = std::min (
+          static_cast<size_t> (child->prefix_length), static_cast<size_t> (size_));
+        size_t common = 1;
+        while (common < max_common && child->prefix ()[common] == prefix_[common])
+            ++common;
+
+        if (common < child->prefix_length) {
+            //  The key diverges from the child's prefix, or ends within it;
+            //  split the prefix at that point.
+            node_t *split = make_node (common, 2);
+            memcpy (split->prefix (), child->prefix (), common);
+            memmove (child->prefix (), child->prefix () + common,
+                     child->prefix_length - common);
+            child->prefix_length -= static_cast<uint32_t> (common);
+            split->first_bytes ()[0] = child->prefix ()[0];
+            split->children ()[0] = child;
+            split->edgecount = 1;
+            *child_slot = split;
+        }
+
+        slot = child_slot;
+        prefix_ += common;
+        size_ -= common;
+    }
+
+    node_t *node = *slot;
+    if (!node->values) {
+        node->values = new (std::nothrow) values_t (1, value_);
+        alloc_assert (node->values);
+        _num_prefixes.add (1);
+        return true;
+    }
+
+    const typename values_t::iterator it =
+      std::lower_bound (node->values->begin (), node->values->end (), value_);
+    if (it == node->values->end () || *it != value_)
+        node->values->insert (it, value_);
+    return false;
+}
+
+template <typename T>
+template <typename Arg>
+void generic_radix_mtrie_t<T>::rm (value_t *value_,
+                                   void (*func_) (const unsigned char *data_,
+                                                  size_t size_,
+                                                  Arg arg_),
+                                   Arg arg_,
+                                   bool call_on_uniq_)
+{
+    //  Depth-first traversal, with an explicit stack so that long keys
+    //  cannot overflow the call stack. Each node is visited before its
+    //  children to remove the value, and after them to compact the trie.
+    struct frame_t
+    {
+        node_t **slot;
+        size_t key_size;
+        int next_edge;
+    };
+    std::vector<frame_t> stack;
+    std::vector<unsigned char> key;
+    const frame_t root_frame = {&_root, 0, -1};
+    stack.push_back (root_frame);
+
+    while (!stack.empty ()) {
+        frame_t &frame = stack.back ();
+        node_t *node = *frame.slot;
+
+        if (frame.next_edge == -1) {
+            if (node->values) {
+                const typename values_t::iterator it = std::lower_bound (
+                  node->values->begin (), node->values->end (), value_);
+                if (it != node->values->end () && *it == value_) {
+                    node->values->erase (it);
+                    const bool empty = node->values->empty ();
+                    if (!call_on_uniq_ || empty)
+                        func_ (key.empty () ? NULL : &key[0], frame.key_size,
+                               arg_);
+                    if (empty) {
+                        LIBZMQ_DELETE (node->values);
+                        zmq_assert (_num_prefixes.get () > 0);
+                        _num_prefixes.sub (1);
+                    }
+                }
+            }
+
+            //  Children are visited last to first, so that removing an
+            //  edge only moves edges that have been visited already.
+            frame.next_edge = node->edgecount;
+        }
+
+        if (frame.next_edge > 0) {
+            --frame.next_edge;
+            node_t *child = node->children ()[frame.next_edge];
+            key.resize (frame.key_size);
+            key.insert (key.end (), child->prefix (),
+                        child->prefix () + child->prefix_length);
+            const frame_t child_frame = {&node->children ()[frame.next_edge],
+                                         key.size (), -1};
+            stack.push_back (child_frame);
+            continue;
+        }
+
+        node_t **const slot = frame.slot;
+        stack.pop_back ();
+        if (node == _root || node->values)
+            continue;
+        if (node->edgecount == 0) {
+            node_t *parent = *stack.back ().slot;
+            rm_edge (parent, static_cast<int> (slot - parent->children ()));
+            free_node (node);
+        } else if (node->edgecount == 1)
+            merge (slot);
+    }
+}
+
+template <typename T>
+typename generic_radix_mtrie_t<T>::rm_result
+generic_radix_mtrie_t<T>::rm (prefix_t prefix_, size_t size_, value_t *value_)
+{
+    node_t **parent_slot = NULL;
+    node_t **slot = &_root;
+    while (size_) {
+        node_t *node = *slot;
+        const int index = find_edge (node, *prefix_);
+        if (index == -1)
+            return not_found;
+        node_t **child_slot = &node->children ()[index];
+        node_t *child = *child_slot;
+        if (child->prefix_length > size_
+            || memcmp (child->prefix (), prefix_, child->prefix_length) != 0)
+            return not_found;
+
+        parent_slot = slot;
+        slot = child_slot;
+        prefix_ += child->prefix_length;
+        size_ -= child->prefix_length;
+    }
+
+    node_t *node = *slot;
+    if (!node->values)
+        return not_found;
+    const typename values_t::iterator it =
+      std::lower_bound (node->values->begin (), node->values->end (), value_);
+    if (it == node->values->end () || *it != value_)
+        return not_found;
+    node->values->erase (it);
+    if (!node->values->empty ())
+        return values_remain;
+
+    LIBZMQ_DELETE (node->values);
+    zmq_assert (_num_prefixes.get () > 0);
+    _num_prefixes.sub (1);
+    compact (slot, parent_slot);
+    return last_value_removed;
+}
+
+template <typename T>
+template <typename Arg>
+void generic_radix_mtrie_t<T>::match (prefix_t data_,
+                                      size_t size_,
+                                      void (*func_) (value_t *value_, Arg arg_),
+                                      Arg arg_)
+{
+    for (node_t *node = _root;;) {
+        //  Signal the values attached to this node.
+        if (node->values) {
+            const values_t &values = *node->values;
+            for (typename values_t::size_type i = 0, count = values.size ();
+                 i != count; ++i)
+                func_ (values[i], arg_);
+        }
+
+        //  If we are at the end of the message, there's nothing more to match.
+        if (!size_)
+            break;
+
+        const int index = find_edge (node, *data_);
+        if (index == -1)
+            break;
+
+        //  The first byte of the child's prefix matches already.
+        node_t *child = node->children ()[index];
+        const size_t length = child->prefix_length;
+        if (length > size_
+            || memcmp (child->prefix () + 1, data_ + 1, length - 1) != 0)
+            break;
+
+        data_ += length;
+        size_ -= length;
+        node = child;
+    }
+}
+}
+
+#endif
@@ -0,0 +1,319 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_HASH_MAP_HPP_INCLUDED__
+#define __ZMQ_HASH_MAP_HPP_INCLUDED__
+
+#include <stddef.h>
+#include <string.h>
+#include <new>
+#include <vector>
+
+#include "blob.hpp"
+#include "err.hpp"
+#include "macros.hpp"
+#include "random.hpp"
+#include "stdint.hpp"
+
+namespace zmq
+{
+//  Key of the hash function, drawn at random for each table so that
+//  peers cannot choose keys that all end up in the same bucket.
+struct hash_seed_t
+{
+    uint64_t k0;
+    uint64_t k1;
+};
+
+inline hash_seed_t random_hash_seed ()
+{
+    hash_seed_t seed;
+    seed.k0 = static_cast<uint64_t> (generate_random ()) << 32
+              | generate_random ();
+    seed.k1 = static_cast<uint64_t> (generate_random ()) << 32
+              | generate_random ();
+    return seed;
+}
+
+inline uint64_t siphash_rotl (uint64_t x_, int bits_)
+{
+    return (x_ << bits_) | (x_ >> (64 - bits_));
+}
+
+inline void siphash_round (uint64_t *v_)
+{
+    v_[0] += v_[1];
+    v_[1] = siphash_rotl (v_[1], 13);
+    v_[1] ^= v_[0];
+    v_[0] = siphash_rotl (v_[0], 32);
+    v_[2] += v_[3];
+    v_[3] = siphash_rotl (v_[3], 16);
+    v_[3] ^= v_[2];
+    v_[0] += v_[3];
+    v_[3] = siphash_rotl (v_[3], 21);
+    v_[3] ^= v_[0];
+    v_[2] += v_[1];
+    v_[1] = siphash_rotl (v_[1], 17);
+    v_[1] ^= v_[2];
+    v_[2] = siphash_rotl (v_[2], 32);
+}
+
+//  SipHash-2-4 of the data, keyed with the seed.
+inline uint64_t siphash (const hash_seed_t &seed_,
+                         const unsigned char *data_,
+                         size_t size_)
+{
+    //  The initialisation constants spell "somepseudorandomlygeneratedbytes".
+    uint64_t v[4];
+    v[0] = seed_.k0 ^ (static_cast<uint64_t> (0x736f6d65u) << 32 | 0x70736575u);
+    v[1] = seed_.k1 ^ (static_cast<uint64_t> (0x646f7261u) << 32 | 0x6e646f6du);
+    v[2] = seed_.k0 ^ (static_cast<uint64_t> (0x6c796765u) << 32 | 0x6e657261u);
+    v[3] = seed_.k1 ^ (static_cast<uint64_t> (0x74656462u) << 32 | 0x79746573u);
+
+    //  The message is processed in little-endian words, the last one
+    //  padded with zeroes and ending with the length of the message.
+    const size_t full = size_ - size_ % 8;
+    for (size_t i = 0; i <= full; i += 8) {
+        uint64_t m = 0;
+        if (i < full)
+            for (int j = 7; j >= 0; --j)
+                m = m << 8 | data_[i + j];
+        else {
+            m = static_cast<uint64_t> (size_ & 0xff) << 56;
+            for (size_t j = size_ - full; j-- > 0;)
+                m |= static_cast<uint64_t> (data_[i + j]) << (8 * j);
+        }
+        v[3] ^= m;
+        siphash_round (v);
+        siphash_round (v);
+        v[0] ^= m;
+    }
+
+    v[2] ^= 0xff;
+    for (int i = 0; i != 4; ++i)
+        siphash_round (v);
+    return v[0] ^ v[1] ^ v[2] ^ v[3];
+}
+
+//  Hashing and equality of the keys stored in hash_map_t.
+
+template <typename K> struct hash_traits_t;
+
+template <> struct hash_traits_t<blob_t>
+{
+    //  Keys may be chosen by peers, e.g. routing ids, so they are hashed
+    //  with a keyed function.
+    static size_t hash (const blob_t &key_, const hash_seed_t &seed_)
+    {
+        return static_cast<size_t> (
+          siphash (seed_, key_.data (), key_.size ()));
+    }
+
+    static bool equal (const blob_t &lhs_, const blob_t &rhs_)
+    {
+        return lhs_.size () == rhs_.size ()
+               && (lhs_.size () == 0
+                   || memcmp (lhs_.data (), rhs_.data (), lhs_.size ()) == 0);
+    }
+};
+
+template <> struct hash_traits_t<uint32_t>
+{
+    //  Integral keys are often sequential; mix the bits so that the low
+    //  ones used for bucket selection depend on the whole key.
+    static size_t hash (uint32_t key_, const hash_seed_t &seed_)
+    {
+        key_ ^= static_cast<uint32_t> (seed_.k0);
+        key_ ^= key_ >> 16;
+        key_ *= 0x7feb352du;
+        key_ ^= key_ >> 15;
+        key_ *= 0x846ca68bu;
+        key_ ^= key_ >> 16;
+        return key_;
+    }
+
+    static bool equal (uint32_t lhs_, uint32_t rhs_) { return lhs_ == rhs_; }
+};
+
+//  Hash table with separate chaining providing O(1) insertion, lookup and
+//  removal. Values do not move in memory while they are in the table, so
+//  pointers returned by find remain valid until the entry is erased.
+//  The bucket array grows as needed and shrinks as entries are erased; it
+//  is released, and the hash function rekeyed, once the table is empty.
+
+template <typename K, typename V, typename Traits = hash_traits_t<K> >
+class hash_map_t
+{
+  private:
+    struct node_t
+    {
+        node_t (K &key_, const V &value_, size_t hash_) :
+            key (ZMQ_MOVE (key_)), value (value_), hash (hash_), next (NULL)
+        {
+        }
+
+        K key;
+        V value;
+        size_t hash;
+        node_t *next;
+    };
+
+  public:
+    hash_map_t () : _seed (random_hash_seed ()), _size (0) {}
+
+    ~hash_map_t () { clear (); }
+
+    size_t size () const { return _size; }
+
+    bool empty () const { return _size == 0; }
+
+    size_t bucket_count () const { return _buckets.size (); }
+
+    //  Inserts the value under the given key, taking ownership of the
+    //  key. Returns false and leaves the table unchanged if the key is
+    //  already present.
+    bool insert (K key_, const V &value_)
+    {
+        const size_t hash = Traits::hash (key_, _seed);
+        if (find_node (key_, hash))
+            return false;
+
+        if (_size >= _buckets.size ())
+            rehash (_buckets.empty () ? initial_buckets
+                                      : _buckets.size () * 2);
+
+        node_t *node = new (std::nothrow) node_t (key_, value_, hash);
+        alloc_assert (node);
+        node_t *&bucket = _buckets[hash & (_buckets.size () - 1)];
+        node->next = bucket;
+        bucket = node;
+        ++_size;
+        return true;
+    }
+
+    //  Returns the value stored under the key, or NULL if there is none.
+    V *find (const K &key_)
+    {
+        node_t *node = find_node (key_, Traits::hash (key_, _seed));
+        return node ? &node->value : NULL;
+    }
+
+    const V *find (const K &key_) const
+    {
+        const node_t *node = find_node (key_, Traits::hash (key_, _seed));
+        return node ? &node->value : NULL;
+    }
+
+    bool contains (const K &key_) const { return find (key_) != NULL; }
+
+    //  Removes the entry with the given key. Returns whether there was
+    //  such an entry. If value_ is not NULL, the erased value is stored
+    //  there.
+    bool erase (const K &key_, V *value_ = NULL)
+    {
+        if (_buckets.empty ())
+            return false;
+
+        const size_t hash = Traits::hash (key_, _seed);
+        for (node_t **link = &_buckets[hash & (_buckets.size () - 1)]; *link;
+             link = &(*link)->next) {
+            node_t *node = *link;
+            if (node->hash == hash && Traits::equal (node->key, key_)) {
+                if (value_)
+                    *value_ = node->value;
+                *link = node->next;
+                LIBZMQ_DELETE (node);
+                --_size;
+                shrink ();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //  Removes all entries.
+    void clear ()
+    {
+        for (size_t i = 0, size = _buckets.size (); i != size; ++i) {
+            node_t *node = _buckets[i];
+            while (node) {
+                node_t *next = node->next;
+                LIBZMQ_DELETE (node);
+                node = next;
+            }
+        }
+        _size = 0;
+        shrink ();
+    }
+
+    //  Calls func_ on every value until it returns true. Returns whether
+    //  any call returned true. The order of iteration is unspecified.
+    template <typename Func> bool any_of (Func func_)
+    {
+        for (size_t i = 0, size = _buckets.size (); i != size; ++i)
+            for (node_t *node = _buckets[i]; node; node = node->next)
+                if (func_ (node->value))
+                    return true;
+        return false;
+    }
+
+  private:
+    enum
+    {
+        initial_buckets = 16
+    };
+
+    node_t *find_node (const K &key_, size_t hash_) const
+    {
+        if (_buckets.empty ())
+            return NULL;
+
+        for (node_t *node = _buckets[hash_ & (_buckets.size () - 1)]; node;
+             node = node->next)
+            if (node->hash == hash_ && Traits::equal (node->key, key_))
+                return node;
+        return NULL;
+    }
+
+    //  Redistributes the nodes into a bucket array of the given size,
+    //  which must be a power of two.
+    void rehash (size_t buckets_)
+    {
+        std::vector<node_t *> buckets (buckets_, static_cast<node_t *> (NULL));
+        for (size_t i = 0, size = _buckets.size (); i != size; ++i) {
+            node_t *node = _buckets[i];
+            while (node) {
+                node_t *next = node->next;
+                node_t *&bucket = buckets[node->hash & (buckets_ - 1)];
+                node->next = bucket;
+                bucket = node;
+                node = next;
+            }
+        }
+        _buckets.swap (buckets);
+    }
+
+    //  Halves the bucket array once it is mostly empty, and releases it
+    //  when no entries are left.
+    void shrink ()
+    {
+        if (_size == 0) {
+            std::vector<node_t *> ().swap (_buckets);
+            _seed = random_hash_seed ();
+        } else if (_buckets.size () > initial_buckets
+                   && _size < _buckets.size () / 8)
+            rehash (_buckets.size () / 2);
+    }
+
+    hash_seed_t _seed;
+
+    //  Buckets, each holding a singly linked list of nodes.
+    std::vector<node_t *> _buckets;
+
+    //  Number of entries in the table.
+    size_t _size;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (hash_map_t)
+};
+}
+
+#endif
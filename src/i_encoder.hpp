@@ -23,6 +23,18 @@ struct i_encoder
     //  Function returns 0 when a new message is required.
     virtual size_t encode (unsigned char **data_, size_t size_) = 0;
 
+    //  Same as encode, except that a chunk of at least threshold_ bytes
+    //  is not copied to the buffer. Instead, encoding stops and the chunk
+    //  is returned in ref_ and ref_size_. The chunk points into the
+    //  message being encoded and is valid until the next call to encode
+    //  or encode_vec. Function returns 0 and no chunk when a new message
+    //  is required.
+    virtual size_t encode_vec (unsigned char **data_,
+                               size_t size_,
+                               size_t threshold_,
+                               unsigned char **ref_,
+                               size_t *ref_size_) = 0;
+
     //  Load a new message into encoder.
     virtual void load_msg (msg_t *msg_) = 0;
 };
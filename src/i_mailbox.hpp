@@ -18,6 +18,10 @@ class i_mailbox
     virtual void send (const command_t &cmd_) = 0;
     virtual int recv (command_t *cmd_, int timeout_) = 0;
 
+    //  Returns true if a command may be available. Never waits, and unlike
+    //  recv does not make any system calls.
+    virtual bool check_read () = 0;
+
 
 #ifdef HAVE_FORK
     // close the file descriptors in the signaller. This is used in a forked
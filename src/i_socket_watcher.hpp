@@ -0,0 +1,24 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_I_SOCKET_WATCHER_HPP_INCLUDED__
+#define __ZMQ_I_SOCKET_WATCHER_HPP_INCLUDED__
+
+#include "macros.hpp"
+
+namespace zmq
+{
+// Virtual interface to be exposed by pollers that check the events of a
+// socket only when its file descriptor is signalled.
+
+struct i_socket_watcher
+{
+    virtual ~i_socket_watcher () ZMQ_DEFAULT;
+
+    // Called by the socket when its events may have changed without its
+    // file descriptor being signalled, as when messages are sent or
+    // received, or when the socket processes its commands itself.
+    virtual void socket_events_changed (void *cookie_) = 0;
+};
+}
+
+#endif
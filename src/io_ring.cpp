@@ -0,0 +1,162 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#if defined ZMQ_IOTHREAD_POLLER_USE_URING || defined ZMQ_HAVE_IO_URING
+#include "io_ring.hpp"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <string.h>
+
+#include "err.hpp"
+#include "stdint.hpp"
+
+zmq::io_ring_t::io_ring_t () :
+    _fd (retired_fd),
+    _sq_ring (MAP_FAILED),
+    _sq_ring_size (0),
+    _cq_ring (MAP_FAILED),
+    _cq_ring_size (0),
+    _sqes (static_cast<io_uring_sqe *> (MAP_FAILED)),
+    _sqes_size (0),
+    _to_submit (0)
+{
+}
+
+zmq::io_ring_t::~io_ring_t ()
+{
+    //  Closing the ring cancels all the requests still in flight.
+    if (_sqes != MAP_FAILED)
+        munmap (_sqes, _sqes_size);
+    if (_cq_ring != MAP_FAILED && _cq_ring != _sq_ring)
+        munmap (_cq_ring, _cq_ring_size);
+    if (_sq_ring != MAP_FAILED)
+        munmap (_sq_ring, _sq_ring_size);
+    if (_fd != retired_fd)
+        close (_fd);
+}
+
+int zmq::io_ring_t::init (unsigned int entries_)
+{
+    zmq_assert (_fd == retired_fd);
+
+    io_uring_params params;
+    memset (&params, 0, sizeof params);
+    const long fd = syscall (__NR_io_uring_setup, entries_, &params);
+    if (fd == -1) {
+        errno_assert (errno == ENOSYS || errno == EPERM || errno == ENOMEM
+                      || errno == EMFILE || errno == ENFILE);
+        return -1;
+    }
+    _fd = static_cast<fd_t> (fd);
+
+    _sq_ring_size =
+      params.sq_off.array + params.sq_entries * sizeof (unsigned int);
+    _cq_ring_size =
+      params.cq_off.cqes + params.cq_entries * sizeof (io_uring_cqe);
+
+    //  Newer kernels allow both rings to be mapped in a single call.
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap && _cq_ring_size > _sq_ring_size)
+        _sq_ring_size = _cq_ring_size;
+
+    _sq_ring = mmap (NULL, _sq_ring_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQ_RING);
+    errno_assert (_sq_ring != MAP_FAILED);
+
+    if (single_mmap)
+        _cq_ring = _sq_ring;
+    else {
+        _cq_ring = mmap (NULL, _cq_ring_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_CQ_RING);
+        errno_assert (_cq_ring != MAP_FAILED);
+    }
+
+    _sqes_size = params.sq_entries * sizeof (io_uring_sqe);
+    _sqes = static_cast<io_uring_sqe *> (
+      mmap (NULL, _sqes_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQES));
+    errno_assert (_sqes != MAP_FAILED);
+
+    unsigned char *const sq = static_cast<unsigned char *> (_sq_ring);
+    _sq_head = reinterpret_cast<unsigned int *> (sq + params.sq_off.head);
+    _sq_tail = reinterpret_cast<unsigned int *> (sq + params.sq_off.tail);
+    _sq_mask = *reinterpret_cast<unsigned int *> (sq + params.sq_off.ring_mask);
+    _sq_entries = params.sq_entries;
+    _sq_array = reinterpret_cast<unsigned int *> (sq + params.sq_off.array);
+
+    unsigned char *const cq = static_cast<unsigned char *> (_cq_ring);
+    _cq_head = reinterpret_cast<unsigned int *> (cq + params.cq_off.head);
+    _cq_tail = reinterpret_cast<unsigned int *> (cq + params.cq_off.tail);
+    _cq_mask = *reinterpret_cast<unsigned int *> (cq + params.cq_off.ring_mask);
+    _cqes = reinterpret_cast<io_uring_cqe *> (cq + params.cq_off.cqes);
+    return 0;
+}
+
+bool zmq::io_ring_t::supports (unsigned int opcode_) const
+{
+    //  Kernels too old to be probed support none of the opcodes probed for.
+    const unsigned int ops = 256;
+    uint64_t buf[(sizeof (io_uring_probe) + ops * sizeof (io_uring_probe_op))
+                 / sizeof (uint64_t)];
+    memset (buf, 0, sizeof buf);
+    io_uring_probe *probe = reinterpret_cast<io_uring_probe *> (buf);
+    const long rc = syscall (__NR_io_uring_register, _fd,
+                             IORING_REGISTER_PROBE, probe, ops);
+    if (rc == -1)
+        return false;
+    return opcode_ <= probe->last_op && opcode_ < probe->ops_len
+           && (probe->ops[opcode_].flags & IO_URING_OP_SUPPORTED) != 0;
+}
+
+io_uring_sqe *zmq::io_ring_t::get_sqe ()
+{
+    const unsigned int tail = *_sq_tail;
+    if (tail - __atomic_load_n (_sq_head, __ATOMIC_ACQUIRE) == _sq_entries) {
+        enter (0);
+        zmq_assert (tail - __atomic_load_n (_sq_head, __ATOMIC_ACQUIRE)
+                    < _sq_entries);
+    }
+
+    //  Without SQPOLL the kernel only consumes the submission queue inside
+    //  io_uring_enter, so the entry may be published before it is filled.
+    const unsigned int index = tail & _sq_mask;
+    io_uring_sqe *sqe = &_sqes[index];
+    memset (sqe, 0, sizeof (io_uring_sqe));
+    _sq_array[index] = index;
+    __atomic_store_n (_sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ++_to_submit;
+    return sqe;
+}
+
+bool zmq::io_ring_t::enter (unsigned int min_complete_)
+{
+    const int rc = static_cast<int> (
+      syscall (__NR_io_uring_enter, _fd, _to_submit, min_complete_,
+               min_complete_ ? IORING_ENTER_GETEVENTS : 0, NULL, 0));
+    if (rc == -1) {
+        errno_assert (errno == EINTR || errno == EAGAIN || errno == EBUSY);
+        return false;
+    }
+    _to_submit -= static_cast<unsigned int> (rc);
+    return true;
+}
+
+unsigned int zmq::io_ring_t::completed () const
+{
+    return __atomic_load_n (_cq_tail, __ATOMIC_ACQUIRE) - *_cq_head;
+}
+
+bool zmq::io_ring_t::next (io_uring_cqe *cqe_)
+{
+    const unsigned int head = *_cq_head;
+    if (head == __atomic_load_n (_cq_tail, __ATOMIC_ACQUIRE))
+        return false;
+    *cqe_ = _cqes[head & _cq_mask];
+    __atomic_store_n (_cq_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+#endif
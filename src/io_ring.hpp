@@ -0,0 +1,88 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_IO_RING_HPP_INCLUDED__
+#define __ZMQ_IO_RING_HPP_INCLUDED__
+
+#if defined ZMQ_IOTHREAD_POLLER_USE_URING || defined ZMQ_HAVE_IO_URING
+
+#include <stddef.h>
+#include <linux/io_uring.h>
+
+#include "fd.hpp"
+#include "macros.hpp"
+
+namespace zmq
+{
+//  A Linux io_uring instance: the submission and completion rings shared
+//  with the kernel. Requests are queued to the submission ring and passed
+//  to the kernel in batches; their completions are read from the
+//  completion ring without any system call.
+
+class io_ring_t
+{
+  public:
+    io_ring_t ();
+    ~io_ring_t ();
+
+    //  Sets up a ring with room for at least entries_ requests. Returns -1
+    //  if io_uring is not available, e.g. disabled by the kernel.
+    int init (unsigned int entries_);
+
+    //  Returns whether the kernel supports requests of the given opcode.
+    bool supports (unsigned int opcode_) const;
+
+    //  The ring's file descriptor, which polls readable while there are
+    //  completions to be read.
+    fd_t get_fd () const { return _fd; }
+
+    //  Returns a cleared submission queue entry, passing the queued ones
+    //  to the kernel first if the submission queue is full.
+    io_uring_sqe *get_sqe ();
+
+    //  Number of entries queued but not passed to the kernel yet.
+    unsigned int queued () const { return _to_submit; }
+
+    //  Passes the queued entries to the kernel and waits for at least
+    //  min_complete_ completions. Returns false if interrupted by a signal.
+    bool enter (unsigned int min_complete_);
+
+    //  Number of completions to be read.
+    unsigned int completed () const;
+
+    //  Copies the next completion out of the ring and hands its slot back
+    //  to the kernel. Returns false if there is none.
+    bool next (io_uring_cqe *cqe_);
+
+  private:
+    //  Ring file descriptor and the mapped ring memory.
+    fd_t _fd;
+    void *_sq_ring;
+    size_t _sq_ring_size;
+    void *_cq_ring;
+    size_t _cq_ring_size;
+    io_uring_sqe *_sqes;
+    size_t _sqes_size;
+
+    //  Pointers into the mapped submission ring.
+    unsigned int *_sq_head;
+    unsigned int *_sq_tail;
+    unsigned int _sq_mask;
+    unsigned int _sq_entries;
+    unsigned int *_sq_array;
+
+    //  Pointers into the mapped completion ring.
+    unsigned int *_cq_head;
+    unsigned int *_cq_tail;
+    unsigned int _cq_mask;
+    io_uring_cqe *_cqes;
+
+    //  Number of entries queued but not yet submitted to the kernel.
+    unsigned int _to_submit;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (io_ring_t)
+};
+}
+
+#endif
+
+#endif
@@ -8,10 +8,16 @@
 #include "io_thread.hpp"
 #include "err.hpp"
 #include "ctx.hpp"
+#include "thread.hpp"
+#include "worker_pool.hpp"
+#include "uring_io.hpp"
 
-zmq::io_thread_t::io_thread_t (ctx_t *ctx_, uint32_t tid_) :
+zmq::io_thread_t::io_thread_t (ctx_t *ctx_, uint32_t tid_, bool ring_io_) :
     object_t (ctx_, tid_),
-    _mailbox_handle (static_cast<poller_t::handle_t> (NULL))
+    _mailbox_handle (static_cast<poller_t::handle_t> (NULL)),
+    _ring_io (NULL),
+    _cpu (-1),
+    _node (-1)
 {
     _poller = new (std::nothrow) poller_t (*ctx_);
     alloc_assert (_poller);
@@ -19,12 +25,28 @@ zmq::io_thread_t::io_thread_t (ctx_t *ctx_, uint32_t tid_) :
     if (_mailbox.get_fd () != retired_fd) {
         _mailbox_handle = _poller->add_fd (_mailbox.get_fd (), this);
         _poller->set_pollin (_mailbox_handle);
+
+#if defined ZMQ_HAVE_IO_URING
+        //  Without io_uring, engines fall back to reading and writing on
+        //  their own.
+        if (ring_io_)
+            _ring_io = uring_io_t::create (_poller);
+#endif
     }
+#if !defined ZMQ_HAVE_IO_URING
+    LIBZMQ_UNUSED (ring_io_);
+#endif
 }
 
 zmq::io_thread_t::~io_thread_t ()
 {
     LIBZMQ_DELETE (_poller);
+
+#if defined ZMQ_HAVE_IO_URING
+    //  Destroyed once the poller has stopped, as the thread uses it up to
+    //  the last event.
+    LIBZMQ_DELETE (_ring_io);
+#endif
 }
 
 void zmq::io_thread_t::start ()
@@ -51,11 +73,28 @@ int zmq::io_thread_t::get_load () const
     return _poller->get_load ();
 }
 
+void zmq::io_thread_t::get_cpu (int *cpu_, int *node_) const
+{
+    *cpu_ = _cpu.load ();
+    *node_ = _node.load ();
+}
+
 void zmq::io_thread_t::in_event ()
 {
     //  TODO: Do we want to limit number of commands I/O thread can
     //  process in a single go?
 
+    //  Track where the thread runs, for choosing I/O threads close to the
+    //  sockets and NIC queues they will serve. The node is only looked up
+    //  when the thread has moved to another CPU.
+    if (get_ctx ()->io_thread_locality ()) {
+        const int cpu = get_current_cpu ();
+        if (cpu != _cpu.load ()) {
+            _node.store (cpu == -1 ? -1 : get_cpu_node (cpu));
+            _cpu.store (cpu);
+        }
+    }
+
     command_t cmd;
     int rc = _mailbox.recv (&cmd, 0);
 
@@ -86,9 +125,30 @@ zmq::poller_t *zmq::io_thread_t::get_poller () const
     return _poller;
 }
 
+zmq::uring_io_t *zmq::io_thread_t::get_ring_io () const
+{
+    return _ring_io;
+}
+
 void zmq::io_thread_t::process_stop ()
 {
     zmq_assert (_mailbox_handle);
     _poller->rm_fd (_mailbox_handle);
+#if defined ZMQ_HAVE_IO_URING
+    if (_ring_io)
+        _ring_io->stop ();
+#endif
     _poller->stop ();
 }
+
+void zmq::io_thread_t::send_work_done (void *job_)
+{
+    object_t::send_work_done (this, job_);
+}
+
+void zmq::io_thread_t::process_work_done (void *job_)
+{
+    worker_pool_t::job_t *const job =
+      static_cast<worker_pool_t::job_t *> (job_);
+    job->done (job);
+}
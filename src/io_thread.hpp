@@ -8,10 +8,12 @@
 #include "poller.hpp"
 #include "i_poll_events.hpp"
 #include "mailbox.hpp"
+#include "atomic_ptr.hpp"
 
 namespace zmq
 {
 class ctx_t;
+class uring_io_t;
 
 //  Generic part of the I/O thread. Polling-mechanism-specific features
 //  are implemented in separate "polling objects".
@@ -19,7 +21,9 @@ class ctx_t;
 class io_thread_t ZMQ_FINAL : public object_t, public i_poll_events
 {
   public:
-    io_thread_t (zmq::ctx_t *ctx_, uint32_t tid_);
+    //  If ring_io_ is set, engines have their reads and writes submitted
+    //  to an io_uring, where available.
+    io_thread_t (zmq::ctx_t *ctx_, uint32_t tid_, bool ring_io_ = false);
 
     //  Clean-up. If the thread was started, it's necessary to call 'stop'
     //  before invoking destructor. Otherwise the destructor would hang up.
@@ -42,12 +46,25 @@ class io_thread_t ZMQ_FINAL : public object_t, public i_poll_events
     //  Used by io_objects to retrieve the associated poller object.
     poller_t *get_poller () const;
 
+    //  Returns the ring engines submit their reads and writes to, or NULL
+    //  if they read and write on their own.
+    zmq::uring_io_t *get_ring_io () const;
+
+    //  Hands a job run by the workers of a pool back to the thread, which
+    //  completes it. Called by the workers.
+    void send_work_done (void *job_);
+
     //  Command handlers.
     void process_stop ();
+    void process_work_done (void *job_);
 
     //  Returns load experienced by the I/O thread.
     int get_load () const;
 
+    //  Retrieves the CPU and NUMA node the I/O thread was last seen running
+    //  on, or -1 if unknown or if no socket uses ZMQ_IO_THREAD_LOCALITY.
+    void get_cpu (int *cpu_, int *node_) const;
+
   private:
     //  I/O thread accesses incoming commands via this mailbox.
     mailbox_t _mailbox;
@@ -58,6 +75,13 @@ class io_thread_t ZMQ_FINAL : public object_t, public i_poll_events
     //  I/O multiplexing is performed using a poller object.
     poller_t *_poller;
 
+    //  Ring the engines' reads and writes are submitted to. May be NULL.
+    zmq::uring_io_t *_ring_io;
+
+    //  CPU and NUMA node the thread ran on when it last processed commands.
+    atomic_value_t _cpu;
+    atomic_value_t _node;
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (io_thread_t)
 };
 }
@@ -256,6 +256,29 @@ int zmq::bind_to_device (fd_t s_, const std::string &bound_device_)
 #endif
 }
 
+void zmq::get_incoming_cpu (fd_t s_, int *cpu_, unsigned int *napi_id_)
+{
+    *cpu_ = -1;
+    *napi_id_ = 0;
+#ifdef SO_INCOMING_CPU
+    int cpu;
+    socklen_t len = sizeof cpu;
+    if (getsockopt (s_, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len) == 0)
+        *cpu_ = cpu;
+#endif
+#ifdef SO_INCOMING_NAPI_ID
+    unsigned int napi_id;
+    socklen_t napi_id_len = sizeof napi_id;
+    if (getsockopt (s_, SOL_SOCKET, SO_INCOMING_NAPI_ID, &napi_id,
+                    &napi_id_len)
+        == 0)
+        *napi_id_ = napi_id;
+#endif
+#if !defined SO_INCOMING_CPU && !defined SO_INCOMING_NAPI_ID
+    LIBZMQ_UNUSED (s_);
+#endif
+}
+
 bool zmq::initialize_network ()
 {
 #if defined ZMQ_HAVE_OPENPGM
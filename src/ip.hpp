@@ -34,6 +34,11 @@ int set_nosigpipe (fd_t s_);
 // Binds the underlying socket to the given device, eg. VRF or interface
 int bind_to_device (fd_t s_, const std::string &bound_device_);
 
+// Retrieves the CPU that processed the last packets received on the socket,
+// and the id of the NIC receive queue they arrived on. Either is set to -1 and
+// 0 respectively if unknown.
+void get_incoming_cpu (fd_t s_, int *cpu_, unsigned int *napi_id_);
+
 // Initialize network subsystem. May be called multiple times. Each call must be matched by a call to shutdown_network.
 bool initialize_network ();
 
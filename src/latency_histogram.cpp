@@ -0,0 +1,79 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include "latency_histogram.hpp"
+
+#include <string.h>
+
+zmq::latency_histogram_t::latency_histogram_t () : _count (0), _max (0)
+{
+    memset (_counts, 0, sizeof _counts);
+}
+
+void zmq::latency_histogram_t::record (uint64_t value_)
+{
+    _counts[bucket_of (value_)]++;
+    _count++;
+    if (value_ > _max)
+        _max = value_;
+}
+
+void zmq::latency_histogram_t::summarize_and_reset (
+  latency_summary_t *summary_)
+{
+    summary_->count = _count;
+    summary_->p50 = percentile (500);
+    summary_->p90 = percentile (900);
+    summary_->p99 = percentile (990);
+    summary_->max = _max;
+
+    memset (_counts, 0, sizeof _counts);
+    _count = 0;
+    _max = 0;
+}
+
+int zmq::latency_histogram_t::bucket_of (uint64_t value_)
+{
+    if (value_ < sub_buckets)
+        return static_cast<int> (value_);
+
+    int exponent = sub_bucket_bits;
+    while (exponent < max_exponent && (value_ >> (exponent + 1)) != 0)
+        ++exponent;
+    if (exponent == max_exponent)
+        return bucket_count - 1;
+
+    //  The leading bit and the next sub_bucket_bits bits select the bucket.
+    const int shift = exponent - sub_bucket_bits;
+    return (shift + 1) * sub_buckets
+           + static_cast<int> ((value_ >> shift) - sub_buckets);
+}
+
+uint64_t zmq::latency_histogram_t::highest_in (int bucket_)
+{
+    if (bucket_ < sub_buckets)
+        return bucket_;
+    //  The last bucket is unbounded.
+    if (bucket_ == bucket_count - 1)
+        return ~static_cast<uint64_t> (0);
+
+    const int shift = bucket_ / sub_buckets - 1;
+    const uint64_t mantissa = sub_buckets + bucket_ % sub_buckets;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+uint64_t zmq::latency_histogram_t::percentile (uint64_t per_mille_) const
+{
+    if (!_count)
+        return 0;
+
+    //  Number of values at or below the percentile, rounded up.
+    const uint64_t rank = (_count * per_mille_ + 999) / 1000;
+    uint64_t seen = 0;
+    for (int i = 0; i != bucket_count; ++i) {
+        seen += _counts[i];
+        if (seen >= rank)
+            return highest_in (i) < _max ? highest_in (i) : _max;
+    }
+    return _max;
+}
@@ -0,0 +1,142 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_LATENCY_HISTOGRAM_HPP_INCLUDED__
+#define __ZMQ_LATENCY_HISTOGRAM_HPP_INCLUDED__
+
+#include "atomic_counter.hpp"
+#include "config.hpp"
+#include "macros.hpp"
+#include "stdint.hpp"
+
+#if (defined __cplusplus && __cplusplus >= 201103L)                            \
+  || (defined _MSC_VER && _MSC_VER >= 1900)
+#define ZMQ_LATENCY_STAMPS_CXX11
+#include <atomic>
+#elif defined ZMQ_HAVE_ATOMIC_INTRINSICS
+#define ZMQ_LATENCY_STAMPS_INTRINSIC
+#endif
+
+namespace zmq
+{
+//  Percentiles of the latencies recorded by a histogram, in microseconds.
+struct latency_summary_t
+{
+    uint64_t count;
+    uint64_t p50;
+    uint64_t p90;
+    uint64_t p99;
+    uint64_t max;
+};
+
+//  Latencies of the messages passing through a connection, as reported
+//  by ZMQ_EVENT_PIPES_LATENCY.
+struct pipe_latency_t
+{
+    //  From writing outbound messages to the pipe to reading them from it.
+    latency_summary_t out_queue;
+    //  From collecting outbound messages into a batch for the network to
+    //  having written the whole batch to it.
+    latency_summary_t out_wire;
+    //  From writing inbound messages to the pipe to reading them from it.
+    latency_summary_t in_queue;
+};
+
+//  Histogram of latencies in the manner of HdrHistogram: values below 8
+//  are counted exactly, larger ones in 8 buckets per power of two, which
+//  bounds the error of the reported percentiles to 12.5%.
+class latency_histogram_t
+{
+  public:
+    latency_histogram_t ();
+
+    void record (uint64_t value_);
+
+    //  Fills in the summary of the recorded values and starts over.
+    void summarize_and_reset (latency_summary_t *summary_);
+
+  private:
+    enum
+    {
+        sub_bucket_bits = 3,
+        sub_buckets = 1 << sub_bucket_bits,
+        //  Values of 2^max_exponent and more share the last bucket.
+        max_exponent = 40,
+        bucket_count = (max_exponent - sub_bucket_bits + 1) * sub_buckets
+    };
+
+    static int bucket_of (uint64_t value_);
+
+    //  Largest value counted in the given bucket.
+    static uint64_t highest_in (int bucket_);
+
+    //  Smallest value reaching the given fraction of the recorded values.
+    uint64_t percentile (uint64_t per_mille_) const;
+
+    uint64_t _counts[bucket_count];
+    uint64_t _count;
+    uint64_t _max;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (latency_histogram_t)
+};
+
+//  Send timestamps of the messages passing through one direction of a
+//  pipe pair. The writer stores the timestamp of its n-th message in slot
+//  n modulo latency_stamps_size, where the reader picks it up once it has
+//  read the message. Timestamps of messages the writer is further ahead of
+//  the reader are overwritten, so that latencies are underestimated when
+//  the high water mark exceeds the size.
+//
+//  The slot being read may be overwritten meanwhile, so the slots are
+//  accessed atomically, without ordering: the message itself is passed
+//  through the pipe, and a stamp overwritten by a later one merely skews
+//  a single latency.
+class latency_stamps_t
+{
+  public:
+    void set (uint64_t msg_, uint64_t stamp_) ZMQ_NOEXCEPT
+    {
+#if defined ZMQ_LATENCY_STAMPS_CXX11
+        _stamps[msg_ % latency_stamps_size].store (stamp_,
+                                                   std::memory_order_relaxed);
+#elif defined ZMQ_LATENCY_STAMPS_INTRINSIC
+        __atomic_store_n (&_stamps[msg_ % latency_stamps_size], stamp_,
+                          __ATOMIC_RELAXED);
+#else
+        _stamps[msg_ % latency_stamps_size] = stamp_;
+#endif
+    }
+
+    uint64_t get (uint64_t msg_) const ZMQ_NOEXCEPT
+    {
+#if defined ZMQ_LATENCY_STAMPS_CXX11
+        return _stamps[msg_ % latency_stamps_size].load (
+          std::memory_order_relaxed);
+#elif defined ZMQ_LATENCY_STAMPS_INTRINSIC
+        return __atomic_load_n (&_stamps[msg_ % latency_stamps_size],
+                                __ATOMIC_RELAXED);
+#else
+        return _stamps[msg_ % latency_stamps_size];
+#endif
+    }
+
+  private:
+#if defined ZMQ_LATENCY_STAMPS_CXX11
+    std::atomic<uint64_t> _stamps[latency_stamps_size];
+#else
+    volatile uint64_t _stamps[latency_stamps_size];
+#endif
+};
+
+//  Timestamps of both directions of a pipe pair, shared by its two pipes.
+struct pipe_stamps_t
+{
+    latency_stamps_t directions[2];
+    atomic_counter_t refs;
+};
+}
+
+//  Remove macros local to this file.
+#undef ZMQ_LATENCY_STAMPS_CXX11
+#undef ZMQ_LATENCY_STAMPS_INTRINSIC
+
+#endif
@@ -73,6 +73,21 @@ int zmq::mailbox_t::recv (command_t *cmd_, int timeout_)
     return 0;
 }
 
+bool zmq::mailbox_t::check_read ()
+{
+    if (_active) {
+        if (_cpipe.check_read ())
+            return true;
+
+        //  The pipe is passive now, so recv has to wait for the signal
+        //  that the sender is going to send with the next command.
+        _active = false;
+    }
+
+    //  Commands written to the passive pipe can be seen before the signal.
+    return _cpipe.check_read ();
+}
+
 bool zmq::mailbox_t::valid () const
 {
     return _signaler.valid ();
@@ -24,6 +24,7 @@ class mailbox_t ZMQ_FINAL : public i_mailbox
     fd_t get_fd () const;
     void send (const command_t &cmd_);
     int recv (command_t *cmd_, int timeout_);
+    bool check_read ();
 
     bool valid () const;
 
@@ -6,34 +6,66 @@
 #include "err.hpp"
 
 #include <algorithm>
+#include <new>
 
-zmq::mailbox_safe_t::mailbox_safe_t (mutex_t *sync_) : _sync (sync_)
+#if defined ZMQ_HAVE_MAILBOX_FUTEX
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+//  Maximum number of nodes kept for reuse.
+static const zmq::atomic_counter_t::integer_t max_free_nodes = 256;
+
+zmq::mailbox_safe_t::mailbox_safe_t (mutex_t *sync_) :
+    _head (new (std::nothrow) node_t),
+    _parked (0),
+    _senders (1),
+    _senders_left (false),
+    _sync (sync_)
 {
-    //  Get the pipe into passive state. That way, if the users starts by
-    //  polling on the associated file descriptor it will get woken up when
-    //  new command is posted.
-    const bool ok = _cpipe.check_read ();
-    zmq_assert (!ok);
+    alloc_assert (_head);
+    _head->next.set (NULL);
+    _tail.set (_head);
 }
 
 zmq::mailbox_safe_t::~mailbox_safe_t ()
 {
-    //  TODO: Retrieve and deallocate commands inside the cpipe.
+    //  TODO: Retrieve and deallocate commands inside the queue.
+
+    //  Other threads might still be in our send() method after the reader
+    //  took their command, wait for the last of them to leave before
+    //  disappearing.
+    if (_senders.sub (1)) {
+        scoped_lock_t lock (_wake_sync);
+        while (!_senders_left)
+            _cond_var.wait (&_wake_sync, -1);
+    }
 
-    // Work around problem that other threads might still be in our
-    // send() method, by waiting on the mutex before disappearing.
-    _sync->lock ();
-    _sync->unlock ();
+    delete_nodes (_head);
+    delete_nodes (_free_nodes.xchg (NULL));
+}
+
+void zmq::mailbox_safe_t::delete_nodes (node_t *node_)
+{
+    while (node_) {
+        node_t *const next = node_->next.cas (NULL, NULL);
+        delete node_;
+        node_ = next;
+    }
 }
 
 void zmq::mailbox_safe_t::add_signaler (signaler_t *signaler_)
 {
+    scoped_lock_t lock (_wake_sync);
     _signalers.push_back (signaler_);
 }
 
 void zmq::mailbox_safe_t::remove_signaler (signaler_t *signaler_)
 {
-    // TODO: make a copy of array and signal outside the lock
+    scoped_lock_t lock (_wake_sync);
     const std::vector<zmq::signaler_t *>::iterator end = _signalers.end ();
     const std::vector<signaler_t *>::iterator it =
       std::find (_signalers.begin (), end, signaler_);
@@ -44,55 +76,198 @@ void zmq::mailbox_safe_t::remove_signaler (signaler_t *signaler_)
 
 void zmq::mailbox_safe_t::clear_signalers ()
 {
+    scoped_lock_t lock (_wake_sync);
     _signalers.clear ();
 }
 
 void zmq::mailbox_safe_t::send (const command_t &cmd_)
 {
-    _sync->lock ();
-    _cpipe.write (cmd_, false);
-    const bool ok = _cpipe.flush ();
+    _senders.add (1);
+
+    node_t *const node = alloc_node ();
+    node->next.set (NULL);
+    node->cmd = cmd_;
+
+    //  Append the node. Until it is linked to its predecessor, the reader
+    //  sees the queue end before it.
+    node_t *const prev = _tail.xchg (node);
+    prev->next.xchg (node);
+
+    //  The reader parks only after it found the queue empty, so checking
+    //  the flag after the node is linked cannot miss a parked reader.
+#if defined ZMQ_HAVE_MAILBOX_FUTEX
+    if (__atomic_exchange_n (&_parked, 0, __ATOMIC_ACQ_REL))
+        wake ();
+#else
+    {
+        scoped_lock_t lock (_wake_sync);
+        if (_parked) {
+            _parked = 0;
+            wake ();
+        }
+    }
+#endif
 
-    if (!ok) {
+    if (!_senders.sub (1)) {
+        scoped_lock_t lock (_wake_sync);
+        _senders_left = true;
         _cond_var.broadcast ();
+    }
+}
 
-        for (std::vector<signaler_t *>::iterator it = _signalers.begin (),
-                                                 end = _signalers.end ();
-             it != end; ++it) {
-            (*it)->send ();
+zmq::mailbox_safe_t::node_t *zmq::mailbox_safe_t::alloc_node ()
+{
+    //  Senders never wait for each other: if another one is taking a node,
+    //  allocate a new one instead.
+    node_t *node = NULL;
+    if (_free_sync.try_lock ()) {
+        node = _free_nodes.cas (NULL, NULL);
+        while (node) {
+            node_t *const first =
+              _free_nodes.cas (node, node->next.cas (NULL, NULL));
+            if (first == node)
+                break;
+            node = first;
         }
+        _free_sync.unlock ();
     }
 
-    _sync->unlock ();
+    if (node)
+        _free_count.sub (1);
+    else {
+        node = new (std::nothrow) node_t;
+        alloc_assert (node);
+    }
+    return node;
 }
 
 int zmq::mailbox_safe_t::recv (command_t *cmd_, int timeout_)
 {
     //  Try to get the command straight away.
-    if (_cpipe.read (cmd_))
+    if (read (cmd_))
+        return 0;
+
+    //  Announce that we are going to wait and check once more, a command
+    //  sent meanwhile did not wake us up.
+    park ();
+    if (read (cmd_))
         return 0;
 
-    //  If the timeout is zero, it will be quicker to release the lock, giving other a chance to send a command
-    //  and immediately relock it.
-    if (timeout_ == 0) {
+    if (timeout_ != 0) {
+        //  Wait for signal from the command sender, letting other threads
+        //  use the socket meanwhile.
         _sync->unlock ();
+        const int rc = wait (timeout_);
         _sync->lock ();
-    } else {
-        //  Wait for signal from the command sender.
-        const int rc = _cond_var.wait (_sync, timeout_);
         if (rc == -1) {
             errno_assert (errno == EAGAIN || errno == EINTR);
             return -1;
         }
+
+        //  Another thread may already fetch the command
+        if (read (cmd_))
+            return 0;
     }
 
-    //  Another thread may already fetch the command
-    const bool ok = _cpipe.read (cmd_);
+    errno = EAGAIN;
+    return -1;
+}
+
+bool zmq::mailbox_safe_t::check_read ()
+{
+    return _head->next.cas (NULL, NULL) != NULL;
+}
 
-    if (!ok) {
-        errno = EAGAIN;
-        return -1;
+bool zmq::mailbox_safe_t::read (command_t *cmd_)
+{
+    node_t *const next = _head->next.cas (NULL, NULL);
+    if (!next)
+        return false;
+
+    //  The node holding the command becomes the new head.
+    *cmd_ = next->cmd;
+    node_t *const prev = _head;
+    _head = next;
+    free_node (prev);
+    return true;
+}
+
+void zmq::mailbox_safe_t::free_node (node_t *node_)
+{
+    if (_free_count.get () >= max_free_nodes) {
+        delete node_;
+        return;
+    }
+    _free_count.add (1);
+
+    node_t *first = _free_nodes.cas (NULL, NULL);
+    while (true) {
+        node_->next.set (first);
+        node_t *const prev = _free_nodes.cas (first, node_);
+        if (prev == first)
+            break;
+        first = prev;
+    }
+}
+
+void zmq::mailbox_safe_t::park ()
+{
+#if defined ZMQ_HAVE_MAILBOX_FUTEX
+    __atomic_exchange_n (&_parked, 1, __ATOMIC_ACQ_REL);
+#else
+    scoped_lock_t lock (_wake_sync);
+    _parked = 1;
+#endif
+}
+
+int zmq::mailbox_safe_t::wait (int timeout_)
+{
+#if defined ZMQ_HAVE_MAILBOX_FUTEX
+    timespec timeout;
+    timespec *ptimeout = NULL;
+    if (timeout_ > 0) {
+        timeout.tv_sec = timeout_ / 1000;
+        timeout.tv_nsec = (timeout_ % 1000) * 1000000L;
+        ptimeout = &timeout;
     }
 
+    //  Returns straight away if a sender has already reset the flag.
+    const long rc = syscall (SYS_futex, &_parked, FUTEX_WAIT_PRIVATE, 1,
+                             ptimeout, NULL, 0);
+    if (rc == -1) {
+        if (errno == ETIMEDOUT) {
+            errno = EAGAIN;
+            return -1;
+        }
+        if (errno == EINTR)
+            return -1;
+        errno_assert (errno == EAGAIN);
+    }
     return 0;
+#else
+    scoped_lock_t lock (_wake_sync);
+    if (!_parked)
+        return 0;
+    return _cond_var.wait (&_wake_sync, timeout_);
+#endif
+}
+
+void zmq::mailbox_safe_t::wake ()
+{
+#if defined ZMQ_HAVE_MAILBOX_FUTEX
+    const long rc =
+      syscall (SYS_futex, &_parked, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+    errno_assert (rc != -1);
+
+    scoped_lock_t lock (_wake_sync);
+#else
+    //  The caller holds _wake_sync.
+    _cond_var.broadcast ();
+#endif
+
+    for (std::vector<signaler_t *>::iterator it = _signalers.begin (),
+                                             end = _signalers.end ();
+         it != end; ++it) {
+        (*it)->send ();
+    }
 }
@@ -10,13 +10,23 @@
 #include "fd.hpp"
 #include "config.hpp"
 #include "command.hpp"
-#include "ypipe.hpp"
+#include "atomic_ptr.hpp"
+#include "atomic_counter.hpp"
 #include "mutex.hpp"
 #include "i_mailbox.hpp"
 #include "condition_variable.hpp"
 
+//  Parked readers are woken up through a futex where available.
+#if defined ZMQ_HAVE_LINUX && defined __GNUC__
+#define ZMQ_HAVE_MAILBOX_FUTEX
+#endif
+
 namespace zmq
 {
+//  Mailbox of thread-safe sockets. Commands are passed through a lock-free
+//  multi-producer single-consumer queue, so that senders never contend with
+//  the application threads holding the socket's mutex. The reader must hold
+//  that mutex; it is released while the reader waits for commands.
 class mailbox_safe_t ZMQ_FINAL : public i_mailbox
 {
   public:
@@ -25,6 +35,7 @@ class mailbox_safe_t ZMQ_FINAL : public i_mailbox
 
     void send (const command_t &cmd_);
     int recv (command_t *cmd_, int timeout_);
+    bool check_read ();
 
     // Add signaler to mailbox which will be called when a message is ready
     void add_signaler (signaler_t *signaler_);
@@ -42,14 +53,65 @@ class mailbox_safe_t ZMQ_FINAL : public i_mailbox
 #endif
 
   private:
-    //  The pipe to store actual commands.
-    typedef ypipe_t<command_t, command_pipe_granularity> cpipe_t;
-    cpipe_t _cpipe;
+    struct node_t
+    {
+        atomic_ptr_t<node_t> next;
+        command_t cmd;
+    };
+
+    //  Takes a node from the free list, or allocates one if it is empty.
+    node_t *alloc_node ();
+
+    //  Deletes a chain of nodes.
+    static void delete_nodes (node_t *node_);
+
+    //  Takes the oldest command from the queue. Returns false if the queue
+    //  is empty or the sender of the oldest command has not linked it yet.
+    bool read (command_t *cmd_);
+
+    //  Passes a node the reader is done with to the free list, or deletes
+    //  it if the list is long enough.
+    void free_node (node_t *node_);
+
+    //  Tells senders that the reader is about to wait for commands.
+    void park ();
+
+    //  Waits until a sender wakes the reader up or the timeout expires.
+    int wait (int timeout_);
+
+    //  Wakes up parked readers and notifies the signalers.
+    void wake ();
+
+    //  Commands are appended at the tail by any thread and taken from the
+    //  head by the reader. The head node holds no command; the node after
+    //  it holds the oldest one.
+    node_t *_head;
+    atomic_ptr_t<node_t> _tail;
+
+    //  Nodes ready for reuse by senders, and how many. Only the reader adds
+    //  nodes, and only the sender holding _free_sync takes them, so a node
+    //  cannot be taken and come back while a sender looks at it.
+    atomic_ptr_t<node_t> _free_nodes;
+    atomic_counter_t _free_count;
+    mutex_t _free_sync;
+
+    //  1 if a reader found the queue empty and may be waiting for commands,
+    //  0 otherwise. The first sender to reset it wakes the readers up.
+    int _parked;
+
+    //  Number of threads currently in send, plus one until the mailbox is
+    //  destroyed. The sender dropping it to zero wakes up the destructor.
+    atomic_counter_t _senders;
+    bool _senders_left;
+
+    //  Protects the signalers and the senders left flag, and the parked flag
+    //  unless futexes are used.
+    mutex_t _wake_sync;
 
-    //  Condition variable to pass signals from writer thread to reader thread.
+    //  Wakes up the destructor and, unless futexes are used, parked readers.
     condition_variable_t _cond_var;
 
-    //  Synchronize access to the mailbox from receivers and senders
+    //  Synchronize access to the mailbox from receivers
     mutex_t *const _sync;
 
     std::vector<zmq::signaler_t *> _signalers;
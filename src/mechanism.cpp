@@ -250,6 +250,8 @@ int zmq::mechanism_t::parse_metadata (const unsigned char *ptr_,
             if (rc == -1)
                 return -1;
         }
+        if (internal_property (name))
+            continue;
         (zap_flag_ ? _zap_properties : _zmtp_properties)
           .ZMQ_MAP_INSERT_OR_EMPLACE (
             name,
@@ -271,6 +273,11 @@ int zmq::mechanism_t::property (const std::string & /* name_ */,
     return 0;
 }
 
+bool zmq::mechanism_t::internal_property (const std::string & /* name_ */) const
+{
+    return false;
+}
+
 template <size_t N>
 static bool strequals (const char *actual_type_,
                        const size_t actual_len_,
@@ -38,8 +38,37 @@ class mechanism_t
 
     virtual int encode (msg_t *) { return 0; }
 
+    //  True iff the mechanism encodes several frames at once, handing out
+    //  the ones after the frame returned by encode through encode_next. It
+    //  may encode them on other threads, encode then failing with EAGAIN
+    //  until the session restarts the output of the engine.
+    virtual bool encodes_ahead () const { return false; }
+
+    //  Retrieves the next frame encoded ahead. Returns false if there is
+    //  none, or none yet.
+    virtual bool encode_next (msg_t *) { return false; }
+
+    //  True iff there are frames encoded ahead, or being encoded.
+    virtual bool encoded_ahead () const { return false; }
+
     virtual int decode (msg_t *) { return 0; }
 
+    //  Retrieves the next message decoded from the same frame as the last
+    //  one, for mechanisms that carry several messages in a frame. Returns
+    //  false if there is none left.
+    virtual bool decode_next (msg_t *) { return false; }
+
+    //  True iff decode held frames back, to decode them along with the ones
+    //  following them, and their messages are not all retrieved yet. decode
+    //  then leaves the messages to decode_next, and may fail with EAGAIN if
+    //  the frames are decoded on other threads, until the session restarts
+    //  the input of the engine.
+    virtual bool decode_deferred () const { return false; }
+
+    //  Decodes the frames held back, the messages of which are then
+    //  retrieved by decode_next. Fails with EAGAIN as decode does.
+    virtual int flush_decode () { return 0; }
+
     //  Notifies mechanism about availability of ZAP message.
     virtual int zap_msg_available () { return 0; }
 
@@ -102,6 +131,10 @@ class mechanism_t
     virtual int
     property (const std::string &name_, const void *value_, size_t length_);
 
+    //  Returns whether the property only serves the mechanism itself, in
+    //  which case it is not part of the metadata of received messages.
+    virtual bool internal_property (const std::string &name_) const;
+
     const options_t options;
 
   private:
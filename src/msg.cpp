@@ -12,6 +12,7 @@
 #include "stdint.hpp"
 #include "likely.hpp"
 #include "metadata.hpp"
+#include "msg_pool.hpp"
 #include "err.hpp"
 
 //  Check whether the sizes of public representation of the message (zmq_msg_t)
@@ -21,6 +22,23 @@ typedef char
   zmq_msg_size_check[2 * ((sizeof (zmq::msg_t) == sizeof (zmq_msg_t)) != 0)
                      - 1];
 
+//  Check that the size of very small messages fits into their size field.
+
+typedef char zmq_msg_vsm_size_check[2 * (zmq::msg_t::max_vsm_size <= 0xff) - 1];
+
+//  Releases the content of a long message. Content allocated by init_size
+//  has no free function, and its hint identifies the pool it came from.
+static void free_content (zmq::msg_t::content_t *content_)
+{
+    if (content_->ffn)
+        content_->ffn (content_->data, content_->hint);
+    else if (content_->hint) {
+        zmq::msg_pool_free (content_, content_->hint);
+        return;
+    }
+    free (content_);
+}
+
 bool zmq::msg_t::check () const
 {
     return _u.base.type >= type_min && _u.base.type <= type_max;
@@ -77,19 +95,28 @@ int zmq::msg_t::init_size (size_t size_)
         _u.lmsg.group.type = group_type_short;
         _u.lmsg.routing_id = 0;
         _u.lmsg.content = NULL;
-        if (sizeof (content_t) + size_ > size_)
-            _u.lmsg.content =
-              static_cast<content_t *> (malloc (sizeof (content_t) + size_));
+        void *pool = NULL;
+        const size_t alloc_size = sizeof (content_t) + wire_headroom + size_;
+        if (alloc_size > size_) {
+            _u.lmsg.content = static_cast<content_t *> (
+              msg_pool_alloc (alloc_size, &pool));
+            if (!_u.lmsg.content)
+                _u.lmsg.content =
+                  static_cast<content_t *> (malloc (alloc_size));
+        }
         if (unlikely (!_u.lmsg.content)) {
             errno = ENOMEM;
             return -1;
         }
 
-        _u.lmsg.content->data = _u.lmsg.content + 1;
+        _u.lmsg.content->data =
+          reinterpret_cast<unsigned char *> (_u.lmsg.content + 1)
+          + wire_headroom;
         _u.lmsg.content->size = size_;
         _u.lmsg.content->ffn = NULL;
-        _u.lmsg.content->hint = NULL;
+        _u.lmsg.content->hint = pool;
         new (&_u.lmsg.content->refcnt) zmq::atomic_counter_t ();
+        _u.lmsg.content->wire_header_size = 0;
     }
     return 0;
 }
@@ -130,6 +157,7 @@ int zmq::msg_t::init_external_storage (content_t *content_,
     _u.zclmsg.content->ffn = ffn_;
     _u.zclmsg.content->hint = hint_;
     new (&_u.zclmsg.content->refcnt) zmq::atomic_counter_t ();
+    _u.zclmsg.content->wire_header_size = 0;
 
     return 0;
 }
@@ -172,6 +200,7 @@ int zmq::msg_t::init_data (void *data_,
         _u.lmsg.content->ffn = ffn_;
         _u.lmsg.content->hint = hint_;
         new (&_u.lmsg.content->refcnt) zmq::atomic_counter_t ();
+        _u.lmsg.content->wire_header_size = 0;
     }
     return 0;
 }
@@ -256,10 +285,7 @@ int zmq::msg_t::close ()
             //  counter so we call the destructor explicitly now.
             _u.lmsg.content->refcnt.~atomic_counter_t ();
 
-            if (_u.lmsg.content->ffn)
-                _u.lmsg.content->ffn (_u.lmsg.content->data,
-                                      _u.lmsg.content->hint);
-            free (_u.lmsg.content);
+            free_content (_u.lmsg.content);
         }
     }
 
@@ -413,6 +439,7 @@ void zmq::msg_t::shrink (size_t new_size_)
             break;
         case type_lmsg:
             _u.lmsg.content->size = new_size_;
+            _u.lmsg.content->wire_header_size = 0;
             break;
         case type_zclmsg:
             _u.zclmsg.content->size = new_size_;
@@ -425,6 +452,29 @@ void zmq::msg_t::shrink (size_t new_size_)
     }
 }
 
+bool zmq::msg_t::set_wire_header (const unsigned char *header_, size_t size_)
+{
+    //  Only content allocated by init_size has room for the header.
+    if (_u.base.type != type_lmsg || _u.lmsg.content->ffn
+        || (_u.base.flags & msg_t::shared) || size_ > wire_headroom)
+        return false;
+
+    content_t *content = _u.lmsg.content;
+    memcpy (static_cast<unsigned char *> (content->data) - size_, header_,
+            size_);
+    content->wire_header_size = static_cast<unsigned char> (size_);
+    return true;
+}
+
+unsigned char *zmq::msg_t::wire_header (size_t *size_)
+{
+    if (_u.base.type != type_lmsg || !_u.lmsg.content->wire_header_size)
+        return NULL;
+
+    *size_ = _u.lmsg.content->wire_header_size;
+    return static_cast<unsigned char *> (_u.lmsg.content->data) - *size_;
+}
+
 unsigned char zmq::msg_t::flags () const
 {
     return _u.base.flags;
@@ -605,9 +655,7 @@ bool zmq::msg_t::rm_refs (int refs_)
         //  counter so we call the destructor explicitly now.
         _u.lmsg.content->refcnt.~atomic_counter_t ();
 
-        if (_u.lmsg.content->ffn)
-            _u.lmsg.content->ffn (_u.lmsg.content->data, _u.lmsg.content->hint);
-        free (_u.lmsg.content);
+        free_content (_u.lmsg.content);
 
         return false;
     }
@@ -39,7 +39,9 @@ class msg_t
     //  In the latter case, ffn member stores pointer to the function to be
     //  used to deallocate the data. If the buffer is actually shared (there
     //  are at least 2 references to it) refcount member contains number of
-    //  references.
+    //  references. Content allocated along with this structure reserves
+    //  wire_headroom bytes in front of the data, where the wire_header_size
+    //  bytes long ZMTP frame header can be stored by set_wire_header.
     struct content_t
     {
         void *data;
@@ -47,6 +49,7 @@ class msg_t
         msg_free_fn *ffn;
         void *hint;
         zmq::atomic_counter_t refcnt;
+        unsigned char wire_header_size;
     };
 
     //  Message flags.
@@ -143,17 +146,33 @@ class msg_t
 
     void shrink (size_t new_size_);
 
+    //  Stores the encoded frame header of the message right in front of its
+    //  data, so that the header is encoded once for all the peers the
+    //  message is sent to, and header and data can be written in one go.
+    //  Fails for messages without room for the header, and for shared ones
+    //  as their content may be read by other threads.
+    bool set_wire_header (const unsigned char *header_, size_t size_);
+
+    //  Returns the header stored by set_wire_header, or NULL if there's none.
+    unsigned char *wire_header (size_t *size_);
+
     //  Size in bytes of the largest message that is still copied around
     //  rather than being reference-counted.
     enum
     {
-        msg_t_size = 64
+        msg_t_size = ZMQ_MSG_T_BYTES
     };
     enum
     {
         max_vsm_size =
           msg_t_size - (sizeof (metadata_t *) + 3 + 16 + sizeof (uint32_t))
     };
+    //  Room reserved for the frame header in front of the data of long
+    //  messages. Keeps the data aligned as if there were no headroom.
+    enum
+    {
+        wire_headroom = 16
+    };
     enum
     {
         ping_cmd_name_size = 5,   // 4PING
@@ -0,0 +1,255 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include "msg_pool.hpp"
+
+#include <stdlib.h>
+
+#include "atomic_counter.hpp"
+#include "config.hpp"
+#include "err.hpp"
+#include "likely.hpp"
+#include "macros.hpp"
+#include "mutex.hpp"
+
+//  Per-thread caches require thread_local storage with destructors.
+#if (defined __cplusplus && __cplusplus >= 201103L)                            \
+  || (defined _MSC_VER && _MSC_VER >= 1900)
+#define ZMQ_HAVE_MSG_POOL
+#endif
+
+namespace
+{
+//  Free blocks are chained through their first bytes. The first block of
+//  a full batch stored in the depot also links the next batch.
+struct free_block_t
+{
+    free_block_t *next;
+    free_block_t *next_batch;
+};
+
+//  A chain of at most msg_pool_batch_size free blocks.
+struct batch_t
+{
+    free_block_t *head;
+    unsigned int count;
+};
+
+//  Shared store of full batches of one size class.
+struct depot_t
+{
+    zmq::mutex_t sync;
+    free_block_t *batches;
+    unsigned int count;
+};
+
+//  Blocks of size class i are min_class_size << i bytes long.
+const size_t min_class_size = 128;
+const int class_count = 7;
+
+depot_t depots[class_count];
+
+//  Number of contexts that have the pool enabled.
+zmq::atomic_counter_t users;
+
+void free_batch (free_block_t *head_)
+{
+    while (head_) {
+        free_block_t *next = head_->next;
+        free (head_);
+        head_ = next;
+    }
+}
+
+void drain_depots ()
+{
+    for (int i = 0; i != class_count; ++i) {
+        free_block_t *batches;
+        {
+            zmq::scoped_lock_t lock (depots[i].sync);
+            batches = depots[i].batches;
+            depots[i].batches = NULL;
+            depots[i].count = 0;
+        }
+        while (batches) {
+            free_block_t *next = batches->next_batch;
+            free_batch (batches);
+            batches = next;
+        }
+    }
+}
+
+#if defined ZMQ_HAVE_MSG_POOL
+size_t class_size (int class_)
+{
+    return min_class_size << class_;
+}
+
+int class_of (size_t size_)
+{
+    int size_class = 0;
+    while (class_size (size_class) < size_)
+        if (++size_class == class_count)
+            return -1;
+    return size_class;
+}
+
+void put_batch (depot_t &depot_, free_block_t *head_)
+{
+    {
+        zmq::scoped_lock_t lock (depot_.sync);
+        if (depot_.count < zmq::msg_pool_max_batches) {
+            head_->next_batch = depot_.batches;
+            depot_.batches = head_;
+            ++depot_.count;
+            return;
+        }
+    }
+    free_batch (head_);
+}
+
+free_block_t *get_batch (depot_t &depot_)
+{
+    zmq::scoped_lock_t lock (depot_.sync);
+    free_block_t *head = depot_.batches;
+    if (head) {
+        depot_.batches = head->next_batch;
+        --depot_.count;
+    }
+    return head;
+}
+
+//  Each thread caches up to two batches per size class: blocks are taken
+//  from and returned to the current one, while the other one absorbs
+//  alternating allocations and releases without touching the depot.
+struct thread_cache_t
+{
+    batch_t current[class_count];
+    batch_t previous[class_count];
+    bool registered;
+    bool destroyed;
+};
+
+thread_local thread_cache_t cache;
+
+//  Returns the cached blocks to the depot when the thread exits.
+struct cache_guard_t
+{
+    ~cache_guard_t ()
+    {
+        for (int i = 0; i != class_count; ++i) {
+            batch_t *const batches[] = {&cache.current[i], &cache.previous[i]};
+            for (int j = 0; j != 2; ++j) {
+                if (batches[j]->count == zmq::msg_pool_batch_size)
+                    put_batch (depots[i], batches[j]->head);
+                else
+                    free_batch (batches[j]->head);
+                batches[j]->head = NULL;
+                batches[j]->count = 0;
+            }
+        }
+        cache.destroyed = true;
+    }
+
+    bool active;
+};
+
+thread_local cache_guard_t guard;
+
+thread_cache_t *get_cache ()
+{
+    if (unlikely (!cache.registered)) {
+        //  Using the guard makes sure its destructor runs at thread exit.
+        cache.registered = true;
+        guard.active = true;
+    }
+    return cache.destroyed ? NULL : &cache;
+}
+#endif
+}
+
+void zmq::msg_pool_enable ()
+{
+    users.add (1);
+}
+
+void zmq::msg_pool_disable ()
+{
+    //  Blocks cached by threads are released as the threads exit.
+    if (!users.sub (1))
+        drain_depots ();
+}
+
+void *zmq::msg_pool_alloc (size_t size_, void **pool_)
+{
+#if defined ZMQ_HAVE_MSG_POOL
+    if (likely (users.get () == 0))
+        return NULL;
+
+    const int size_class = class_of (size_);
+    if (size_class == -1)
+        return NULL;
+    *pool_ = &depots[size_class];
+
+    thread_cache_t *const thread_cache = get_cache ();
+    if (unlikely (!thread_cache))
+        return malloc (class_size (size_class));
+
+    batch_t &current = thread_cache->current[size_class];
+    if (unlikely (current.count == 0)) {
+        batch_t &previous = thread_cache->previous[size_class];
+        if (previous.count) {
+            current = previous;
+            previous.head = NULL;
+            previous.count = 0;
+        } else {
+            current.head = get_batch (depots[size_class]);
+            if (!current.head)
+                return malloc (class_size (size_class));
+            current.count = msg_pool_batch_size;
+        }
+    }
+
+    free_block_t *const block = current.head;
+    current.head = block->next;
+    --current.count;
+    return block;
+#else
+    LIBZMQ_UNUSED (size_);
+    LIBZMQ_UNUSED (pool_);
+    return NULL;
+#endif
+}
+
+void zmq::msg_pool_free (void *block_, void *pool_)
+{
+#if defined ZMQ_HAVE_MSG_POOL
+    thread_cache_t *const thread_cache = get_cache ();
+    if (unlikely (users.get () == 0 || !thread_cache)) {
+        free (block_);
+        return;
+    }
+
+    depot_t &depot = *static_cast<depot_t *> (pool_);
+    const int size_class = static_cast<int> (&depot - depots);
+    zmq_assert (size_class >= 0 && size_class < class_count);
+
+    batch_t &current = thread_cache->current[size_class];
+    if (unlikely (current.count == msg_pool_batch_size)) {
+        batch_t &previous = thread_cache->previous[size_class];
+        if (previous.count)
+            put_batch (depot, previous.head);
+        previous = current;
+        current.head = NULL;
+        current.count = 0;
+    }
+
+    free_block_t *const block = static_cast<free_block_t *> (block_);
+    block->next = current.head;
+    current.head = block;
+    ++current.count;
+#else
+    LIBZMQ_UNUSED (pool_);
+    free (block_);
+#endif
+}
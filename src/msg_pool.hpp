@@ -0,0 +1,32 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_MSG_POOL_HPP_INCLUDED__
+#define __ZMQ_MSG_POOL_HPP_INCLUDED__
+
+#include <stddef.h>
+
+namespace zmq
+{
+//  Process-wide pool for the content of long messages. Blocks are grouped
+//  into power-of-two size classes and recycled through per-thread caches,
+//  which exchange whole batches of blocks with a shared depot, so that
+//  allocating and releasing a block takes no lock in the common case.
+//  This holds even when messages are allocated by one thread and released
+//  by another, as is the case for messages passing through I/O threads.
+
+//  Enables or disables pooling on behalf of a context. Refcounted, so that
+//  the pool is in use as long as any context has it enabled.
+void msg_pool_enable ();
+void msg_pool_disable ();
+
+//  Returns a block of at least size_ bytes, or NULL if the pool is not in
+//  use or no size class is large enough. On success, pool_ is set to the
+//  value that identifies the block's size class to msg_pool_free.
+void *msg_pool_alloc (size_t size_, void **pool_);
+
+//  Returns a block obtained from msg_pool_alloc. Can be called from any
+//  thread and regardless of whether the pool is still in use.
+void msg_pool_free (void *block_, void *pool_);
+}
+
+#endif
@@ -82,14 +82,16 @@ void zmq::object_t::process_command (const command_t &cmd_)
         case command_t::pipe_peer_stats:
             process_pipe_peer_stats (cmd_.args.pipe_peer_stats.queue_count,
                                      cmd_.args.pipe_peer_stats.socket_base,
-                                     cmd_.args.pipe_peer_stats.endpoint_pair);
+                                     cmd_.args.pipe_peer_stats.endpoint_pair,
+                                     cmd_.args.pipe_peer_stats.latency);
             break;
 
         case command_t::pipe_stats_publish:
             process_pipe_stats_publish (
               cmd_.args.pipe_stats_publish.outbound_queue_count,
               cmd_.args.pipe_stats_publish.inbound_queue_count,
-              cmd_.args.pipe_stats_publish.endpoint_pair);
+              cmd_.args.pipe_stats_publish.endpoint_pair,
+              cmd_.args.pipe_stats_publish.latency);
             break;
 
         case command_t::pipe_term:
@@ -137,6 +139,10 @@ void zmq::object_t::process_command (const command_t &cmd_)
             process_conn_failed ();
             break;
 
+        case command_t::work_done:
+            process_work_done (cmd_.args.work_done.job);
+            break;
+
         case command_t::done:
         default:
             zmq_assert (false);
@@ -183,9 +189,11 @@ void zmq::object_t::destroy_socket (socket_base_t *socket_)
     _ctx->destroy_socket (socket_);
 }
 
-zmq::io_thread_t *zmq::object_t::choose_io_thread (uint64_t affinity_) const
+zmq::io_thread_t *zmq::object_t::choose_io_thread (uint64_t affinity_,
+                                                   int cpu_,
+                                                   unsigned int napi_id_) const
 {
-    return _ctx->choose_io_thread (affinity_);
+    return _ctx->choose_io_thread (affinity_, cpu_, napi_id_);
 }
 
 void zmq::object_t::send_stop ()
@@ -241,6 +249,15 @@ void zmq::object_t::send_conn_failed (session_base_t *destination_)
     send_command (cmd);
 }
 
+void zmq::object_t::send_work_done (object_t *destination_, void *job_)
+{
+    command_t cmd;
+    cmd.destination = destination_;
+    cmd.type = command_t::work_done;
+    cmd.args.work_done.job = job_;
+    send_command (cmd);
+}
+
 void zmq::object_t::send_bind (own_t *destination_,
                                pipe_t *pipe_,
                                bool inc_seqnum_)
@@ -285,7 +302,8 @@ void zmq::object_t::send_hiccup (pipe_t *destination_, void *pipe_)
 void zmq::object_t::send_pipe_peer_stats (pipe_t *destination_,
                                           uint64_t queue_count_,
                                           own_t *socket_base_,
-                                          endpoint_uri_pair_t *endpoint_pair_)
+                                          endpoint_uri_pair_t *endpoint_pair_,
+                                          pipe_latency_t *latency_)
 {
     command_t cmd;
     cmd.destination = destination_;
@@ -293,6 +311,7 @@ void zmq::object_t::send_pipe_peer_stats (pipe_t *destination_,
     cmd.args.pipe_peer_stats.queue_count = queue_count_;
     cmd.args.pipe_peer_stats.socket_base = socket_base_;
     cmd.args.pipe_peer_stats.endpoint_pair = endpoint_pair_;
+    cmd.args.pipe_peer_stats.latency = latency_;
     send_command (cmd);
 }
 
@@ -300,7 +319,8 @@ void zmq::object_t::send_pipe_stats_publish (
   own_t *destination_,
   uint64_t outbound_queue_count_,
   uint64_t inbound_queue_count_,
-  endpoint_uri_pair_t *endpoint_pair_)
+  endpoint_uri_pair_t *endpoint_pair_,
+  pipe_latency_t *latency_)
 {
     command_t cmd;
     cmd.destination = destination_;
@@ -308,6 +328,7 @@ void zmq::object_t::send_pipe_stats_publish (
     cmd.args.pipe_stats_publish.outbound_queue_count = outbound_queue_count_;
     cmd.args.pipe_stats_publish.inbound_queue_count = inbound_queue_count_;
     cmd.args.pipe_stats_publish.endpoint_pair = endpoint_pair_;
+    cmd.args.pipe_stats_publish.latency = latency_;
     send_command (cmd);
 }
 
@@ -450,14 +471,16 @@ void zmq::object_t::process_hiccup (void *)
 
 void zmq::object_t::process_pipe_peer_stats (uint64_t,
                                              own_t *,
-                                             endpoint_uri_pair_t *)
+                                             endpoint_uri_pair_t *,
+                                             pipe_latency_t *)
 {
     zmq_assert (false);
 }
 
 void zmq::object_t::process_pipe_stats_publish (uint64_t,
                                                 uint64_t,
-                                                endpoint_uri_pair_t *)
+                                                endpoint_uri_pair_t *,
+                                                pipe_latency_t *)
 {
     zmq_assert (false);
 }
@@ -517,6 +540,11 @@ void zmq::object_t::process_conn_failed ()
     zmq_assert (false);
 }
 
+void zmq::object_t::process_work_done (void *)
+{
+    zmq_assert (false);
+}
+
 void zmq::object_t::send_command (const command_t &cmd_)
 {
     _ctx->send_command (cmd_.destination->get_tid (), cmd_);
@@ -21,6 +21,7 @@ class socket_base_t;
 class session_base_t;
 class io_thread_t;
 class own_t;
+struct pipe_latency_t;
 
 //  Base class for all objects that participate in inter-thread
 //  communication.
@@ -58,8 +59,11 @@ class object_t
     //  Logs an message.
     void log (const char *format_, ...);
 
-    //  Chooses least loaded I/O thread.
-    zmq::io_thread_t *choose_io_thread (uint64_t affinity_) const;
+    //  Chooses least loaded I/O thread, or the closest one to the given
+    //  CPU or NIC receive queue.
+    zmq::io_thread_t *choose_io_thread (uint64_t affinity_,
+                                        int cpu_ = -1,
+                                        unsigned int napi_id_ = 0) const;
 
     //  Derived object can use these functions to send commands
     //  to other objects.
@@ -75,11 +79,13 @@ class object_t
     void send_pipe_peer_stats (zmq::pipe_t *destination_,
                                uint64_t queue_count_,
                                zmq::own_t *socket_base,
-                               endpoint_uri_pair_t *endpoint_pair_);
+                               endpoint_uri_pair_t *endpoint_pair_,
+                               zmq::pipe_latency_t *latency_);
     void send_pipe_stats_publish (zmq::own_t *destination_,
                                   uint64_t outbound_queue_count_,
                                   uint64_t inbound_queue_count_,
-                                  endpoint_uri_pair_t *endpoint_pair_);
+                                  endpoint_uri_pair_t *endpoint_pair_,
+                                  zmq::pipe_latency_t *latency_);
     void send_pipe_term (zmq::pipe_t *destination_);
     void send_pipe_term_ack (zmq::pipe_t *destination_);
     void send_pipe_hwm (zmq::pipe_t *destination_, int inhwm_, int outhwm_);
@@ -91,6 +97,7 @@ class object_t
     void send_reaped ();
     void send_done ();
     void send_conn_failed (zmq::session_base_t *destination_);
+    void send_work_done (zmq::object_t *destination_, void *job_);
 
 
     //  These handlers can be overridden by the derived objects. They are
@@ -105,11 +112,13 @@ class object_t
     virtual void process_hiccup (void *pipe_);
     virtual void process_pipe_peer_stats (uint64_t queue_count_,
                                           zmq::own_t *socket_base_,
-                                          endpoint_uri_pair_t *endpoint_pair_);
+                                          endpoint_uri_pair_t *endpoint_pair_,
+                                          zmq::pipe_latency_t *latency_);
     virtual void
     process_pipe_stats_publish (uint64_t outbound_queue_count_,
                                 uint64_t inbound_queue_count_,
-                                endpoint_uri_pair_t *endpoint_pair_);
+                                endpoint_uri_pair_t *endpoint_pair_,
+                                zmq::pipe_latency_t *latency_);
     virtual void process_pipe_term ();
     virtual void process_pipe_term_ack ();
     virtual void process_pipe_hwm (int inhwm_, int outhwm_);
@@ -120,6 +129,7 @@ class object_t
     virtual void process_reap (zmq::socket_base_t *socket_);
     virtual void process_reaped ();
     virtual void process_conn_failed ();
+    virtual void process_work_done (void *job_);
 
 
     //  Special handler called after a command that requires a seqnum
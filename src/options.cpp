@@ -238,7 +238,13 @@ zmq::options_t::options_t () :
     norm_num_parity (4),
     norm_num_autoparity (0),
     norm_push_enable (false),
-    busy_poll (0)
+    busy_poll (0),
+    tcp_zerocopy (false),
+    rcvspin (0),
+    latency_stats (false),
+    io_thread_locality (false),
+    tcp_accept_shards (0),
+    curve_batch (false)
 {
     memset (curve_public_key, 0, CURVE_KEYSIZE);
     memset (curve_secret_key, 0, CURVE_KEYSIZE);
@@ -792,6 +798,36 @@ int zmq::options_t::setsockopt (int option_,
                 return 0;
             }
             break;
+
+        case ZMQ_TCP_ZEROCOPY:
+            return do_setsockopt_int_as_bool_strict (optval_, optvallen_,
+                                                     &tcp_zerocopy);
+
+        case ZMQ_RCVSPIN:
+            if (is_int && value >= 0) {
+                rcvspin = value;
+                return 0;
+            }
+            break;
+
+        case ZMQ_LATENCY_STATS:
+            return do_setsockopt_int_as_bool_strict (optval_, optvallen_,
+                                                     &latency_stats);
+
+        case ZMQ_IO_THREAD_LOCALITY:
+            return do_setsockopt_int_as_bool_strict (optval_, optvallen_,
+                                                     &io_thread_locality);
+
+        case ZMQ_TCP_ACCEPT_SHARDS:
+            if (is_int && value >= 0 && value <= 64) {
+                tcp_accept_shards = value;
+                return 0;
+            }
+            break;
+
+        case ZMQ_CURVE_BATCH:
+            return do_setsockopt_int_as_bool_strict (optval_, optvallen_,
+                                                     &curve_batch);
 #ifdef ZMQ_HAVE_WSS
         case ZMQ_WSS_KEY_PEM:
             // TODO: check if valid certificate
@@ -1346,6 +1382,48 @@ int zmq::options_t::getsockopt (int option_,
             }
             break;
 
+        case ZMQ_TCP_ZEROCOPY:
+            if (is_int) {
+                *value = tcp_zerocopy;
+                return 0;
+            }
+            break;
+
+        case ZMQ_RCVSPIN:
+            if (is_int) {
+                *value = rcvspin;
+                return 0;
+            }
+            break;
+
+        case ZMQ_LATENCY_STATS:
+            if (is_int) {
+                *value = latency_stats;
+                return 0;
+            }
+            break;
+
+        case ZMQ_IO_THREAD_LOCALITY:
+            if (is_int) {
+                *value = io_thread_locality;
+                return 0;
+            }
+            break;
+
+        case ZMQ_TCP_ACCEPT_SHARDS:
+            if (is_int) {
+                *value = tcp_accept_shards;
+                return 0;
+            }
+            break;
+
+        case ZMQ_CURVE_BATCH:
+            if (is_int) {
+                *value = curve_batch;
+                return 0;
+            }
+            break;
+
 #ifdef ZMQ_HAVE_NORM
         case ZMQ_NORM_MODE:
             if (is_int) {
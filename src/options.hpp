@@ -298,6 +298,30 @@ struct options_t
 
     //  This option removes several delays caused by scheduling, interrupts and context switching.
     int busy_poll;
+
+    //  If true, large message bodies are sent over TCP with MSG_ZEROCOPY.
+    bool tcp_zerocopy;
+
+    //  Time in microseconds that a blocking recv spins waiting for messages
+    //  before going to sleep. 0 means not to spin.
+    int rcvspin;
+
+    //  If true, latencies of the messages passing through the socket's pipes
+    //  are recorded and reported with ZMQ_EVENT_PIPES_LATENCY.
+    bool latency_stats;
+
+    //  If true, sessions and listeners run in the I/O threads closest to the
+    //  CPUs that handle their traffic, rather than the least loaded ones.
+    bool io_thread_locality;
+
+    //  Number of I/O threads that accept connections on bound TCP endpoints,
+    //  each with a listener of its own bound with SO_REUSEPORT. 0 or 1 means
+    //  a single listener.
+    int tcp_accept_shards;
+
+    //  If true, CURVE connections offer to carry several messages in each
+    //  MESSAGE command, which they do if the peer agrees.
+    bool curve_batch;
 };
 
 inline bool get_effective_conflate_option (const options_t &options)
@@ -3,10 +3,12 @@
 #include "precompiled.hpp"
 #include <new>
 #include <stddef.h>
+#include <algorithm>
 
 #include "macros.hpp"
 #include "pipe.hpp"
 #include "err.hpp"
+#include "clock.hpp"
 
 #include "ypipe.hpp"
 #include "ypipe_conflate.hpp"
@@ -14,7 +16,8 @@
 int zmq::pipepair (object_t *parents_[2],
                    pipe_t *pipes_[2],
                    const int hwms_[2],
-                   const bool conflate_[2])
+                   const bool conflate_[2],
+                   bool latency_stats_)
 {
     //   Creates two pipe objects. These objects are connected by two ypipes,
     //   each to pass messages in one direction.
@@ -36,11 +39,20 @@ int zmq::pipepair (object_t *parents_[2],
         upipe2 = new (std::nothrow) upipe_normal_t ();
     alloc_assert (upipe2);
 
-    pipes_[0] = new (std::nothrow)
-      pipe_t (parents_[0], upipe1, upipe2, hwms_[1], hwms_[0], conflate_[0]);
+    //  Conflation drops messages, after which the timestamps would no longer
+    //  match the messages read.
+    pipe_stamps_t *stamps = NULL;
+    if (latency_stats_ && !conflate_[0] && !conflate_[1]) {
+        stamps = new (std::nothrow) pipe_stamps_t;
+        alloc_assert (stamps);
+        stamps->refs.set (2);
+    }
+
+    pipes_[0] = new (std::nothrow) pipe_t (parents_[0], upipe1, upipe2, hwms_[1],
+                                           hwms_[0], conflate_[0], stamps, 0);
     alloc_assert (pipes_[0]);
-    pipes_[1] = new (std::nothrow)
-      pipe_t (parents_[1], upipe2, upipe1, hwms_[0], hwms_[1], conflate_[1]);
+    pipes_[1] = new (std::nothrow) pipe_t (parents_[1], upipe2, upipe1, hwms_[0],
+                                           hwms_[1], conflate_[1], stamps, 1);
     alloc_assert (pipes_[1]);
 
     pipes_[0]->set_peer (pipes_[1]);
@@ -72,12 +84,47 @@ void zmq::send_hello_msg (pipe_t *pipe_, const options_t &options_)
     pipe_->flush ();
 }
 
+zmq::pipe_flush_batch_t::pipe_flush_batch_t () : _active (false)
+{
+}
+
+zmq::pipe_flush_batch_t::~pipe_flush_batch_t ()
+{
+    zmq_assert (_pipes.empty ());
+}
+
+void zmq::pipe_flush_batch_t::begin ()
+{
+    _active = true;
+}
+
+void zmq::pipe_flush_batch_t::flush ()
+{
+    const bool active = _active;
+    _active = false;
+    for (std::vector<pipe_t *>::size_type i = 0, size = _pipes.size ();
+         i != size; ++i) {
+        _pipes[i]->_flush_pending = false;
+        _pipes[i]->flush ();
+    }
+    _pipes.clear ();
+    _active = active;
+}
+
+void zmq::pipe_flush_batch_t::end ()
+{
+    flush ();
+    _active = false;
+}
+
 zmq::pipe_t::pipe_t (object_t *parent_,
                      upipe_t *inpipe_,
                      upipe_t *outpipe_,
                      int inhwm_,
                      int outhwm_,
-                     bool conflate_) :
+                     bool conflate_,
+                     pipe_stamps_t *stamps_,
+                     int out_direction_) :
     object_t (parent_),
     _in_pipe (inpipe_),
     _out_pipe (outpipe_),
@@ -90,19 +137,38 @@ zmq::pipe_t::pipe_t (object_t *parent_,
     _msgs_read (0),
     _msgs_written (0),
     _peers_msgs_read (0),
+    _stamps (stamps_),
+    _out_stamps (stamps_ ? &stamps_->directions[out_direction_] : NULL),
+    _in_stamps (stamps_ ? &stamps_->directions[1 - out_direction_] : NULL),
+    _in_latency (NULL),
+    _wire_latency (NULL),
     _peer (NULL),
     _sink (NULL),
+    _flush_batch (NULL),
+    _flush_pending (false),
     _state (active),
     _delay (true),
     _server_socket_routing_id (0),
     _conflate (conflate_)
 {
     _disconnect_msg.init ();
+
+    if (_stamps) {
+        _in_latency = new (std::nothrow) latency_histogram_t;
+        alloc_assert (_in_latency);
+        _wire_latency = new (std::nothrow) latency_histogram_t;
+        alloc_assert (_wire_latency);
+    }
 }
 
 zmq::pipe_t::~pipe_t ()
 {
     _disconnect_msg.close ();
+
+    LIBZMQ_DELETE (_in_latency);
+    LIBZMQ_DELETE (_wire_latency);
+    if (_stamps && !_stamps->refs.sub (1))
+        delete _stamps;
 }
 
 void zmq::pipe_t::set_peer (pipe_t *peer_)
@@ -119,6 +185,12 @@ void zmq::pipe_t::set_event_sink (i_pipe_events *sink_)
     _sink = sink_;
 }
 
+void zmq::pipe_t::set_flush_batch (pipe_flush_batch_t *flush_batch_)
+{
+    zmq_assert (!_flush_batch);
+    _flush_batch = flush_batch_;
+}
+
 void zmq::pipe_t::set_server_socket_routing_id (
   uint32_t server_socket_routing_id_)
 {
@@ -195,8 +267,12 @@ bool zmq::pipe_t::read (msg_t *msg_)
         return false;
     }
 
-    if (!(msg_->flags () & msg_t::more) && !msg_->is_routing_id ())
+    if (!(msg_->flags () & msg_t::more) && !msg_->is_routing_id ()) {
+        if (_in_stamps)
+            _in_latency->record (clock_t::now_us ()
+                                 - _in_stamps->get (_msgs_read));
         _msgs_read++;
+    }
 
     if (_lwm > 0 && _msgs_read % _lwm == 0)
         send_activate_write (_peer, _msgs_read);
@@ -227,8 +303,11 @@ bool zmq::pipe_t::write (const msg_t *msg_)
     const bool more = (msg_->flags () & msg_t::more) != 0;
     const bool is_routing_id = msg_->is_routing_id ();
     _out_pipe->write (*msg_, more);
-    if (!more && !is_routing_id)
+    if (!more && !is_routing_id) {
+        if (_out_stamps)
+            _out_stamps->set (_msgs_written, clock_t::now_us ());
         _msgs_written++;
+    }
 
     return true;
 }
@@ -252,6 +331,16 @@ void zmq::pipe_t::flush ()
     if (_state == term_ack_sent)
         return;
 
+    //  Leave the flush to the end of the batch, if one is open. Once the
+    //  pipe is terminating it's flushed straight away.
+    if (_flush_batch && _flush_batch->active () && _state == active) {
+        if (!_flush_pending) {
+            _flush_pending = true;
+            _flush_batch->_pipes.push_back (this);
+        }
+        return;
+    }
+
     if (_out_pipe && !_out_pipe->flush ())
         send_activate_read (_peer);
 }
@@ -344,6 +433,12 @@ void zmq::pipe_t::process_pipe_term_ack ()
     zmq_assert (_sink);
     _sink->pipe_terminated (this);
 
+    //  The batch must not flush the pipe once it's gone.
+    if (_flush_pending) {
+        std::vector<pipe_t *> &pipes = _flush_batch->_pipes;
+        pipes.erase (std::find (pipes.begin (), pipes.end (), this));
+    }
+
     //  In term_ack_sent and term_req_sent2 states there's nothing to do.
     //  Simply deallocate the pipe. In term_req_sent1 state we have to ack
     //  the peer before deallocating this side of the pipe.
@@ -558,17 +653,35 @@ void zmq::pipe_t::send_stats_to_peer (own_t *socket_base_)
     if (_state == active) {
         endpoint_uri_pair_t *ep =
           new (std::nothrow) endpoint_uri_pair_t (_endpoint_pair);
+        pipe_latency_t *latency = NULL;
+        if (_in_latency) {
+            latency = new (std::nothrow) pipe_latency_t;
+            alloc_assert (latency);
+            _in_latency->summarize_and_reset (&latency->in_queue);
+        }
         send_pipe_peer_stats (_peer, _msgs_written - _peers_msgs_read,
-                              socket_base_, ep);
+                              socket_base_, ep, latency);
     }
 }
 
 void zmq::pipe_t::process_pipe_peer_stats (uint64_t queue_count_,
                                            own_t *socket_base_,
-                                           endpoint_uri_pair_t *endpoint_pair_)
+                                           endpoint_uri_pair_t *endpoint_pair_,
+                                           pipe_latency_t *latency_)
 {
+    if (latency_) {
+        _in_latency->summarize_and_reset (&latency_->out_queue);
+        _wire_latency->summarize_and_reset (&latency_->out_wire);
+    }
     send_pipe_stats_publish (socket_base_, queue_count_,
-                             _msgs_written - _peers_msgs_read, endpoint_pair_);
+                             _msgs_written - _peers_msgs_read, endpoint_pair_,
+                             latency_);
+}
+
+void zmq::pipe_t::record_wire_latency (uint64_t latency_us_)
+{
+    if (_wire_latency)
+        _wire_latency->record (latency_us_);
 }
 
 void zmq::pipe_t::send_disconnect_msg ()
@@ -12,6 +12,7 @@
 #include "options.hpp"
 #include "endpoint.hpp"
 #include "msg.hpp"
+#include "latency_histogram.hpp"
 
 namespace zmq
 {
@@ -25,10 +26,13 @@ class pipe_t;
 //  terminates straight away.
 //  If conflate is true, only the most recently arrived message could be
 //  read (older messages are discarded)
+//  If latency_stats is true, the pipes record the time messages spend in
+//  them, unless either of them conflates.
 int pipepair (zmq::object_t *parents_[2],
               zmq::pipe_t *pipes_[2],
               const int hwms_[2],
-              const bool conflate_[2]);
+              const bool conflate_[2],
+              bool latency_stats_ = false);
 
 struct i_pipe_events
 {
@@ -40,6 +44,35 @@ struct i_pipe_events
     virtual void pipe_terminated (zmq::pipe_t *pipe_) = 0;
 };
 
+//  While a batch is open, the pipes attached to it defer their flushes
+//  till the batch is flushed or ended, so that a reader is woken up once
+//  per batch of messages rather than once per message.
+class pipe_flush_batch_t
+{
+  public:
+    pipe_flush_batch_t ();
+    ~pipe_flush_batch_t ();
+
+    void begin ();
+    bool active () const { return _active; }
+
+    //  Flushes the pipes written to so far, keeping the batch open.
+    void flush ();
+
+    //  Flushes the pipes written to and closes the batch.
+    void end ();
+
+  private:
+    friend class pipe_t;
+
+    bool _active;
+
+    //  Pipes with a deferred flush.
+    std::vector<pipe_t *> _pipes;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (pipe_flush_batch_t)
+};
+
 //  Note that pipe can be stored in three different arrays.
 //  The array of inbound pipes (1), the array of outbound pipes (2) and
 //  the generic array of pipes to be deallocated (3).
@@ -53,7 +86,11 @@ class pipe_t ZMQ_FINAL : public object_t,
     friend int pipepair (zmq::object_t *parents_[2],
                          zmq::pipe_t *pipes_[2],
                          const int hwms_[2],
-                         const bool conflate_[2]);
+                         const bool conflate_[2],
+                         bool latency_stats_);
+
+    //  This allows the flush batch to flush the pipes it deferred.
+    friend class pipe_flush_batch_t;
 
   public:
     //  Specifies the object to send events to.
@@ -89,6 +126,9 @@ class pipe_t ZMQ_FINAL : public object_t,
     //  Flush the messages downstream.
     void flush ();
 
+    //  Attaches the pipe to the batch its flushes are deferred by, if open.
+    void set_flush_batch (pipe_flush_batch_t *flush_batch_);
+
     //  Temporarily disconnects the inbound message stream and drops
     //  all the messages on the fly. Causes 'hiccuped' event to be generated
     //  in the peer.
@@ -120,6 +160,10 @@ class pipe_t ZMQ_FINAL : public object_t,
 
     void send_stats_to_peer (own_t *socket_base_);
 
+    //  Records the time the engine took to write a batch of messages read
+    //  from the pipe to the network.
+    void record_wire_latency (uint64_t latency_us_);
+
     void send_disconnect_msg ();
     void set_disconnect_msg (const std::vector<unsigned char> &disconnect_);
 
@@ -136,7 +180,8 @@ class pipe_t ZMQ_FINAL : public object_t,
     void
     process_pipe_peer_stats (uint64_t queue_count_,
                              own_t *socket_base_,
-                             endpoint_uri_pair_t *endpoint_pair_) ZMQ_OVERRIDE;
+                             endpoint_uri_pair_t *endpoint_pair_,
+                             pipe_latency_t *latency_) ZMQ_OVERRIDE;
     void process_pipe_term () ZMQ_OVERRIDE;
     void process_pipe_term_ack () ZMQ_OVERRIDE;
     void process_pipe_hwm (int inhwm_, int outhwm_) ZMQ_OVERRIDE;
@@ -151,7 +196,9 @@ class pipe_t ZMQ_FINAL : public object_t,
             upipe_t *outpipe_,
             int inhwm_,
             int outhwm_,
-            bool conflate_);
+            bool conflate_,
+            pipe_stamps_t *stamps_,
+            int out_direction_);
 
     //  Pipepair uses this function to let us know about
     //  the peer pipe object.
@@ -186,12 +233,29 @@ class pipe_t ZMQ_FINAL : public object_t,
     //  can be higher at the moment.
     uint64_t _peers_msgs_read;
 
+    //  Send timestamps shared with the peer, indexed by _msgs_written for
+    //  outbound and by _msgs_read for inbound messages. NULL unless latency
+    //  statistics are enabled.
+    pipe_stamps_t *_stamps;
+    latency_stamps_t *_out_stamps;
+    latency_stamps_t *_in_stamps;
+
+    //  Latencies of the inbound messages, and of the engine writing the
+    //  messages read from this pipe.
+    latency_histogram_t *_in_latency;
+    latency_histogram_t *_wire_latency;
+
     //  The pipe object on the other side of the pipepair.
     pipe_t *_peer;
 
     //  Sink to send events to.
     i_pipe_events *_sink;
 
+    //  Batch deferring the flushes of the pipe, if any, and whether the
+    //  pipe is waiting in it to be flushed.
+    pipe_flush_batch_t *_flush_batch;
+    bool _flush_pending;
+
     //  States of the pipe endpoint:
     //  active: common state before any termination begins,
     //  delimiter_received: delimiter was read from pipe before
@@ -3,11 +3,10 @@
 #ifndef __ZMQ_POLLER_BASE_HPP_INCLUDED__
 #define __ZMQ_POLLER_BASE_HPP_INCLUDED__
 
-#include <map>
-
 #include "clock.hpp"
 #include "atomic_counter.hpp"
 #include "ctx.hpp"
+#include "timer_wheel.hpp"
 
 namespace zmq
 {
@@ -115,14 +114,8 @@ class poller_base_t
     //  Clock instance private to this I/O thread.
     clock_t _clock;
 
-    //  List of active timers.
-    struct timer_info_t
-    {
-        zmq::i_poll_events *sink;
-        int id;
-    };
-    typedef std::multimap<uint64_t, timer_info_t> timers_t;
-    timers_t _timers;
+    //  Active timers.
+    timer_wheel_t _timers;
 
     //  Load of the poller. Currently the number of file descriptors
     //  registered.
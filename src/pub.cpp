@@ -2,7 +2,9 @@
 
 #include "precompiled.hpp"
 #include "pub.hpp"
+#include "pub_shard.hpp"
 #include "pipe.hpp"
+#include "ctx.hpp"
 #include "err.hpp"
 #include "msg.hpp"
 
@@ -14,6 +16,10 @@ zmq::pub_t::pub_t (class ctx_t *parent_, uint32_t tid_, int sid_) :
 
 zmq::pub_t::~pub_t ()
 {
+    //  The socket and its sessions are gone, so no more pipes can be passed
+    //  to the shards. Let them go as soon as their pipes are terminated.
+    for (shards_t::size_type i = 0, size = _shards.size (); i != size; ++i)
+        send_term (_shards[i], 0);
 }
 
 void zmq::pub_t::xattach_pipe (pipe_t *pipe_,
@@ -22,6 +28,10 @@ void zmq::pub_t::xattach_pipe (pipe_t *pipe_,
 {
     zmq_assert (pipe_);
 
+    //  Pipes to the shards are attached to the distributor on creation.
+    if (_shard_dist.has_pipe (pipe_))
+        return;
+
     //  Don't delay pipe termination as there is no one
     //  to receive the delimiter.
     pipe_->set_nodelay ();
@@ -29,6 +39,30 @@ void zmq::pub_t::xattach_pipe (pipe_t *pipe_,
     xpub_t::xattach_pipe (pipe_, subscribe_to_all_, locally_initiated_);
 }
 
+int zmq::pub_t::xsend (msg_t *msg_)
+{
+    if (_shards.empty ())
+        return xpub_t::xsend (msg_);
+
+    //  The shards get the message only once it was sent to the subscribers
+    //  attached to the socket itself, so that a failed send can be retried.
+    dist_t::encode_header (msg_);
+    msg_t copy;
+    int rc = copy.init ();
+    errno_assert (rc == 0);
+    rc = copy.copy (*msg_);
+    errno_assert (rc == 0);
+
+    if (xpub_t::xsend (msg_) != 0) {
+        rc = copy.close ();
+        errno_assert (rc == 0);
+        return -1;
+    }
+    rc = _shard_dist.send_to_all (&copy);
+    errno_assert (rc == 0);
+    return 0;
+}
+
 int zmq::pub_t::xrecv (class msg_t *)
 {
     //  Messages cannot be received from PUB socket.
@@ -40,3 +74,83 @@ bool zmq::pub_t::xhas_in ()
 {
     return false;
 }
+
+void zmq::pub_t::xwrite_activated (pipe_t *pipe_)
+{
+    if (_shard_dist.has_pipe (pipe_))
+        _shard_dist.activated (pipe_);
+    else
+        xpub_t::xwrite_activated (pipe_);
+}
+
+int zmq::pub_t::xsetsockopt (int option_,
+                             const void *optval_,
+                             size_t optvallen_)
+{
+    if (option_ == ZMQ_PUB_SHARDS) {
+        //  The shards must exist before any session may look for them.
+        if (optvallen_ != sizeof (int)
+            || *static_cast<const int *> (optval_) < 0 || options.connected
+            || !_shards.empty ()) {
+            errno = EINVAL;
+            return -1;
+        }
+        return create_shards (*static_cast<const int *> (optval_));
+    }
+    return xpub_t::xsetsockopt (option_, optval_, optvallen_);
+}
+
+void zmq::pub_t::xpipe_terminated (pipe_t *pipe_)
+{
+    if (_shard_dist.has_pipe (pipe_))
+        _shard_dist.pipe_terminated (pipe_);
+    else
+        xpub_t::xpipe_terminated (pipe_);
+}
+
+zmq::own_t *zmq::pub_t::session_peer (uint32_t tid_)
+{
+    //  The shards are created before the socket is bound or connected, so
+    //  the list may be read from the I/O threads without locking.
+    for (shards_t::size_type i = 0, size = _shards.size (); i != size; ++i)
+        if (_shards[i]->get_tid () == tid_)
+            return _shards[i];
+    return this;
+}
+
+int zmq::pub_t::create_shards (int count_)
+{
+    //  Each shard lives in an I/O thread of its own, which is selected by
+    //  the corresponding affinity bit.
+    if (count_ > get_ctx ()->get (ZMQ_IO_THREADS) || count_ > 64) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    for (int i = 0; i != count_; ++i) {
+        io_thread_t *io_thread =
+          choose_io_thread (static_cast<uint64_t> (1) << i);
+        if (!io_thread) {
+            errno = EMTHREAD;
+            return -1;
+        }
+        pub_shard_t *shard = new (std::nothrow) pub_shard_t (io_thread, options);
+        alloc_assert (shard);
+
+        //  Create the pipe the published messages are passed through. The
+        //  shard isn't running yet, so its end can be attached directly.
+        object_t *parents[2] = {this, shard};
+        pipe_t *new_pipes[2] = {NULL, NULL};
+        int hwms[2] = {options.sndhwm, 0};
+        bool conflates[2] = {false, false};
+        const int rc = pipepair (parents, new_pipes, hwms, conflates);
+        errno_assert (rc == 0);
+        shard->attach_pipe (new_pipes[1]);
+        send_plug (shard);
+
+        _shard_dist.attach (new_pipes[0]);
+        attach_pipe (new_pipes[0]);
+        _shards.push_back (shard);
+    }
+    return 0;
+}
@@ -3,7 +3,10 @@
 #ifndef __ZMQ_PUB_HPP_INCLUDED__
 #define __ZMQ_PUB_HPP_INCLUDED__
 
+#include <vector>
+
 #include "xpub.hpp"
+#include "dist.hpp"
 
 namespace zmq
 {
@@ -11,6 +14,7 @@ class ctx_t;
 class io_thread_t;
 class socket_base_t;
 class msg_t;
+class pub_shard_t;
 
 class pub_t ZMQ_FINAL : public xpub_t
 {
@@ -22,8 +26,25 @@ class pub_t ZMQ_FINAL : public xpub_t
     void xattach_pipe (zmq::pipe_t *pipe_,
                        bool subscribe_to_all_ = false,
                        bool locally_initiated_ = false);
+    int xsend (zmq::msg_t *msg_);
     int xrecv (zmq::msg_t *msg_);
     bool xhas_in ();
+    void xwrite_activated (zmq::pipe_t *pipe_);
+    int xsetsockopt (int option_, const void *optval_, size_t optvallen_);
+    void xpipe_terminated (zmq::pipe_t *pipe_);
+    own_t *session_peer (uint32_t tid_);
+
+  private:
+    //  Creates a shard in each of the first count_ I/O threads.
+    int create_shards (int count_);
+
+    //  Shards taking care of the subscribers whose sessions run in
+    //  their I/O threads, if ZMQ_PUB_SHARDS is set.
+    typedef std::vector<pub_shard_t *> shards_t;
+    shards_t _shards;
+
+    //  Distributor of messages holding the pipes to the shards.
+    dist_t _shard_dist;
 
     ZMQ_NON_COPYABLE_NOR_MOVABLE (pub_t)
 };
@@ -0,0 +1,169 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include "macros.hpp"
+#include "pub_shard.hpp"
+#include "io_thread.hpp"
+#include "err.hpp"
+#include "msg.hpp"
+#include "generic_radix_mtrie_impl.hpp"
+
+zmq::pub_shard_t::pub_shard_t (io_thread_t *io_thread_,
+                               const options_t &options_) :
+    own_t (io_thread_, options_),
+    _socket_pipe (NULL),
+    _more_send (false)
+{
+}
+
+zmq::pub_shard_t::~pub_shard_t ()
+{
+    zmq_assert (_pipes.empty ());
+}
+
+void zmq::pub_shard_t::attach_pipe (pipe_t *pipe_)
+{
+    zmq_assert (!_socket_pipe);
+    zmq_assert (pipe_);
+    _socket_pipe = pipe_;
+    _socket_pipe->set_event_sink (this);
+    _pipes.push_back (_socket_pipe);
+}
+
+void zmq::pub_shard_t::process_plug ()
+{
+    //  Start reading the messages published through the socket, if any, so
+    //  that we get notified when new ones arrive.
+    publish ();
+}
+
+void zmq::pub_shard_t::process_bind (pipe_t *pipe_)
+{
+    //  Register the subscriber's pipe so that we can terminate it later on.
+    pipe_->set_event_sink (this);
+    _pipes.push_back (pipe_);
+
+    //  Don't delay pipe termination as there is no one
+    //  to receive the delimiter.
+    pipe_->set_nodelay ();
+    _dist.attach (pipe_);
+
+    //  If the socket is already gone, ask new pipes to terminate straight
+    //  away. Otherwise read the subscriptions from the pipe, if any.
+    if (is_terminating ()) {
+        register_term_acks (1);
+        pipe_->terminate (false);
+    } else
+        subscribe (pipe_);
+}
+
+void zmq::pub_shard_t::process_term (int linger_)
+{
+    //  Ask all attached pipes to terminate. By now the peers have asked
+    //  for it already, so this merely waits for the termination to complete.
+    for (pipes_t::size_type i = 0, size = _pipes.size (); i != size; ++i)
+        _pipes[i]->terminate (false);
+    register_term_acks (static_cast<int> (_pipes.size ()));
+
+    own_t::process_term (linger_);
+}
+
+void zmq::pub_shard_t::read_activated (pipe_t *pipe_)
+{
+    if (pipe_ == _socket_pipe)
+        publish ();
+    else
+        subscribe (pipe_);
+}
+
+void zmq::pub_shard_t::write_activated (pipe_t *pipe_)
+{
+    _dist.activated (pipe_);
+}
+
+void zmq::pub_shard_t::hiccuped (pipe_t *pipe_)
+{
+    if (options.immediate == 1)
+        pipe_->terminate (false);
+}
+
+void zmq::pub_shard_t::pipe_terminated (pipe_t *pipe_)
+{
+    if (pipe_ == _socket_pipe)
+        _socket_pipe = NULL;
+    else {
+        _subscriptions.rm (pipe_, unsubscribed, this, false);
+        _dist.pipe_terminated (pipe_);
+    }
+
+    //  Remove the pipe from the list of attached pipes and confirm its
+    //  termination if we are already shutting down.
+    _pipes.erase (pipe_);
+    if (is_terminating ())
+        unregister_term_ack ();
+}
+
+void zmq::pub_shard_t::publish ()
+{
+    msg_t msg;
+    while (_socket_pipe->read (&msg)) {
+        const bool msg_more = (msg.flags () & msg_t::more) != 0;
+
+        //  For the first part of multi-part message, find the matching pipes.
+        if (!_more_send) {
+            _subscriptions.match (static_cast<unsigned char *> (msg.data ()),
+                                  msg.size (), mark_as_matching, this);
+            //  If inverted matching is used, reverse the selection now
+            if (options.invert_matching)
+                _dist.reverse_match ();
+        }
+
+        const int rc = _dist.send_to_matching (&msg);
+        errno_assert (rc == 0);
+
+        //  If we are at the end of multi-part message we can mark
+        //  all the pipes as non-matching.
+        if (!msg_more)
+            _dist.unmatch ();
+        _more_send = msg_more;
+    }
+}
+
+void zmq::pub_shard_t::subscribe (pipe_t *pipe_)
+{
+    //  As with PUB sockets, all the subscription messages are applied to the
+    //  trie and any other message is dropped.
+    msg_t msg;
+    while (pipe_->read (&msg)) {
+        unsigned char *msg_data = static_cast<unsigned char *> (msg.data ());
+        if (msg.is_subscribe ())
+            _subscriptions.add (
+              static_cast<unsigned char *> (msg.command_body ()),
+              msg.command_body_size (), pipe_);
+        else if (msg.is_cancel ())
+            _subscriptions.rm (
+              static_cast<unsigned char *> (msg.command_body ()),
+              msg.command_body_size (), pipe_);
+        else if (msg.size () > 0 && *msg_data == 1)
+            _subscriptions.add (msg_data + 1, msg.size () - 1, pipe_);
+        else if (msg.size () > 0 && *msg_data == 0)
+            _subscriptions.rm (msg_data + 1, msg.size () - 1, pipe_);
+
+        const int rc = msg.close ();
+        errno_assert (rc == 0);
+    }
+}
+
+void zmq::pub_shard_t::mark_as_matching (pipe_t *pipe_, pub_shard_t *self_)
+{
+    self_->_dist.match (pipe_);
+}
+
+void zmq::pub_shard_t::unsubscribed (radix_mtrie_t::prefix_t data_,
+                                     size_t size_,
+                                     pub_shard_t *self_)
+{
+    LIBZMQ_UNUSED (data_);
+    LIBZMQ_UNUSED (size_);
+    LIBZMQ_UNUSED (self_);
+}
@@ -0,0 +1,84 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_PUB_SHARD_HPP_INCLUDED__
+#define __ZMQ_PUB_SHARD_HPP_INCLUDED__
+
+#include "own.hpp"
+#include "pipe.hpp"
+#include "array.hpp"
+#include "radix_mtrie.hpp"
+#include "dist.hpp"
+
+namespace zmq
+{
+class io_thread_t;
+
+//  Part of a PUB socket living in an I/O thread. It takes care of the
+//  subscribers whose sessions run in the same thread: it keeps track of
+//  their subscriptions, and matches and writes to them the messages
+//  published through the socket, which are passed to the shard through
+//  a pipe of their own. This way one publisher can use as many cores as
+//  there are shards.
+//
+//  Shards are not owned by the socket, as sessions may still pass pipes to
+//  them while the socket is being terminated. The socket asks them to
+//  terminate once it's gone along with all its sessions.
+class pub_shard_t ZMQ_FINAL : public own_t, public i_pipe_events
+{
+  public:
+    pub_shard_t (zmq::io_thread_t *io_thread_, const options_t &options_);
+
+    //  To be used once only, when creating the shard, before it's plugged
+    //  into its I/O thread.
+    void attach_pipe (zmq::pipe_t *pipe_);
+
+    //  i_pipe_events interface implementation.
+    void read_activated (zmq::pipe_t *pipe_) ZMQ_FINAL;
+    void write_activated (zmq::pipe_t *pipe_) ZMQ_FINAL;
+    void hiccuped (zmq::pipe_t *pipe_) ZMQ_FINAL;
+    void pipe_terminated (zmq::pipe_t *pipe_) ZMQ_FINAL;
+
+  private:
+    ~pub_shard_t () ZMQ_OVERRIDE;
+
+    //  Handlers for incoming commands.
+    void process_plug () ZMQ_FINAL;
+    void process_bind (zmq::pipe_t *pipe_) ZMQ_FINAL;
+    void process_term (int linger_) ZMQ_FINAL;
+
+    //  Sends the messages published through the socket to the matching
+    //  subscribers.
+    void publish ();
+
+    //  Applies the subscriptions received from a subscriber.
+    void subscribe (zmq::pipe_t *pipe_);
+
+    //  Function to be applied to each matching pipes.
+    static void mark_as_matching (zmq::pipe_t *pipe_, pub_shard_t *self_);
+
+    //  Function to be applied to the subscriptions of a terminated pipe.
+    static void unsubscribed (zmq::radix_mtrie_t::prefix_t data_,
+                              size_t size_,
+                              pub_shard_t *self_);
+
+    //  Pipe the messages published through the socket come from.
+    pipe_t *_socket_pipe;
+
+    //  All the pipes attached to the shard, so that they can be terminated.
+    typedef array_t<pipe_t, 3> pipes_t;
+    pipes_t _pipes;
+
+    //  List of all subscriptions mapped to corresponding pipes.
+    radix_mtrie_t _subscriptions;
+
+    //  Distributor of messages holding the list of subscriber pipes.
+    dist_t _dist;
+
+    //  True if we are in the middle of sending a multi-part message.
+    bool _more_send;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (pub_shard_t)
+};
+}
+
+#endif
@@ -0,0 +1,20 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_RADIX_MTRIE_HPP_INCLUDED__
+#define __ZMQ_RADIX_MTRIE_HPP_INCLUDED__
+
+#include "generic_radix_mtrie.hpp"
+#include "mtrie.hpp"
+
+namespace zmq
+{
+class pipe_t;
+
+#if ZMQ_HAS_EXTERN_TEMPLATE
+extern template class generic_radix_mtrie_t<pipe_t>;
+#endif
+
+typedef generic_radix_mtrie_t<pipe_t> radix_mtrie_t;
+}
+
+#endif
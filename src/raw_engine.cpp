@@ -42,6 +42,7 @@ zmq::raw_engine_t::raw_engine_t (
   const endpoint_uri_pair_t &endpoint_uri_pair_) :
     stream_engine_base_t (fd_, options_, endpoint_uri_pair_, false)
 {
+    _vectored_output = true;
 }
 
 zmq::raw_engine_t::~raw_engine_t ()
@@ -39,8 +39,7 @@ void zmq::server_t::xattach_pipe (pipe_t *pipe_,
     pipe_->set_server_socket_routing_id (routing_id);
     //  Add the record into output pipes lookup table
     outpipe_t outpipe = {pipe_, true};
-    const bool ok =
-      _out_pipes.ZMQ_MAP_INSERT_OR_EMPLACE (routing_id, outpipe).second;
+    const bool ok = _out_pipes.insert (routing_id, outpipe);
     zmq_assert (ok);
 
     _fq.attach (pipe_);
@@ -48,10 +47,9 @@ void zmq::server_t::xattach_pipe (pipe_t *pipe_,
 
 void zmq::server_t::xpipe_terminated (pipe_t *pipe_)
 {
-    const out_pipes_t::iterator it =
-      _out_pipes.find (pipe_->get_server_socket_routing_id ());
-    zmq_assert (it != _out_pipes.end ());
-    _out_pipes.erase (it);
+    const bool erased =
+      _out_pipes.erase (pipe_->get_server_socket_routing_id ());
+    zmq_assert (erased);
     _fq.pipe_terminated (pipe_);
 }
 
@@ -62,15 +60,11 @@ void zmq::server_t::xread_activated (pipe_t *pipe_)
 
 void zmq::server_t::xwrite_activated (pipe_t *pipe_)
 {
-    const out_pipes_t::iterator end = _out_pipes.end ();
-    out_pipes_t::iterator it;
-    for (it = _out_pipes.begin (); it != end; ++it)
-        if (it->second.pipe == pipe_)
-            break;
-
-    zmq_assert (it != _out_pipes.end ());
-    zmq_assert (!it->second.active);
-    it->second.active = true;
+    outpipe_t *const out_pipe =
+      _out_pipes.find (pipe_->get_server_socket_routing_id ());
+    zmq_assert (out_pipe && out_pipe->pipe == pipe_);
+    zmq_assert (!out_pipe->active);
+    out_pipe->active = true;
 }
 
 int zmq::server_t::xsend (msg_t *msg_)
@@ -82,11 +76,11 @@ int zmq::server_t::xsend (msg_t *msg_)
     }
     //  Find the pipe associated with the routing stored in the message.
     const uint32_t routing_id = msg_->get_routing_id ();
-    out_pipes_t::iterator it = _out_pipes.find (routing_id);
+    outpipe_t *const out_pipe = _out_pipes.find (routing_id);
 
-    if (it != _out_pipes.end ()) {
-        if (!it->second.pipe->check_write ()) {
-            it->second.active = false;
+    if (out_pipe) {
+        if (!out_pipe->pipe->check_write ()) {
+            out_pipe->active = false;
             errno = EAGAIN;
             return -1;
         }
@@ -99,13 +93,13 @@ int zmq::server_t::xsend (msg_t *msg_)
     int rc = msg_->reset_routing_id ();
     errno_assert (rc == 0);
 
-    const bool ok = it->second.pipe->write (msg_);
+    const bool ok = out_pipe->pipe->write (msg_);
     if (unlikely (!ok)) {
         // Message failed to send - we must close it ourselves.
         rc = msg_->close ();
         errno_assert (rc == 0);
     } else
-        it->second.pipe->flush ();
+        out_pipe->pipe->flush ();
 
     //  Detach the message from the data buffer.
     rc = msg_->init ();
@@ -3,12 +3,11 @@
 #ifndef __ZMQ_SERVER_HPP_INCLUDED__
 #define __ZMQ_SERVER_HPP_INCLUDED__
 
-#include <map>
-
 #include "socket_base.hpp"
 #include "session_base.hpp"
 #include "stdint.hpp"
 #include "blob.hpp"
+#include "hash_map.hpp"
 #include "fq.hpp"
 
 namespace zmq
@@ -17,7 +16,6 @@ class ctx_t;
 class msg_t;
 class pipe_t;
 
-//  TODO: This class uses O(n) scheduling. Rewrite it to use O(1) algorithm.
 class server_t : public socket_base_t
 {
   public:
@@ -47,7 +45,7 @@ class server_t : public socket_base_t
     };
 
     //  Outbound pipes indexed by the peer IDs.
-    typedef std::map<uint32_t, outpipe_t> out_pipes_t;
+    typedef hash_map_t<uint32_t, outpipe_t> out_pipes_t;
     out_pipes_t _out_pipes;
 
     //  Routing IDs are generated. It's a simple increment and wrap-over
@@ -209,6 +209,12 @@ void zmq::session_base_t::flush ()
         _pipe->flush ();
 }
 
+void zmq::session_base_t::record_wire_latency (uint64_t latency_us_)
+{
+    if (_pipe)
+        _pipe->record_wire_latency (latency_us_);
+}
+
 void zmq::session_base_t::rollback ()
 {
     if (_pipe)
@@ -306,6 +312,18 @@ void zmq::session_base_t::write_activated (pipe_t *pipe_)
         _engine->restart_input ();
 }
 
+void zmq::session_base_t::restart_engine_output ()
+{
+    zmq_assert (_engine);
+    _engine->restart_output ();
+}
+
+void zmq::session_base_t::restart_engine_input ()
+{
+    zmq_assert (_engine);
+    _engine->restart_input ();
+}
+
 void zmq::session_base_t::hiccuped (pipe_t *)
 {
     //  Hiccups are always sent from session to socket, not the other
@@ -318,6 +336,11 @@ zmq::socket_base_t *zmq::session_base_t::get_socket () const
     return _socket;
 }
 
+zmq::io_thread_t *zmq::session_base_t::get_io_thread () const
+{
+    return _io_thread;
+}
+
 void zmq::session_base_t::process_plug ()
 {
     if (_active)
@@ -395,7 +418,8 @@ void zmq::session_base_t::engine_ready ()
 {
     //  Create the pipe if it does not exist yet.
     if (!_pipe && !is_terminating ()) {
-        object_t *parents[2] = {this, _socket};
+        own_t *const peer = _socket->session_peer (get_tid ());
+        object_t *parents[2] = {this, peer};
         pipe_t *pipes[2] = {NULL, NULL};
 
         const bool conflate = get_effective_conflate_option (options);
@@ -403,7 +427,8 @@ void zmq::session_base_t::engine_ready ()
         int hwms[2] = {conflate ? -1 : options.rcvhwm,
                        conflate ? -1 : options.sndhwm};
         bool conflates[2] = {conflate, conflate};
-        const int rc = pipepair (parents, pipes, hwms, conflates);
+        const int rc = pipepair (parents, pipes, hwms, conflates,
+                                 options.latency_stats);
         errno_assert (rc == 0);
 
         //  Plug the local end of the pipe.
@@ -419,7 +444,7 @@ void zmq::session_base_t::engine_ready ()
         pipes[1]->set_endpoint_pair (_engine->get_endpoint ());
 
         //  Ask socket to plug into the remote end of the pipe.
-        send_bind (_socket, pipes[1]);
+        send_bind (peer, pipes[1]);
     }
 }
 
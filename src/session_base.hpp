@@ -35,9 +35,15 @@ class session_base_t : public own_t, public io_object_t, public i_pipe_events
     virtual void reset ();
     void flush ();
     void rollback ();
+    void record_wire_latency (uint64_t latency_us_);
     void engine_error (bool handshaked_, zmq::i_engine::error_reason_t reason_);
     void engine_ready ();
 
+    //  Called by the mechanism of the engine once the frames it handed over
+    //  to other threads are encoded or decoded.
+    void restart_engine_output ();
+    void restart_engine_input ();
+
     //  i_pipe_events interface implementation.
     void read_activated (zmq::pipe_t *pipe_) ZMQ_FINAL;
     void write_activated (zmq::pipe_t *pipe_) ZMQ_FINAL;
@@ -69,6 +75,9 @@ class session_base_t : public own_t, public io_object_t, public i_pipe_events
     socket_base_t *get_socket () const;
     const endpoint_uri_pair_t &get_endpoint () const;
 
+    //  I/O thread the engine runs in.
+    io_thread_t *get_io_thread () const;
+
   protected:
     session_base_t (zmq::io_thread_t *io_thread_,
                     bool active_,
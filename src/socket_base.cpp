@@ -119,6 +119,11 @@ bool zmq::socket_base_t::check_tag () const
     return _tag == 0xbaddecaf;
 }
 
+int zmq::socket_base_t::get_socket_id () const
+{
+    return options.socket_id;
+}
+
 bool zmq::socket_base_t::is_thread_safe () const
 {
     return _thread_safe;
@@ -262,6 +267,13 @@ int zmq::socket_base_t::get_peer_state (const void *routing_id_,
     return -1;
 }
 
+zmq::own_t *zmq::socket_base_t::session_peer (uint32_t tid_)
+{
+    LIBZMQ_UNUSED (tid_);
+
+    return this;
+}
+
 zmq::socket_base_t::~socket_base_t ()
 {
     if (_mailbox)
@@ -384,6 +396,7 @@ void zmq::socket_base_t::attach_pipe (pipe_t *pipe_,
 {
     //  First, register the pipe so that we can terminate it later on.
     pipe_->set_event_sink (this);
+    pipe_->set_flush_batch (&_flush_batch);
     _pipes.push_back (pipe_);
 
     //  Let the derived socket type know about new pipe.
@@ -418,6 +431,9 @@ int zmq::socket_base_t::setsockopt (int option_,
     //  the generic option parser.
     rc = options.setsockopt (option_, optval_, optvallen_);
     update_pipe_options (option_);
+    if (rc == 0 && option_ == ZMQ_IO_THREAD_LOCALITY
+        && options.io_thread_locality)
+        get_ctx ()->enable_io_thread_locality ();
 
     return rc;
 }
@@ -508,6 +524,35 @@ void zmq::socket_base_t::remove_signaler (signaler_t *s_)
     (static_cast<mailbox_safe_t *> (_mailbox))->remove_signaler (s_);
 }
 
+void zmq::socket_base_t::add_watcher (i_socket_watcher *watcher_,
+                                      void *cookie_)
+{
+    zmq_assert (!_thread_safe);
+    _watchers.push_back (std::make_pair (watcher_, cookie_));
+}
+
+void zmq::socket_base_t::remove_watcher (i_socket_watcher *watcher_)
+{
+    for (watchers_t::iterator it = _watchers.begin (), end = _watchers.end ();
+         it != end; ++it)
+        if (it->first == watcher_) {
+            _watchers.erase (it);
+            return;
+        }
+}
+
+void zmq::socket_base_t::notify_watchers ()
+{
+    for (size_t i = 0; i != _watchers.size (); ++i)
+        _watchers[i].first->socket_events_changed (_watchers[i].second);
+}
+
+zmq::io_thread_t *zmq::socket_base_t::choose_endpoint_io_thread () const
+{
+    const int cpu = options.io_thread_locality ? get_current_cpu () : -1;
+    return choose_io_thread (options.affinity, cpu);
+}
+
 int zmq::socket_base_t::bind (const char *endpoint_uri_)
 {
     scoped_optional_lock_t sync_lock (_thread_safe ? &_sync : NULL);
@@ -567,7 +612,7 @@ int zmq::socket_base_t::bind (const char *endpoint_uri_)
         }
 
         //  Choose the I/O thread to run the session in.
-        io_thread_t *io_thread = choose_io_thread (options.affinity);
+        io_thread_t *io_thread = choose_endpoint_io_thread ();
         if (!io_thread) {
             errno = EMTHREAD;
             return -1;
@@ -596,7 +641,8 @@ int zmq::socket_base_t::bind (const char *endpoint_uri_)
 
         int hwms[2] = {options.sndhwm, options.rcvhwm};
         bool conflates[2] = {false, false};
-        rc = pipepair (parents, new_pipes, hwms, conflates);
+        rc = pipepair (parents, new_pipes, hwms, conflates,
+                       options.latency_stats);
         errno_assert (rc == 0);
 
         //  Attach local end of the pipe to the socket object.
@@ -619,29 +665,53 @@ int zmq::socket_base_t::bind (const char *endpoint_uri_)
 
     //  Remaining transports require to be run in an I/O thread, so at this
     //  point we'll choose one.
-    io_thread_t *io_thread = choose_io_thread (options.affinity);
+    io_thread_t *io_thread = choose_endpoint_io_thread ();
     if (!io_thread) {
         errno = EMTHREAD;
         return -1;
     }
 
     if (protocol == protocol_name::tcp) {
-        tcp_listener_t *listener =
-          new (std::nothrow) tcp_listener_t (io_thread, this, options);
-        alloc_assert (listener);
-        rc = listener->set_local_address (address.c_str ());
-        if (rc != 0) {
-            LIBZMQ_DELETE (listener);
-            event_bind_failed (make_unconnected_bind_endpoint_pair (address),
-                               zmq_errno ());
-            return -1;
-        }
+        //  With sharded accepting, a listener runs in each of the first
+        //  I/O threads, selected by the corresponding affinity bit.
+        int shards = 1;
+        if (options.tcp_accept_shards > 1 && options.use_fd == -1
+            && tcp_listener_t::accept_shards_supported ())
+            shards = std::min (options.tcp_accept_shards,
+                               get_ctx ()->get (ZMQ_IO_THREADS));
+
+        for (int i = 0; i != shards; ++i) {
+            if (shards > 1) {
+                io_thread = choose_io_thread (static_cast<uint64_t> (1) << i);
+                zmq_assert (io_thread);
+            }
+            tcp_listener_t *listener = new (std::nothrow)
+              tcp_listener_t (io_thread, this, options, shards > 1);
+            alloc_assert (listener);
+
+            //  The other listeners bind to the address resolved by the first
+            //  one, which includes the port chosen for a wildcard port.
+            rc = listener->set_local_address (
+              i == 0 ? address.c_str ()
+                     : _last_endpoint.c_str () + protocol.length () + 3);
+            if (rc != 0) {
+                LIBZMQ_DELETE (listener);
+                if (i != 0) {
+                    //  The endpoint works with the listeners bound so far.
+                    break;
+                }
+                event_bind_failed (
+                  make_unconnected_bind_endpoint_pair (address), zmq_errno ());
+                return -1;
+            }
 
-        // Save last endpoint URI
-        listener->get_local_address (_last_endpoint);
+            // Save last endpoint URI
+            if (i == 0)
+                listener->get_local_address (_last_endpoint);
 
-        add_endpoint (make_unconnected_bind_endpoint_pair (_last_endpoint),
-                      static_cast<own_t *> (listener), NULL);
+            add_endpoint (make_unconnected_bind_endpoint_pair (_last_endpoint),
+                          static_cast<own_t *> (listener), NULL);
+        }
         options.connected = true;
         return 0;
     }
@@ -800,7 +870,10 @@ int zmq::socket_base_t::connect_internal (const char *endpoint_uri_)
 
         int hwms[2] = {conflate ? -1 : sndhwm, conflate ? -1 : rcvhwm};
         bool conflates[2] = {conflate, conflate};
-        rc = pipepair (parents, new_pipes, hwms, conflates);
+        const bool latency_stats =
+          options.latency_stats
+          || (peer.socket != NULL && peer.options.latency_stats);
+        rc = pipepair (parents, new_pipes, hwms, conflates, latency_stats);
         if (!conflate) {
             new_pipes[0]->set_hwms_boost (peer.options.sndhwm,
                                           peer.options.rcvhwm);
@@ -884,7 +957,7 @@ int zmq::socket_base_t::connect_internal (const char *endpoint_uri_)
     }
 
     //  Choose the I/O thread to run the session in.
-    io_thread_t *io_thread = choose_io_thread (options.affinity);
+    io_thread_t *io_thread = choose_endpoint_io_thread ();
     if (!io_thread) {
         errno = EMTHREAD;
         return -1;
@@ -1065,8 +1138,12 @@ int zmq::socket_base_t::connect_internal (const char *endpoint_uri_)
     pipe_t *newpipe = NULL;
 
     if (options.immediate != 1 || subscribe_to_all) {
-        //  Create a bi-directional pipe.
-        object_t *parents[2] = {this, session};
+        //  Create a bi-directional pipe. Its local end is attached to the
+        //  socket, unless the socket hands the session's pipes over to
+        //  another object.
+        own_t *const peer =
+          subscribe_to_all ? this : session_peer (session->get_tid ());
+        object_t *parents[2] = {peer, session};
         pipe_t *new_pipes[2] = {NULL, NULL};
 
         const bool conflate = get_effective_conflate_option (options);
@@ -1074,12 +1151,16 @@ int zmq::socket_base_t::connect_internal (const char *endpoint_uri_)
         int hwms[2] = {conflate ? -1 : options.sndhwm,
                        conflate ? -1 : options.rcvhwm};
         bool conflates[2] = {conflate, conflate};
-        rc = pipepair (parents, new_pipes, hwms, conflates);
+        rc = pipepair (parents, new_pipes, hwms, conflates,
+                       options.latency_stats);
         errno_assert (rc == 0);
 
         //  Attach local end of the pipe to the socket object.
-        attach_pipe (new_pipes[0], subscribe_to_all, true);
-        newpipe = new_pipes[0];
+        if (peer == this) {
+            attach_pipe (new_pipes[0], subscribe_to_all, true);
+            newpipe = new_pipes[0];
+        } else
+            send_bind (peer, new_pipes[0]);
 
         //  Attach remote end of the pipe to the session object later on.
         session->attach_pipe (new_pipes[1]);
@@ -1211,15 +1292,78 @@ int zmq::socket_base_t::send (msg_t *msg_, int flags_)
         return -1;
     }
 
-    //  Check whether message passed to the function is valid.
-    if (unlikely (!msg_ || !msg_->check ())) {
-        errno = EFAULT;
+    //  Process pending commands, if any.
+    if (unlikely (process_commands (0, true) != 0)) {
         return -1;
     }
 
-    //  Process pending commands, if any.
-    int rc = process_commands (0, true);
-    if (unlikely (rc != 0)) {
+    //  With ZMQ_SNDDEFER the pipes written to are not flushed until a
+    //  message is sent without the flag.
+    const bool defer = (flags_ & ZMQ_SNDDEFER) != 0;
+    if (defer)
+        _flush_batch.begin ();
+    const int rc = send_msg (msg_, flags_);
+    if (!defer && unlikely (_flush_batch.active ())) {
+        const int err = errno;
+        _flush_batch.end ();
+        errno = err;
+    }
+    if (unlikely (!_watchers.empty ())) {
+        const int err = errno;
+        notify_watchers ();
+        errno = err;
+    }
+    return rc;
+}
+
+int zmq::socket_base_t::send_batch (msg_t *msgs_, size_t count_, int flags_)
+{
+    scoped_optional_lock_t sync_lock (_thread_safe ? &_sync : NULL);
+
+    //  Check whether the context hasn't been shut down yet.
+    if (unlikely (_ctx_terminated)) {
+        errno = ETERM;
+        return -1;
+    }
+
+    if (unlikely (!msgs_ || count_ == 0)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    //  Commands are processed once for the whole batch, unless a send
+    //  has to wait, and the pipes written to are flushed at the end only.
+    if (unlikely (process_commands (0, true) != 0)) {
+        return -1;
+    }
+
+    const size_t max_count = std::numeric_limits<int>::max ();
+    if (count_ > max_count)
+        count_ = max_count;
+    _flush_batch.begin ();
+    size_t sent = 0;
+    while (sent != count_ && send_msg (&msgs_[sent], flags_) == 0)
+        ++sent;
+    const int err = errno;
+    if (!(flags_ & ZMQ_SNDDEFER))
+        _flush_batch.end ();
+    if (unlikely (!_watchers.empty ()))
+        notify_watchers ();
+
+    //  As with sendmmsg, the messages sent before an error are reported
+    //  rather than the error itself.
+    if (sent == 0) {
+        errno = err;
+        return -1;
+    }
+    return static_cast<int> (sent);
+}
+
+int zmq::socket_base_t::send_msg (msg_t *msg_, int flags_)
+{
+    //  Check whether message passed to the function is valid.
+    if (unlikely (!msg_ || !msg_->check ())) {
+        errno = EFAULT;
         return -1;
     }
 
@@ -1233,7 +1377,7 @@ int zmq::socket_base_t::send (msg_t *msg_, int flags_)
     msg_->reset_metadata ();
 
     //  Try to send the message using method in each socket class
-    rc = xsend (msg_);
+    int rc = xsend (msg_);
     if (rc == 0) {
         return 0;
     }
@@ -1259,6 +1403,11 @@ int zmq::socket_base_t::send (msg_t *msg_, int flags_)
         return -1;
     }
 
+    //  The peers may be waiting for the messages of the batch being sent,
+    //  so let them have those before we wait for them.
+    if (_flush_batch.active ())
+        _flush_batch.flush ();
+
     //  Compute the time when the timeout should occur.
     //  If the timeout is infinite, don't care.
     int timeout = options.sndtimeo;
@@ -1299,6 +1448,57 @@ int zmq::socket_base_t::recv (msg_t *msg_, int flags_)
         return -1;
     }
 
+    const int rc = recv_msg (msg_, flags_);
+    if (unlikely (!_watchers.empty ())) {
+        const int err = errno;
+        notify_watchers ();
+        errno = err;
+    }
+    return rc;
+}
+
+int zmq::socket_base_t::recv_batch (msg_t *msgs_, size_t count_, int flags_)
+{
+    scoped_optional_lock_t sync_lock (_thread_safe ? &_sync : NULL);
+
+    //  Check whether the context hasn't been shut down yet.
+    if (unlikely (_ctx_terminated)) {
+        errno = ETERM;
+        return -1;
+    }
+
+    if (unlikely (!msgs_ || count_ == 0)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    //  Wait for the first message as requested. The batch is then filled
+    //  with the messages readily available, without processing commands.
+    if (recv_msg (&msgs_[0], flags_) != 0) {
+        if (unlikely (!_watchers.empty ())) {
+            const int err = errno;
+            notify_watchers ();
+            errno = err;
+        }
+        return -1;
+    }
+
+    const size_t max_count = std::numeric_limits<int>::max ();
+    if (count_ > max_count)
+        count_ = max_count;
+    size_t received = 1;
+    while (received != count_ && msgs_[received].check ()
+           && xrecv (&msgs_[received]) == 0) {
+        extract_flags (&msgs_[received]);
+        ++received;
+    }
+    if (unlikely (!_watchers.empty ()))
+        notify_watchers ();
+    return static_cast<int> (received);
+}
+
+int zmq::socket_base_t::recv_msg (msg_t *msg_, int flags_)
+{
     //  Check whether message passed to the function is valid.
     if (unlikely (!msg_ || !msg_->check ())) {
         errno = EFAULT;
@@ -1356,10 +1556,32 @@ int zmq::socket_base_t::recv (msg_t *msg_, int flags_)
     int timeout = options.rcvtimeo;
     const uint64_t end = timeout < 0 ? 0 : (_clock.now_ms () + timeout);
 
+    //  The peer may be waiting for the messages whose flush was deferred
+    //  before replying.
+    if (_flush_batch.active ())
+        _flush_batch.end ();
+
     //  In blocking scenario, commands are processed over and over again until
     //  we are able to fetch a message.
     bool block = (_ticks != 0);
     while (true) {
+        //  Rather than going to sleep straight away, spin for a while in
+        //  the hope that a message arrives meanwhile, but never for longer
+        //  than the timeout left. Thread-safe sockets don't spin, as that
+        //  would keep the socket locked for other threads.
+        if (block && timeout != 0 && options.rcvspin > 0 && !_thread_safe) {
+            int spin = options.rcvspin;
+            if (timeout > 0
+                && static_cast<uint64_t> (timeout) * 1000
+                     < static_cast<uint64_t> (spin))
+                spin = timeout * 1000;
+            spin_for_commands (spin);
+            if (timeout > 0) {
+                const uint64_t now = _clock.now_ms ();
+                timeout = now < end ? static_cast<int> (end - now) : 0;
+            }
+        }
+
         if (unlikely (process_commands (block ? timeout : 0, false) != 0)) {
             return -1;
         }
@@ -1372,7 +1594,7 @@ int zmq::socket_base_t::recv (msg_t *msg_, int flags_)
             return -1;
         }
         block = true;
-        if (timeout > 0) {
+        if (timeout >= 0) {
             timeout = static_cast<int> (end - _clock.now_ms ());
             if (timeout <= 0) {
                 errno = EAGAIN;
@@ -1393,6 +1615,10 @@ int zmq::socket_base_t::close ()
     if (_thread_safe)
         (static_cast<mailbox_safe_t *> (_mailbox))->clear_signalers ();
 
+    //  The socket may be terminated by the reaper thread, which must not
+    //  reach the pollers.
+    _watchers.clear ();
+
     //  Mark the socket as dead
     _tag = 0xdeadbeef;
 
@@ -1481,6 +1707,7 @@ int zmq::socket_base_t::process_commands (int timeout_, bool throttle_)
         return -1;
 
     //  Process all available commands.
+    const bool processed = rc == 0;
     while (rc == 0 || errno == EINTR) {
         if (rc == 0) {
             cmd.destination->process_command (cmd);
@@ -1490,6 +1717,9 @@ int zmq::socket_base_t::process_commands (int timeout_, bool throttle_)
 
     zmq_assert (errno == EAGAIN);
 
+    if (processed && unlikely (!_watchers.empty ()))
+        notify_watchers ();
+
     if (_ctx_terminated) {
         errno = ETERM;
         return -1;
@@ -1498,6 +1728,32 @@ int zmq::socket_base_t::process_commands (int timeout_, bool throttle_)
     return 0;
 }
 
+//  Tells the CPU that the thread is busy-waiting.
+static void spin_pause ()
+{
+#if defined _MSC_VER
+    YieldProcessor ();
+#elif defined __GNUC__ && (defined __i386__ || defined __x86_64__)
+    __builtin_ia32_pause ();
+#elif defined __GNUC__ && defined __aarch64__
+    __asm__ volatile("yield" ::: "memory");
+#endif
+}
+
+bool zmq::socket_base_t::spin_for_commands (int max_us_)
+{
+    const uint64_t end = _clock.now_us () + max_us_;
+    while (true) {
+        for (int i = 0; i != rcvspin_checks; ++i) {
+            if (_mailbox->check_read ())
+                return true;
+            spin_pause ();
+        }
+        if (_clock.now_us () >= end)
+            return false;
+    }
+}
+
 void zmq::socket_base_t::process_stop ()
 {
     //  Here, someone have called zmq_ctx_term while the socket was still alive.
@@ -1543,10 +1799,25 @@ void zmq::socket_base_t::process_term_endpoint (std::string *endpoint_)
 void zmq::socket_base_t::process_pipe_stats_publish (
   uint64_t outbound_queue_count_,
   uint64_t inbound_queue_count_,
-  endpoint_uri_pair_t *endpoint_pair_)
+  endpoint_uri_pair_t *endpoint_pair_,
+  pipe_latency_t *latency_)
 {
     uint64_t values[2] = {outbound_queue_count_, inbound_queue_count_};
     event (*endpoint_pair_, values, 2, ZMQ_EVENT_PIPES_STATS);
+    if (latency_) {
+        const latency_summary_t *const summaries[3] = {
+          &latency_->out_queue, &latency_->out_wire, &latency_->in_queue};
+        uint64_t latency_values[15];
+        for (int i = 0; i != 3; ++i) {
+            latency_values[i * 5] = summaries[i]->count;
+            latency_values[i * 5 + 1] = summaries[i]->p50;
+            latency_values[i * 5 + 2] = summaries[i]->p90;
+            latency_values[i * 5 + 3] = summaries[i]->p99;
+            latency_values[i * 5 + 4] = summaries[i]->max;
+        }
+        event (*endpoint_pair_, latency_values, 15, ZMQ_EVENT_PIPES_LATENCY);
+        delete latency_;
+    }
     delete endpoint_pair_;
 }
 
@@ -1563,7 +1834,8 @@ int zmq::socket_base_t::query_pipes_stats ()
 {
     {
         scoped_lock_t lock (_monitor_sync);
-        if (!(_monitor_events & ZMQ_EVENT_PIPES_STATS)) {
+        if (!(_monitor_events
+              & (ZMQ_EVENT_PIPES_STATS | ZMQ_EVENT_PIPES_LATENCY))) {
             errno = EINVAL;
             return -1;
         }
@@ -2079,15 +2351,10 @@ int zmq::routing_socket_base_t::xsetsockopt (int option_,
 
 void zmq::routing_socket_base_t::xwrite_activated (pipe_t *pipe_)
 {
-    const out_pipes_t::iterator end = _out_pipes.end ();
-    out_pipes_t::iterator it;
-    for (it = _out_pipes.begin (); it != end; ++it)
-        if (it->second.pipe == pipe_)
-            break;
-
-    zmq_assert (it != end);
-    zmq_assert (!it->second.active);
-    it->second.active = true;
+    out_pipe_t *const out_pipe = _out_pipes.find (pipe_->get_routing_id ());
+    zmq_assert (out_pipe && out_pipe->pipe == pipe_);
+    zmq_assert (!out_pipe->active);
+    out_pipe->active = true;
 }
 
 std::string zmq::routing_socket_base_t::extract_connect_routing_id ()
@@ -2107,47 +2374,39 @@ void zmq::routing_socket_base_t::add_out_pipe (blob_t routing_id_,
 {
     //  Add the record into output pipes lookup table
     const out_pipe_t outpipe = {pipe_, true};
-    const bool ok =
-      _out_pipes.ZMQ_MAP_INSERT_OR_EMPLACE (ZMQ_MOVE (routing_id_), outpipe)
-        .second;
+    const bool ok = _out_pipes.insert (ZMQ_MOVE (routing_id_), outpipe);
     zmq_assert (ok);
 }
 
 bool zmq::routing_socket_base_t::has_out_pipe (const blob_t &routing_id_) const
 {
-    return 0 != _out_pipes.count (routing_id_);
+    return _out_pipes.contains (routing_id_);
 }
 
 zmq::routing_socket_base_t::out_pipe_t *
 zmq::routing_socket_base_t::lookup_out_pipe (const blob_t &routing_id_)
 {
     // TODO we could probably avoid constructor a temporary blob_t to call this function
-    out_pipes_t::iterator it = _out_pipes.find (routing_id_);
-    return it == _out_pipes.end () ? NULL : &it->second;
+    return _out_pipes.find (routing_id_);
 }
 
 const zmq::routing_socket_base_t::out_pipe_t *
 zmq::routing_socket_base_t::lookup_out_pipe (const blob_t &routing_id_) const
 {
     // TODO we could probably avoid constructor a temporary blob_t to call this function
-    const out_pipes_t::const_iterator it = _out_pipes.find (routing_id_);
-    return it == _out_pipes.end () ? NULL : &it->second;
+    return _out_pipes.find (routing_id_);
 }
 
 void zmq::routing_socket_base_t::erase_out_pipe (const pipe_t *pipe_)
 {
-    const size_t erased = _out_pipes.erase (pipe_->get_routing_id ());
+    const bool erased = _out_pipes.erase (pipe_->get_routing_id ());
     zmq_assert (erased);
 }
 
 zmq::routing_socket_base_t::out_pipe_t
 zmq::routing_socket_base_t::try_erase_out_pipe (const blob_t &routing_id_)
 {
-    const out_pipes_t::iterator it = _out_pipes.find (routing_id_);
     out_pipe_t res = {NULL, false};
-    if (it != _out_pipes.end ()) {
-        res = it->second;
-        _out_pipes.erase (it);
-    }
+    _out_pipes.erase (routing_id_, &res);
     return res;
 }
@@ -5,14 +5,17 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include <stdarg.h>
 
 #include "own.hpp"
 #include "array.hpp"
 #include "blob.hpp"
+#include "hash_map.hpp"
 #include "stdint.hpp"
 #include "poller.hpp"
 #include "i_poll_events.hpp"
+#include "i_socket_watcher.hpp"
 #include "i_mailbox.hpp"
 #include "clock.hpp"
 #include "pipe.hpp"
@@ -39,6 +42,10 @@ class socket_base_t : public own_t,
     //  Returns false if object is not a socket.
     bool check_tag () const;
 
+    //  Returns the id assigned to the socket on creation. No other socket
+    //  of the process gets the same id.
+    int get_socket_id () const;
+
     //  Returns whether the socket is thread-safe.
     bool is_thread_safe () const;
 
@@ -61,10 +68,18 @@ class socket_base_t : public own_t,
     int term_endpoint (const char *endpoint_uri_);
     int send (zmq::msg_t *msg_, int flags_);
     int recv (zmq::msg_t *msg_, int flags_);
+    int send_batch (zmq::msg_t *msgs_, size_t count_, int flags_);
+    int recv_batch (zmq::msg_t *msgs_, size_t count_, int flags_);
     void add_signaler (signaler_t *s_);
     void remove_signaler (signaler_t *s_);
     int close ();
 
+    //  Registers a poller to be told when the events of the socket may have
+    //  changed without its file descriptor being signalled. The cookie is
+    //  passed back to the poller. Not for thread-safe sockets.
+    void add_watcher (i_socket_watcher *watcher_, void *cookie_);
+    void remove_watcher (i_socket_watcher *watcher_);
+
     //  These functions are used by the polling mechanism to determine
     //  which events are to be reported from this socket.
     bool has_in ();
@@ -128,6 +143,11 @@ class socket_base_t : public own_t,
     event_handshake_succeeded (const endpoint_uri_pair_t &endpoint_uri_pair_,
                                int err_);
 
+    //  Returns the object the pipes of the sessions running in the I/O
+    //  thread tid_ are to be attached to. The default implementation returns
+    //  the socket itself. May be called from any thread.
+    virtual own_t *session_peer (uint32_t tid_);
+
     //  Query the state of a specific peer. The default implementation
     //  always returns an ENOTSUP error.
     virtual int get_peer_state (const void *routing_id_,
@@ -187,6 +207,11 @@ class socket_base_t : public own_t,
 
     int connect_internal (const char *endpoint_uri_);
 
+    //  Register the pipe with this socket.
+    void attach_pipe (zmq::pipe_t *pipe_,
+                      bool subscribe_to_all_ = false,
+                      bool locally_initiated_ = false);
+
     // Mutex for synchronize access to the socket in thread safe mode
     mutex_t _sync;
 
@@ -206,6 +231,10 @@ class socket_base_t : public own_t,
     // Monitor socket cleanup
     void stop_monitor (bool send_monitor_stopped_event_ = true);
 
+    //  Chooses the I/O thread to run a new endpoint in, the closest to the
+    //  calling thread if ZMQ_IO_THREAD_LOCALITY is set.
+    io_thread_t *choose_endpoint_io_thread () const;
+
     //  Creates new endpoint ID and adds the endpoint to the map.
     void add_endpoint (const endpoint_uri_pair_t &endpoint_pair_,
                        own_t *endpoint_,
@@ -238,6 +267,11 @@ class socket_base_t : public own_t,
     //  to be later retrieved by getsockopt.
     void extract_flags (const msg_t *msg_);
 
+    //  Send and receive a single message, once the socket is locked and
+    //  known to be alive.
+    int send_msg (msg_t *msg_, int flags_);
+    int recv_msg (msg_t *msg_, int flags_);
+
     //  Used to check whether the object is a socket.
     uint32_t _tag;
 
@@ -257,24 +291,27 @@ class socket_base_t : public own_t,
     //  bind, is available and compatible with the socket type.
     int check_protocol (const std::string &protocol_) const;
 
-    //  Register the pipe with this socket.
-    void attach_pipe (zmq::pipe_t *pipe_,
-                      bool subscribe_to_all_ = false,
-                      bool locally_initiated_ = false);
-
     //  Processes commands sent to this socket (if any). If timeout is -1,
     //  returns only after at least one command was processed.
     //  If throttle argument is true, commands are processed at most once
     //  in a predefined time period.
     int process_commands (int timeout_, bool throttle_);
 
+    //  Busy-waits for at most the given number of microseconds until there
+    //  are commands to process. Returns false if none arrived in time.
+    bool spin_for_commands (int max_us_);
+
+    //  Tells the watchers that the events of the socket may have changed.
+    void notify_watchers ();
+
     //  Handlers for incoming commands.
     void process_stop () ZMQ_FINAL;
     void process_bind (zmq::pipe_t *pipe_) ZMQ_FINAL;
     void
     process_pipe_stats_publish (uint64_t outbound_queue_count_,
                                 uint64_t inbound_queue_count_,
-                                endpoint_uri_pair_t *endpoint_pair_) ZMQ_FINAL;
+                                endpoint_uri_pair_t *endpoint_pair_,
+                                pipe_latency_t *latency_) ZMQ_FINAL;
     void process_term (int linger_) ZMQ_FINAL;
     void process_term_endpoint (std::string *endpoint_) ZMQ_FINAL;
 
@@ -290,6 +327,9 @@ class socket_base_t : public own_t,
     typedef array_t<pipe_t, 3> pipes_t;
     pipes_t _pipes;
 
+    //  Defers the flushes of the pipes while a batch of messages is sent.
+    pipe_flush_batch_t _flush_batch;
+
     //  Reaper's poller and handle of this socket within it.
     poller_t *_poller;
     poller_t::handle_t _handle;
@@ -321,6 +361,10 @@ class socket_base_t : public own_t,
     // Signaler to be used in the reaping stage
     signaler_t *_reaper_signaler;
 
+    //  Pollers watching the socket, with their cookies.
+    typedef std::vector<std::pair<i_socket_watcher *, void *> > watchers_t;
+    watchers_t _watchers;
+
     // Mutex to synchronize access to the monitor Pair socket
     mutex_t _monitor_sync;
 
@@ -360,19 +404,23 @@ class routing_socket_base_t : public socket_base_t
     out_pipe_t try_erase_out_pipe (const blob_t &routing_id_);
     template <typename Func> bool any_of_out_pipes (Func func_)
     {
-        bool res = false;
-        for (out_pipes_t::iterator it = _out_pipes.begin (),
-                                   end = _out_pipes.end ();
-             it != end && !res; ++it) {
-            res |= func_ (*it->second.pipe);
-        }
-
-        return res;
+        return _out_pipes.any_of (out_pipe_func_t<Func> (func_));
     }
 
   private:
+    //  Adapts a predicate on pipes to the values stored in _out_pipes.
+    template <typename Func> struct out_pipe_func_t
+    {
+        out_pipe_func_t (Func func_) : func (func_) {}
+        bool operator() (const out_pipe_t &out_pipe_)
+        {
+            return func (*out_pipe_.pipe);
+        }
+        Func func;
+    };
+
     //  Outbound pipes indexed by the peer IDs.
-    typedef std::map<blob_t, out_pipe_t> out_pipes_t;
+    typedef hash_map_t<blob_t, out_pipe_t> out_pipes_t;
     out_pipes_t _out_pipes;
 
     // Next assigned name on a zmq_connect() call used by ROUTER and STREAM socket types
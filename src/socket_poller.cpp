@@ -8,6 +8,13 @@
 
 #include <limits.h>
 
+#if defined ZMQ_SOCKET_POLLER_USE_EPOLL
+#include <algorithm>
+#include <new>
+
+#include "config.hpp"
+#endif
+
 static bool is_thread_safe (const zmq::socket_base_t &socket_)
 {
     // do not use getsockopt here, since that would fail during context termination
@@ -26,6 +33,496 @@ static It find_if2 (It b_, It e_, const T &value, Pred pred)
     return b_;
 }
 
+bool zmq::socket_poller_t::check_tag () const
+{
+    return _tag == 0xCAFEBABE;
+}
+
+int zmq::socket_poller_t::signaler_fd (fd_t *fd_) const
+{
+    if (_signaler) {
+        *fd_ = _signaler->get_fd ();
+        return 0;
+    }
+    // Only thread-safe socket types are guaranteed to have a signaler.
+    errno = EINVAL;
+    return -1;
+}
+
+#if defined ZMQ_SOCKET_POLLER_USE_EPOLL
+
+zmq::socket_poller_t::socket_poller_t () :
+    _tag (0xCAFEBABE),
+    _signaler (NULL),
+    _epoll_fd (retired_fd),
+    _epoll_events (max_io_events),
+    _pollset_size (0)
+{
+}
+
+zmq::socket_poller_t::~socket_poller_t ()
+{
+    //  Mark the socket_poller as dead
+    _tag = 0xdeadbeef;
+
+    unregister_poll_items ();
+
+    for (items_t::iterator it = _ready.begin (), end = _ready.end ();
+         it != end; ++it) {
+        if ((*it)->removed) {
+            LIBZMQ_DELETE (*it);
+        }
+    }
+
+    for (sockets_t::iterator it = _sockets.begin (), end = _sockets.end ();
+         it != end; ++it) {
+        socket_base_t *const socket = it->second->socket;
+        if (socket->check_tag ()) {
+            if (is_thread_safe (*socket))
+                socket->remove_signaler (_signaler);
+            else
+                socket->remove_watcher (this);
+        }
+        LIBZMQ_DELETE (it->second);
+    }
+
+    for (fds_t::iterator it = _fds.begin (), end = _fds.end (); it != end;
+         ++it) {
+        LIBZMQ_DELETE (it->second);
+    }
+
+    if (_signaler != NULL) {
+        LIBZMQ_DELETE (_signaler);
+    }
+
+    if (_epoll_fd != retired_fd)
+        close (_epoll_fd);
+}
+
+int zmq::socket_poller_t::open_epoll ()
+{
+    if (_epoll_fd != retired_fd)
+        return 0;
+#ifdef ZMQ_IOTHREAD_POLLER_USE_EPOLL_CLOEXEC
+    _epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+#else
+    _epoll_fd = epoll_create (1);
+#endif
+    return _epoll_fd == retired_fd ? -1 : 0;
+}
+
+int zmq::socket_poller_t::create_signaler ()
+{
+    if (_signaler)
+        return 0;
+    if (open_epoll () == -1)
+        return -1;
+
+    _signaler = new (std::nothrow) signaler_t ();
+    if (!_signaler) {
+        errno = ENOMEM;
+        return -1;
+    }
+    if (!_signaler->valid ()) {
+        LIBZMQ_DELETE (_signaler);
+        errno = EMFILE;
+        return -1;
+    }
+
+    //  The signaler is the only entry of the epoll set without an item.
+    epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    if (epoll_ctl (_epoll_fd, EPOLL_CTL_ADD, _signaler->get_fd (), &ev)
+        == -1) {
+        LIBZMQ_DELETE (_signaler);
+        return -1;
+    }
+    return 0;
+}
+
+int zmq::socket_poller_t::update (item_t *item_, short events_)
+{
+    //  Thread safe sockets are polled through the signaler only.
+    if (!item_->socket || !is_thread_safe (*item_->socket)) {
+        //  Sockets signal their file descriptor when they have commands to
+        //  process, which leaves it readable until they process them. Only
+        //  the edge matters, as their events are checked until they have
+        //  none to report. File descriptors are polled as with poll ().
+        epoll_event ev;
+        ev.events = 0;
+        ev.data.ptr = item_;
+        if (item_->socket)
+            ev.events = EPOLLIN | EPOLLET;
+        else {
+            if (events_ & ZMQ_POLLIN)
+                ev.events |= EPOLLIN;
+            if (events_ & ZMQ_POLLOUT)
+                ev.events |= EPOLLOUT;
+            if (events_ & ZMQ_POLLPRI)
+                ev.events |= EPOLLPRI;
+        }
+
+        if (events_ && !item_->registered && !item_->always_ready) {
+            if (open_epoll () == -1)
+                return -1;
+            if (epoll_ctl (_epoll_fd, EPOLL_CTL_ADD, item_->fd, &ev) == 0)
+                item_->registered = true;
+            else if (errno == EPERM && !item_->socket) {
+                try {
+                    _always_ready.push_back (item_);
+                }
+                catch (const std::bad_alloc &) {
+                    errno = ENOMEM;
+                    return -1;
+                }
+                item_->always_ready = true;
+            } else
+                return -1;
+        } else if (events_ && item_->registered && !item_->socket) {
+            if (epoll_ctl (_epoll_fd, EPOLL_CTL_MOD, item_->fd, &ev) == -1)
+                return -1;
+        } else if (!events_ && item_->registered) {
+            //  The file descriptor may be closed already, which removed it
+            //  from the epoll set.
+            epoll_ctl (_epoll_fd, EPOLL_CTL_DEL, item_->fd, &ev);
+            item_->registered = false;
+        } else if (!events_ && item_->always_ready) {
+            _always_ready.erase (std::find (_always_ready.begin (),
+                                            _always_ready.end (), item_));
+            item_->always_ready = false;
+        }
+    }
+
+    _pollset_size += (events_ != 0) - (item_->events != 0);
+    item_->events = events_;
+    return 0;
+}
+
+void zmq::socket_poller_t::make_ready (item_t *item_)
+{
+    if (!item_->ready) {
+        item_->ready = true;
+        _ready.push_back (item_);
+    }
+}
+
+void zmq::socket_poller_t::destroy (item_t *item_)
+{
+    //  Items in the list of items to check are deleted as the list is
+    //  walked through.
+    if (item_->ready)
+        item_->removed = true;
+    else
+        LIBZMQ_DELETE (item_);
+}
+
+void zmq::socket_poller_t::socket_events_changed (void *cookie_)
+{
+    make_ready (static_cast<item_t *> (cookie_));
+}
+
+int zmq::socket_poller_t::add (socket_base_t *socket_,
+                               void *user_data_,
+                               short events_)
+{
+    if (_sockets.find (socket_) != _sockets.end ()) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    const bool thread_safe = is_thread_safe (*socket_);
+    fd_t fd = retired_fd;
+    if (thread_safe) {
+        if (create_signaler () == -1)
+            return -1;
+    } else {
+        size_t fd_size = sizeof fd;
+        const int rc = socket_->getsockopt (ZMQ_FD, &fd, &fd_size);
+        zmq_assert (rc == 0);
+    }
+
+    item_t *const item = new (std::nothrow) item_t;
+    if (!item) {
+        errno = ENOMEM;
+        return -1;
+    }
+    item->socket = socket_;
+    item->fd = fd;
+    item->user_data = user_data_;
+    item->events = 0;
+    item->revents = 0;
+    item->registered = false;
+    item->ready = false;
+    item->removed = false;
+    item->always_ready = false;
+
+    try {
+        _sockets.insert (sockets_t::value_type (socket_, item));
+        if (thread_safe)
+            _thread_safe_items.push_back (item);
+    }
+    catch (const std::bad_alloc &) {
+        _sockets.erase (socket_);
+        delete item;
+        errno = ENOMEM;
+        return -1;
+    }
+
+    if (update (item, events_) == -1) {
+        _sockets.erase (socket_);
+        delete item;
+        return -1;
+    }
+
+    if (thread_safe)
+        socket_->add_signaler (_signaler);
+    else {
+        socket_->add_watcher (this, item);
+
+        //  Events the socket has already are not signalled.
+        make_ready (item);
+    }
+
+    return 0;
+}
+
+int zmq::socket_poller_t::add_fd (fd_t fd_, void *user_data_, short events_)
+{
+    if (_fds.find (fd_) != _fds.end ()) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    item_t *const item = new (std::nothrow) item_t;
+    if (!item) {
+        errno = ENOMEM;
+        return -1;
+    }
+    item->socket = NULL;
+    item->fd = fd_;
+    item->user_data = user_data_;
+    item->events = 0;
+    item->revents = 0;
+    item->registered = false;
+    item->ready = false;
+    item->removed = false;
+    item->always_ready = false;
+
+    try {
+        _fds.insert (fds_t::value_type (fd_, item));
+    }
+    catch (const std::bad_alloc &) {
+        delete item;
+        errno = ENOMEM;
+        return -1;
+    }
+
+    if (update (item, events_) == -1) {
+        _fds.erase (fd_);
+        delete item;
+        return -1;
+    }
+
+    return 0;
+}
+
+int zmq::socket_poller_t::modify (const socket_base_t *socket_, short events_)
+{
+    const sockets_t::iterator it = _sockets.find (socket_);
+    if (it == _sockets.end ()) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    item_t *const item = it->second;
+    if (update (item, events_) == -1)
+        return -1;
+    if (!is_thread_safe (*socket_))
+        make_ready (item);
+
+    return 0;
+}
+
+int zmq::socket_poller_t::modify_fd (fd_t fd_, short events_)
+{
+    const fds_t::iterator it = _fds.find (fd_);
+    if (it == _fds.end ()) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    it->second->revents = 0;
+    return update (it->second, events_);
+}
+
+int zmq::socket_poller_t::remove (socket_base_t *socket_)
+{
+    const sockets_t::iterator it = _sockets.find (socket_);
+    if (it == _sockets.end ()) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    item_t *const item = it->second;
+    update (item, 0);
+    _sockets.erase (it);
+
+    if (is_thread_safe (*socket_)) {
+        _thread_safe_items.erase (std::find (_thread_safe_items.begin (),
+                                             _thread_safe_items.end (), item));
+        socket_->remove_signaler (_signaler);
+    } else
+        socket_->remove_watcher (this);
+
+    destroy (item);
+    return 0;
+}
+
+int zmq::socket_poller_t::remove_fd (fd_t fd_)
+{
+    const fds_t::iterator it = _fds.find (fd_);
+    if (it == _fds.end ()) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    item_t *const item = it->second;
+    update (item, 0);
+    _fds.erase (it);
+
+    destroy (item);
+    return 0;
+}
+
+void zmq::socket_poller_t::forget (const socket_base_t *socket_)
+{
+    const sockets_t::iterator it = _sockets.find (socket_);
+    zmq_assert (it != _sockets.end ());
+    item_t *const item = it->second;
+    _sockets.erase (it);
+
+    const items_t::iterator thread_safe = std::find (
+      _thread_safe_items.begin (), _thread_safe_items.end (), item);
+    if (thread_safe != _thread_safe_items.end ())
+        _thread_safe_items.erase (thread_safe);
+    else if (item->registered) {
+        //  The file descriptor of a socket is closed once the socket is
+        //  destroyed, which removed it from the epoll set.
+        epoll_event ev;
+        epoll_ctl (_epoll_fd, EPOLL_CTL_DEL, item->fd, &ev);
+        item->registered = false;
+    }
+    _pollset_size -= item->events != 0;
+    item->events = 0;
+
+    destroy (item);
+}
+
+int zmq::socket_poller_t::check_socket (item_t *item_,
+                                        zmq::socket_poller_t::event_t *events_,
+                                        int &found_)
+{
+    //  Retrieve pending events using the ZMQ_EVENTS socket option.
+    size_t events_size = sizeof (uint32_t);
+    uint32_t events;
+    if (item_->socket->getsockopt (ZMQ_EVENTS, &events, &events_size) == -1)
+        return -1;
+
+    if (item_->events & events) {
+        events_[found_].socket = item_->socket;
+        events_[found_].fd = zmq::retired_fd;
+        events_[found_].user_data = item_->user_data;
+        events_[found_].events = item_->events & events;
+        ++found_;
+    }
+    return 0;
+}
+
+int zmq::socket_poller_t::check_events (zmq::socket_poller_t::event_t *events_,
+                                        int n_events_)
+{
+    int found = 0;
+    for (items_t::iterator it = _thread_safe_items.begin (),
+                           end = _thread_safe_items.end ();
+         it != end && found < n_events_; ++it) {
+        if ((*it)->events && check_socket (*it, events_, found) == -1)
+            return -1;
+    }
+
+    //  Regular files and the like are reported as poll () does.
+    for (items_t::iterator it = _always_ready.begin (),
+                           end = _always_ready.end ();
+         it != end && found < n_events_; ++it) {
+        const short events = (*it)->events & (ZMQ_POLLIN | ZMQ_POLLOUT);
+        if (events) {
+            events_[found].socket = NULL;
+            events_[found].fd = (*it)->fd;
+            events_[found].user_data = (*it)->user_data;
+            events_[found].events = events;
+            ++found;
+        }
+    }
+
+    //  Checking a socket may add it to the list, hence the indices.
+    int rc = 0;
+    size_t kept = 0;
+    for (size_t i = 0; i != _ready.size (); ++i) {
+        item_t *const item = _ready[i];
+        if (item->removed) {
+            delete item;
+            continue;
+        }
+        if (found == n_events_ || rc == -1) {
+            _ready[kept++] = item;
+            continue;
+        }
+
+        if (item->socket) {
+            //  Sockets are checked again next time as long as they have
+            //  events to report, as their file descriptor is not signalled
+            //  for these.
+            const int reported = found;
+            rc = check_socket (item, events_, found);
+            if (rc == -1 || found != reported)
+                _ready[kept++] = item;
+            else
+                item->ready = false;
+            continue;
+        }
+
+        //  The poll item is a raw file descriptor, simply convert the events
+        //  to zmq_pollitem_t-style format. Epoll reports it again as long as
+        //  the events are there.
+        const uint32_t revents = item->revents;
+        item->revents = 0;
+        item->ready = false;
+
+        short events = 0;
+        if (revents & EPOLLIN)
+            events |= ZMQ_POLLIN;
+        if (revents & EPOLLOUT)
+            events |= ZMQ_POLLOUT;
+        if (revents & EPOLLPRI)
+            events |= ZMQ_POLLPRI;
+        if (revents & ~(EPOLLIN | EPOLLOUT | EPOLLPRI))
+            events |= ZMQ_POLLERR;
+
+        if (events && item->events) {
+            events_[found].socket = NULL;
+            events_[found].fd = item->fd;
+            events_[found].user_data = item->user_data;
+            events_[found].events = events;
+            ++found;
+        }
+    }
+    _ready.resize (kept);
+
+    return rc == -1 ? -1 : found;
+}
+
+#else
+
 zmq::socket_poller_t::socket_poller_t () :
     _tag (0xCAFEBABE),
     _signaler (NULL)
@@ -45,6 +542,8 @@ zmq::socket_poller_t::~socket_poller_t ()
     //  Mark the socket_poller as dead
     _tag = 0xdeadbeef;
 
+    unregister_poll_items ();
+
     for (items_t::iterator it = _items.begin (), end = _items.end (); it != end;
          ++it) {
         // TODO shouldn't this zmq_assert (it->socket->check_tag ()) instead?
@@ -66,22 +565,6 @@ zmq::socket_poller_t::~socket_poller_t ()
 #endif
 }
 
-bool zmq::socket_poller_t::check_tag () const
-{
-    return _tag == 0xCAFEBABE;
-}
-
-int zmq::socket_poller_t::signaler_fd (fd_t *fd_) const
-{
-    if (_signaler) {
-        *fd_ = _signaler->get_fd ();
-        return 0;
-    }
-    // Only thread-safe socket types are guaranteed to have a signaler.
-    errno = EINVAL;
-    return -1;
-}
-
 int zmq::socket_poller_t::add (socket_base_t *socket_,
                                void *user_data_,
                                short events_)
@@ -232,6 +715,16 @@ int zmq::socket_poller_t::remove_fd (fd_t fd_)
     return 0;
 }
 
+void zmq::socket_poller_t::forget (const socket_base_t *socket_)
+{
+    const items_t::iterator it =
+      find_if2 (_items.begin (), _items.end (), socket_, &is_socket);
+    zmq_assert (it != _items.end ());
+
+    _items.erase (it);
+    _need_rebuild = true;
+}
+
 int zmq::socket_poller_t::rebuild ()
 {
     _use_signaler = false;
@@ -371,15 +864,9 @@ int zmq::socket_poller_t::rebuild ()
     return 0;
 }
 
-void zmq::socket_poller_t::zero_trail_events (
-  zmq::socket_poller_t::event_t *events_, int n_events_, int found_)
+void zmq::socket_poller_t::socket_events_changed (void *cookie_)
 {
-    for (int i = found_; i < n_events_; ++i) {
-        events_[i].socket = NULL;
-        events_[i].fd = zmq::retired_fd;
-        events_[i].user_data = NULL;
-        events_[i].events = 0;
-    }
+    LIBZMQ_UNUSED (cookie_);
 }
 
 #if defined ZMQ_POLL_BASED_ON_POLL
@@ -456,6 +943,19 @@ int zmq::socket_poller_t::check_events (zmq::socket_poller_t::event_t *events_,
     return found;
 }
 
+#endif
+
+void zmq::socket_poller_t::zero_trail_events (
+  zmq::socket_poller_t::event_t *events_, int n_events_, int found_)
+{
+    for (int i = found_; i < n_events_; ++i) {
+        events_[i].socket = NULL;
+        events_[i].fd = zmq::retired_fd;
+        events_[i].user_data = NULL;
+        events_[i].events = 0;
+    }
+}
+
 //Return 0 if timeout is expired otherwise 1
 int zmq::socket_poller_t::adjust_timeout (zmq::clock_t &clock_,
                                           long timeout_,
@@ -498,16 +998,18 @@ int zmq::socket_poller_t::wait (zmq::socket_poller_t::event_t *events_,
                                 int n_events_,
                                 long timeout_)
 {
-    if (_items.empty () && timeout_ < 0) {
+    if (size () == 0 && timeout_ < 0) {
         errno = EFAULT;
         return -1;
     }
 
+#if !defined ZMQ_SOCKET_POLLER_USE_EPOLL
     if (_need_rebuild) {
         const int rc = rebuild ();
         if (rc == -1)
             return -1;
     }
+#endif
 
     if (unlikely (_pollset_size == 0)) {
         if (timeout_ < 0) {
@@ -544,7 +1046,60 @@ int zmq::socket_poller_t::wait (zmq::socket_poller_t::event_t *events_,
 #endif
     }
 
-#if defined ZMQ_POLL_BASED_ON_POLL
+#if defined ZMQ_SOCKET_POLLER_USE_EPOLL
+    zmq::clock_t clock;
+    uint64_t now = 0;
+    uint64_t end = 0;
+
+    bool first_pass = true;
+
+    while (true) {
+        //  Compute the timeout for the subsequent poll.
+        int timeout;
+        if (first_pass)
+            timeout = 0;
+        else if (timeout_ < 0)
+            timeout = -1;
+        else
+            timeout =
+              static_cast<int> (std::min<uint64_t> (end - now, INT_MAX));
+
+        //  Wait for events.
+        const int rc =
+          epoll_wait (_epoll_fd, &_epoll_events[0],
+                      static_cast<int> (_epoll_events.size ()), timeout);
+        if (rc == -1 && errno == EINTR) {
+            return -1;
+        }
+        errno_assert (rc >= 0);
+
+        for (int i = 0; i != rc; ++i) {
+            item_t *const item =
+              static_cast<item_t *> (_epoll_events[i].data.ptr);
+            if (item) {
+                item->revents = _epoll_events[i].events;
+                make_ready (item);
+            } else
+                //  Receive the signal from the signaler
+                _signaler->recv ();
+        }
+
+        //  Check for the events.
+        const int found = check_events (events_, n_events_);
+        if (found) {
+            if (found > 0)
+                zero_trail_events (events_, n_events_, found);
+            return found;
+        }
+
+        //  Adjust timeout or break
+        if (adjust_timeout (clock, timeout_, now, end, first_pass) == 0)
+            break;
+    }
+    errno = EAGAIN;
+    return -1;
+
+#elif defined ZMQ_POLL_BASED_ON_POLL
     zmq::clock_t clock;
     uint64_t now = 0;
     uint64_t end = 0;
@@ -666,3 +1221,150 @@ int zmq::socket_poller_t::wait (zmq::socket_poller_t::event_t *events_,
 
 #endif
 }
+
+int zmq::socket_poller_t::poll_items (zmq_pollitem_t *items_,
+                                      int nitems_,
+                                      long timeout_)
+{
+    if (unlikely (nitems_ < 0)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (unlikely (nitems_ > 0 && !items_)) {
+        errno = EFAULT;
+        return -1;
+    }
+
+    if (poll_items_changed (items_, nitems_)) {
+        unregister_poll_items ();
+        if (register_poll_items (items_, nitems_) == -1) {
+            unregister_poll_items ();
+            return -1;
+        }
+    }
+
+    const int rc =
+      wait (nitems_ ? &_poll_events[0] : NULL, nitems_, timeout_);
+
+    //  Only the items reported have their events reset afterwards, so
+    //  that the cost of this follows the number of items reported.
+    const int found = rc == -1 ? 0 : rc;
+    for (int i = 0; i != found; i++)
+        static_cast<poll_item_t *> (_poll_events[i].user_data)->revents =
+          _poll_events[i].events;
+    for (int i = 0; i != nitems_; i++) {
+        const poll_item_t &item = _poll_items[i];
+        items_[i].revents = _poll_items[item.first].revents & item.events;
+    }
+    for (int i = 0; i != found; i++)
+        static_cast<poll_item_t *> (_poll_events[i].user_data)->revents = 0;
+
+    if (rc == -1 && errno == EAGAIN)
+        return 0;
+    return rc;
+}
+
+bool zmq::socket_poller_t::poll_items_changed (const zmq_pollitem_t *items_,
+                                               int nitems_) const
+{
+    if (static_cast<size_t> (nitems_) != _poll_items.size ())
+        return true;
+    for (int i = 0; i != nitems_; i++) {
+        const poll_item_t &item = _poll_items[i];
+        if (items_[i].socket != item.socket || items_[i].events != item.events
+            || (!item.socket && items_[i].fd != item.fd)
+            || (item.socket && !registered_socket_alive (item)))
+            return true;
+    }
+    return false;
+}
+
+bool zmq::socket_poller_t::registered_socket_alive (const poll_item_t &item_)
+{
+    const socket_base_t *const socket =
+      static_cast<const socket_base_t *> (item_.socket);
+    return socket->check_tag () && socket->get_socket_id () == item_.socket_id;
+}
+
+int zmq::socket_poller_t::register_poll_items (const zmq_pollitem_t *items_,
+                                               int nitems_)
+{
+    //  The items are registered with pointers to their copies, so these
+    //  must not move afterwards.
+    try {
+        _poll_items.resize (nitems_);
+        _poll_events.resize (nitems_);
+    }
+    catch (const std::bad_alloc &) {
+        _poll_items.clear ();
+        errno = ENOMEM;
+        return -1;
+    }
+
+    for (int i = 0; i != nitems_; i++) {
+        poll_item_t &item = _poll_items[i];
+        item.socket = items_[i].socket;
+        item.socket_id = 0;
+        item.fd = item.socket ? retired_fd : items_[i].fd;
+        item.events = items_[i].events;
+        item.first = i;
+        item.registered = item.events;
+        item.revents = 0;
+
+        socket_base_t *const socket =
+          static_cast<socket_base_t *> (item.socket);
+        if (socket && !socket->check_tag ()) {
+            _poll_items.resize (i);
+            errno = ENOTSOCK;
+            return -1;
+        }
+        if (socket)
+            item.socket_id = socket->get_socket_id ();
+        const int rc = socket ? add (socket, &item, item.events)
+                              : add_fd (item.fd, &item, item.events);
+        if (rc == 0)
+            continue;
+
+        //  Adding fails with EINVAL for repeated sockets and file
+        //  descriptors only, so these are searched for in that case only.
+        int first = 0;
+        if (errno == EINVAL)
+            while (first != i
+                   && (_poll_items[first].socket != item.socket
+                       || _poll_items[first].fd != item.fd))
+                first++;
+        if (first == i) {
+            _poll_items.resize (i);
+            return -1;
+        }
+        poll_item_t &registration = _poll_items[first];
+        registration.registered |= item.events;
+        const int modified =
+          socket ? modify (socket, registration.registered)
+                 : modify_fd (item.fd, registration.registered);
+        if (modified == -1) {
+            _poll_items.resize (i);
+            return -1;
+        }
+        item.first = first;
+    }
+    return 0;
+}
+
+void zmq::socket_poller_t::unregister_poll_items ()
+{
+    for (size_t i = 0, n = _poll_items.size (); i != n; i++) {
+        const poll_item_t &item = _poll_items[i];
+        if (item.first != static_cast<int> (i))
+            continue;
+        if (item.socket && !registered_socket_alive (item)) {
+            forget (static_cast<socket_base_t *> (item.socket));
+            continue;
+        }
+        const int rc =
+          item.socket ? remove (static_cast<socket_base_t *> (item.socket))
+                      : remove_fd (item.fd);
+        errno_assert (rc == 0);
+    }
+    _poll_items.clear ();
+}
@@ -5,10 +5,21 @@
 
 #include "poller.hpp"
 
+//  Where epoll is available, sockets are polled through a persistent epoll
+//  set, and only the sockets signalled or otherwise changed are checked.
+#if defined ZMQ_IOTHREAD_POLLER_USE_EPOLL && !defined ZMQ_HAVE_WINDOWS
+#define ZMQ_SOCKET_POLLER_USE_EPOLL
+#endif
+
 #if defined ZMQ_POLL_BASED_ON_POLL && !defined ZMQ_HAVE_WINDOWS
 #include <poll.h>
 #endif
 
+#if defined ZMQ_SOCKET_POLLER_USE_EPOLL
+#include <sys/epoll.h>
+#include <map>
+#endif
+
 #if defined ZMQ_HAVE_WINDOWS
 #include "windows.hpp"
 #elif defined ZMQ_HAVE_VXWORKS
@@ -24,10 +35,11 @@
 #include "socket_base.hpp"
 #include "signaler.hpp"
 #include "polling_util.hpp"
+#include "i_socket_watcher.hpp"
 
 namespace zmq
 {
-class socket_poller_t
+class socket_poller_t ZMQ_FINAL : public i_socket_watcher
 {
   public:
     socket_poller_t ();
@@ -47,7 +59,23 @@ class socket_poller_t
 
     int wait (event_t *events_, int n_events_, long timeout_);
 
+    //  Polls an array of poll items as zmq_poll does. The items stay
+    //  registered as long as the array holds the same sockets, file
+    //  descriptors and events, so that polling it again neither allocates
+    //  nor registers anything. Other items must not be registered.
+    int poll_items (zmq_pollitem_t *items_, int nitems_, long timeout_);
+
+#if defined ZMQ_SOCKET_POLLER_USE_EPOLL
+    int size () const
+    {
+        return static_cast<int> (_sockets.size () + _fds.size ());
+    };
+#else
     int size () const { return static_cast<int> (_items.size ()); };
+#endif
+
+    //  i_socket_watcher implementation.
+    void socket_events_changed (void *cookie_) ZMQ_OVERRIDE;
 
     //  Return false if object is not a socket.
     bool check_tag () const;
@@ -59,7 +87,20 @@ class socket_poller_t
         fd_t fd;
         void *user_data;
         short events;
-#if defined ZMQ_POLL_BASED_ON_POLL
+#if defined ZMQ_SOCKET_POLLER_USE_EPOLL
+        //  Events reported by epoll for a file descriptor.
+        uint32_t revents;
+
+        //  Whether the item is in the epoll set and in the list of items
+        //  to check, and whether it waits there to be deleted.
+        bool registered;
+        bool ready;
+        bool removed;
+
+        //  Whether the file descriptor is one epoll does not support, and
+        //  is reported ready instead.
+        bool always_ready;
+#elif defined ZMQ_POLL_BASED_ON_POLL
         int pollfd_index;
 #endif
     } item_t;
@@ -67,7 +108,12 @@ class socket_poller_t
     static void zero_trail_events (zmq::socket_poller_t::event_t *events_,
                                    int n_events_,
                                    int found_);
-#if defined ZMQ_POLL_BASED_ON_POLL
+#if defined ZMQ_SOCKET_POLLER_USE_EPOLL
+    int check_events (zmq::socket_poller_t::event_t *events_, int n_events_);
+    int check_socket (item_t *item_,
+                      zmq::socket_poller_t::event_t *events_,
+                      int &found_);
+#elif defined ZMQ_POLL_BASED_ON_POLL
     int check_events (zmq::socket_poller_t::event_t *events_, int n_events_);
 #elif defined ZMQ_POLL_BASED_ON_SELECT
     int check_events (zmq::socket_poller_t::event_t *events_,
@@ -90,7 +136,53 @@ class socket_poller_t
         return !item.socket && item.fd == fd_;
     }
 
+    //  Copy of a poll item registered by poll_items. Repeated sockets and
+    //  file descriptors are registered once, for the union of the events,
+    //  by the first item holding them.
+    struct poll_item_t
+    {
+        //  Socket addresses are reused, so sockets are told apart by id.
+        void *socket;
+        int socket_id;
+        fd_t fd;
+        short events;
+
+        //  Index of the item holding the registration, the events
+        //  registered and the events reported by the last wait.
+        int first;
+        short registered;
+        short revents;
+    };
+
+    bool poll_items_changed (const zmq_pollitem_t *items_, int nitems_) const;
+    int register_poll_items (const zmq_pollitem_t *items_, int nitems_);
+    void unregister_poll_items ();
+
+    //  Returns whether the socket of the item was not closed since it was
+    //  registered. The item array may no longer hold it, so it is only
+    //  accessed once its tag shows it is a socket still.
+    static bool registered_socket_alive (const poll_item_t &item_);
+
+    //  Removes the socket without accessing it, as it may be destroyed
+    //  already. Closing a socket drops its watchers and signalers.
+    void forget (const socket_base_t *socket_);
+
+#if defined ZMQ_SOCKET_POLLER_USE_EPOLL
+    //  The epoll set is created with the first item, as creating it may
+    //  fail.
+    int open_epoll ();
+    int create_signaler ();
+
+    //  Sets the events of the item, updating the epoll set.
+    int update (item_t *item_, short events_);
+
+    //  Adds the item to the list of items to check.
+    void make_ready (item_t *item_);
+
+    void destroy (item_t *item_);
+#else
     int rebuild ();
+#endif
 
     //  Used to check whether the object is a socket_poller.
     uint32_t _tag;
@@ -98,6 +190,37 @@ class socket_poller_t
     //  Signaler used for thread safe sockets polling
     signaler_t *_signaler;
 
+    //  Items registered by poll_items, and the events waited for them.
+    std::vector<poll_item_t> _poll_items;
+    std::vector<event_t> _poll_events;
+
+#if defined ZMQ_SOCKET_POLLER_USE_EPOLL
+    fd_t _epoll_fd;
+
+    //  Items by socket and by file descriptor.
+    typedef std::map<const socket_base_t *, item_t *> sockets_t;
+    sockets_t _sockets;
+    typedef std::map<fd_t, item_t *> fds_t;
+    fds_t _fds;
+
+    //  Thread safe sockets are signalled through the signaler, shared by
+    //  all of them, and are checked on every wait.
+    typedef std::vector<item_t *> items_t;
+    items_t _thread_safe_items;
+
+    //  File descriptors epoll does not support, such as regular files.
+    //  As with poll (), they are always ready for input and output.
+    items_t _always_ready;
+
+    //  Items that may have events to report: sockets signalled, changed or
+    //  reported last time, and file descriptors reported by epoll.
+    items_t _ready;
+
+    std::vector<epoll_event> _epoll_events;
+
+    //  Number of items with events to poll for.
+    int _pollset_size;
+#else
     //  List of sockets
     typedef std::vector<item_t> items_t;
     items_t _items;
@@ -118,6 +241,7 @@ class socket_poller_t
     resizable_optimized_fd_set_t _pollset_out;
     resizable_optimized_fd_set_t _pollset_err;
     zmq::fd_t _max_fd;
+#endif
 #endif
 
     ZMQ_NON_COPYABLE_NOR_MOVABLE (socket_poller_t)
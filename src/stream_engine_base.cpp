@@ -4,6 +4,7 @@
 #include "macros.hpp"
 
 #include <limits.h>
+#include <stdlib.h>
 #include <string.h>
 
 #ifndef ZMQ_HAVE_WINDOWS
@@ -33,8 +34,10 @@
 #include "err.hpp"
 #include "ip.hpp"
 #include "tcp.hpp"
+#include "zerocopy.hpp"
 #include "likely.hpp"
 #include "wire.hpp"
+#include "clock.hpp"
 
 static std::string get_peer_address (zmq::fd_t s_)
 {
@@ -84,10 +87,13 @@ zmq::stream_engine_base_t::stream_engine_base_t (
     _outpos (NULL),
     _outsize (0),
     _encoder (NULL),
+    _vectored_output (false),
     _mechanism (NULL),
     _next_msg (NULL),
     _process_msg (NULL),
     _metadata (NULL),
+    _held_msg_pending (false),
+    _encode_ahead (false),
     _input_stopped (false),
     _output_stopped (false),
     _endpoint_uri_pair (endpoint_uri_pair_),
@@ -96,16 +102,34 @@ zmq::stream_engine_base_t::stream_engine_base_t (
     _has_timeout_timer (false),
     _has_heartbeat_timer (false),
     _peer_address (get_peer_address (fd_)),
+#if defined ZMQ_HAVE_TCP_WRITEV
+    _out_iovcnt (0),
+    _out_iovpos (0),
+    _out_refcnt (0),
+#endif
+#if defined ZMQ_HAVE_TCP_ZEROCOPY
+    _zerocopy (false),
+    _out_zerocopy (false),
+    _out_zerocopied (false),
+    _io_thread (NULL),
+#endif
     _s (fd_),
     _handle (static_cast<handle_t> (NULL)),
+#if defined ZMQ_HAVE_IO_URING
+    _ring_io (NULL),
+    _ring_handle (NULL),
+#endif
     _plugged (false),
     _handshaking (true),
     _io_error (false),
     _session (NULL),
     _socket (NULL),
-    _has_handshake_stage (has_handshake_stage_)
+    _has_handshake_stage (has_handshake_stage_),
+    _out_batch_started (0)
 {
-    const int rc = _tx_msg.init ();
+    int rc = _tx_msg.init ();
+    errno_assert (rc == 0);
+    rc = _held_msg.init ();
     errno_assert (rc == 0);
 
     //  Put the socket into non-blocking mode.
@@ -116,6 +140,21 @@ zmq::stream_engine_base_t::~stream_engine_base_t ()
 {
     zmq_assert (!_plugged);
 
+#if defined ZMQ_HAVE_TCP_WRITEV
+    release_out_refs ();
+#endif
+#if defined ZMQ_HAVE_TCP_ZEROCOPY
+    //  The messages must outlive the zero-copy writes, so the socket is
+    //  handed over to an object waiting for their completion in the poller.
+    if (_s != retired_fd && _zerocopy_refs.pending ()) {
+        _zerocopy_refs.process (_s);
+        if (_zerocopy_refs.pending ()) {
+            zerocopy_linger_t::launch (_io_thread, _s, _zerocopy_refs);
+            _s = retired_fd;
+        }
+    }
+#endif
+
     if (_s != retired_fd) {
 #ifdef ZMQ_HAVE_WINDOWS
         const int rc = closesocket (_s);
@@ -133,7 +172,9 @@ zmq::stream_engine_base_t::~stream_engine_base_t ()
         _s = retired_fd;
     }
 
-    const int rc = _tx_msg.close ();
+    int rc = _tx_msg.close ();
+    errno_assert (rc == 0);
+    rc = _held_msg.close ();
     errno_assert (rc == 0);
 
     //  Drop reference to metadata and destroy it if we are
@@ -163,9 +204,31 @@ void zmq::stream_engine_base_t::plug (io_thread_t *io_thread_,
 
     //  Connect to I/O threads poller object.
     io_object_t::plug (io_thread_);
-    _handle = add_fd (_s);
     _io_error = false;
 
+#if defined ZMQ_HAVE_IO_URING
+    //  The ring copies through buffers of its own, so the data is written
+    //  from the encoder's buffer rather than referenced.
+    if (_vectored_output) {
+        _ring_io = io_thread_->get_ring_io ();
+        if (_ring_io) {
+            _vectored_output = false;
+            _ring_handle = _ring_io->add_fd (
+              _s, this, static_cast<size_t> (_options.in_batch_size),
+              static_cast<size_t> (_options.out_batch_size));
+        }
+    }
+    if (!_ring_io)
+#endif
+        _handle = add_fd (_s);
+
+#if defined ZMQ_HAVE_TCP_ZEROCOPY
+    //  Transports other than TCP do not support zero-copy transmission.
+    if (_vectored_output && _options.tcp_zerocopy)
+        _zerocopy = tcp_enable_zerocopy (_s) == 0;
+    _io_thread = io_thread_;
+#endif
+
     plug_internal ();
 }
 
@@ -196,7 +259,7 @@ void zmq::stream_engine_base_t::unplug ()
     }
     //  Cancel all fd subscriptions.
     if (!_io_error)
-        rm_fd (_handle);
+        rm_fd ();
 
     //  Disconnect from I/O threads poller object.
     io_object_t::unplug ();
@@ -212,6 +275,14 @@ void zmq::stream_engine_base_t::terminate ()
 
 void zmq::stream_engine_base_t::in_event ()
 {
+#if defined ZMQ_HAVE_TCP_ZEROCOPY
+    //  Completions of zero-copy writes are signalled as an error on the
+    //  socket. Do not mistake them for a failure while input is stopped.
+    if (_zerocopy_refs.pending () && _zerocopy_refs.process (_s)
+        && _input_stopped)
+        return;
+#endif
+
     // ignore errors
     const bool res = in_event_internal ();
     LIBZMQ_UNUSED (res);
@@ -245,7 +316,7 @@ bool zmq::stream_engine_base_t::in_event_internal ()
 
     //  If there has been an I/O error, stop polling.
     if (_input_stopped) {
-        rm_fd (_handle);
+        rm_fd ();
         _io_error = true;
         return true; // TODO or return false in this case too?
     }
@@ -289,6 +360,8 @@ bool zmq::stream_engine_base_t::in_event_internal ()
         if (rc == -1)
             break;
     }
+    if (rc != -1)
+        rc = decode_held_and_push ();
 
     //  Tear down the connection if we have failed to decode input data
     //  or the session has rejected the message.
@@ -304,7 +377,7 @@ bool zmq::stream_engine_base_t::in_event_internal ()
             }
         }
         _input_stopped = true;
-        reset_pollin (_handle);
+        reset_pollin ();
     }
 
     _session->flush ();
@@ -315,6 +388,39 @@ void zmq::stream_engine_base_t::out_event ()
 {
     zmq_assert (!_io_error);
 
+    //  ws_engine can cause an engine error and delete it while producing
+    //  messages other than those of the session.
+    const bool encoding =
+      _encode_ahead && _next_msg == &stream_engine_base_t::pull_and_encode;
+    out_event_internal ();
+    if (!encoding)
+        return;
+
+    //  Frames the mechanism encoded ahead of the batch written would be
+    //  lost if the session terminated before the next output event, so
+    //  they are written right away, as long as the socket takes them.
+    //  Output stops if they are still being encoded.
+    _next_msg = &stream_engine_base_t::pull_encoded_ahead;
+    while (!_io_error && !_output_stopped && _outsize == 0
+#if defined ZMQ_HAVE_TCP_WRITEV
+           && _out_iovpos == _out_iovcnt
+#endif
+           && _mechanism->encoded_ahead ())
+        out_event_internal ();
+    _next_msg = &stream_engine_base_t::pull_and_encode;
+}
+
+void zmq::stream_engine_base_t::out_event_internal ()
+{
+#if defined ZMQ_HAVE_TCP_WRITEV
+    //  Data placed in the write buffer directly by the engine, such as
+    //  the greeting, is written by the regular path below.
+    if (_vectored_output && !_outsize) {
+        out_event_vectored ();
+        return;
+    }
+#endif
+
     //  If write buffer is empty, try to read new data from the encoder.
     if (!_outsize) {
         //  Even when we stop polling as soon as there is no
@@ -353,6 +459,7 @@ void zmq::stream_engine_base_t::out_event ()
             reset_pollout ();
             return;
         }
+        batch_collected ();
     }
 
     //  If there are any data to write in write buffer, write as much as
@@ -372,6 +479,8 @@ void zmq::stream_engine_base_t::out_event ()
 
     _outpos += nbytes;
     _outsize -= nbytes;
+    if (_outsize == 0)
+        batch_written ();
 
     //  If we are still handshaking and there are no data
     //  to send, stop polling for output.
@@ -380,6 +489,258 @@ void zmq::stream_engine_base_t::out_event ()
             reset_pollout ();
 }
 
+void zmq::stream_engine_base_t::batch_collected ()
+{
+    //  Handshake data is not accounted for, as it does not come from the
+    //  pipe.
+    if (_options.latency_stats && !_handshaking)
+        _out_batch_started = clock_t::now_us ();
+}
+
+void zmq::stream_engine_base_t::batch_written ()
+{
+    if (_out_batch_started) {
+        _session->record_wire_latency (clock_t::now_us ()
+                                       - _out_batch_started);
+        _out_batch_started = 0;
+    }
+}
+
+#if defined ZMQ_HAVE_TCP_WRITEV
+void zmq::stream_engine_base_t::out_event_vectored ()
+{
+    //  If the last batch has been written, collect a new one.
+    if (_out_iovpos == _out_iovcnt) {
+        if (unlikely (_encoder == NULL)) {
+            zmq_assert (_handshaking);
+            return;
+        }
+
+        if (!fill_out_iov ())
+            return;
+
+        //  If there is no data to send, stop polling for output.
+        if (_out_iovcnt == 0) {
+            _output_stopped = true;
+            reset_pollout ();
+            return;
+        }
+        batch_collected ();
+    }
+
+    //  Write until the whole batch is written or the socket is full.
+    int rc;
+    do {
+        rc = write_out_iov ();
+
+        //  IO error has occurred. We stop waiting for output events.
+        //  The engine is not terminated until we detect input error;
+        //  this is necessary to prevent losing incoming messages.
+        if (rc == -1) {
+            reset_pollout ();
+            return;
+        }
+    } while (rc == 1 && _out_iovpos < _out_iovcnt);
+
+    if (_out_iovpos == _out_iovcnt) {
+        release_out_refs ();
+        batch_written ();
+
+        //  If we are still handshaking and there are no data
+        //  to send, stop polling for output.
+        if (unlikely (_handshaking))
+            reset_pollout ();
+    }
+}
+
+bool zmq::stream_engine_base_t::fill_out_iov ()
+{
+    _out_iovcnt = 0;
+    _out_iovpos = 0;
+
+    //  Small chunks are copied to the encoder's buffer, large ones are
+    //  referenced. The first call to the encoder provides its buffer.
+    const size_t batch_size = static_cast<size_t> (_options.out_batch_size);
+    unsigned char *bufptr = NULL;
+    size_t buffree = batch_size;
+    size_t total = 0;
+
+    size_t ref_total = 0;
+
+    //  Each step may add two buffers: copied data and a referenced chunk.
+    //  Adjacent chunks share a buffer but each adds a message reference;
+    //  the last slot is left for stage_copied_out_iov.
+    while (_out_iovcnt <= max_out_iov - 2 && _out_refcnt < max_out_iov
+           && buffree > 0 && total < batch_size) {
+        unsigned char *data = bufptr;
+        unsigned char *ref;
+        size_t ref_size;
+        const size_t n = _encoder->encode_vec (
+          &data, buffree, out_ref_threshold, &ref, &ref_size);
+
+        if (n == 0 && ref == NULL) {
+            if ((this->*_next_msg) (&_tx_msg) == -1) {
+                //  ws_engine can cause an engine error and delete it, so
+                //  bail out immediately to avoid use-after-free
+                if (errno == ECONNRESET)
+                    return false;
+                break;
+            }
+            _encoder->load_msg (&_tx_msg);
+            continue;
+        }
+
+        if (n > 0) {
+            add_out_iov (data, n, false);
+            bufptr = data + n;
+            buffree -= n;
+            total += n;
+        }
+
+        //  The chunk belongs to the message being encoded, which the
+        //  encoder releases on the next call. Keep a reference to the
+        //  message data until the batch has been written.
+        if (ref) {
+            msg_t &retained = _out_refs[_out_refcnt++];
+            int rc = retained.init ();
+            errno_assert (rc == 0);
+            rc = retained.copy (_tx_msg);
+            errno_assert (rc == 0);
+            add_out_iov (ref, ref_size, true);
+            total += ref_size;
+            ref_total += ref_size;
+        }
+    }
+
+#if defined ZMQ_HAVE_TCP_ZEROCOPY
+    //  The kernel references all the data of a zero-copy write, so the
+    //  copied data is moved out of the encoder's buffer, which is reused
+    //  for the next batch while the write may still be in flight.
+    _out_zerocopy = _zerocopy && ref_total >= out_zerocopy_threshold;
+    if (_out_zerocopy)
+        stage_copied_out_iov ();
+#else
+    LIBZMQ_UNUSED (ref_total);
+#endif
+    return true;
+}
+
+void zmq::stream_engine_base_t::add_out_iov (unsigned char *data_,
+                                             size_t size_,
+                                             bool ref_)
+{
+    if (_out_iovcnt > 0) {
+        iovec &last = _out_iov[_out_iovcnt - 1];
+        bool same_kind = true;
+#if defined ZMQ_HAVE_TCP_ZEROCOPY
+        same_kind = _out_iov_ref[_out_iovcnt - 1] == ref_;
+#endif
+        if (same_kind
+            && static_cast<unsigned char *> (last.iov_base) + last.iov_len
+                 == data_) {
+            last.iov_len += size_;
+            return;
+        }
+    }
+    zmq_assert (_out_iovcnt < max_out_iov);
+    _out_iov[_out_iovcnt].iov_base = data_;
+    _out_iov[_out_iovcnt].iov_len = size_;
+#if defined ZMQ_HAVE_TCP_ZEROCOPY
+    _out_iov_ref[_out_iovcnt] = ref_;
+#else
+    LIBZMQ_UNUSED (ref_);
+#endif
+    ++_out_iovcnt;
+}
+
+#if defined ZMQ_HAVE_TCP_ZEROCOPY
+static void free_staged (void *data_, void *hint_)
+{
+    LIBZMQ_UNUSED (hint_);
+    free (data_);
+}
+
+void zmq::stream_engine_base_t::stage_copied_out_iov ()
+{
+    size_t size = 0;
+    for (int i = 0; i < _out_iovcnt; ++i)
+        if (!_out_iov_ref[i])
+            size += _out_iov[i].iov_len;
+    if (size == 0)
+        return;
+
+    unsigned char *const data = static_cast<unsigned char *> (malloc (size));
+    alloc_assert (data);
+    msg_t &retained = _out_refs[_out_refcnt++];
+    const int rc = retained.init_data (data, size, free_staged, NULL);
+    errno_assert (rc == 0);
+
+    unsigned char *pos = data;
+    for (int i = 0; i < _out_iovcnt; ++i)
+        if (!_out_iov_ref[i]) {
+            memcpy (pos, _out_iov[i].iov_base, _out_iov[i].iov_len);
+            _out_iov[i].iov_base = pos;
+            pos += _out_iov[i].iov_len;
+        }
+}
+#endif
+
+int zmq::stream_engine_base_t::write_out_iov ()
+{
+    int nbytes;
+#if defined ZMQ_HAVE_TCP_ZEROCOPY
+    if (_out_zerocopy) {
+        bool zerocopy;
+        nbytes = tcp_writev_zerocopy (_s, _out_iov + _out_iovpos,
+                                      _out_iovcnt - _out_iovpos, &zerocopy);
+        if (zerocopy) {
+            _zerocopy_refs.sent ();
+            _out_zerocopied = true;
+        }
+    } else
+#endif
+        nbytes =
+          tcp_writev (_s, _out_iov + _out_iovpos, _out_iovcnt - _out_iovpos);
+
+    if (nbytes == -1)
+        return -1;
+
+    //  Skip the buffers written completely and trim the partial one.
+    size_t written = static_cast<size_t> (nbytes);
+    while (_out_iovpos < _out_iovcnt
+           && written >= _out_iov[_out_iovpos].iov_len) {
+        written -= _out_iov[_out_iovpos].iov_len;
+        ++_out_iovpos;
+    }
+    if (written) {
+        iovec &iov = _out_iov[_out_iovpos];
+        iov.iov_base = static_cast<unsigned char *> (iov.iov_base) + written;
+        iov.iov_len -= written;
+    }
+    return _out_iovpos == _out_iovcnt ? 1 : 0;
+}
+
+void zmq::stream_engine_base_t::release_out_refs ()
+{
+#if defined ZMQ_HAVE_TCP_ZEROCOPY
+    //  Messages sent by zero-copy writes must be kept until the kernel
+    //  reports the last of those writes as completed.
+    if (_out_zerocopied) {
+        for (int i = 0; i < _out_refcnt; ++i)
+            _zerocopy_refs.hold (_out_refs[i]);
+        _out_refcnt = 0;
+        _out_zerocopied = false;
+        return;
+    }
+#endif
+    for (int i = 0; i < _out_refcnt; ++i) {
+        const int rc = _out_refs[i].close ();
+        errno_assert (rc == 0);
+    }
+    _out_refcnt = 0;
+}
+#endif
+
 void zmq::stream_engine_base_t::restart_output ()
 {
     if (unlikely (_io_error))
@@ -426,6 +787,8 @@ bool zmq::stream_engine_base_t::restart_input ()
         if (rc == -1)
             break;
     }
+    if (rc != -1)
+        rc = decode_held_and_push ();
 
     if (rc == -1 && errno == EAGAIN)
         _session->flush ();
@@ -552,6 +915,7 @@ void zmq::stream_engine_base_t::mechanism_ready ()
     if (flush_session)
         _session->flush ();
 
+    _encode_ahead = _mechanism->encodes_ahead ();
     _next_msg = &stream_engine_base_t::pull_and_encode;
     _process_msg = &stream_engine_base_t::write_credential;
 
@@ -608,6 +972,16 @@ int zmq::stream_engine_base_t::pull_and_encode (msg_t *msg_)
 {
     zmq_assert (_mechanism != NULL);
 
+    //  Frames encoded ahead go out first, and no message is pulled while
+    //  some are still being encoded.
+    if (unlikely (_encode_ahead)) {
+        if (_mechanism->encode_next (msg_))
+            return 0;
+        if (_mechanism->encoded_ahead ()) {
+            errno = EAGAIN;
+            return -1;
+        }
+    }
     if (_session->pull_msg (msg_) == -1)
         return -1;
     if (_mechanism->encode (msg_) == -1)
@@ -615,11 +989,20 @@ int zmq::stream_engine_base_t::pull_and_encode (msg_t *msg_)
     return 0;
 }
 
+int zmq::stream_engine_base_t::pull_encoded_ahead (msg_t *msg_)
+{
+    if (_mechanism->encode_next (msg_))
+        return 0;
+    errno = EAGAIN;
+    return -1;
+}
+
 int zmq::stream_engine_base_t::decode_and_push (msg_t *msg_)
 {
     zmq_assert (_mechanism != NULL);
 
-    if (_mechanism->decode (msg_) == -1)
+    const int rc = _mechanism->decode (msg_);
+    if (rc == -1 && errno != EAGAIN)
         return -1;
 
     if (_has_timeout_timer) {
@@ -632,28 +1015,85 @@ int zmq::stream_engine_base_t::decode_and_push (msg_t *msg_)
         cancel_timer (heartbeat_ttl_timer_id);
     }
 
-    if (msg_->flags () & msg_t::command) {
-        process_command_message (msg_);
-    }
-
-    if (_metadata)
-        msg_->set_metadata (_metadata);
-    if (_session->push_msg (msg_) == -1) {
-        if (errno == EAGAIN)
-            _process_msg = &stream_engine_base_t::push_one_then_decode_and_push;
+    //  The frame may be held back, and decoded on other threads along with
+    //  the ones before it, in which case input stops until they are.
+    if (rc == -1) {
+        _process_msg = &stream_engine_base_t::push_held;
+        errno = EAGAIN;
         return -1;
     }
+    if (_mechanism->decode_deferred ())
+        return push_held (msg_);
+    return push_decoded (msg_);
+}
+
+int zmq::stream_engine_base_t::push_decoded (msg_t *msg_)
+{
+    //  The mechanism may have decoded several messages from the frame.
+    do {
+        if (msg_->flags () & msg_t::command) {
+            process_command_message (msg_);
+        }
+
+        if (_metadata)
+            msg_->set_metadata (_metadata);
+        if (_session->push_msg (msg_) == -1) {
+            if (errno == EAGAIN)
+                _process_msg =
+                  &stream_engine_base_t::push_one_then_decode_and_push;
+            return -1;
+        }
+    } while (_mechanism->decode_next (msg_));
     return 0;
 }
 
 int zmq::stream_engine_base_t::push_one_then_decode_and_push (msg_t *msg_)
 {
     const int rc = _session->push_msg (msg_);
-    if (rc == 0)
+    if (rc == 0) {
         _process_msg = &stream_engine_base_t::decode_and_push;
+        if (_mechanism->decode_next (msg_))
+            return push_decoded (msg_);
+    }
     return rc;
 }
 
+int zmq::stream_engine_base_t::decode_held_and_push ()
+{
+    if (_mechanism == NULL || !_mechanism->decode_deferred ())
+        return 0;
+
+    if (_mechanism->flush_decode () == -1) {
+        if (errno == EAGAIN)
+            _process_msg = &stream_engine_base_t::push_held;
+        return -1;
+    }
+    return push_held (NULL);
+}
+
+int zmq::stream_engine_base_t::push_held (msg_t *)
+{
+    //  The decoder may have moved on to the frames following the ones held
+    //  back, so their messages are pushed from a message of the engine.
+    while (_held_msg_pending || _mechanism->decode_next (&_held_msg)) {
+        if (!_held_msg_pending) {
+            if (_held_msg.flags () & msg_t::command)
+                process_command_message (&_held_msg);
+            if (_metadata)
+                _held_msg.set_metadata (_metadata);
+            _held_msg_pending = true;
+        }
+        if (_session->push_msg (&_held_msg) == -1) {
+            if (errno == EAGAIN)
+                _process_msg = &stream_engine_base_t::push_held;
+            return -1;
+        }
+        _held_msg_pending = false;
+    }
+    _process_msg = &stream_engine_base_t::decode_and_push;
+    return 0;
+}
+
 int zmq::stream_engine_base_t::pull_msg_from_session (msg_t *msg_)
 {
     return _session->pull_msg (msg_);
@@ -755,7 +1195,12 @@ void zmq::stream_engine_base_t::timer_event (int id_)
 
 int zmq::stream_engine_base_t::read (void *data_, size_t size_)
 {
+#if defined ZMQ_HAVE_IO_URING
+    const int rc = _ring_io ? _ring_io->read (_ring_handle, data_, size_)
+                            : zmq::tcp_read (_s, data_, size_);
+#else
     const int rc = zmq::tcp_read (_s, data_, size_);
+#endif
 
     if (rc == 0) {
         // connection closed by peer
@@ -768,5 +1213,64 @@ int zmq::stream_engine_base_t::read (void *data_, size_t size_)
 
 int zmq::stream_engine_base_t::write (const void *data_, size_t size_)
 {
+#if defined ZMQ_HAVE_IO_URING
+    if (_ring_io)
+        return _ring_io->write (_ring_handle, data_, size_);
+#endif
     return zmq::tcp_write (_s, data_, size_);
 }
+
+void zmq::stream_engine_base_t::rm_fd ()
+{
+#if defined ZMQ_HAVE_IO_URING
+    if (_ring_io) {
+        _ring_io->rm_fd (_ring_handle);
+        return;
+    }
+#endif
+    io_object_t::rm_fd (_handle);
+}
+
+void zmq::stream_engine_base_t::reset_pollin ()
+{
+#if defined ZMQ_HAVE_IO_URING
+    if (_ring_io) {
+        _ring_io->reset_pollin (_ring_handle);
+        return;
+    }
+#endif
+    io_object_t::reset_pollin (_handle);
+}
+
+void zmq::stream_engine_base_t::set_pollin ()
+{
+#if defined ZMQ_HAVE_IO_URING
+    if (_ring_io) {
+        _ring_io->set_pollin (_ring_handle);
+        return;
+    }
+#endif
+    io_object_t::set_pollin (_handle);
+}
+
+void zmq::stream_engine_base_t::reset_pollout ()
+{
+#if defined ZMQ_HAVE_IO_URING
+    if (_ring_io) {
+        _ring_io->reset_pollout (_ring_handle);
+        return;
+    }
+#endif
+    io_object_t::reset_pollout (_handle);
+}
+
+void zmq::stream_engine_base_t::set_pollout ()
+{
+#if defined ZMQ_HAVE_IO_URING
+    if (_ring_io) {
+        _ring_io->set_pollout (_ring_handle);
+        return;
+    }
+#endif
+    io_object_t::set_pollout (_handle);
+}
@@ -15,6 +15,9 @@
 #include "metadata.hpp"
 #include "msg.hpp"
 #include "tcp.hpp"
+#include "uring_io.hpp"
+#include "zerocopy.hpp"
+#include "config.hpp"
 
 namespace zmq
 {
@@ -66,6 +69,18 @@ class stream_engine_base_t : public io_object_t, public i_engine
     virtual int decode_and_push (msg_t *msg_);
     int push_one_then_decode_and_push (msg_t *msg_);
 
+    //  Pushes a decoded message to the session, along with the messages
+    //  decoded from the same frame.
+    int push_decoded (msg_t *msg_);
+
+    //  Decodes the frames the mechanism held back and pushes their messages
+    //  to the session. Called once the input read is decoded.
+    int decode_held_and_push ();
+
+    //  Pushes the messages of the frames the mechanism held back to the
+    //  session, as they are decoded, then resumes with decode_and_push.
+    int push_held (msg_t *);
+
     void set_handshake_timer ();
 
     virtual bool handshake () { return true; };
@@ -95,9 +110,13 @@ class stream_engine_base_t : public io_object_t, public i_engine
     virtual int read (void *data, size_t size_);
     virtual int write (const void *data_, size_t size_);
 
-    void reset_pollout () { io_object_t::reset_pollout (_handle); }
-    void set_pollout () { io_object_t::set_pollout (_handle); }
-    void set_pollin () { io_object_t::set_pollin (_handle); }
+    //  Poll the socket, through the ring its reads and writes are
+    //  submitted to if there is one.
+    void rm_fd ();
+    void reset_pollin ();
+    void set_pollin ();
+    void reset_pollout ();
+    void set_pollout ();
     session_base_t *session () { return _session; }
     socket_base_t *socket () { return _socket; }
 
@@ -111,6 +130,12 @@ class stream_engine_base_t : public io_object_t, public i_engine
     size_t _outsize;
     i_encoder *_encoder;
 
+    //  True iff encoded data may be written with vectored writes that
+    //  reference large message bodies instead of copying them. Only
+    //  engines that use the default write implementation and whose
+    //  encoders hand out message data directly may set this.
+    bool _vectored_output;
+
     mechanism_t *_mechanism;
 
     int (stream_engine_base_t::*_next_msg) (msg_t *msg_);
@@ -119,6 +144,15 @@ class stream_engine_base_t : public io_object_t, public i_engine
     //  Metadata to be attached to received messages. May be NULL.
     metadata_t *_metadata;
 
+    //  Message decoded from the frames the mechanism held back, and whether
+    //  it is still to be pushed to the session.
+    msg_t _held_msg;
+    bool _held_msg_pending;
+
+    //  True iff the mechanism encodes frames ahead of those it is asked
+    //  to encode.
+    bool _encode_ahead;
+
     //  True iff the engine couldn't consume the last decoded message.
     bool _input_stopped;
 
@@ -153,6 +187,72 @@ class stream_engine_base_t : public io_object_t, public i_engine
 
   private:
     bool in_event_internal ();
+    void out_event_internal ();
+
+    //  Retrieves the next frame the mechanism encoded ahead, without
+    //  pulling messages from the session.
+    int pull_encoded_ahead (msg_t *msg_);
+
+    //  Time the writing of each batch of outbound data to the network,
+    //  when latency statistics are enabled.
+    void batch_collected ();
+    void batch_written ();
+
+#if defined ZMQ_HAVE_TCP_WRITEV
+    //  Output handling when _vectored_output is set.
+    void out_event_vectored ();
+
+    //  Collects the next batch of encoded data into _out_iov. Returns
+    //  false if the engine was destroyed in the process.
+    bool fill_out_iov ();
+
+    //  Appends a buffer to _out_iov, merging it with the last one if
+    //  they are adjacent and both are either referenced or copied.
+    void add_out_iov (unsigned char *data_, size_t size_, bool ref_);
+
+    //  Writes the rest of the batch in a single call. Returns -1 on
+    //  error, 1 if all of it was written and 0 otherwise.
+    int write_out_iov ();
+
+    //  Releases the messages referenced by the batch written last.
+    void release_out_refs ();
+
+    //  The batch being written, and the index of its first buffer that
+    //  has not been completely written yet.
+    iovec _out_iov[max_out_iov];
+    int _out_iovcnt;
+    int _out_iovpos;
+
+    //  Messages whose data is referenced from the batch being written,
+    //  including the copied data staged for a zero-copy write.
+    msg_t _out_refs[max_out_iov + 1];
+    int _out_refcnt;
+#endif
+
+#if defined ZMQ_HAVE_TCP_ZEROCOPY
+    //  Moves the copied data of the batch out of the encoder's buffer
+    //  into a message kept along with the referenced ones.
+    void stage_copied_out_iov ();
+
+    //  True iff large batches are sent using MSG_ZEROCOPY.
+    bool _zerocopy;
+
+    //  True iff the batch being written is sent using MSG_ZEROCOPY.
+    bool _out_zerocopy;
+
+    //  Whether each buffer of the batch references message data.
+    bool _out_iov_ref[max_out_iov];
+
+    //  True if some of the batch was written using MSG_ZEROCOPY.
+    bool _out_zerocopied;
+
+    //  Messages referenced by zero-copy writes that have not completed.
+    zerocopy_refs_t _zerocopy_refs;
+
+    //  The I/O thread the socket is left to if the engine is destroyed
+    //  before the writes complete.
+    zmq::io_thread_t *_io_thread;
+#endif
 
     //  Unplug the engine from the session.
     void unplug ();
@@ -166,6 +266,13 @@ class stream_engine_base_t : public io_object_t, public i_engine
 
     handle_t _handle;
 
+#if defined ZMQ_HAVE_IO_URING
+    //  Ring the reads and writes are submitted to, or NULL if they are made
+    //  on the socket once the poller reports it ready.
+    uring_io_t *_ring_io;
+    uring_io_t::handle_t _ring_handle;
+#endif
+
     bool _plugged;
 
     //  When true, we are still trying to determine whether
@@ -187,6 +294,9 @@ class stream_engine_base_t : public io_object_t, public i_engine
     //  when handshake is completed.
     bool _has_handshake_stage;
 
+    //  Time the batch being written was collected, or 0 if it is not timed.
+    uint64_t _out_batch_started;
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (stream_engine_base_t)
 };
 }
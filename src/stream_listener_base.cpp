@@ -6,6 +6,7 @@
 #include "socket_base.hpp"
 #include "zmtp_engine.hpp"
 #include "raw_engine.hpp"
+#include "ip.hpp"
 
 #ifndef ZMQ_HAVE_WINDOWS
 #include <unistd.h>
@@ -21,7 +22,9 @@ zmq::stream_listener_base_t::stream_listener_base_t (
     io_object_t (io_thread_),
     _s (retired_fd),
     _handle (static_cast<handle_t> (NULL)),
-    _socket (socket_)
+    _socket (socket_),
+    _io_thread (io_thread_),
+    _local_sessions (false)
 {
 }
 
@@ -85,7 +88,16 @@ void zmq::stream_listener_base_t::create_engine (fd_t fd_)
 
     //  Choose I/O thread to run connecter in. Given that we are already
     //  running in an I/O thread, there must be at least one available.
-    io_thread_t *io_thread = choose_io_thread (options.affinity);
+    //  With ZMQ_IO_THREAD_LOCALITY, pick the one closest to where the
+    //  connection's packets are received.
+    io_thread_t *io_thread = _io_thread;
+    if (!_local_sessions) {
+        int cpu = -1;
+        unsigned int napi_id = 0;
+        if (options.io_thread_locality)
+            get_incoming_cpu (fd_, &cpu, &napi_id);
+        io_thread = choose_io_thread (options.affinity, cpu, napi_id);
+    }
     zmq_assert (io_thread);
 
     //  Create and launch a session object.
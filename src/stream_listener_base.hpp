@@ -51,6 +51,12 @@ class stream_listener_base_t : public own_t, public io_object_t
     //  Socket the listener belongs to.
     zmq::socket_base_t *_socket;
 
+    //  I/O thread the listener runs in, and whether the sessions of the
+    //  connections it accepts run there too rather than being spread over
+    //  the I/O threads.
+    zmq::io_thread_t *const _io_thread;
+    bool _local_sessions;
+
     // String representation of endpoint to bind to
     std::string _endpoint;
 
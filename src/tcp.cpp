@@ -14,11 +14,16 @@
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <unistd.h>
+#include <string.h>
 #ifdef ZMQ_HAVE_VXWORKS
 #include <sockLib.h>
 #endif
 #endif
 
+#if defined ZMQ_HAVE_TCP_ZEROCOPY
+#include <linux/errqueue.h>
+#endif
+
 #if defined ZMQ_HAVE_OPENVMS
 #include <ioctl.h>
 #endif
@@ -183,6 +188,37 @@ int zmq::tune_tcp_maxrt (fd_t sockfd_, int timeout_)
 #endif
 }
 
+#if !defined ZMQ_HAVE_WINDOWS
+//  Translates the result of a send call to the tcp_write convention.
+static int check_send_result (ssize_t nbytes_)
+{
+    //  Several errors are OK. When speculative write is being done we may not
+    //  be able to write a single byte from the socket. Also, SIGSTOP issued
+    //  by a debugging tool can result in EINTR error.
+    if (nbytes_ == -1
+        && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+        return 0;
+
+    //  Signalise peer failure.
+    if (nbytes_ == -1) {
+#if !defined(TARGET_OS_IPHONE) || !TARGET_OS_IPHONE
+        errno_assert (errno != EACCES && errno != EBADF && errno != EDESTADDRREQ
+                      && errno != EFAULT && errno != EISCONN
+                      && errno != EMSGSIZE && errno != ENOMEM
+                      && errno != ENOTSOCK && errno != EOPNOTSUPP);
+#else
+        errno_assert (errno != EACCES && errno != EDESTADDRREQ
+                      && errno != EFAULT && errno != EISCONN
+                      && errno != EMSGSIZE && errno != ENOMEM
+                      && errno != ENOTSOCK && errno != EOPNOTSUPP);
+#endif
+        return -1;
+    }
+
+    return static_cast<int> (nbytes_);
+}
+#endif
+
 int zmq::tcp_write (fd_t s_, const void *data_, size_t size_)
 {
 #ifdef ZMQ_HAVE_WINDOWS
@@ -212,35 +248,91 @@ int zmq::tcp_write (fd_t s_, const void *data_, size_t size_)
     return nbytes;
 
 #else
-    ssize_t nbytes = send (s_, static_cast<const char *> (data_), size_, 0);
-
-    //  Several errors are OK. When speculative write is being done we may not
-    //  be able to write a single byte from the socket. Also, SIGSTOP issued
-    //  by a debugging tool can result in EINTR error.
-    if (nbytes == -1
-        && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
-        return 0;
+    const ssize_t nbytes =
+      send (s_, static_cast<const char *> (data_), size_, 0);
+    return check_send_result (nbytes);
+#endif
+}
 
-    //  Signalise peer failure.
-    if (nbytes == -1) {
-#if !defined(TARGET_OS_IPHONE) || !TARGET_OS_IPHONE
-        errno_assert (errno != EACCES && errno != EBADF && errno != EDESTADDRREQ
-                      && errno != EFAULT && errno != EISCONN
-                      && errno != EMSGSIZE && errno != ENOMEM
-                      && errno != ENOTSOCK && errno != EOPNOTSUPP);
-#else
-        errno_assert (errno != EACCES && errno != EDESTADDRREQ
-                      && errno != EFAULT && errno != EISCONN
-                      && errno != EMSGSIZE && errno != ENOMEM
-                      && errno != ENOTSOCK && errno != EOPNOTSUPP);
+#if defined ZMQ_HAVE_TCP_WRITEV
+int zmq::tcp_writev (fd_t s_, const struct iovec *iov_, int iovcnt_)
+{
+    //  sendmsg is used rather than writev so that the semantics, including
+    //  the handling of flags, stay the same as those of tcp_write.
+    struct msghdr msg;
+    memset (&msg, 0, sizeof msg);
+    msg.msg_iov = const_cast<struct iovec *> (iov_);
+    msg.msg_iovlen = iovcnt_;
+    const ssize_t nbytes = sendmsg (s_, &msg, 0);
+    return check_send_result (nbytes);
+}
 #endif
-        return -1;
+
+#if defined ZMQ_HAVE_TCP_ZEROCOPY
+int zmq::tcp_enable_zerocopy (fd_t s_)
+{
+    int flag = 1;
+    return setsockopt (s_, SOL_SOCKET, SO_ZEROCOPY, &flag, sizeof flag);
+}
+
+int zmq::tcp_writev_zerocopy (fd_t s_,
+                              const struct iovec *iov_,
+                              int iovcnt_,
+                              bool *zerocopy_)
+{
+    struct msghdr msg;
+    memset (&msg, 0, sizeof msg);
+    msg.msg_iov = const_cast<struct iovec *> (iov_);
+    msg.msg_iovlen = iovcnt_;
+    ssize_t nbytes = sendmsg (s_, &msg, MSG_ZEROCOPY);
+
+    //  The memory for tracking pending completions is exhausted. Rather
+    //  than waiting for some of them to arrive, copy the data.
+    *zerocopy_ = true;
+    if (nbytes == -1 && errno == ENOBUFS) {
+        *zerocopy_ = false;
+        nbytes = sendmsg (s_, &msg, 0);
     }
+    if (nbytes <= 0)
+        *zerocopy_ = false;
+    return check_send_result (nbytes);
+}
 
-    return static_cast<int> (nbytes);
+int zmq::tcp_read_zerocopy_completion (fd_t s_, uint32_t *lo_, uint32_t *hi_)
+{
+    char control[CMSG_SPACE (sizeof (struct sock_extended_err))];
+    struct msghdr msg;
+    memset (&msg, 0, sizeof msg);
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof control;
+
+    while (true) {
+        const ssize_t rc = recvmsg (s_, &msg, MSG_ERRQUEUE | MSG_DONTWAIT);
+        if (rc == -1) {
+            errno_assert (errno == EAGAIN || errno == EWOULDBLOCK
+                          || errno == EINTR);
+            if (errno != EINTR)
+                return -1;
+            continue;
+        }
 
-#endif
+        //  Skip anything that is not a completion of a zero-copy write.
+        for (struct cmsghdr *cm = CMSG_FIRSTHDR (&msg); cm;
+             cm = CMSG_NXTHDR (&msg, cm)) {
+            const struct sock_extended_err *err =
+              reinterpret_cast<const struct sock_extended_err *> (
+                CMSG_DATA (cm));
+            if (err->ee_errno == 0
+                && err->ee_origin == SO_EE_ORIGIN_ZEROCOPY) {
+                *lo_ = err->ee_info;
+                *hi_ = err->ee_data;
+                return 0;
+            }
+        }
+        msg.msg_controllen = sizeof control;
+    }
 }
+#endif
 
 int zmq::tcp_read (fd_t s_, void *data_, size_t size_)
 {
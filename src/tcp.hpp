@@ -4,6 +4,15 @@
 #define __ZMQ_TCP_HPP_INCLUDED__
 
 #include "fd.hpp"
+#include "stdint.hpp"
+
+#if defined ZMQ_HAVE_UIO && !defined ZMQ_HAVE_WINDOWS
+#define ZMQ_HAVE_TCP_WRITEV
+#include <sys/uio.h>
+#if defined ZMQ_HAVE_SO_ZEROCOPY
+#define ZMQ_HAVE_TCP_ZEROCOPY
+#endif
+#endif
 
 namespace zmq
 {
@@ -34,6 +43,34 @@ int tune_tcp_maxrt (fd_t sockfd_, int timeout_);
 //  of error or orderly shutdown by the other peer -1 is returned.
 int tcp_write (fd_t s_, const void *data_, size_t size_);
 
+#if defined ZMQ_HAVE_TCP_WRITEV
+//  Writes the data described by the supplied buffers to the socket in
+//  a single call. Returns as tcp_write does.
+int tcp_writev (fd_t s_, const struct iovec *iov_, int iovcnt_);
+#endif
+
+#if defined ZMQ_HAVE_TCP_ZEROCOPY
+//  Enables zero-copy transmission on the socket. Returns -1 if the
+//  socket does not support it.
+int tcp_enable_zerocopy (fd_t s_);
+
+//  Writes the buffers as tcp_writev does, but lets the kernel send the
+//  data straight from them. The buffers must stay unmodified until the
+//  completion of the write is reported. Each call that writes some data
+//  this way is assigned the next sequence number, starting from zero;
+//  zerocopy_ is set to whether this was the case. If the kernel cannot
+//  track another such write, the data is copied instead.
+int tcp_writev_zerocopy (fd_t s_,
+                         const struct iovec *iov_,
+                         int iovcnt_,
+                         bool *zerocopy_);
+
+//  Reads one completion notification of zero-copy writes from the error
+//  queue of the socket. The writes with sequence numbers from lo_ to hi_
+//  inclusive have completed. Returns -1 if there is no notification.
+int tcp_read_zerocopy_completion (fd_t s_, uint32_t *lo_, uint32_t *hi_);
+#endif
+
 //  Reads data from the socket (up to 'size' bytes).
 //  Returns the number of bytes actually read or -1 on error.
 //  Zero indicates the peer has closed the connection.
@@ -34,9 +34,23 @@
 
 zmq::tcp_listener_t::tcp_listener_t (io_thread_t *io_thread_,
                                      socket_base_t *socket_,
-                                     const options_t &options_) :
+                                     const options_t &options_,
+                                     bool accept_shard_) :
     stream_listener_base_t (io_thread_, socket_, options_)
 {
+    zmq_assert (!accept_shard_ || accept_shards_supported ());
+    _local_sessions = accept_shard_;
+}
+
+bool zmq::tcp_listener_t::accept_shards_supported ()
+{
+    //  Other systems allow binding the same port several times, but don't
+    //  balance the connections between the listeners.
+#if defined ZMQ_HAVE_LINUX && defined SO_REUSEPORT
+    return true;
+#else
+    return false;
+#endif
 }
 
 void zmq::tcp_listener_t::in_event ()
@@ -105,6 +119,14 @@ int zmq::tcp_listener_t::create_socket (const char *addr_)
     errno_assert (rc == 0);
 #endif
 
+    //  Let the other listeners of the address bind to it too.
+#if defined ZMQ_HAVE_LINUX && defined SO_REUSEPORT
+    if (_local_sessions) {
+        rc = setsockopt (_s, SOL_SOCKET, SO_REUSEPORT, &flag, sizeof (int));
+        errno_assert (rc == 0);
+    }
+#endif
+
     //  Bind the socket to the network interface and port.
 #if defined ZMQ_HAVE_VXWORKS
     rc = bind (_s, (sockaddr *) _address.addr (), _address.addrlen ());
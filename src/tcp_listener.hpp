@@ -12,13 +12,21 @@ namespace zmq
 class tcp_listener_t ZMQ_FINAL : public stream_listener_base_t
 {
   public:
+    //  If accept_shard_ is true, the listener is one of several bound to
+    //  the same address with SO_REUSEPORT, and runs the sessions of the
+    //  connections it accepts in its own I/O thread.
     tcp_listener_t (zmq::io_thread_t *io_thread_,
                     zmq::socket_base_t *socket_,
-                    const options_t &options_);
+                    const options_t &options_,
+                    bool accept_shard_ = false);
 
     //  Set address to listen on.
     int set_local_address (const char *addr_);
 
+    //  Returns whether the kernel spreads the connections to an address
+    //  over several listeners bound to it.
+    static bool accept_shards_supported ();
+
   protected:
     std::string get_socket_name (fd_t fd_, socket_end_t socket_end_) const;
 
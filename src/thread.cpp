@@ -4,6 +4,7 @@
 #include "macros.hpp"
 #include "thread.hpp"
 #include "err.hpp"
+#include "atomic_counter.hpp"
 
 #ifdef ZMQ_HAVE_WINDOWS
 #include <winnt.h>
@@ -13,6 +14,13 @@
 #include "pthread.h"
 #endif
 
+#ifdef ZMQ_HAVE_LINUX
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#endif
+
 bool zmq::thread_t::get_started () const
 {
     return _started;
@@ -382,3 +390,52 @@ void zmq::thread_t::
 }
 
 #endif
+
+int zmq::get_current_cpu ()
+{
+#if defined ZMQ_HAVE_LINUX
+    //  Served from the vDSO, without entering the kernel.
+    return sched_getcpu ();
+#else
+    return -1;
+#endif
+}
+
+#if defined ZMQ_HAVE_LINUX
+namespace
+{
+//  The nodes of the CPUs looked up so far, plus two, as they never change.
+//  Zero for CPUs not looked up yet.
+const int max_cached_cpus = 1024;
+zmq::atomic_counter_t cpu_nodes[max_cached_cpus];
+}
+#endif
+
+int zmq::get_cpu_node (int cpu_)
+{
+#if defined ZMQ_HAVE_LINUX
+    const bool cached = cpu_ >= 0 && cpu_ < max_cached_cpus;
+    if (cached && cpu_nodes[cpu_].get () != 0)
+        return static_cast<int> (cpu_nodes[cpu_].get ()) - 2;
+
+    //  The directory of each CPU links to the node it belongs to.
+    char path[64];
+    snprintf (path, sizeof path, "/sys/devices/system/cpu/cpu%d", cpu_);
+    DIR *dir = opendir (path);
+    if (!dir)
+        return -1;
+    int node = -1;
+    const struct dirent *entry;
+    while (node == -1 && (entry = readdir (dir)) != NULL)
+        if (strncmp (entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0'
+            && entry->d_name[4] <= '9')
+            node = atoi (entry->d_name + 4);
+    closedir (dir);
+    if (cached)
+        cpu_nodes[cpu_].set (node + 2);
+    return node;
+#else
+    LIBZMQ_UNUSED (cpu_);
+    return -1;
+#endif
+}
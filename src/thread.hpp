@@ -104,6 +104,14 @@ class thread_t
 
     ZMQ_NON_COPYABLE_NOR_MOVABLE (thread_t)
 };
+
+//  Returns the CPU the calling thread runs on, or -1 if unknown. Only
+//  implemented on Linux.
+int get_current_cpu ();
+
+//  Returns the NUMA node of the given CPU, or -1 if unknown. Nodes are
+//  looked up once per CPU.
+int get_cpu_node (int cpu_);
 }
 
 #endif
@@ -0,0 +1,256 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include "timer_wheel.hpp"
+#include "err.hpp"
+
+#if defined _MSC_VER && defined _WIN64
+#include <intrin.h>
+#endif
+
+namespace
+{
+//  Null link of the lists of nodes.
+const uint32_t nil = 0xffffffff;
+
+//  Index of the lowest bit set in a non-zero bitmap.
+int lowest_bit (uint64_t bits_)
+{
+#if defined __GNUC__
+    return __builtin_ctzll (bits_);
+#elif defined _MSC_VER && defined _WIN64
+    unsigned long index;
+    _BitScanForward64 (&index, bits_);
+    return static_cast<int> (index);
+#else
+    int index = 0;
+    while (!(bits_ & 1)) {
+        bits_ >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+}
+
+zmq::timer_wheel_t::timer_wheel_t () : _free (nil), _tick (0), _count (0)
+{
+    for (int i = 0; i != levels * slots; ++i)
+        _heads[i] = nil;
+    for (int i = 0; i != levels; ++i)
+        _occupied[i] = 0;
+}
+
+void zmq::timer_wheel_t::add (uint64_t now_,
+                              uint64_t expiration_,
+                              void *sink_,
+                              int id_)
+{
+    //  An empty wheel can skip to the present without moving any timers.
+    if (_count == 0 && now_ > _tick)
+        _tick = now_;
+
+    if (_count >= _buckets.size ())
+        grow_buckets ();
+
+    uint32_t node;
+    if (_free != nil) {
+        node = _free;
+        _free = _nodes[node].next;
+    } else {
+        zmq_assert (_nodes.size () < nil);
+        node = static_cast<uint32_t> (_nodes.size ());
+        _nodes.push_back (node_t ());
+    }
+
+    node_t &n = _nodes[node];
+    n.expiration = expiration_;
+    n.sink = sink_;
+    n.id = id_;
+    uint32_t &head = bucket (sink_, id_);
+    n.hash_next = head;
+    head = node;
+    link (node);
+    ++_count;
+}
+
+bool zmq::timer_wheel_t::cancel (void *sink_, int id_)
+{
+    if (_count == 0)
+        return false;
+
+    //  Of several timers with the same sink and id, cancel the first to
+    //  expire.
+    uint32_t found = nil;
+    for (uint32_t node = bucket (sink_, id_); node != nil;
+         node = _nodes[node].hash_next) {
+        const node_t &n = _nodes[node];
+        if (n.sink == sink_ && n.id == id_
+            && (found == nil || n.expiration < _nodes[found].expiration))
+            found = node;
+    }
+    if (found == nil)
+        return false;
+
+    unlink (found);
+    release (found);
+    return true;
+}
+
+bool zmq::timer_wheel_t::expire (uint64_t now_, void **sink_, int *id_)
+{
+    advance (now_);
+    if (_count == 0 || _tick > now_)
+        return false;
+    const uint32_t node = _heads[_tick & (slots - 1)];
+    if (node == nil)
+        return false;
+    *sink_ = _nodes[node].sink;
+    *id_ = _nodes[node].id;
+    unlink (node);
+    release (node);
+    return true;
+}
+
+void zmq::timer_wheel_t::advance (uint64_t now_)
+{
+    //  Skip to the next tick with timers to expire or to move down, until
+    //  there are timers due.
+    while (_count != 0 && _heads[_tick & (slots - 1)] == nil) {
+        const uint64_t due = next_due ();
+        if (due > now_)
+            return;
+        _tick = due;
+        for (int level = 1; level != levels; ++level) {
+            const uint64_t mask = (uint64_t (1) << (slot_bits * level)) - 1;
+            if (_tick & mask)
+                break;
+            cascade (level);
+        }
+    }
+}
+
+uint64_t zmq::timer_wheel_t::next_due () const
+{
+    zmq_assert (_count != 0);
+    if (_heads[_tick & (slots - 1)] != nil)
+        return _tick;
+
+    //  For each level, find the first slot with timers after the one the
+    //  wheel is in. The wheel reaches it at the start of the slot.
+    uint64_t due = 0;
+    for (int level = 0; level != levels; ++level) {
+        const uint64_t occupied = _occupied[level];
+        if (!occupied)
+            continue;
+        const int shift = slot_bits * level;
+        const uint64_t first = (_tick >> shift) + 1;
+        const int index = static_cast<int> (first & (slots - 1));
+        const uint64_t rotated =
+          index ? (occupied >> index) | (occupied << (slots - index))
+                : occupied;
+        const uint64_t tick = (first + lowest_bit (rotated)) << shift;
+        if (!due || tick < due)
+            due = tick;
+    }
+    return due;
+}
+
+void zmq::timer_wheel_t::link (uint32_t node_)
+{
+    node_t &n = _nodes[node_];
+
+    //  Timers due already go to the slot the wheel is in. Timers beyond the
+    //  range of the wheel go to the last level and are moved back there
+    //  until they come in range.
+    int slot;
+    if (n.expiration <= _tick)
+        slot = static_cast<int> (_tick & (slots - 1));
+    else {
+        const uint64_t max_delta = (uint64_t (1) << (slot_bits * levels)) - 1;
+        const uint64_t delta = n.expiration - _tick;
+        const uint64_t expiration =
+          delta > max_delta ? _tick + max_delta : n.expiration;
+        int level = 0;
+        while ((delta >> (slot_bits * (level + 1))) && level != levels - 1)
+            ++level;
+        slot = level * slots
+               + static_cast<int> ((expiration >> (slot_bits * level))
+                                   & (slots - 1));
+    }
+
+    n.slot = static_cast<uint32_t> (slot);
+    n.prev = nil;
+    n.next = _heads[slot];
+    if (n.next != nil)
+        _nodes[n.next].prev = node_;
+    _heads[slot] = node_;
+    _occupied[slot / slots] |= uint64_t (1) << (slot % slots);
+}
+
+void zmq::timer_wheel_t::unlink (uint32_t node_)
+{
+    const node_t &n = _nodes[node_];
+    if (n.prev != nil)
+        _nodes[n.prev].next = n.next;
+    else {
+        _heads[n.slot] = n.next;
+        if (n.next == nil)
+            _occupied[n.slot / slots] &= ~(uint64_t (1) << (n.slot % slots));
+    }
+    if (n.next != nil)
+        _nodes[n.next].prev = n.prev;
+}
+
+void zmq::timer_wheel_t::cascade (int level_)
+{
+    const int index =
+      static_cast<int> ((_tick >> (slot_bits * level_)) & (slots - 1));
+    const int slot = level_ * slots + index;
+    uint32_t node = _heads[slot];
+    _heads[slot] = nil;
+    _occupied[level_] &= ~(uint64_t (1) << index);
+    while (node != nil) {
+        const uint32_t next = _nodes[node].next;
+        link (node);
+        node = next;
+    }
+}
+
+void zmq::timer_wheel_t::release (uint32_t node_)
+{
+    node_t &n = _nodes[node_];
+    uint32_t *link = &bucket (n.sink, n.id);
+    while (*link != node_)
+        link = &_nodes[*link].hash_next;
+    *link = n.hash_next;
+
+    n.slot = nil;
+    n.next = _free;
+    _free = node_;
+    --_count;
+}
+
+uint32_t &zmq::timer_wheel_t::bucket (void *sink_, int id_)
+{
+    const uint64_t id = static_cast<uint32_t> (id_);
+    uint64_t hash = reinterpret_cast<uintptr_t> (sink_) ^ (id << 32);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return _buckets[static_cast<size_t> (hash) & (_buckets.size () - 1)];
+}
+
+void zmq::timer_wheel_t::grow_buckets ()
+{
+    _buckets.assign (_buckets.empty () ? 16 : _buckets.size () * 2, nil);
+    for (uint32_t node = 0, size = static_cast<uint32_t> (_nodes.size ());
+         node != size; ++node) {
+        node_t &n = _nodes[node];
+        if (n.slot != nil) {
+            uint32_t &head = bucket (n.sink, n.id);
+            n.hash_next = head;
+            head = node;
+        }
+    }
+}
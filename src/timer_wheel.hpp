@@ -0,0 +1,113 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_TIMER_WHEEL_HPP_INCLUDED__
+#define __ZMQ_TIMER_WHEEL_HPP_INCLUDED__
+
+#include <stddef.h>
+#include <vector>
+
+#include "macros.hpp"
+#include "stdint.hpp"
+
+namespace zmq
+{
+//  Hierarchical timing wheel with a resolution of one millisecond. Timers
+//  are identified by a sink and an id, as in the poller concept. Adding,
+//  cancelling and expiring a timer take constant time, and no memory is
+//  allocated once the wheel has held as many timers as it holds at once.
+//
+//  Each of the levels has 64 slots, a slot of level L covering 64^L ms.
+//  A timer is put on the lowest level that covers its expiration, and moved
+//  down a level when the wheel reaches its slot, until it expires from the
+//  lowest level. Times are in milliseconds of an arbitrary monotonic clock.
+
+class timer_wheel_t
+{
+  public:
+    timer_wheel_t ();
+
+    //  Adds a timer expiring at the given time, now_ being the current time.
+    void add (uint64_t now_, uint64_t expiration_, void *sink_, int id_);
+
+    //  Cancels the timer with the given sink and id, the one expiring first
+    //  if there are several of them. Returns false if there is none.
+    bool cancel (void *sink_, int id_);
+
+    bool empty () const { return _count == 0; }
+
+    size_t size () const { return _count; }
+
+    //  Removes a timer that has expired by now_, returning its sink and id.
+    //  Returns false if no timer has expired. Timers expire in the order of
+    //  their expiration times, rounded to milliseconds.
+    bool expire (uint64_t now_, void **sink_, int *id_);
+
+    //  Moves the wheel up to now_ without expiring any timer, so that
+    //  next_due returns the next expiration, or at least a later time.
+    void advance (uint64_t now_);
+
+    //  Returns the time by which expire should be called again, which may
+    //  be earlier than the next expiration. The wheel must not be empty.
+    uint64_t next_due () const;
+
+  private:
+    enum
+    {
+        slot_bits = 6,
+        slots = 1 << slot_bits,
+        levels = 6
+    };
+
+    struct node_t
+    {
+        uint64_t expiration;
+        void *sink;
+        int id;
+
+        //  Slot the node is in, as level * slots + index, or a null link if
+        //  the node is free.
+        uint32_t slot;
+
+        //  Links of the doubly linked list of the slot, or the free list.
+        uint32_t prev;
+        uint32_t next;
+
+        //  Link of the list of the hash bucket.
+        uint32_t hash_next;
+    };
+
+    //  Puts the node in the slot its expiration falls into.
+    void link (uint32_t node_);
+    void unlink (uint32_t node_);
+
+    //  Moves the timers of a slot to the lower levels.
+    void cascade (int level_);
+
+    //  Removes the node from its hash bucket and frees it.
+    void release (uint32_t node_);
+
+    uint32_t &bucket (void *sink_, int id_);
+    void grow_buckets ();
+
+    std::vector<node_t> _nodes;
+    uint32_t _free;
+
+    //  Heads of the lists of the slots, and for each level a bitmap of the
+    //  slots that are not empty.
+    uint32_t _heads[levels * slots];
+    uint64_t _occupied[levels];
+
+    //  Hash buckets, each the head of a list of nodes.
+    std::vector<uint32_t> _buckets;
+
+    //  The tick the wheel is at. Its slot holds the timers that are due.
+    uint64_t _tick;
+
+    //  Number of timers.
+    size_t _count;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (timer_wheel_t)
+};
+}
+
+#endif
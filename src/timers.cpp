@@ -4,7 +4,7 @@
 #include "timers.hpp"
 #include "err.hpp"
 
-#include <algorithm>
+#include <limits.h>
 
 zmq::timers_t::timers_t () : _tag (0xCAFEDADA), _next_timer_id (0)
 {
@@ -28,130 +28,129 @@ int zmq::timers_t::add (size_t interval_, timers_timer_fn handler_, void *arg_)
         return -1;
     }
 
-    uint64_t when = _clock.now_ms () + interval_;
-    timer_t timer = {++_next_timer_id, interval_, handler_, arg_};
-    _timers.insert (timersmap_t::value_type (when, timer));
-
-    return timer.timer_id;
+    //  Ids increase with each timer added. Once they run out, they start
+    //  over from 1, skipping the ones of timers still live.
+    if (_timers.size () == static_cast<size_t> (INT_MAX)) {
+        errno = ENOMEM;
+        return -1;
+    }
+    do
+        _next_timer_id = _next_timer_id == INT_MAX ? 1 : _next_timer_id + 1;
+    while (_timers.contains (static_cast<uint32_t> (_next_timer_id)));
+
+    timer_t timer;
+    timer.interval = interval_;
+    timer.handler = handler_;
+    timer.arg = arg_;
+    timer.scheduled = false;
+    const bool inserted =
+      _timers.insert (static_cast<uint32_t> (_next_timer_id), timer);
+    zmq_assert (inserted);
+    schedule (_next_timer_id, *find (_next_timer_id), _clock.now_ms ());
+
+    return _next_timer_id;
 }
 
-struct zmq::timers_t::match_by_id
+zmq::timers_t::timer_t *zmq::timers_t::find (int timer_id_)
 {
-    match_by_id (int timer_id_) : _timer_id (timer_id_) {}
+    if (timer_id_ <= 0)
+        return NULL;
+    return _timers.find (static_cast<uint32_t> (timer_id_));
+}
 
-    bool operator() (timersmap_t::value_type const &entry_) const
-    {
-        return entry_.second.timer_id == _timer_id;
+void zmq::timers_t::schedule (int timer_id_, timer_t &timer_, uint64_t now_)
+{
+    if (timer_.scheduled) {
+        const bool cancelled = _wheel.cancel (this, timer_id_);
+        zmq_assert (cancelled);
     }
-
-  private:
-    int _timer_id;
-};
+    //  Intervals too long to be represented never expire.
+    const uint64_t never = ~static_cast<uint64_t> (0);
+    const uint64_t expiration =
+      timer_.interval < never - now_ ? now_ + timer_.interval : never;
+    _wheel.add (now_, expiration, this, timer_id_);
+    timer_.scheduled = true;
+}
 
 int zmq::timers_t::cancel (int timer_id_)
 {
-    // check first if timer exists at all
-    if (_timers.end ()
-        == std::find_if (_timers.begin (), _timers.end (),
-                         match_by_id (timer_id_))) {
+    timer_t *const timer = find (timer_id_);
+    if (!timer) {
         errno = EINVAL;
         return -1;
     }
 
-    // check if timer was already canceled
-    if (_cancelled_timers.count (timer_id_)) {
-        errno = EINVAL;
-        return -1;
+    if (timer->scheduled) {
+        const bool cancelled = _wheel.cancel (this, timer_id_);
+        zmq_assert (cancelled);
     }
-
-    _cancelled_timers.insert (timer_id_);
+    _timers.erase (static_cast<uint32_t> (timer_id_));
 
     return 0;
 }
 
 int zmq::timers_t::set_interval (int timer_id_, size_t interval_)
 {
-    const timersmap_t::iterator end = _timers.end ();
-    const timersmap_t::iterator it =
-      std::find_if (_timers.begin (), end, match_by_id (timer_id_));
-    if (it != end) {
-        timer_t timer = it->second;
-        timer.interval = interval_;
-        uint64_t when = _clock.now_ms () + interval_;
-        _timers.erase (it);
-        _timers.insert (timersmap_t::value_type (when, timer));
-
-        return 0;
+    timer_t *const timer = find (timer_id_);
+    if (!timer) {
+        errno = EINVAL;
+        return -1;
     }
 
-    errno = EINVAL;
-    return -1;
+    timer->interval = interval_;
+    schedule (timer_id_, *timer, _clock.now_ms ());
+    return 0;
 }
 
 int zmq::timers_t::reset (int timer_id_)
 {
-    const timersmap_t::iterator end = _timers.end ();
-    const timersmap_t::iterator it =
-      std::find_if (_timers.begin (), end, match_by_id (timer_id_));
-    if (it != end) {
-        timer_t timer = it->second;
-        uint64_t when = _clock.now_ms () + timer.interval;
-        _timers.erase (it);
-        _timers.insert (timersmap_t::value_type (when, timer));
-
-        return 0;
+    timer_t *const timer = find (timer_id_);
+    if (!timer) {
+        errno = EINVAL;
+        return -1;
     }
 
-    errno = EINVAL;
-    return -1;
+    schedule (timer_id_, *timer, _clock.now_ms ());
+    return 0;
 }
 
 long zmq::timers_t::timeout ()
 {
     const uint64_t now = _clock.now_ms ();
-    long res = -1;
-
-    const timersmap_t::iterator begin = _timers.begin ();
-    const timersmap_t::iterator end = _timers.end ();
-    timersmap_t::iterator it = begin;
-    for (; it != end; ++it) {
-        if (0 == _cancelled_timers.erase (it->second.timer_id)) {
-            //  Live timer, lets return the timeout
-            res = std::max (static_cast<long> (it->first - now), 0l);
-            break;
-        }
-    }
 
-    //  Remove timed-out timers
-    _timers.erase (begin, it);
-
-    return res;
+    //  Timers in the wheel are live, as cancelled ones are removed.
+    _wheel.advance (now);
+    if (_wheel.empty ())
+        return -1;
+    const uint64_t due = _wheel.next_due ();
+    return due > now ? static_cast<long> (due - now) : 0;
 }
 
 int zmq::timers_t::execute ()
 {
     const uint64_t now = _clock.now_ms ();
 
-    const timersmap_t::iterator begin = _timers.begin ();
-    const timersmap_t::iterator end = _timers.end ();
-    timersmap_t::iterator it = _timers.begin ();
-    for (; it != end; ++it) {
-        if (0 == _cancelled_timers.erase (it->second.timer_id)) {
-            //  Timer is not cancelled
-
-            //  Map is ordered, if we have to wait for current timer we can stop.
-            if (it->first > now)
-                break;
-
-            const timer_t &timer = it->second;
+    //  Take the expired timers out of the wheel first, so that timers
+    //  restarted by handlers don't expire again in this call.
+    _expired.clear ();
+    void *sink;
+    int timer_id;
+    while (_wheel.expire (now, &sink, &timer_id)) {
+        find (timer_id)->scheduled = false;
+        _expired.push_back (timer_id);
+    }
 
-            timer.handler (timer.timer_id, timer.arg);
+    for (size_t i = 0, size = _expired.size (); i != size; ++i) {
+        //  Handlers may cancel, restart or add timers.
+        const timer_t *timer = find (_expired[i]);
+        if (!timer || timer->scheduled)
+            continue;
+        timer->handler (_expired[i], timer->arg);
 
-            _timers.insert (
-              timersmap_t::value_type (now + timer.interval, timer));
-        }
+        timer_t *const restarted = find (_expired[i]);
+        if (restarted && !restarted->scheduled)
+            schedule (_expired[i], *restarted, now);
     }
-    _timers.erase (begin, it);
 
     return 0;
 }
@@ -4,10 +4,11 @@
 #define __ZMQ_TIMERS_HPP_INCLUDED__
 
 #include <stddef.h>
-#include <map>
-#include <set>
+#include <vector>
 
 #include "clock.hpp"
+#include "hash_map.hpp"
+#include "timer_wheel.hpp"
 
 namespace zmq
 {
@@ -25,12 +26,10 @@ class timers_t
     int add (size_t interval_, timers_timer_fn handler_, void *arg_);
 
     //  Set the interval of the timer.
-    //  This method is slow, cancelling exsting and adding a new timer yield better performance.
     //  Returns 0 on success and -1 on error.
     int set_interval (int timer_id_, size_t interval_);
 
     //  Reset the timer.
-    //  This method is slow, cancelling exsting and adding a new timer yield better performance.
     //  Returns 0 on success and -1 on error.
     int reset (int timer_id_);
 
@@ -38,7 +37,8 @@ class timers_t
     //  Returns 0 on success and -1 on error.
     int cancel (int timer_id_);
 
-    //  Returns the time in millisecond until the next timer.
+    //  Returns the time in millisecond until the next timer, or less when
+    //  the next timer is far in the future.
     //  Returns -1 if no timer is due.
     long timeout ();
 
@@ -53,26 +53,34 @@ class timers_t
     //  Used to check whether the object is a timers class.
     uint32_t _tag;
 
-    int _next_timer_id;
-
     //  Clock instance.
     clock_t _clock;
 
     typedef struct timer_t
     {
-        int timer_id;
         size_t interval;
         timers_timer_fn *handler;
         void *arg;
+
+        //  False while the handler of an expired timer runs.
+        bool scheduled;
     } timer_t;
 
-    typedef std::multimap<uint64_t, timer_t> timersmap_t;
-    timersmap_t _timers;
+    //  Returns the timer with the given id, or NULL if there is none.
+    timer_t *find (int timer_id_);
+
+    //  Starts the timer over from now_.
+    void schedule (int timer_id_, timer_t &timer_, uint64_t now_);
+
+    //  Live timers by id. Ids increase with each timer added, so that the
+    //  id of a cancelled timer does not refer to another one.
+    hash_map_t<uint32_t, timer_t> _timers;
+    int _next_timer_id;
 
-    typedef std::set<int> cancelled_timers_t;
-    cancelled_timers_t _cancelled_timers;
+    timer_wheel_t _wheel;
 
-    struct match_by_id;
+    //  Ids of the timers expired by execute, kept to avoid allocations.
+    std::vector<int> _expired;
 
     ZMQ_NON_COPYABLE_NOR_MOVABLE (timers_t)
 };
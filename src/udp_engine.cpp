@@ -1,6 +1,9 @@
 /* SPDX-License-Identifier: MPL-2.0 */
 
 #include "precompiled.hpp"
+#include "macros.hpp"
+
+#include <new>
 
 #if !defined ZMQ_HAVE_WINDOWS
 #include <sys/types.h>
@@ -35,6 +38,14 @@ zmq::udp_engine_t::udp_engine_t (const options_t &options_) :
     _handle (static_cast<handle_t> (NULL)),
     _address (NULL),
     _options (options_),
+#if defined ZMQ_HAVE_UDP_MMSG
+    _out_batch (NULL),
+    _in_batch (NULL),
+    _out_count (0),
+    _out_pos (0),
+    _in_count (0),
+    _in_pos (0),
+#endif
     _send_enabled (false),
     _recv_enabled (false)
 {
@@ -54,7 +65,30 @@ zmq::udp_engine_t::~udp_engine_t ()
 #endif
         _fd = retired_fd;
     }
+
+#if defined ZMQ_HAVE_UDP_MMSG
+    LIBZMQ_DELETE (_out_batch);
+    LIBZMQ_DELETE (_in_batch);
+#endif
+}
+
+#if defined ZMQ_HAVE_UDP_MMSG
+zmq::udp_engine_t::mmsg_batch_t *zmq::udp_engine_t::alloc_batch ()
+{
+    mmsg_batch_t *const batch = new (std::nothrow) mmsg_batch_t;
+    alloc_assert (batch);
+
+    memset (batch->hdrs, 0, sizeof batch->hdrs);
+    for (int i = 0; i < udp_batch_size; ++i) {
+        batch->iov[i].iov_base = batch->buffers[i];
+        batch->iov[i].iov_len = MAX_UDP_MSG;
+        batch->hdrs[i].msg_hdr.msg_name = &batch->addresses[i];
+        batch->hdrs[i].msg_hdr.msg_iov = &batch->iov[i];
+        batch->hdrs[i].msg_hdr.msg_iovlen = 1;
+    }
+    return batch;
 }
+#endif
 
 int zmq::udp_engine_t::init (address_t *address_, bool send_, bool recv_)
 {
@@ -71,6 +105,12 @@ int zmq::udp_engine_t::init (address_t *address_, bool send_, bool recv_)
 
     unblock_socket (_fd);
 
+#if defined ZMQ_HAVE_UDP_MMSG
+    if (_send_enabled)
+        _out_batch = alloc_batch ();
+    if (_recv_enabled)
+        _in_batch = alloc_batch ();
+#endif
     return 0;
 }
 
@@ -407,13 +447,15 @@ int zmq::udp_engine_t::resolve_raw_address (const char *name_, size_t length_)
     return 0;
 }
 
-void zmq::udp_engine_t::out_event ()
+int zmq::udp_engine_t::prepare_datagram (char *buffer_, size_t *size_)
 {
-    msg_t group_msg;
-    int rc = _session->pull_msg (&group_msg);
-    errno_assert (rc == 0 || (rc == -1 && errno == EAGAIN));
+    while (true) {
+        msg_t group_msg;
+        int rc = _session->pull_msg (&group_msg);
+        errno_assert (rc == 0 || (rc == -1 && errno == EAGAIN));
+        if (rc != 0)
+            return -1;
 
-    if (rc == 0) {
         msg_t body_msg;
         rc = _session->pull_msg (&body_msg);
         //  If there's a group, there should also be a body
@@ -421,7 +463,6 @@ void zmq::udp_engine_t::out_event ()
 
         const size_t group_size = group_msg.size ();
         const size_t body_size = body_msg.size ();
-        size_t size;
 
         if (_options.raw_socket) {
             rc = resolve_raw_address (static_cast<char *> (group_msg.data ()),
@@ -435,52 +476,108 @@ void zmq::udp_engine_t::out_event ()
                 rc = body_msg.close ();
                 errno_assert (rc == 0);
 
-                return;
+                continue;
             }
 
-            size = body_size;
+            *size_ = body_size;
 
-            memcpy (_out_buffer, body_msg.data (), body_size);
+            memcpy (buffer_, body_msg.data (), body_size);
         } else {
-            size = group_size + body_size + 1;
+            *size_ = group_size + body_size + 1;
 
             // TODO: check if larger than maximum size
-            _out_buffer[0] = static_cast<unsigned char> (group_size);
-            memcpy (_out_buffer + 1, group_msg.data (), group_size);
-            memcpy (_out_buffer + 1 + group_size, body_msg.data (), body_size);
+            buffer_[0] = static_cast<unsigned char> (group_size);
+            memcpy (buffer_ + 1, group_msg.data (), group_size);
+            memcpy (buffer_ + 1 + group_size, body_msg.data (), body_size);
         }
 
         rc = group_msg.close ();
         errno_assert (rc == 0);
 
-        body_msg.close ();
+        rc = body_msg.close ();
         errno_assert (rc == 0);
 
-#ifdef ZMQ_HAVE_WINDOWS
-        rc = sendto (_fd, _out_buffer, static_cast<int> (size), 0, _out_address,
-                     _out_address_len);
-#elif defined ZMQ_HAVE_VXWORKS
-        rc = sendto (_fd, reinterpret_cast<caddr_t> (_out_buffer), size, 0,
-                     (sockaddr *) _out_address, _out_address_len);
-#else
-        rc = sendto (_fd, _out_buffer, size, 0, _out_address, _out_address_len);
-#endif
+        return 0;
+    }
+}
+
+void zmq::udp_engine_t::out_event ()
+{
+#if defined ZMQ_HAVE_UDP_MMSG
+    //  Collect as many datagrams as a single call can send, unless some
+    //  are left over from the last time the socket was full.
+    if (_out_pos == _out_count) {
+        _out_count = 0;
+        _out_pos = 0;
+        for (; _out_count < udp_batch_size; ++_out_count) {
+            size_t size;
+            if (prepare_datagram (_out_batch->buffers[_out_count], &size)
+                == -1)
+                break;
+
+            _out_batch->iov[_out_count].iov_len = size;
+            msghdr &hdr = _out_batch->hdrs[_out_count].msg_hdr;
+            if (_options.raw_socket) {
+                memcpy (&_out_batch->addresses[_out_count], &_raw_address,
+                        sizeof _raw_address);
+                hdr.msg_name = &_out_batch->addresses[_out_count];
+            } else
+                hdr.msg_name = const_cast<sockaddr *> (_out_address);
+            hdr.msg_namelen = _out_address_len;
+        }
+
+        if (_out_count == 0) {
+            reset_pollout (_handle);
+            return;
+        }
+    }
+
+    //  The datagrams the socket does not take now are sent on the next
+    //  POLLOUT.
+    while (_out_pos < _out_count) {
+        const int rc =
+          sendmmsg (_fd, _out_batch->hdrs + _out_pos,
+                    static_cast<unsigned int> (_out_count - _out_pos), 0);
         if (rc < 0) {
-#ifdef ZMQ_HAVE_WINDOWS
-            if (WSAGetLastError () != WSAEWOULDBLOCK) {
+            if (errno != EWOULDBLOCK) {
                 assert_success_or_recoverable (_fd, rc);
                 error (connection_error);
             }
+            return;
+        }
+        _out_pos += rc;
+    }
 #else
-            if (rc != EWOULDBLOCK) {
-                assert_success_or_recoverable (_fd, rc);
-                error (connection_error);
-            }
+    size_t size;
+    if (prepare_datagram (_out_buffer, &size) == -1) {
+        reset_pollout (_handle);
+        return;
+    }
+
+#ifdef ZMQ_HAVE_WINDOWS
+    const int rc = sendto (_fd, _out_buffer, static_cast<int> (size), 0,
+                           _out_address, _out_address_len);
+#elif defined ZMQ_HAVE_VXWORKS
+    const int rc = sendto (_fd, reinterpret_cast<caddr_t> (_out_buffer), size,
+                           0, (sockaddr *) _out_address, _out_address_len);
+#else
+    const int rc = static_cast<int> (
+      sendto (_fd, _out_buffer, size, 0, _out_address, _out_address_len));
 #endif
+    if (rc < 0) {
+#ifdef ZMQ_HAVE_WINDOWS
+        if (WSAGetLastError () != WSAEWOULDBLOCK) {
+            assert_success_or_recoverable (_fd, rc);
+            error (connection_error);
         }
-    } else {
-        reset_pollout (_handle);
+#else
+        if (errno != EWOULDBLOCK) {
+            assert_success_or_recoverable (_fd, rc);
+            error (connection_error);
+        }
+#endif
     }
+#endif
 }
 
 const zmq::endpoint_uri_pair_t &zmq::udp_engine_t::get_endpoint () const
@@ -503,6 +600,36 @@ void zmq::udp_engine_t::restart_output ()
 
 void zmq::udp_engine_t::in_event ()
 {
+#if defined ZMQ_HAVE_UDP_MMSG
+    //  Receive as many datagrams as are available, up to the batch size,
+    //  unless some are left over from the last time the pipe was full.
+    if (_in_pos == _in_count) {
+        for (int i = 0; i < udp_batch_size; ++i)
+            _in_batch->hdrs[i].msg_hdr.msg_namelen =
+              static_cast<socklen_t> (sizeof (sockaddr_storage));
+
+        const int count =
+          recvmmsg (_fd, _in_batch->hdrs, udp_batch_size, 0, NULL);
+        if (count < 0) {
+            if (errno != EWOULDBLOCK) {
+                assert_success_or_recoverable (_fd, count);
+                error (connection_error);
+            }
+            return;
+        }
+        _in_count = count;
+        _in_pos = 0;
+    }
+
+    //  The datagram that does not fit into the pipe, and those after it,
+    //  are pushed once the session restarts the input.
+    while (_in_pos < _in_count
+           && process_datagram (
+             _in_batch->buffers[_in_pos],
+             static_cast<int> (_in_batch->hdrs[_in_pos].msg_len),
+             _in_batch->addresses[_in_pos]))
+        ++_in_pos;
+#else
     sockaddr_storage in_address;
     zmq_socklen_t in_addrlen =
       static_cast<zmq_socklen_t> (sizeof (sockaddr_storage));
@@ -518,7 +645,7 @@ void zmq::udp_engine_t::in_event ()
             error (connection_error);
         }
 #else
-        if (nbytes != EWOULDBLOCK) {
+        if (errno != EWOULDBLOCK) {
             assert_success_or_recoverable (_fd, nbytes);
             error (connection_error);
         }
@@ -526,22 +653,33 @@ void zmq::udp_engine_t::in_event ()
         return;
     }
 
+    if (!process_datagram (_in_buffer, nbytes, in_address))
+        return;
+#endif
+    _session->flush ();
+}
+
+bool zmq::udp_engine_t::process_datagram (const char *data_,
+                                          int nbytes_,
+                                          const sockaddr_storage &address_)
+{
     int rc;
     int body_size;
     int body_offset;
     msg_t msg;
 
     if (_options.raw_socket) {
-        zmq_assert (in_address.ss_family == AF_INET);
-        sockaddr_to_msg (&msg, reinterpret_cast<sockaddr_in *> (&in_address));
+        zmq_assert (address_.ss_family == AF_INET);
+        sockaddr_to_msg (&msg,
+                         reinterpret_cast<const sockaddr_in *> (&address_));
 
-        body_size = nbytes;
+        body_size = nbytes_;
         body_offset = 0;
     } else {
         // TODO in out_event, the group size is an *unsigned* char. what is
         // the maximum value?
-        const char *group_buffer = _in_buffer + 1;
-        const int group_size = _in_buffer[0];
+        const char *group_buffer = data_ + 1;
+        const int group_size = data_[0];
 
         rc = msg.init_size (group_size);
         errno_assert (rc == 0);
@@ -549,10 +687,10 @@ void zmq::udp_engine_t::in_event ()
         memcpy (msg.data (), group_buffer, group_size);
 
         //  This doesn't fit, just ignore
-        if (nbytes - 1 < group_size)
-            return;
+        if (nbytes_ - 1 < group_size)
+            return true;
 
-        body_size = nbytes - 1 - group_size;
+        body_size = nbytes_ - 1 - group_size;
         body_offset = 1 + group_size;
     }
     // Push group description to session
@@ -565,14 +703,14 @@ void zmq::udp_engine_t::in_event ()
         errno_assert (rc == 0);
 
         reset_pollin (_handle);
-        return;
+        return false;
     }
 
     rc = msg.close ();
     errno_assert (rc == 0);
     rc = msg.init_size (body_size);
     errno_assert (rc == 0);
-    memcpy (msg.data (), _in_buffer + body_offset, body_size);
+    memcpy (msg.data (), data_ + body_offset, body_size);
 
     // Push message body to session
     rc = _session->push_msg (&msg);
@@ -583,12 +721,12 @@ void zmq::udp_engine_t::in_event ()
 
         _session->reset ();
         reset_pollin (_handle);
-        return;
+        return false;
     }
 
     rc = msg.close ();
     errno_assert (rc == 0);
-    _session->flush ();
+    return true;
 }
 
 bool zmq::udp_engine_t::restart_input ()
@@ -6,6 +6,13 @@
 #include "i_engine.hpp"
 #include "address.hpp"
 #include "msg.hpp"
+#include "config.hpp"
+
+#if defined HAVE_RECVMMSG && defined HAVE_SENDMMSG
+#define ZMQ_HAVE_UDP_MMSG
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
 
 #define MAX_UDP_MSG 8192
 
@@ -51,6 +58,17 @@ class udp_engine_t ZMQ_FINAL : public io_object_t, public i_engine
     int resolve_raw_address (const char *name_, size_t length_);
     static void sockaddr_to_msg (zmq::msg_t *msg_, const sockaddr_in *addr_);
 
+    //  Pulls the next message from the session and lays it out in the
+    //  buffer as a datagram. Returns -1 if there is no message to send.
+    int prepare_datagram (char *buffer_, size_t *size_);
+
+    //  Pushes the message received in the datagram to the session.
+    //  Returns false if it does not fit into the pipe, in which case
+    //  the datagram can be pushed again once the input is restarted.
+    bool process_datagram (const char *data_,
+                           int nbytes_,
+                           const sockaddr_storage &address_);
+
     static int set_udp_reuse_address (fd_t s_, bool on_);
     static int set_udp_reuse_port (fd_t s_, bool on_);
     // Indicate, if the multicast data being sent should be looped back
@@ -82,8 +100,34 @@ class udp_engine_t ZMQ_FINAL : public io_object_t, public i_engine
     const struct sockaddr *_out_address;
     zmq_socklen_t _out_address_len;
 
+#if defined ZMQ_HAVE_UDP_MMSG
+    //  Datagrams are sent and received in batches by sendmmsg and
+    //  recvmmsg, so that a single call fills or drains the socket.
+    struct mmsg_batch_t
+    {
+        char buffers[udp_batch_size][MAX_UDP_MSG];
+        sockaddr_storage addresses[udp_batch_size];
+        iovec iov[udp_batch_size];
+        mmsghdr hdrs[udp_batch_size];
+    };
+
+    static mmsg_batch_t *alloc_batch ();
+
+    //  The batches are large, so they are only allocated for the
+    //  directions the engine is enabled for.
+    mmsg_batch_t *_out_batch;
+    mmsg_batch_t *_in_batch;
+
+    //  Number of datagrams in each batch, and the first of them not yet
+    //  sent to the socket or pushed to the session respectively.
+    int _out_count;
+    int _out_pos;
+    int _in_count;
+    int _in_pos;
+#else
     char _out_buffer[MAX_UDP_MSG];
     char _in_buffer[MAX_UDP_MSG];
+#endif
     bool _send_enabled;
     bool _recv_enabled;
 };
@@ -0,0 +1,235 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#if defined ZMQ_IOTHREAD_POLLER_USE_URING || defined ZMQ_HAVE_IO_URING
+#include "uring.hpp"
+
+#include <poll.h>
+#include <endian.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+#include "macros.hpp"
+#include "err.hpp"
+#include "config.hpp"
+#include "i_poll_events.hpp"
+
+zmq::uring_t::uring_t (const zmq::thread_ctx_t &ctx_) :
+    worker_poller_base_t (ctx_)
+{
+    const int rc = _ring.init (static_cast<unsigned int> (max_io_events));
+    errno_assert (rc == 0);
+    memset (&_timeout, 0, sizeof _timeout);
+}
+
+zmq::uring_t::~uring_t ()
+{
+    //  Wait till the worker thread exits.
+    stop_worker ();
+
+    for (retired_t::iterator it = _retired.begin (), end = _retired.end ();
+         it != end; ++it) {
+        LIBZMQ_DELETE (*it);
+    }
+}
+
+zmq::uring_t::handle_t zmq::uring_t::add_fd (fd_t fd_, i_poll_events *events_)
+{
+    check_thread ();
+    poll_entry_t *pe = new (std::nothrow) poll_entry_t;
+    alloc_assert (pe);
+
+    pe->fd = fd_;
+    pe->events = events_;
+    pe->wanted = 0;
+    pe->armed = 0;
+    pe->cancelling = false;
+
+    //  Increase the load metric of the thread.
+    adjust_load (1);
+
+    return pe;
+}
+
+void zmq::uring_t::rm_fd (handle_t handle_)
+{
+    check_thread ();
+    poll_entry_t *pe = static_cast<poll_entry_t *> (handle_);
+    pe->fd = retired_fd;
+    pe->wanted = 0;
+
+    //  A poll request in flight holds a reference to the file, so it is
+    //  removed right away; the caller expects the file to be released
+    //  once it closes the descriptor. The entry itself must stay alive
+    //  until the completion of the request is processed.
+    if (pe->armed) {
+        if (!pe->cancelling) {
+            io_uring_sqe *sqe = _ring.get_sqe ();
+            sqe->opcode = IORING_OP_POLL_REMOVE;
+            sqe->addr = reinterpret_cast<uintptr_t> (pe);
+            pe->cancelling = true;
+        }
+        _ring.enter (0);
+    }
+    _retired.push_back (pe);
+
+    //  Decrease the load metric of the thread.
+    adjust_load (-1);
+}
+
+void zmq::uring_t::set_pollin (handle_t handle_)
+{
+    check_thread ();
+    poll_entry_t *pe = static_cast<poll_entry_t *> (handle_);
+    pe->wanted |= POLLIN;
+    update (pe);
+}
+
+void zmq::uring_t::reset_pollin (handle_t handle_)
+{
+    check_thread ();
+    poll_entry_t *pe = static_cast<poll_entry_t *> (handle_);
+    pe->wanted &= ~(static_cast<unsigned int> (POLLIN));
+}
+
+void zmq::uring_t::set_pollout (handle_t handle_)
+{
+    check_thread ();
+    poll_entry_t *pe = static_cast<poll_entry_t *> (handle_);
+    pe->wanted |= POLLOUT;
+    update (pe);
+}
+
+void zmq::uring_t::reset_pollout (handle_t handle_)
+{
+    check_thread ();
+    poll_entry_t *pe = static_cast<poll_entry_t *> (handle_);
+    pe->wanted &= ~(static_cast<unsigned int> (POLLOUT));
+}
+
+void zmq::uring_t::stop ()
+{
+    check_thread ();
+}
+
+int zmq::uring_t::max_fds ()
+{
+    return -1;
+}
+
+void zmq::uring_t::update (poll_entry_t *pe_)
+{
+    //  Events that are no longer wanted are filtered out on completion;
+    //  only a request lacking some wanted events has to be replaced.
+    if (pe_->armed == 0) {
+        if (pe_->wanted == 0)
+            return;
+        io_uring_sqe *sqe = _ring.get_sqe ();
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = pe_->fd;
+#if __BYTE_ORDER == __BIG_ENDIAN
+        sqe->poll32_events = (pe_->wanted << 16) | (pe_->wanted >> 16);
+#else
+        sqe->poll32_events = pe_->wanted;
+#endif
+        sqe->user_data = reinterpret_cast<uintptr_t> (pe_);
+        pe_->armed = pe_->wanted;
+    } else if ((pe_->wanted & ~pe_->armed) && !pe_->cancelling) {
+        //  The completion of the removed request re-arms the entry.
+        io_uring_sqe *sqe = _ring.get_sqe ();
+        sqe->opcode = IORING_OP_POLL_REMOVE;
+        sqe->addr = reinterpret_cast<uintptr_t> (pe_);
+        pe_->cancelling = true;
+    }
+}
+
+void zmq::uring_t::process (const io_uring_cqe &cqe_)
+{
+    //  Removal and timeout requests carry no entry.
+    if (cqe_.user_data == 0)
+        return;
+
+    poll_entry_t *pe = reinterpret_cast<poll_entry_t *> (cqe_.user_data);
+    pe->armed = 0;
+    pe->cancelling = false;
+    if (pe->fd == retired_fd)
+        return;
+
+    if (cqe_.res != -ECANCELED) {
+        //  Failure to poll the descriptor is reported as an error on it.
+        const unsigned int revents =
+          cqe_.res < 0 ? POLLERR : static_cast<unsigned int> (cqe_.res);
+
+        if (revents & (POLLERR | POLLHUP))
+            pe->events->in_event ();
+        if (pe->fd == retired_fd)
+            return;
+        if (revents & pe->wanted & POLLOUT)
+            pe->events->out_event ();
+        if (pe->fd == retired_fd)
+            return;
+        if (revents & pe->wanted & POLLIN)
+            pe->events->in_event ();
+        if (pe->fd == retired_fd)
+            return;
+    }
+
+    //  Poll requests are one-shot, queue the next one.
+    update (pe);
+}
+
+void zmq::uring_t::loop ()
+{
+    while (true) {
+        //  Execute any due timers.
+        const uint64_t timeout = execute_timers ();
+
+        if (get_load () == 0) {
+            if (timeout == 0)
+                break;
+
+            // TODO sleep for timeout
+            continue;
+        }
+
+        //  Submit pending requests and wait for completions, unless some
+        //  are already available.
+        if (!_ring.completed ()) {
+            if (timeout) {
+                //  The timeout also completes as soon as any other request
+                //  does, so it never outlives the wait it was queued for.
+                _timeout.tv_sec = static_cast<long long> (timeout / 1000);
+                _timeout.tv_nsec =
+                  static_cast<long long> (timeout % 1000 * 1000000);
+                io_uring_sqe *sqe = _ring.get_sqe ();
+                sqe->opcode = IORING_OP_TIMEOUT;
+                sqe->addr = reinterpret_cast<uintptr_t> (&_timeout);
+                sqe->len = 1;
+                sqe->off = 1;
+            }
+            if (!_ring.enter (1))
+                continue;
+        } else if (_ring.queued ())
+            _ring.enter (0);
+
+        //  Process the completions. Each one is copied out of the ring
+        //  before its slot is handed back to the kernel. Those of requests
+        //  the event handlers submit are left to the next iteration.
+        io_uring_cqe cqe;
+        for (unsigned int n = _ring.completed (); n && _ring.next (&cqe); --n)
+            process (cqe);
+
+        //  Destroy retired event sources the kernel no longer references.
+        for (retired_t::iterator it = _retired.begin (); it != _retired.end ();) {
+            if ((*it)->armed == 0) {
+                LIBZMQ_DELETE (*it);
+                it = _retired.erase (it);
+            } else
+                ++it;
+        }
+    }
+}
+
+#endif
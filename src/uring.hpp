@@ -0,0 +1,102 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_URING_HPP_INCLUDED__
+#define __ZMQ_URING_HPP_INCLUDED__
+
+//  poller.hpp decides which polling mechanism to use. The io_uring poller
+//  is built wherever the kernel headers provide it, so that it can be
+//  tested even where it is not the I/O threads' poller.
+#include "poller.hpp"
+#if defined ZMQ_IOTHREAD_POLLER_USE_URING || defined ZMQ_HAVE_IO_URING
+
+#include <vector>
+#include <linux/io_uring.h>
+
+#include "ctx.hpp"
+#include "fd.hpp"
+#include "io_ring.hpp"
+#include "thread.hpp"
+#include "poller_base.hpp"
+
+namespace zmq
+{
+struct i_poll_events;
+
+//  This class implements socket polling mechanism using the Linux-specific
+//  io_uring interface. Poll requests for all registered file descriptors
+//  are queued to the submission ring and harvested from the completion ring,
+//  so that re-arming and waiting for any number of file descriptors costs a
+//  single io_uring_enter system call per loop iteration.
+//
+//  Only readiness goes through this ring. As with the other pollers, the
+//  engines read and write on their own once notified, unless the context
+//  has them submit their reads and writes to a ring, see uring_io_t.
+
+class uring_t ZMQ_FINAL : public worker_poller_base_t
+{
+  public:
+    typedef void *handle_t;
+
+    uring_t (const thread_ctx_t &ctx_);
+    ~uring_t () ZMQ_OVERRIDE;
+
+    //  "poller" concept.
+    handle_t add_fd (fd_t fd_, zmq::i_poll_events *events_);
+    void rm_fd (handle_t handle_);
+    void set_pollin (handle_t handle_);
+    void reset_pollin (handle_t handle_);
+    void set_pollout (handle_t handle_);
+    void reset_pollout (handle_t handle_);
+    void stop ();
+
+    static int max_fds ();
+
+  private:
+    //  Main event loop.
+    void loop () ZMQ_OVERRIDE;
+
+    struct poll_entry_t
+    {
+        fd_t fd;
+        zmq::i_poll_events *events;
+
+        //  Events the owner is currently interested in.
+        unsigned int wanted;
+
+        //  Events requested by the poll request in flight, or zero if
+        //  there is no such request.
+        unsigned int armed;
+
+        //  True if a removal of the in-flight poll request was queued.
+        bool cancelling;
+    };
+
+    //  Make the in-flight poll request of the entry match its wanted
+    //  events, queueing a new poll or a removal of the current one.
+    void update (poll_entry_t *pe_);
+
+    //  Processes a single completion queue entry.
+    void process (const io_uring_cqe &cqe_);
+
+    //  The ring the poll requests are submitted to.
+    io_ring_t _ring;
+
+    //  Storage for the timeout passed to the kernel while waiting.
+    __kernel_timespec _timeout;
+
+    //  List of retired event sources. They are destroyed once the kernel
+    //  has completed their last poll request.
+    typedef std::vector<poll_entry_t *> retired_t;
+    retired_t _retired;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (uring_t)
+};
+
+#if defined ZMQ_IOTHREAD_POLLER_USE_URING
+typedef uring_t poller_t;
+#endif
+}
+
+#endif
+
+#endif
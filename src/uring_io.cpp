@@ -0,0 +1,350 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#if defined ZMQ_HAVE_IO_URING
+#include "uring_io.hpp"
+
+#include <sys/socket.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <new>
+
+#include "config.hpp"
+#include "err.hpp"
+#include "stdint.hpp"
+
+zmq::uring_io_t *zmq::uring_io_t::create (poller_t *poller_)
+{
+    uring_io_t *io = new (std::nothrow) uring_io_t (poller_);
+    alloc_assert (io);
+    if (io->_ring.init (static_cast<unsigned int> (max_io_events)) == -1
+        || !io->_ring.supports (IORING_OP_RECV)
+        || !io->_ring.supports (IORING_OP_SEND)) {
+        delete io;
+        return NULL;
+    }
+    io->_handle = poller_->add_fd (io->_ring.get_fd (), io);
+    poller_->set_pollin (io->_handle);
+    return io;
+}
+
+zmq::uring_io_t::uring_io_t (poller_t *poller_) :
+    _poller (poller_),
+    _handle (static_cast<poller_t::handle_t> (NULL)),
+    _flush_scheduled (false)
+{
+}
+
+zmq::uring_io_t::~uring_io_t ()
+{
+    zmq_assert (!_handle);
+
+    //  The kernel may write to the buffers of a receive until it completes,
+    //  so the requests still in flight are cancelled and waited for.
+    for (std::vector<conn_t *>::iterator it = _retired.begin ();
+         it != _retired.end (); ++it) {
+        for (int send = 0; send != 2; ++send) {
+            if (send ? !(*it)->sending : !(*it)->receiving)
+                continue;
+            io_uring_sqe *sqe = _ring.get_sqe ();
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->addr = reinterpret_cast<uintptr_t> (*it) | send;
+        }
+    }
+    while (true) {
+        io_uring_cqe cqe;
+        while (_ring.next (&cqe))
+            process (cqe);
+        bool pending = false;
+        for (std::vector<conn_t *>::iterator it = _retired.begin ();
+             it != _retired.end (); ++it)
+            pending = pending || (*it)->receiving || (*it)->sending;
+        if (!pending)
+            break;
+        _ring.enter (1);
+    }
+
+    for (std::vector<conn_t *>::iterator it = _retired.begin ();
+         it != _retired.end (); ++it)
+        free (*it);
+}
+
+zmq::uring_io_t::handle_t zmq::uring_io_t::add_fd (fd_t fd_,
+                                                   i_poll_events *events_,
+                                                   size_t in_size_,
+                                                   size_t out_size_)
+{
+    conn_t *conn =
+      static_cast<conn_t *> (malloc (sizeof (conn_t) + in_size_ + out_size_));
+    alloc_assert (conn);
+
+    conn->fd = fd_;
+    conn->events = events_;
+    conn->pollin = false;
+    conn->pollout = false;
+    conn->receiving = false;
+    conn->sending = false;
+    conn->ready = false;
+    conn->in_buf = reinterpret_cast<unsigned char *> (conn + 1);
+    conn->in_size = in_size_;
+    conn->in_pos = 0;
+    conn->in_end = 0;
+    conn->in_closed = false;
+    conn->error = 0;
+    conn->out_buf = conn->in_buf + in_size_;
+    conn->out_size = out_size_;
+    conn->out_pos = 0;
+    conn->out_end = 0;
+    return conn;
+}
+
+void zmq::uring_io_t::rm_fd (handle_t handle_)
+{
+    conn_t *conn = static_cast<conn_t *> (handle_);
+    conn->events = NULL;
+    conn->pollin = false;
+    conn->pollout = false;
+
+    //  The data being sent is left to the kernel, but nothing more is
+    //  received.
+    if (conn->receiving) {
+        io_uring_sqe *sqe = _ring.get_sqe ();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = reinterpret_cast<uintptr_t> (conn);
+    }
+
+    //  A request holds a reference to the socket once passed to the
+    //  kernel, while the caller expects to close the descriptor right
+    //  away, after which it may be reused.
+    if (_ring.queued ())
+        _ring.enter (0);
+    _retired.push_back (conn);
+}
+
+void zmq::uring_io_t::set_pollin (handle_t handle_)
+{
+    conn_t *conn = static_cast<conn_t *> (handle_);
+    conn->pollin = true;
+    if (readable (conn))
+        make_ready (conn);
+    else if (!conn->receiving)
+        receive (conn);
+}
+
+void zmq::uring_io_t::reset_pollin (handle_t handle_)
+{
+    static_cast<conn_t *> (handle_)->pollin = false;
+}
+
+void zmq::uring_io_t::set_pollout (handle_t handle_)
+{
+    conn_t *conn = static_cast<conn_t *> (handle_);
+    conn->pollout = true;
+    if (!conn->sending)
+        make_ready (conn);
+}
+
+void zmq::uring_io_t::reset_pollout (handle_t handle_)
+{
+    static_cast<conn_t *> (handle_)->pollout = false;
+}
+
+int zmq::uring_io_t::read (handle_t handle_, void *data_, size_t size_)
+{
+    conn_t *conn = static_cast<conn_t *> (handle_);
+    if (conn->in_pos < conn->in_end) {
+        const size_t n = std::min (size_, conn->in_end - conn->in_pos);
+        memcpy (data_, conn->in_buf + conn->in_pos, n);
+        conn->in_pos += n;
+        if (conn->in_pos == conn->in_end && conn->pollin)
+            receive (conn);
+        return static_cast<int> (n);
+    }
+    if (conn->in_closed)
+        return 0;
+    if (conn->error) {
+        errno = conn->error;
+        return -1;
+    }
+    errno = EAGAIN;
+    return -1;
+}
+
+int zmq::uring_io_t::write (handle_t handle_, const void *data_, size_t size_)
+{
+    conn_t *conn = static_cast<conn_t *> (handle_);
+    if (conn->error) {
+        errno = conn->error;
+        return -1;
+    }
+    if (conn->sending)
+        return 0;
+
+    const size_t n = std::min (size_, conn->out_size);
+    memcpy (conn->out_buf, data_, n);
+    conn->out_pos = 0;
+    conn->out_end = n;
+    send (conn);
+    return static_cast<int> (n);
+}
+
+void zmq::uring_io_t::stop ()
+{
+    if (_flush_scheduled) {
+        _poller->cancel_timer (this, flush_timer_id);
+        _flush_scheduled = false;
+    }
+    _poller->rm_fd (_handle);
+    _handle = static_cast<poller_t::handle_t> (NULL);
+}
+
+void zmq::uring_io_t::in_event ()
+{
+    io_uring_cqe cqe;
+    while (_ring.next (&cqe))
+        process (cqe);
+    flush ();
+}
+
+void zmq::uring_io_t::out_event ()
+{
+    //  We are never polling for POLLOUT here. This function is never called.
+    zmq_assert (false);
+}
+
+void zmq::uring_io_t::timer_event (int id_)
+{
+    zmq_assert (id_ == flush_timer_id);
+    _flush_scheduled = false;
+    flush ();
+}
+
+void zmq::uring_io_t::receive (conn_t *conn_)
+{
+    zmq_assert (!conn_->receiving);
+    io_uring_sqe *sqe = _ring.get_sqe ();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = conn_->fd;
+    sqe->addr = reinterpret_cast<uintptr_t> (conn_->in_buf);
+    sqe->len = static_cast<uint32_t> (conn_->in_size);
+    sqe->user_data = reinterpret_cast<uintptr_t> (conn_);
+    conn_->receiving = true;
+    conn_->in_pos = 0;
+    conn_->in_end = 0;
+    schedule_flush ();
+}
+
+void zmq::uring_io_t::send (conn_t *conn_)
+{
+    zmq_assert (!conn_->sending);
+    io_uring_sqe *sqe = _ring.get_sqe ();
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = conn_->fd;
+    sqe->addr = reinterpret_cast<uintptr_t> (conn_->out_buf + conn_->out_pos);
+    sqe->len = static_cast<uint32_t> (conn_->out_end - conn_->out_pos);
+    sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+    sqe->user_data = reinterpret_cast<uintptr_t> (conn_) | 1;
+    conn_->sending = true;
+    schedule_flush ();
+}
+
+void zmq::uring_io_t::process (const io_uring_cqe &cqe_)
+{
+    //  Cancellations carry no socket.
+    if (cqe_.user_data == 0)
+        return;
+
+    conn_t *conn = reinterpret_cast<conn_t *> (cqe_.user_data
+                                               & ~static_cast<uint64_t> (1));
+    const bool failed = cqe_.res < 0 && cqe_.res != -ECANCELED;
+    if (failed && !conn->error)
+        conn->error = -cqe_.res;
+
+    if (cqe_.user_data & 1) {
+        conn->sending = false;
+
+        //  Kernels not retrying short sends leave the rest to be sent. The
+        //  socket of a removed entry may already be closed, so the rest is
+        //  dropped along with the connection.
+        if (cqe_.res > 0) {
+            conn->out_pos += static_cast<size_t> (cqe_.res);
+            if (conn->out_pos < conn->out_end && conn->events) {
+                send (conn);
+                return;
+            }
+        }
+        if (conn->events && (conn->pollout || failed))
+            make_ready (conn);
+    } else {
+        conn->receiving = false;
+        if (cqe_.res > 0)
+            conn->in_end = static_cast<size_t> (cqe_.res);
+        else if (cqe_.res == 0)
+            conn->in_closed = true;
+
+        //  As with the pollers, failures are reported even while input is
+        //  not wanted.
+        if (conn->events && readable (conn))
+            make_ready (conn);
+    }
+}
+
+void zmq::uring_io_t::flush ()
+{
+    //  Events delivered may make the sockets ready again, as the data
+    //  received is read a buffer at a time.
+    std::vector<conn_t *> ready;
+    ready.swap (_ready);
+    for (std::vector<conn_t *>::iterator it = ready.begin ();
+         it != ready.end (); ++it) {
+        conn_t *conn = *it;
+        conn->ready = false;
+        if (conn->events && conn->pollout && !conn->sending)
+            conn->events->out_event ();
+        if (conn->events && readable (conn)
+            && (conn->pollin || conn->in_closed || conn->error))
+            conn->events->in_event ();
+        if (conn->events && conn->pollin && readable (conn))
+            make_ready (conn);
+    }
+
+    if (_ring.queued ())
+        _ring.enter (0);
+
+    //  Destroy removed sockets the kernel no longer references.
+    for (std::vector<conn_t *>::iterator it = _retired.begin ();
+         it != _retired.end ();) {
+        if (!(*it)->receiving && !(*it)->sending && !(*it)->ready) {
+            free (*it);
+            it = _retired.erase (it);
+        } else
+            ++it;
+    }
+}
+
+void zmq::uring_io_t::make_ready (conn_t *conn_)
+{
+    if (conn_->ready)
+        return;
+    conn_->ready = true;
+    _ready.push_back (conn_);
+    schedule_flush ();
+}
+
+void zmq::uring_io_t::schedule_flush ()
+{
+    if (_flush_scheduled)
+        return;
+    _poller->add_timer (0, this, flush_timer_id);
+    _flush_scheduled = true;
+}
+
+bool zmq::uring_io_t::readable (const conn_t *conn_)
+{
+    return conn_->in_pos < conn_->in_end || conn_->in_closed
+           || conn_->error != 0;
+}
+
+#endif
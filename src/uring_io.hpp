@@ -0,0 +1,156 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_URING_IO_HPP_INCLUDED__
+#define __ZMQ_URING_IO_HPP_INCLUDED__
+
+#if defined ZMQ_HAVE_IO_URING
+
+#include <stddef.h>
+#include <vector>
+
+#include "fd.hpp"
+#include "i_poll_events.hpp"
+#include "io_ring.hpp"
+#include "macros.hpp"
+#include "poller.hpp"
+
+namespace zmq
+{
+//  Reads and writes of the stream engines of an I/O thread, submitted to
+//  an io_uring rather than made by the engines once the poller reports
+//  their sockets ready. The requests queued while the I/O thread handles
+//  its events are passed to the kernel together, and their completions
+//  are read from the ring once the poller reports its descriptor ready,
+//  which saves a wakeup and a system call per read and per write.
+//
+//  The kernel may use the buffers of a request until it completes, which
+//  can be after the engine is gone. Each socket therefore gets buffers of
+//  its own, which the engine reads from and writes to as it would from
+//  and to the socket; they are released along with the last request.
+//
+//  Sockets are registered as with the poller, and the same events report
+//  that data was received or the connection failed, and that more data
+//  can be written.
+
+class uring_io_t ZMQ_FINAL : public i_poll_events
+{
+  public:
+    typedef void *handle_t;
+
+    //  Returns NULL if io_uring is not available.
+    static uring_io_t *create (poller_t *poller_);
+    ~uring_io_t ();
+
+    //  Registers the socket, with buffers of the given sizes.
+    handle_t add_fd (fd_t fd_,
+                     i_poll_events *events_,
+                     size_t in_size_,
+                     size_t out_size_);
+    void rm_fd (handle_t handle_);
+    void set_pollin (handle_t handle_);
+    void reset_pollin (handle_t handle_);
+    void set_pollout (handle_t handle_);
+    void reset_pollout (handle_t handle_);
+
+    //  Same as tcp_read and tcp_write, on the data received and the data
+    //  to be sent. A write is only taken once the previous one has been
+    //  sent, and at most out_size_ bytes of it.
+    int read (handle_t handle_, void *data_, size_t size_);
+    int write (handle_t handle_, const void *data_, size_t size_);
+
+    //  Removes the ring from the poller, before the poller stops. The
+    //  requests still in flight are cancelled on destruction, once the
+    //  poller has stopped.
+    void stop ();
+
+    //  i_poll_events implementation.
+    void in_event ();
+    void out_event ();
+    void timer_event (int id_);
+
+  private:
+    uring_io_t (poller_t *poller_);
+
+    struct conn_t
+    {
+        fd_t fd;
+
+        //  NULL once the socket is removed.
+        i_poll_events *events;
+
+        //  Events the owner is currently interested in.
+        bool pollin;
+        bool pollout;
+
+        //  Requests in flight.
+        bool receiving;
+        bool sending;
+
+        //  True if queued to have its events delivered.
+        bool ready;
+
+        //  Data received and not read yet. Set once the peer closed the
+        //  connection, and the error receiving or sending failed with.
+        unsigned char *in_buf;
+        size_t in_size;
+        size_t in_pos;
+        size_t in_end;
+        bool in_closed;
+        int error;
+
+        //  Data being sent.
+        unsigned char *out_buf;
+        size_t out_size;
+        size_t out_pos;
+        size_t out_end;
+    };
+
+    //  Queues a receive into the input buffer of the socket.
+    void receive (conn_t *conn_);
+
+    //  Queues a send of the rest of the output buffer of the socket.
+    void send (conn_t *conn_);
+
+    //  Processes a single completion queue entry.
+    void process (const io_uring_cqe &cqe_);
+
+    //  Delivers the events of the sockets made ready, then passes the
+    //  queued requests to the kernel.
+    void flush ();
+
+    //  Has the events of the socket delivered before the poller waits.
+    void make_ready (conn_t *conn_);
+
+    //  Has flush called before the poller waits next.
+    void schedule_flush ();
+
+    //  Returns whether the socket has data to read, or an error to report.
+    static bool readable (const conn_t *conn_);
+
+    enum
+    {
+        flush_timer_id = 1
+    };
+
+    io_ring_t _ring;
+
+    poller_t *_poller;
+    poller_t::handle_t _handle;
+
+    //  True if the flush timer is set.
+    bool _flush_scheduled;
+
+    //  Sockets whose events are to be delivered.
+    std::vector<conn_t *> _ready;
+
+    //  Removed sockets with requests in flight. They are destroyed once
+    //  the last of those has completed.
+    std::vector<conn_t *> _retired;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (uring_io_t)
+};
+}
+
+#endif
+
+#endif
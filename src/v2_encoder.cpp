@@ -22,6 +22,18 @@ zmq::v2_encoder_t::~v2_encoder_t ()
 
 void zmq::v2_encoder_t::message_ready ()
 {
+    //  Messages fanned out to many peers carry their header in front of
+    //  their data. Send both in a single step.
+    size_t stored_header_size;
+    unsigned char *stored_header =
+      v2_encoder_t::stored_data_header (in_progress (), &stored_header_size);
+    if (stored_header) {
+        next_step (stored_header,
+                   stored_header_size + in_progress ()->size (),
+                   &v2_encoder_t::message_ready, true);
+        return;
+    }
+
     //  Encode flags.
     size_t size = in_progress ()->size ();
     size_t header_size = 2; // flags byte + size byte
@@ -67,3 +79,38 @@ void zmq::v2_encoder_t::size_ready ()
     next_step (in_progress ()->data (), in_progress ()->size (),
                &v2_encoder_t::message_ready, true);
 }
+
+size_t zmq::v2_encoder_t::encode_data_header (const msg_t *msg_,
+                                              unsigned char *buf_)
+{
+    if (msg_->flags () & (msg_t::command | CMD_TYPE_MASK))
+        return 0;
+
+    const size_t size = msg_->size ();
+    buf_[0] = 0;
+    if (msg_->flags () & msg_t::more)
+        buf_[0] |= v2_protocol_t::more_flag;
+    if (size > UCHAR_MAX) {
+        buf_[0] |= v2_protocol_t::large_flag;
+        put_uint64 (buf_ + 1, size);
+        return 9;
+    }
+    buf_[1] = static_cast<uint8_t> (size);
+    return 2;
+}
+
+unsigned char *zmq::v2_encoder_t::stored_data_header (msg_t *msg_,
+                                                      size_t *size_)
+{
+    unsigned char *header = msg_->wire_header (size_);
+    if (!header)
+        return NULL;
+
+    //  The header was encoded for the flags of the message that was
+    //  fanned out, which copies of the content may not share.
+    const unsigned char flags = msg_->flags ();
+    if ((flags & (msg_t::command | CMD_TYPE_MASK))
+        || !(flags & msg_t::more) != !(header[0] & v2_protocol_t::more_flag))
+        return NULL;
+    return header;
+}
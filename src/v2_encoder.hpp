@@ -15,6 +15,19 @@ class v2_encoder_t ZMQ_FINAL : public encoder_base_t<v2_encoder_t>
     v2_encoder_t (size_t bufsize_);
     ~v2_encoder_t ();
 
+    //  Encodes the header of a data frame, framed alike by the v2 and v3.1
+    //  encoders, into buf_ and returns its size. Returns 0 for commands.
+    static size_t encode_data_header (const msg_t *msg_, unsigned char *buf_);
+
+    //  Returns the header stored in front of the data of the message by
+    //  encode_data_header if it is still valid for the message, or NULL.
+    static unsigned char *stored_data_header (msg_t *msg_, size_t *size_);
+
+    enum
+    {
+        max_data_header_size = 9
+    };
+
   private:
     void size_ready ();
     void message_ready ();
@@ -3,6 +3,7 @@
 #include "precompiled.hpp"
 #include "v2_protocol.hpp"
 #include "v3_1_encoder.hpp"
+#include "v2_encoder.hpp"
 #include "msg.hpp"
 #include "likely.hpp"
 #include "wire.hpp"
@@ -22,6 +23,18 @@ zmq::v3_1_encoder_t::~v3_1_encoder_t ()
 
 void zmq::v3_1_encoder_t::message_ready ()
 {
+    //  Messages fanned out to many peers carry their header in front of
+    //  their data. Send both in a single step.
+    size_t stored_header_size;
+    unsigned char *stored_header =
+      v2_encoder_t::stored_data_header (in_progress (), &stored_header_size);
+    if (stored_header) {
+        next_step (stored_header,
+                   stored_header_size + in_progress ()->size (),
+                   &v3_1_encoder_t::message_ready, true);
+        return;
+    }
+
     //  Encode flags.
     size_t size = in_progress ()->size ();
     size_t header_size = 2; // flags byte + size byte
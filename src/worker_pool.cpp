@@ -0,0 +1,103 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include "worker_pool.hpp"
+
+#include <new>
+#include <stdio.h>
+
+#include "ctx.hpp"
+#include "err.hpp"
+#include "io_thread.hpp"
+
+zmq::worker_pool_t::worker_pool_t () : _stopping (false)
+{
+}
+
+zmq::worker_pool_t::~worker_pool_t ()
+{
+    _sync.lock ();
+    _stopping = true;
+    _work.broadcast ();
+    _sync.unlock ();
+
+    for (std::vector<thread_t *>::size_type i = 0; i != _workers.size ();
+         i++) {
+        _workers[i]->stop ();
+        LIBZMQ_DELETE (_workers[i]);
+    }
+}
+
+void zmq::worker_pool_t::start (const thread_ctx_t &thread_ctx_,
+                                int workers_)
+{
+    for (int i = 0; i != workers_; i++) {
+        thread_t *const worker = new (std::nothrow) thread_t;
+        alloc_assert (worker);
+        _workers.push_back (worker);
+
+        char name[16] = "";
+        snprintf (name, sizeof (name), "Worker/%d", i);
+        thread_ctx_.start_thread (*worker, worker_routine, this, name);
+    }
+}
+
+void zmq::worker_pool_t::submit (job_t *job_)
+{
+    job_->next = 0;
+    job_->ran = 0;
+
+    if (_workers.empty () || job_->count == 0) {
+        for (int i = 0; i != job_->count; i++)
+            job_->fn (job_->args[i]);
+        job_->next = job_->ran = job_->count;
+        complete (job_);
+        return;
+    }
+
+    _sync.lock ();
+    _jobs.push_back (job_);
+    _work.broadcast ();
+    _sync.unlock ();
+}
+
+void zmq::worker_pool_t::worker_routine (void *arg_)
+{
+    static_cast<worker_pool_t *> (arg_)->loop ();
+}
+
+void zmq::worker_pool_t::loop ()
+{
+    _sync.lock ();
+    while (true) {
+        while (_jobs.empty () && !_stopping)
+            _work.wait (&_sync, -1);
+        if (_jobs.empty ())
+            break;
+
+        //  Tasks are taken in the order the jobs were handed over in.
+        job_t *const job = _jobs.front ();
+        const int index = job->next++;
+        if (job->next == job->count)
+            _jobs.pop_front ();
+
+        _sync.unlock ();
+        job->fn (job->args[index]);
+        _sync.lock ();
+
+        if (++job->ran == job->count) {
+            _sync.unlock ();
+            complete (job);
+            _sync.lock ();
+        }
+    }
+    _sync.unlock ();
+}
+
+void zmq::worker_pool_t::complete (job_t *job_)
+{
+    if (job_->thread)
+        job_->thread->send_work_done (job_);
+    else
+        job_->done (job_);
+}
@@ -0,0 +1,85 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_WORKER_POOL_HPP_INCLUDED__
+#define __ZMQ_WORKER_POOL_HPP_INCLUDED__
+
+#include <deque>
+#include <vector>
+
+#include "condition_variable.hpp"
+#include "macros.hpp"
+#include "mutex.hpp"
+#include "thread.hpp"
+
+namespace zmq
+{
+class thread_ctx_t;
+class io_thread_t;
+
+//  Pool of threads that run tasks on behalf of other threads, such as the
+//  I/O threads, so that work which would otherwise be bound to the core of
+//  a single thread is spread over several. The thread handing tasks over
+//  does not wait for them: it is handed the job back once they have run.
+
+class worker_pool_t
+{
+  public:
+    typedef void (task_fn) (void *arg_);
+
+    //  Tasks handed over by a call to submit.
+    struct job_t
+    {
+        task_fn *fn;
+        void *const *args;
+        int count;
+
+        //  Called with the job once all of its tasks have run: by the I/O
+        //  thread given, to which the job is sent through its mailbox, or
+        //  by the worker which ran the last task if there is none. The pool
+        //  does not access the job afterwards.
+        task_fn *done;
+        io_thread_t *thread;
+
+        //  Index of the next task to run, and number of tasks that ran.
+        int next;
+        int ran;
+    };
+
+    worker_pool_t ();
+
+    //  Waits for the workers to run the tasks left and terminate.
+    ~worker_pool_t ();
+
+    //  Starts the given number of worker threads.
+    void start (const thread_ctx_t &thread_ctx_, int workers_);
+
+    int workers () const { return static_cast<int> (_workers.size ()); }
+
+    //  Hands the tasks of the job over to the workers, and returns. Without
+    //  workers, they are run by the calling thread. Can be called from
+    //  several threads at once.
+    void submit (job_t *job_);
+
+  private:
+    static void worker_routine (void *arg_);
+    void loop ();
+
+    //  Hands the job whose tasks have all run back to its thread.
+    static void complete (job_t *job_);
+
+    std::vector<thread_t *> _workers;
+
+    //  Jobs with tasks not taken yet, in the order they were handed over.
+    std::deque<job_t *> _jobs;
+    bool _stopping;
+
+    mutex_t _sync;
+
+    //  Signalled when jobs are handed over or the pool is stopping.
+    condition_variable_t _work;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (worker_pool_t)
+};
+}
+
+#endif
@@ -888,17 +888,33 @@ int zmq::ws_engine_t::decode_and_push (msg_t *msg_)
     zmq_assert (_mechanism != NULL);
 
     //  with WS engine, ping and pong commands are control messages and should not go through any mechanism
-    if (msg_->is_ping () || msg_->is_pong () || msg_->is_close_cmd ()) {
+    const bool control =
+      msg_->is_ping () || msg_->is_pong () || msg_->is_close_cmd ();
+    int rc = 0;
+    if (control) {
         if (process_command_message (msg_) == -1)
             return -1;
-    } else if (_mechanism->decode (msg_) == -1)
-        return -1;
+    } else {
+        rc = _mechanism->decode (msg_);
+        if (rc == -1 && errno != EAGAIN)
+            return -1;
+    }
 
     if (_has_timeout_timer) {
         _has_timeout_timer = false;
         cancel_timer (heartbeat_timeout_timer_id);
     }
 
+    //  The frame may be held back, and decoded on other threads along with
+    //  the ones before it, in which case input stops until they are.
+    if (rc == -1) {
+        _process_msg = &ws_engine_t::push_held;
+        errno = EAGAIN;
+        return -1;
+    }
+    if (!control && _mechanism->decode_deferred ())
+        return push_held (msg_);
+
     if (msg_->flags () & msg_t::command && !msg_->is_ping ()
         && !msg_->is_pong () && !msg_->is_close_cmd ())
         process_command_message (msg_);
@@ -910,6 +926,8 @@ int zmq::ws_engine_t::decode_and_push (msg_t *msg_)
             _process_msg = &ws_engine_t::push_one_then_decode_and_push;
         return -1;
     }
+    if (_mechanism->decode_next (msg_))
+        return push_decoded (msg_);
     return 0;
 }
 
@@ -296,7 +296,13 @@ void zmq::ws_listener_t::create_engine (fd_t fd_)
 
     //  Choose I/O thread to run connecter in. Given that we are already
     //  running in an I/O thread, there must be at least one available.
-    io_thread_t *io_thread = choose_io_thread (options.affinity);
+    //  With ZMQ_IO_THREAD_LOCALITY, pick the one closest to where the
+    //  connection's packets are received.
+    int cpu = -1;
+    unsigned int napi_id = 0;
+    if (options.io_thread_locality)
+        get_incoming_cpu (fd_, &cpu, &napi_id);
+    io_thread_t *io_thread = choose_io_thread (options.affinity, cpu, napi_id);
     zmq_assert (io_thread);
 
     //  Create and launch a session object.
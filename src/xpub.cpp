@@ -8,7 +8,7 @@
 #include "err.hpp"
 #include "msg.hpp"
 #include "macros.hpp"
-#include "generic_mtrie_impl.hpp"
+#include "generic_radix_mtrie_impl.hpp"
 
 zmq::xpub_t::xpub_t (class ctx_t *parent_, uint32_t tid_, int sid_) :
     socket_base_t (parent_, tid_, sid_),
@@ -115,11 +115,11 @@ void zmq::xpub_t::xread_activated (pipe_t *pipe_)
                 _pending_pipes.push_back (pipe_);
             } else {
                 if (!subscribe) {
-                    const mtrie_t::rm_result rm_result =
+                    const radix_mtrie_t::rm_result rm_result =
                       _subscriptions.rm (data, size, pipe_);
-                    //  TODO reconsider what to do if rm_result == mtrie_t::not_found
-                    notify =
-                      rm_result != mtrie_t::values_remain || _verbose_unsubs;
+                    //  TODO reconsider what to do if rm_result == not_found
+                    notify = rm_result != radix_mtrie_t::values_remain
+                             || _verbose_unsubs;
                 } else {
                     const bool first_added =
                       _subscriptions.add (data, size, pipe_);
@@ -243,7 +243,8 @@ int zmq::xpub_t::xgetsockopt (int option_, void *optval_, size_t *optvallen_)
     return -1;
 }
 
-static void stub (zmq::mtrie_t::prefix_t data_, size_t size_, void *arg_)
+static void
+stub (zmq::radix_mtrie_t::prefix_t data_, size_t size_, void *arg_)
 {
     LIBZMQ_UNUSED (data_);
     LIBZMQ_UNUSED (size_);
@@ -376,7 +377,7 @@ bool zmq::xpub_t::xhas_in ()
     return !_pending_data.empty ();
 }
 
-void zmq::xpub_t::send_unsubscription (zmq::mtrie_t::prefix_t data_,
+void zmq::xpub_t::send_unsubscription (zmq::radix_mtrie_t::prefix_t data_,
                                        size_t size_,
                                        xpub_t *self_)
 {
@@ -7,7 +7,7 @@
 
 #include "socket_base.hpp"
 #include "session_base.hpp"
-#include "mtrie.hpp"
+#include "radix_mtrie.hpp"
 #include "dist.hpp"
 
 namespace zmq
@@ -27,21 +27,22 @@ class xpub_t : public socket_base_t
     void xattach_pipe (zmq::pipe_t *pipe_,
                        bool subscribe_to_all_ = false,
                        bool locally_initiated_ = false) ZMQ_OVERRIDE;
-    int xsend (zmq::msg_t *msg_) ZMQ_FINAL;
+    int xsend (zmq::msg_t *msg_) ZMQ_OVERRIDE;
     bool xhas_out () ZMQ_FINAL;
     int xrecv (zmq::msg_t *msg_) ZMQ_OVERRIDE;
     bool xhas_in () ZMQ_OVERRIDE;
     void xread_activated (zmq::pipe_t *pipe_) ZMQ_FINAL;
-    void xwrite_activated (zmq::pipe_t *pipe_) ZMQ_FINAL;
-    int
-    xsetsockopt (int option_, const void *optval_, size_t optvallen_) ZMQ_FINAL;
+    void xwrite_activated (zmq::pipe_t *pipe_) ZMQ_OVERRIDE;
+    int xsetsockopt (int option_,
+                     const void *optval_,
+                     size_t optvallen_) ZMQ_OVERRIDE;
     int xgetsockopt (int option_, void *optval_, size_t *optvallen_) ZMQ_FINAL;
-    void xpipe_terminated (zmq::pipe_t *pipe_) ZMQ_FINAL;
+    void xpipe_terminated (zmq::pipe_t *pipe_) ZMQ_OVERRIDE;
 
   private:
     //  Function to be applied to the trie to send all the subscriptions
     //  upstream.
-    static void send_unsubscription (zmq::mtrie_t::prefix_t data_,
+    static void send_unsubscription (zmq::radix_mtrie_t::prefix_t data_,
                                      size_t size_,
                                      xpub_t *self_);
 
@@ -49,10 +50,10 @@ class xpub_t : public socket_base_t
     static void mark_as_matching (zmq::pipe_t *pipe_, xpub_t *self_);
 
     //  List of all subscriptions mapped to corresponding pipes.
-    mtrie_t _subscriptions;
+    radix_mtrie_t _subscriptions;
 
     //  List of manual subscriptions mapped to corresponding pipes.
-    mtrie_t _manual_subscriptions;
+    radix_mtrie_t _manual_subscriptions;
 
     //  Distributor of messages holding the list of outbound pipes.
     dist_t _dist;
@@ -8,6 +8,7 @@
 
 #include "err.hpp"
 #include "atomic_ptr.hpp"
+#include "chunk_pool.hpp"
 #include "platform.hpp"
 
 namespace zmq
@@ -54,16 +55,16 @@ template <typename T, int N> class yqueue_t
     {
         while (true) {
             if (_begin_chunk == _end_chunk) {
-                free (_begin_chunk);
+                chunk_pool_free (_begin_chunk);
                 break;
             }
             chunk_t *o = _begin_chunk;
             _begin_chunk = _begin_chunk->next;
-            free (o);
+            chunk_pool_free (o);
         }
 
         chunk_t *sc = _spare_chunk.xchg (NULL);
-        free (sc);
+        chunk_pool_free (sc);
     }
 
     //  Returns reference to the front element of the queue.
@@ -122,7 +123,7 @@ template <typename T, int N> class yqueue_t
         else {
             _end_pos = N - 1;
             _end_chunk = _end_chunk->prev;
-            free (_end_chunk->next);
+            chunk_pool_free (_end_chunk->next);
             _end_chunk->next = NULL;
         }
     }
@@ -140,7 +141,7 @@ template <typename T, int N> class yqueue_t
             //  so for cache reasons we'll get rid of the spare and
             //  use 'o' as the spare.
             chunk_t *cs = _spare_chunk.xchg (o);
-            free (cs);
+            chunk_pool_free (cs);
         }
     }
 
@@ -156,12 +157,10 @@ template <typename T, int N> class yqueue_t
     static inline chunk_t *allocate_chunk ()
     {
 #if defined HAVE_POSIX_MEMALIGN
-        void *pv;
-        if (posix_memalign (&pv, ALIGN, sizeof (chunk_t)) == 0)
-            return (chunk_t *) pv;
-        return NULL;
+        return static_cast<chunk_t *> (
+          chunk_pool_alloc (sizeof (chunk_t), ALIGN));
 #else
-        return static_cast<chunk_t *> (malloc (sizeof (chunk_t)));
+        return static_cast<chunk_t *> (chunk_pool_alloc (sizeof (chunk_t)));
 #endif
     }
 
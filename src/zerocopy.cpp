@@ -0,0 +1,159 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include "zerocopy.hpp"
+
+#if defined ZMQ_HAVE_TCP_ZEROCOPY
+
+#include <new>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "config.hpp"
+#include "err.hpp"
+
+zmq::zerocopy_refs_t::zerocopy_refs_t () : _seq (0), _done (0)
+{
+}
+
+zmq::zerocopy_refs_t::~zerocopy_refs_t ()
+{
+    for (std::deque<ref_t>::iterator it = _refs.begin (); it != _refs.end ();
+         ++it) {
+        const int rc = it->msg.close ();
+        errno_assert (rc == 0);
+    }
+}
+
+void zmq::zerocopy_refs_t::sent ()
+{
+    ++_seq;
+}
+
+void zmq::zerocopy_refs_t::hold (msg_t &msg_)
+{
+    zmq_assert (_seq != _done);
+    _refs.push_back (ref_t ());
+    _refs.back ().seq = _seq - 1;
+    _refs.back ().msg = msg_;
+    const int rc = msg_.init ();
+    errno_assert (rc == 0);
+}
+
+bool zmq::zerocopy_refs_t::pending () const
+{
+    return _seq != _done;
+}
+
+bool zmq::zerocopy_refs_t::process (fd_t s_)
+{
+    bool completed = false;
+    uint32_t lo, hi;
+    while (tcp_read_zerocopy_completion (s_, &lo, &hi) == 0) {
+        completed = true;
+        _ranges.push_back (std::make_pair (lo, hi));
+    }
+
+    //  Advance past all the ranges adjoining the completed writes.
+    for (size_t i = 0; i < _ranges.size ();) {
+        if (_ranges[i].first == _done) {
+            _done = _ranges[i].second + 1;
+            _ranges[i] = _ranges.back ();
+            _ranges.pop_back ();
+            i = 0;
+        } else
+            ++i;
+    }
+
+    //  Sequence numbers wrap around.
+    while (!_refs.empty ()
+           && static_cast<int32_t> (_refs.front ().seq - _done) < 0) {
+        const int rc = _refs.front ().msg.close ();
+        errno_assert (rc == 0);
+        _refs.pop_front ();
+    }
+    return completed;
+}
+
+void zmq::zerocopy_refs_t::swap (zerocopy_refs_t &other_)
+{
+    std::swap (_seq, other_._seq);
+    std::swap (_done, other_._done);
+    _ranges.swap (other_._ranges);
+    _refs.swap (other_._refs);
+}
+
+void zmq::zerocopy_linger_t::launch (io_thread_t *io_thread_,
+                                     fd_t s_,
+                                     zerocopy_refs_t &refs_)
+{
+    zerocopy_linger_t *linger =
+      new (std::nothrow) zerocopy_linger_t (io_thread_, s_, refs_);
+    alloc_assert (linger);
+}
+
+zmq::zerocopy_linger_t::zerocopy_linger_t (io_thread_t *io_thread_,
+                                           fd_t s_,
+                                           zerocopy_refs_t &refs_) :
+    io_object_t (io_thread_), _s (s_)
+{
+    _refs.swap (refs_);
+
+    //  Completions are signalled as an error on the socket, which the
+    //  pollers only report along with the events polled for.
+    _handle = add_fd (_s);
+    set_pollin (_handle);
+    add_timer (zerocopy_linger, linger_timer_id);
+}
+
+zmq::zerocopy_linger_t::~zerocopy_linger_t ()
+{
+}
+
+void zmq::zerocopy_linger_t::in_event ()
+{
+    _refs.process (_s);
+    if (!_refs.pending ()) {
+        cancel_timer (linger_timer_id);
+        close (false);
+        return;
+    }
+
+    //  Anything else is data the peer still sends, which is dropped. Once
+    //  it has closed or reset the connection, no write is left to complete.
+    unsigned char buf[512];
+    const ssize_t rc = recv (_s, buf, sizeof buf, MSG_DONTWAIT);
+    if (rc == 0
+        || (rc == -1 && errno != EAGAIN && errno != EWOULDBLOCK
+            && errno != EINTR)) {
+        cancel_timer (linger_timer_id);
+        close (true);
+    }
+}
+
+void zmq::zerocopy_linger_t::timer_event (int id_)
+{
+    zmq_assert (id_ == linger_timer_id);
+
+    //  Resetting the connection discards the data still queued, so that
+    //  the kernel no longer reads from the messages.
+    _refs.process (_s);
+    close (_refs.pending ());
+}
+
+void zmq::zerocopy_linger_t::close (bool reset_)
+{
+    rm_fd (_handle);
+    if (reset_) {
+        const struct linger lin = {1, 0};
+        const int rc =
+          setsockopt (_s, SOL_SOCKET, SO_LINGER, &lin, sizeof lin);
+        errno_assert (rc == 0);
+    }
+    const int rc = ::close (_s);
+    errno_assert (rc == 0 || errno == ECONNRESET);
+    delete this;
+}
+
+#endif
@@ -0,0 +1,120 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_ZEROCOPY_HPP_INCLUDED__
+#define __ZMQ_ZEROCOPY_HPP_INCLUDED__
+
+#include "tcp.hpp"
+
+#if defined ZMQ_HAVE_TCP_ZEROCOPY
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "fd.hpp"
+#include "io_object.hpp"
+#include "macros.hpp"
+#include "msg.hpp"
+#include "stdint.hpp"
+
+namespace zmq
+{
+class io_thread_t;
+
+//  Messages referenced by the zero-copy writes on a socket. They are
+//  kept until the kernel reports the writes as completed, as it only
+//  pins the pages of the data still to be sent.
+
+class zerocopy_refs_t
+{
+  public:
+    zerocopy_refs_t ();
+
+    //  Releases the messages left, whether their writes completed or not.
+    ~zerocopy_refs_t ();
+
+    //  Accounts for a write made using MSG_ZEROCOPY.
+    void sent ();
+
+    //  Takes over the reference held by msg_, which is released once the
+    //  last write accounted for has completed.
+    void hold (msg_t &msg_);
+
+    //  Returns whether some of the writes have not completed yet.
+    bool pending () const;
+
+    //  Reads the pending completions from the error queue of s_ and
+    //  releases the messages of the writes completed. Returns whether
+    //  there were any.
+    bool process (fd_t s_);
+
+    void swap (zerocopy_refs_t &other_);
+
+  private:
+    //  Sequence number of the next write; all the writes before _done
+    //  have completed.
+    uint32_t _seq;
+    uint32_t _done;
+
+    //  Completed ranges of writes not adjacent to _done yet. The kernel
+    //  does not guarantee that completions arrive in order.
+    std::vector<std::pair<uint32_t, uint32_t> > _ranges;
+
+    //  Messages along with the sequence number of the last write that
+    //  referenced them.
+    struct ref_t
+    {
+        uint32_t seq;
+        msg_t msg;
+    };
+    std::deque<ref_t> _refs;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (zerocopy_refs_t)
+};
+
+//  Keeps the socket of a destroyed engine open until its zero-copy
+//  writes have completed, releasing the messages as they do, then
+//  closes it. If that takes longer than zerocopy_linger, the connection
+//  is reset and the messages are released right away. The object lives
+//  in the I/O thread and destroys itself.
+
+class zerocopy_linger_t ZMQ_FINAL : public io_object_t
+{
+  public:
+    //  Takes over s_ and the messages held by refs_.
+    static void launch (zmq::io_thread_t *io_thread_,
+                        fd_t s_,
+                        zerocopy_refs_t &refs_);
+
+  private:
+    zerocopy_linger_t (zmq::io_thread_t *io_thread_,
+                       fd_t s_,
+                       zerocopy_refs_t &refs_);
+    ~zerocopy_linger_t ();
+
+    //  i_poll_events interface implementation.
+    void in_event ();
+    void timer_event (int id_);
+
+    //  Closes the socket, resetting the connection if reset_ is set,
+    //  and destroys the object.
+    void close (bool reset_);
+
+    enum
+    {
+        linger_timer_id = 0x60
+    };
+
+    //  The socket and its handle in the poller.
+    fd_t _s;
+    handle_t _handle;
+
+    zerocopy_refs_t _refs;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (zerocopy_linger_t)
+};
+}
+
+#endif
+
+#endif
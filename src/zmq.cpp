@@ -464,6 +464,23 @@ int zmq_sendiov (void *s_, iovec *a_, size_t count_, int flags_)
     return rc;
 }
 
+// Send an array of messages, each of them complete unless ZMQ_SNDMORE
+// is set. The socket is locked, and its commands are processed, once
+// for the whole batch, and the messages are flushed to the peers at the
+// end of it.
+// Returns the number of messages sent, which may be less than count_ if
+// an error occurs, or -1 if none was sent. The messages sent are left
+// empty, the others are untouched.
+//
+int zmq_sendmmsg (void *s_, zmq_msg_t *msgs_, size_t count_, int flags_)
+{
+    zmq::socket_base_t *s = as_socket_base_t (s_);
+    if (!s)
+        return -1;
+    return s->send_batch (reinterpret_cast<zmq::msg_t *> (msgs_), count_,
+                          flags_);
+}
+
 // Receiving functions.
 
 static int s_recvmsg (zmq::socket_base_t *s_, zmq_msg_t *msg_, int flags_)
@@ -582,6 +599,21 @@ int zmq_recviov (void *s_, iovec *a_, size_t *count_, int flags_)
     return nread;
 }
 
+// Receive up to count_ messages into an array of initialised messages.
+// Only the first message is waited for, as specified by the flags and
+// ZMQ_RCVTIMEO; the others are the messages readily available.
+// Returns the number of messages received, or -1 if none was. Use
+// zmq_msg_more to find out where multi-part messages end.
+//
+int zmq_recvmmsg (void *s_, zmq_msg_t *msgs_, size_t count_, int flags_)
+{
+    zmq::socket_base_t *s = as_socket_base_t (s_);
+    if (!s)
+        return -1;
+    return s->recv_batch (reinterpret_cast<zmq::msg_t *> (msgs_), count_,
+                          flags_);
+}
+
 // Message manipulators.
 
 int zmq_msg_init (zmq_msg_t *msg_)
@@ -724,106 +756,6 @@ const char *zmq_msg_gets (const zmq_msg_t *msg_, const char *property_)
 
 // Polling.
 
-#if defined ZMQ_HAVE_POLLER
-static int zmq_poller_poll (zmq_pollitem_t *items_, int nitems_, long timeout_)
-{
-    // implement zmq_poll on top of zmq_poller
-    int rc;
-    zmq_poller_event_t *events;
-    zmq::socket_poller_t poller;
-    events = new (std::nothrow) zmq_poller_event_t[nitems_];
-    alloc_assert (events);
-
-    bool repeat_items = false;
-    //  Register sockets with poller
-    for (int i = 0; i < nitems_; i++) {
-        items_[i].revents = 0;
-
-        bool modify = false;
-        short e = items_[i].events;
-        if (items_[i].socket) {
-            //  Poll item is a 0MQ socket.
-            for (int j = 0; j < i; ++j) {
-                // Check for repeat entries
-                if (items_[j].socket == items_[i].socket) {
-                    repeat_items = true;
-                    modify = true;
-                    e |= items_[j].events;
-                }
-            }
-            if (modify) {
-                rc = zmq_poller_modify (&poller, items_[i].socket, e);
-            } else {
-                rc = zmq_poller_add (&poller, items_[i].socket, NULL, e);
-            }
-            if (rc < 0) {
-                delete[] events;
-                return rc;
-            }
-        } else {
-            //  Poll item is a raw file descriptor.
-            for (int j = 0; j < i; ++j) {
-                // Check for repeat entries
-                if (!items_[j].socket && items_[j].fd == items_[i].fd) {
-                    repeat_items = true;
-                    modify = true;
-                    e |= items_[j].events;
-                }
-            }
-            if (modify) {
-                rc = zmq_poller_modify_fd (&poller, items_[i].fd, e);
-            } else {
-                rc = zmq_poller_add_fd (&poller, items_[i].fd, NULL, e);
-            }
-            if (rc < 0) {
-                delete[] events;
-                return rc;
-            }
-        }
-    }
-
-    //  Wait for events
-    rc = zmq_poller_wait_all (&poller, events, nitems_, timeout_);
-    if (rc < 0) {
-        delete[] events;
-        if (zmq_errno () == EAGAIN) {
-            return 0;
-        }
-        return rc;
-    }
-
-    //  Transform poller events into zmq_pollitem events.
-    //  items_ contains all items, while events only contains fired events.
-    //  If no sockets are repeated (likely), the two are still co-ordered, so step through the items
-    //  checking for matches only on the first event.
-    //  If there are repeat items, they cannot be assumed to be co-ordered,
-    //  so each pollitem must check fired events from the beginning.
-    int j_start = 0, found_events = rc;
-    for (int i = 0; i < nitems_; i++) {
-        for (int j = j_start; j < found_events; ++j) {
-            if ((items_[i].socket && items_[i].socket == events[j].socket)
-                || (!(items_[i].socket || events[j].socket)
-                    && items_[i].fd == events[j].fd)) {
-                items_[i].revents = events[j].events & items_[i].events;
-                if (!repeat_items) {
-                    // no repeats, we can ignore events we've already seen
-                    j_start++;
-                }
-                break;
-            }
-            if (!repeat_items) {
-                // no repeats, never have to look at j > j_start
-                break;
-            }
-        }
-    }
-
-    //  Cleanup
-    delete[] events;
-    return rc;
-}
-#endif // ZMQ_HAVE_POLLER
-
 int zmq_poll (zmq_pollitem_t *items_, int nitems_, long timeout_)
 {
 #if defined ZMQ_HAVE_POLLER
@@ -833,8 +765,10 @@ int zmq_poll (zmq_pollitem_t *items_, int nitems_, long timeout_)
         if (items_[i].socket) {
             zmq::socket_base_t *s = as_socket_base_t (items_[i].socket);
             if (s) {
-                if (s->is_thread_safe ())
-                    return zmq_poller_poll (items_, nitems_, timeout_);
+                if (s->is_thread_safe ()) {
+                    zmq::socket_poller_t poller;
+                    return poller.poll_items (items_, nitems_, timeout_);
+                }
             } else {
                 //as_socket_base_t returned NULL : socket is invalid
                 return -1;
@@ -1612,6 +1546,18 @@ int zmq_poller_wait_all (void *poller_,
     return rc;
 }
 
+int zmq_poller_poll (void *poller_,
+                     zmq_pollitem_t *items_,
+                     int nitems_,
+                     long timeout_)
+{
+    if (-1 == check_poller (poller_))
+        return -1;
+
+    return (static_cast<zmq::socket_poller_t *> (poller_))
+      ->poll_items (items_, nitems_, timeout_);
+}
+
 int zmq_poller_fd (void *poller_, zmq_fd_t *fd_)
 {
     if (!poller_
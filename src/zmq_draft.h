@@ -54,6 +54,16 @@
 #define ZMQ_NORM_NUM_PARITY 122
 #define ZMQ_NORM_NUM_AUTOPARITY 123
 #define ZMQ_NORM_PUSH 124
+#define ZMQ_TCP_ZEROCOPY 125
+#define ZMQ_RCVSPIN 126
+#define ZMQ_LATENCY_STATS 127
+#define ZMQ_PUB_SHARDS 128
+#define ZMQ_IO_THREAD_LOCALITY 129
+#define ZMQ_TCP_ACCEPT_SHARDS 130
+#define ZMQ_CURVE_BATCH 131
+
+/*  DRAFT Send/recv options.                                                  */
+#define ZMQ_SNDDEFER 4
 
 /*  DRAFT ZMQ_NORM_MODE options                                               */
 #define ZMQ_NORM_FIXED 0
@@ -69,6 +79,11 @@
 
 /*  DRAFT Context options                                                     */
 #define ZMQ_ZERO_COPY_RECV 10
+#define ZMQ_MSG_POOL 11
+#define ZMQ_HUGE_PAGES 12
+#define ZMQ_NUMA_LOCAL 13
+#define ZMQ_CURVE_THREADS 14
+#define ZMQ_IO_URING 15
 
 /*  DRAFT Context methods.                                                    */
 int zmq_ctx_set_ext (void *context_,
@@ -83,6 +98,8 @@ int zmq_ctx_get_ext (void *context_,
 /*  DRAFT Socket methods.                                                     */
 int zmq_join (void *s_, const char *group_);
 int zmq_leave (void *s_, const char *group_);
+int zmq_sendmmsg (void *s_, zmq_msg_t *msgs_, size_t count_, int flags_);
+int zmq_recvmmsg (void *s_, zmq_msg_t *msgs_, size_t count_, int flags_);
 
 /*  DRAFT Msg methods.                                                        */
 int zmq_msg_set_routing_id (zmq_msg_t *msg_, uint32_t routing_id_);
@@ -134,6 +151,10 @@ int zmq_poller_wait_all (void *poller_,
                          int n_events_,
                          long timeout_);
 zmq_fd_t zmq_poller_fd (void *poller_);
+int zmq_poller_poll (void *poller_,
+                     zmq_pollitem_t *items_,
+                     int nitems_,
+                     long timeout_);
 
 int zmq_poller_add_fd (void *poller_,
                        zmq_fd_t fd_,
@@ -148,12 +169,14 @@ int zmq_socket_get_peer_state (void *socket_,
 
 /*  DRAFT Socket monitoring events                                            */
 #define ZMQ_EVENT_PIPES_STATS 0x10000
+#define ZMQ_EVENT_PIPES_LATENCY 0x20000
 
 #define ZMQ_CURRENT_EVENT_VERSION 1
 #define ZMQ_CURRENT_EVENT_VERSION_DRAFT 2
 
 #define ZMQ_EVENT_ALL_V1 ZMQ_EVENT_ALL
-#define ZMQ_EVENT_ALL_V2 ZMQ_EVENT_ALL_V1 | ZMQ_EVENT_PIPES_STATS
+#define ZMQ_EVENT_ALL_V2                                                       \
+    ZMQ_EVENT_ALL_V1 | ZMQ_EVENT_PIPES_STATS | ZMQ_EVENT_PIPES_LATENCY
 
 int zmq_socket_monitor_versioned (
   void *s_, const char *addr_, uint64_t events_, int event_version_, int type_);
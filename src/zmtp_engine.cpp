@@ -50,6 +50,7 @@ zmq::zmtp_engine_t::zmtp_engine_t (
       &zmtp_engine_t::routing_id_msg);
     _process_msg = static_cast<int (stream_engine_base_t::*) (msg_t *)> (
       &zmtp_engine_t::process_routing_id_msg);
+    _vectored_output = true;
 
     int rc = _pong_msg.init ();
     errno_assert (rc == 0);
@@ -1,6 +1,7 @@
 /* SPDX-License-Identifier: MPL-2.0 */
 
 #include <limits>
+#include <string.h>
 #include "testutil.hpp"
 #include "testutil_unity.hpp"
 
@@ -178,6 +179,164 @@ void test_ctx_zero_copy ()
 #endif
 }
 
+void test_ctx_msg_pool ()
+{
+#ifdef ZMQ_MSG_POOL
+    //  Disabled by default.
+    TEST_ASSERT_EQUAL_INT (0, zmq_ctx_get (get_test_context (), ZMQ_MSG_POOL));
+
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set (get_test_context (), ZMQ_MSG_POOL, 1));
+    TEST_ASSERT_EQUAL_INT (1, zmq_ctx_get (get_test_context (), ZMQ_MSG_POOL));
+
+    //  Send messages of pooled and non-pooled sizes over TCP, so that they
+    //  are released by threads other than those that allocated them.
+    void *pull = zmq_socket (get_test_context (), ZMQ_PULL);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+
+    void *push = zmq_socket (get_test_context (), ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    const size_t sizes[] = {100, 200, 1000, 5000, 20000};
+    const int count = 500;
+    char buf[20000];
+    for (int i = 0; i < count; ++i) {
+        const size_t size = sizes[i % (sizeof sizes / sizeof sizes[0])];
+        memset (buf, 'a' + i % 26, size);
+        TEST_ASSERT_EQUAL_INT (
+          static_cast<int> (size),
+          TEST_ASSERT_SUCCESS_ERRNO (zmq_send (push, buf, size, 0)));
+    }
+    for (int i = 0; i < count; ++i) {
+        const size_t size = sizes[i % (sizeof sizes / sizeof sizes[0])];
+        zmq_msg_t msg;
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+        TEST_ASSERT_EQUAL_INT (static_cast<int> (size),
+                               TEST_ASSERT_SUCCESS_ERRNO (
+                                 zmq_msg_recv (&msg, pull, 0)));
+        memset (buf, 'a' + i % 26, size);
+        TEST_ASSERT_EQUAL_MEMORY (buf, zmq_msg_data (&msg), size);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+    }
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (push));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (pull));
+
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set (get_test_context (), ZMQ_MSG_POOL, 0));
+    TEST_ASSERT_EQUAL_INT (0, zmq_ctx_get (get_test_context (), ZMQ_MSG_POOL));
+#endif
+}
+
+#if defined ZMQ_HUGE_PAGES || defined ZMQ_NUMA_LOCAL
+//  Sends messages of several sizes over TCP, so that pipe chunks and decoder
+//  buffers are allocated while the feature is in use.
+static void test_ctx_chunk_pool_feature (int option_)
+{
+    //  Disabled by default.
+    TEST_ASSERT_EQUAL_INT (0, zmq_ctx_get (get_test_context (), option_));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_set (get_test_context (), option_, 1));
+    TEST_ASSERT_EQUAL_INT (1, zmq_ctx_get (get_test_context (), option_));
+
+    void *pull = zmq_socket (get_test_context (), ZMQ_PULL);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+
+    void *push = zmq_socket (get_test_context (), ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    const size_t sizes[] = {10, 1000, 10000, 100000};
+    const int count = 200;
+    static char buf[100000];
+    for (int i = 0; i < count; ++i) {
+        const size_t size = sizes[i % (sizeof sizes / sizeof sizes[0])];
+        memset (buf, 'a' + i % 26, size);
+        TEST_ASSERT_EQUAL_INT (
+          static_cast<int> (size),
+          TEST_ASSERT_SUCCESS_ERRNO (zmq_send (push, buf, size, 0)));
+    }
+    for (int i = 0; i < count; ++i) {
+        const size_t size = sizes[i % (sizeof sizes / sizeof sizes[0])];
+        zmq_msg_t msg;
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+        TEST_ASSERT_EQUAL_INT (static_cast<int> (size),
+                               TEST_ASSERT_SUCCESS_ERRNO (
+                                 zmq_msg_recv (&msg, pull, 0)));
+        memset (buf, 'a' + i % 26, size);
+        TEST_ASSERT_EQUAL_MEMORY (buf, zmq_msg_data (&msg), size);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+    }
+
+    //  Chunks allocated while the feature was in use can be released after.
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_set (get_test_context (), option_, 0));
+    TEST_ASSERT_EQUAL_INT (0, zmq_ctx_get (get_test_context (), option_));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (push));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (pull));
+}
+#endif
+
+void test_ctx_huge_pages ()
+{
+#ifdef ZMQ_HUGE_PAGES
+    test_ctx_chunk_pool_feature (ZMQ_HUGE_PAGES);
+#endif
+}
+
+void test_ctx_numa_local ()
+{
+#ifdef ZMQ_NUMA_LOCAL
+    test_ctx_chunk_pool_feature (ZMQ_NUMA_LOCAL);
+#endif
+}
+
+void test_ctx_curve_threads ()
+{
+#ifdef ZMQ_CURVE_THREADS
+    //  None by default.
+    void *ctx = zmq_ctx_new ();
+    TEST_ASSERT_NOT_NULL (ctx);
+    TEST_ASSERT_EQUAL_INT (0, zmq_ctx_get (ctx, ZMQ_CURVE_THREADS));
+
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL,
+                               zmq_ctx_set (ctx, ZMQ_CURVE_THREADS, -1));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_set (ctx, ZMQ_CURVE_THREADS, 2));
+    TEST_ASSERT_EQUAL_INT (2, zmq_ctx_get (ctx, ZMQ_CURVE_THREADS));
+
+    //  The threads start along with the first socket, and stop when the
+    //  context terminates.
+    void *socket = zmq_socket (ctx, ZMQ_PULL);
+    TEST_ASSERT_NOT_NULL (socket);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (socket));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_term (ctx));
+#endif
+}
+
+void test_ctx_io_uring ()
+{
+#ifdef ZMQ_IO_URING
+    //  Off by default.
+    void *ctx = zmq_ctx_new ();
+    TEST_ASSERT_NOT_NULL (ctx);
+    TEST_ASSERT_EQUAL_INT (0, zmq_ctx_get (ctx, ZMQ_IO_URING));
+
+    //  Only available in builds with io_uring.
+    if (zmq_ctx_set (ctx, ZMQ_IO_URING, 1) == 0) {
+        TEST_ASSERT_EQUAL_INT (1, zmq_ctx_get (ctx, ZMQ_IO_URING));
+        TEST_ASSERT_FAILURE_ERRNO (EINVAL,
+                                   zmq_ctx_set (ctx, ZMQ_IO_URING, -1));
+    } else
+        TEST_ASSERT_EQUAL_INT (EINVAL, errno);
+
+    void *socket = zmq_socket (ctx, ZMQ_PULL);
+    TEST_ASSERT_NOT_NULL (socket);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (socket));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_term (ctx));
+#endif
+}
+
 void test_ctx_option_max_sockets ()
 {
     TEST_ASSERT_EQUAL_INT (ZMQ_MAX_SOCKETS_DFLT,
@@ -277,6 +436,11 @@ int main (void)
     RUN_TEST (test_ctx_option_ipv6_set);
     RUN_TEST (test_ctx_thread_opts);
     RUN_TEST (test_ctx_zero_copy);
+    RUN_TEST (test_ctx_msg_pool);
+    RUN_TEST (test_ctx_huge_pages);
+    RUN_TEST (test_ctx_numa_local);
+    RUN_TEST (test_ctx_curve_threads);
+    RUN_TEST (test_ctx_io_uring);
     RUN_TEST (test_ctx_option_blocky);
     RUN_TEST (test_ctx_option_invalid);
     return UNITY_END ();
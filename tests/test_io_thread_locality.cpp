@@ -0,0 +1,116 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+static const int io_threads = 4;
+
+void setUp ()
+{
+    setup_test_context ();
+    zmq_ctx_set (get_test_context (), ZMQ_IO_THREADS, io_threads);
+}
+
+void tearDown ()
+{
+    teardown_test_context ();
+}
+
+static void set_locality (void *socket_)
+{
+    const int locality = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (
+      socket_, ZMQ_IO_THREAD_LOCALITY, &locality, sizeof locality));
+}
+
+void test_option ()
+{
+    void *socket = test_context_socket (ZMQ_DEALER);
+
+    int value = -1;
+    size_t value_size = sizeof value;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_IO_THREAD_LOCALITY, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (0, value);
+
+    set_locality (socket);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_IO_THREAD_LOCALITY, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (1, value);
+
+    value = 2;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL,
+      zmq_setsockopt (socket, ZMQ_IO_THREAD_LOCALITY, &value, sizeof value));
+
+    test_context_socket_close (socket);
+}
+
+void test_tcp ()
+{
+    void *server = test_context_socket (ZMQ_ROUTER);
+    set_locality (server);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (server, endpoint, sizeof endpoint);
+
+    //  Some connections are pinned to an I/O thread in addition.
+    const int count = 8;
+    void *clients[count];
+    for (int i = 0; i < count; ++i) {
+        clients[i] = test_context_socket (ZMQ_DEALER);
+        set_locality (clients[i]);
+        if (i % 2) {
+            const uint64_t affinity = 1 << (i % io_threads);
+            TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (
+              clients[i], ZMQ_AFFINITY, &affinity, sizeof affinity));
+        }
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (clients[i], endpoint));
+    }
+
+    for (int i = 0; i < count; ++i) {
+        send_string_expect_success (clients[i], "hello", 0);
+        zmq_msg_t routing_id;
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&routing_id));
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_recv (&routing_id, server, 0));
+        recv_string_expect_success (server, "hello", 0);
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_msg_send (&routing_id, server, ZMQ_SNDMORE));
+        send_string_expect_success (server, "world", 0);
+        recv_string_expect_success (clients[i], "world", 0);
+    }
+
+    for (int i = 0; i < count; ++i)
+        test_context_socket_close (clients[i]);
+    test_context_socket_close (server);
+}
+
+void test_pair_over_ipc ()
+{
+#if defined ZMQ_HAVE_IPC
+    void *server = test_context_socket (ZMQ_PAIR);
+    set_locality (server);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipc (server, endpoint, sizeof endpoint);
+    void *client = test_context_socket (ZMQ_PAIR);
+    set_locality (client);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (client, endpoint));
+
+    bounce (server, client);
+
+    test_context_socket_close (client);
+    test_context_socket_close (server);
+#else
+    TEST_IGNORE_MESSAGE ("libzmq without IPC, ignoring test");
+#endif
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_option);
+    RUN_TEST (test_tcp);
+    RUN_TEST (test_pair_over_ipc);
+    return UNITY_END ();
+}
@@ -0,0 +1,155 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+void setUp ()
+{
+    setup_test_context ();
+
+    //  Builds without io_uring reject the option, and run the tests with
+    //  the usual I/O.
+#ifdef ZMQ_IO_URING
+    const int rc = zmq_ctx_set (get_test_context (), ZMQ_IO_URING, 1);
+    TEST_ASSERT_TRUE (rc == 0 || errno == EINVAL);
+#endif
+}
+
+void tearDown ()
+{
+    teardown_test_context ();
+}
+
+static const size_t large_size = 256 * 1024;
+
+static void fill (unsigned char *data_, size_t size_, int seed_)
+{
+    for (size_t i = 0; i < size_; ++i)
+        data_[i] = static_cast<unsigned char> (i * 7 + seed_);
+}
+
+static void send_and_check (void *push_, void *pull_, int count_)
+{
+    unsigned char *buf = static_cast<unsigned char *> (malloc (large_size));
+    TEST_ASSERT_NOT_NULL (buf);
+
+    //  Large messages span several buffers of the ring, small ones share
+    //  one.
+    for (int i = 0; i < count_; ++i) {
+        const size_t size = i % 3 == 0 ? large_size : 10;
+        fill (buf, size, i);
+        TEST_ASSERT_EQUAL_INT (
+          static_cast<int> (size),
+          TEST_ASSERT_SUCCESS_ERRNO (zmq_send (push_, buf, size, 0)));
+    }
+
+    unsigned char *expected =
+      static_cast<unsigned char *> (malloc (large_size));
+    TEST_ASSERT_NOT_NULL (expected);
+    for (int i = 0; i < count_; ++i) {
+        const size_t size = i % 3 == 0 ? large_size : 10;
+        fill (expected, size, i);
+        TEST_ASSERT_EQUAL_INT (
+          static_cast<int> (size),
+          TEST_ASSERT_SUCCESS_ERRNO (zmq_recv (pull_, buf, large_size, 0)));
+        TEST_ASSERT_EQUAL_MEMORY (expected, buf, size);
+    }
+
+    free (expected);
+    free (buf);
+}
+
+static void test_push_pull (bind_function_t bind_function_)
+{
+    char endpoint[MAX_SOCKET_STRING];
+    void *pull = test_context_socket (ZMQ_PULL);
+    bind_function_ (pull, endpoint, sizeof endpoint);
+    void *push = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    send_and_check (push, pull, 30);
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+void test_push_pull_tcp ()
+{
+    test_push_pull (bind_loopback_ipv4);
+}
+
+void test_push_pull_ipc ()
+{
+#if defined ZMQ_HAVE_IPC
+    test_push_pull (bind_loopback_ipc);
+#else
+    TEST_IGNORE_MESSAGE ("libzmq without IPC, ignoring test");
+#endif
+}
+
+void test_req_rep ()
+{
+    char endpoint[MAX_SOCKET_STRING];
+    void *rep = test_context_socket (ZMQ_REP);
+    bind_loopback_ipv4 (rep, endpoint, sizeof endpoint);
+    void *req = test_context_socket (ZMQ_REQ);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (req, endpoint));
+
+    for (int i = 0; i < 100; ++i)
+        bounce (rep, req);
+
+    test_context_socket_close (req);
+    test_context_socket_close (rep);
+}
+
+void test_stream_disconnect ()
+{
+    char endpoint[MAX_SOCKET_STRING];
+    void *server = test_context_socket (ZMQ_STREAM);
+    bind_loopback_ipv4 (server, endpoint, sizeof endpoint);
+    void *client = test_context_socket (ZMQ_STREAM);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (client, endpoint));
+
+    //  Both ends are notified of the connection.
+    unsigned char id[256];
+    const int id_size = TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_recv (client, id, sizeof id, 0));
+    TEST_ASSERT_EQUAL_INT (0, zmq_recv (client, NULL, 0, 0));
+    unsigned char server_id[256];
+    const int server_id_size = TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_recv (server, server_id, sizeof server_id, 0));
+    TEST_ASSERT_EQUAL_INT (0, zmq_recv (server, NULL, 0, 0));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_send (client, id, id_size, ZMQ_SNDMORE));
+    send_string_expect_success (client, "hello", 0);
+    unsigned char buf[256];
+    TEST_ASSERT_EQUAL_INT (server_id_size,
+                           TEST_ASSERT_SUCCESS_ERRNO (
+                             zmq_recv (server, buf, sizeof buf, 0)));
+    recv_string_expect_success (server, "hello", 0);
+
+    //  The server is notified once the client has closed the connection.
+    test_context_socket_close (client);
+    TEST_ASSERT_EQUAL_INT (server_id_size,
+                           TEST_ASSERT_SUCCESS_ERRNO (
+                             zmq_recv (server, buf, sizeof buf, 0)));
+    TEST_ASSERT_EQUAL_MEMORY (server_id, buf, server_id_size);
+    TEST_ASSERT_EQUAL_INT (0, zmq_recv (server, NULL, 0, 0));
+
+    test_context_socket_close (server);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_push_pull_tcp);
+    RUN_TEST (test_push_pull_ipc);
+    RUN_TEST (test_req_rep);
+    RUN_TEST (test_stream_disconnect);
+    return UNITY_END ();
+}
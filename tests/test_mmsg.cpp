@@ -0,0 +1,225 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+static const int batch_size = 32;
+
+static void init_batch (zmq_msg_t *msgs_, int count_, int first_)
+{
+    for (int i = 0; i < count_; ++i) {
+        char buf[16];
+        const int size = sprintf (buf, "msg %d", first_ + i);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_buffer (&msgs_[i], buf, size));
+    }
+}
+
+static void close_batch (zmq_msg_t *msgs_, int count_)
+{
+    for (int i = 0; i < count_; ++i)
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msgs_[i]));
+}
+
+static void expect_msg (zmq_msg_t *msg_, int index_)
+{
+    char buf[16];
+    const int size = sprintf (buf, "msg %d", index_);
+    TEST_ASSERT_EQUAL_INT (size, zmq_msg_size (msg_));
+    TEST_ASSERT_EQUAL_MEMORY (buf, zmq_msg_data (msg_), size);
+}
+
+//  Receives count_ messages in batches, checking they arrive in order.
+static void recv_batches (void *socket_, int count_)
+{
+    zmq_msg_t msgs[batch_size];
+    for (int i = 0; i < batch_size; ++i)
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msgs[i]));
+
+    int received = 0;
+    while (received < count_) {
+        const int rc = TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_recvmmsg (socket_, msgs, batch_size, 0));
+        TEST_ASSERT_GREATER_THAN_INT (0, rc);
+        TEST_ASSERT_LESS_OR_EQUAL_INT (count_ - received, rc);
+        for (int i = 0; i < rc; ++i)
+            expect_msg (&msgs[i], received + i);
+        received += rc;
+    }
+    close_batch (msgs, batch_size);
+}
+
+static void recv_batches_thread (void *socket_)
+{
+    recv_batches (socket_, 10 * batch_size);
+}
+
+void test_invalid ()
+{
+    void *push = test_context_socket (ZMQ_PUSH);
+    zmq_msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL, zmq_sendmmsg (push, NULL, 1, 0));
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL, zmq_sendmmsg (push, &msg, 0, 0));
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL, zmq_recvmmsg (push, NULL, 1, 0));
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL, zmq_recvmmsg (push, &msg, 0, 0));
+    TEST_ASSERT_FAILURE_ERRNO (ENOTSOCK, zmq_sendmmsg (NULL, &msg, 1, 0));
+    TEST_ASSERT_FAILURE_ERRNO (ENOTSOCK, zmq_recvmmsg (NULL, &msg, 1, 0));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+    test_context_socket_close (push);
+}
+
+void test_push_pull ()
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pull, "inproc://mmsg"));
+    void *push = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, "inproc://mmsg"));
+
+    zmq_msg_t msgs[batch_size];
+    init_batch (msgs, batch_size, 0);
+    TEST_ASSERT_EQUAL_INT (batch_size, TEST_ASSERT_SUCCESS_ERRNO (zmq_sendmmsg (
+                                         push, msgs, batch_size, 0)));
+
+    //  The messages sent are left empty.
+    for (int i = 0; i < batch_size; ++i)
+        TEST_ASSERT_EQUAL_INT (0, zmq_msg_size (&msgs[i]));
+    close_batch (msgs, batch_size);
+
+    recv_batches (pull, batch_size);
+
+    //  Nothing else is waiting to be received.
+    zmq_msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN,
+                               zmq_recvmmsg (pull, &msg, 1, ZMQ_DONTWAIT));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+void test_multipart ()
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+    void *push = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    //  The whole batch is sent as the leading parts of a message.
+    zmq_msg_t msgs[3];
+    init_batch (msgs, 3, 0);
+    TEST_ASSERT_EQUAL_INT (
+      3, TEST_ASSERT_SUCCESS_ERRNO (zmq_sendmmsg (push, msgs, 3, ZMQ_SNDMORE)));
+    send_string_expect_success (push, "msg 3", 0);
+
+    zmq_msg_t parts[4];
+    for (int i = 0; i < 4; ++i)
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&parts[i]));
+    int received = 0;
+    while (received < 4)
+        received += TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_recvmmsg (pull, parts + received, 4 - received, 0));
+    for (int i = 0; i < 4; ++i) {
+        expect_msg (&parts[i], i);
+        TEST_ASSERT_EQUAL_INT (i < 3, zmq_msg_more (&parts[i]));
+    }
+
+    int rcvmore = 1;
+    size_t rcvmore_size = sizeof rcvmore;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (pull, ZMQ_RCVMORE, &rcvmore, &rcvmore_size));
+    TEST_ASSERT_EQUAL_INT (0, rcvmore);
+
+    close_batch (msgs, 3);
+    close_batch (parts, 4);
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+void test_partial_send ()
+{
+    //  Without any peer nothing can be sent.
+    void *push = test_context_socket (ZMQ_PUSH);
+    zmq_msg_t msgs[batch_size];
+    init_batch (msgs, batch_size, 0);
+    TEST_ASSERT_FAILURE_ERRNO (
+      EAGAIN, zmq_sendmmsg (push, msgs, batch_size, ZMQ_DONTWAIT));
+    expect_msg (&msgs[0], 0);
+
+    //  Once the peer is there, the batch is sent up to the high water mark.
+    const int hwm = 4;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (push, ZMQ_SNDHWM, &hwm, sizeof hwm));
+    void *pull = test_context_socket (ZMQ_PULL);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (pull, ZMQ_RCVHWM, &hwm, sizeof hwm));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pull, "inproc://mmsg-partial"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, "inproc://mmsg-partial"));
+
+    const int sent = TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_sendmmsg (push, msgs, batch_size, ZMQ_DONTWAIT));
+    TEST_ASSERT_GREATER_THAN_INT (0, sent);
+    TEST_ASSERT_LESS_THAN_INT (batch_size, sent);
+
+    //  The messages which were not sent are left as they were.
+    for (int i = sent; i < batch_size; ++i)
+        expect_msg (&msgs[i], i);
+
+    recv_batches (pull, sent);
+
+    close_batch (msgs, batch_size);
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+void test_blocking_send ()
+{
+    //  A batch larger than the high water marks can be sent only if the
+    //  messages sent so far are flushed to the peer while waiting.
+    const int hwm = 8;
+    void *pull = test_context_socket (ZMQ_PULL);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (pull, ZMQ_RCVHWM, &hwm, sizeof hwm));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pull, "inproc://mmsg-blocking"));
+    void *push = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (push, ZMQ_SNDHWM, &hwm, sizeof hwm));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, "inproc://mmsg-blocking"));
+
+    void *thread = zmq_threadstart (recv_batches_thread, pull);
+
+    const int count = 10 * batch_size;
+    zmq_msg_t msgs[count];
+    init_batch (msgs, count, 0);
+    int sent = 0;
+    while (sent < count)
+        sent += TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_sendmmsg (push, msgs + sent, count - sent, 0));
+    close_batch (msgs, count);
+
+    zmq_threadclose (thread);
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_invalid);
+    RUN_TEST (test_push_pull);
+    RUN_TEST (test_multipart);
+    RUN_TEST (test_partial_send);
+    RUN_TEST (test_blocking_send);
+    return UNITY_END ();
+}
@@ -408,6 +408,79 @@ void test_monitor_versioned_stats_ipc ()
     static const char prefix[] = "ipc://";
     test_monitor_versioned_stats (bind_loopback_ipc, prefix);
 }
+
+#ifdef ZMQ_EVENT_PIPES_LATENCY
+void test_monitor_versioned_latency ()
+{
+    char server_endpoint[MAX_SOCKET_STRING];
+    const int msg_count = 100;
+
+    void *server = test_context_socket (ZMQ_DEALER);
+    int enabled = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (server, ZMQ_LATENCY_STATS,
+                                               &enabled, sizeof (enabled)));
+    enabled = 0;
+    size_t enabled_size = sizeof (enabled);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_getsockopt (server, ZMQ_LATENCY_STATS,
+                                               &enabled, &enabled_size));
+    TEST_ASSERT_EQUAL_INT (1, enabled);
+
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_socket_monitor_versioned (server, "inproc://monitor-latency",
+                                    ZMQ_EVENT_PIPES_LATENCY, 2, ZMQ_PAIR));
+    void *server_mon = test_context_socket (ZMQ_PAIR);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_connect (server_mon, "inproc://monitor-latency"));
+
+    bind_loopback_ipv4 (server, server_endpoint, sizeof (server_endpoint));
+    void *client = test_context_socket (ZMQ_DEALER);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (client, server_endpoint));
+
+    //  Pass messages in both directions
+    for (int i = 0; i < msg_count; ++i)
+        send_string_expect_success (server, "ping", 0);
+    for (int i = 0; i < msg_count; ++i) {
+        recv_string_expect_success (client, "ping", 0);
+        send_string_expect_success (client, "pong", 0);
+    }
+    for (int i = 0; i < msg_count; ++i)
+        recv_string_expect_success (server, "pong", 0);
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_socket_monitor_pipes_stats (server));
+    msleep (SETTLE_TIME);
+    unsigned long int dummy;
+    size_t dummy_size = sizeof (dummy);
+    zmq_getsockopt (server, ZMQ_EVENTS, &dummy, &dummy_size);
+
+    char *local_address = NULL;
+    char *remote_address = NULL;
+    uint64_t *latency = NULL;
+    const int64_t event = get_monitor_event_v2 (server_mon, &latency,
+                                                &local_address, &remote_address);
+    TEST_ASSERT_EQUAL_INT (ZMQ_EVENT_PIPES_LATENCY, event);
+    TEST_ASSERT_EQUAL_STRING (server_endpoint, local_address);
+    TEST_ASSERT_NOT_NULL (latency);
+
+    //  Egress queue, egress network writes and ingress queue, each as
+    //  count, 50th, 90th and 99th percentiles, and maximum.
+    TEST_ASSERT_EQUAL_UINT64 (msg_count, latency[0]);
+    TEST_ASSERT_TRUE (latency[5] > 0);
+    TEST_ASSERT_TRUE (latency[5] <= msg_count);
+    TEST_ASSERT_EQUAL_UINT64 (msg_count, latency[10]);
+    for (int i = 0; i < 3; ++i) {
+        TEST_ASSERT_TRUE (latency[i * 5 + 1] <= latency[i * 5 + 2]);
+        TEST_ASSERT_TRUE (latency[i * 5 + 2] <= latency[i * 5 + 3]);
+        TEST_ASSERT_TRUE (latency[i * 5 + 3] <= latency[i * 5 + 4]);
+    }
+    free (local_address);
+    free (remote_address);
+    free (latency);
+
+    test_context_socket_close_zero_linger (server_mon);
+    test_context_socket_close_zero_linger (client);
+    test_context_socket_close_zero_linger (server);
+}
+#endif // ZMQ_EVENT_PIPES_LATENCY
 #endif // ZMQ_EVENT_PIPES_STATS
 #endif
 
@@ -431,6 +504,9 @@ int main ()
     RUN_TEST (test_monitor_versioned_stats_tcp_ipv4);
     RUN_TEST (test_monitor_versioned_stats_tcp_ipv6);
     RUN_TEST (test_monitor_versioned_stats_ipc);
+#ifdef ZMQ_EVENT_PIPES_LATENCY
+    RUN_TEST (test_monitor_versioned_latency);
+#endif
 #endif
 #endif
 
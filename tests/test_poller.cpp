@@ -4,6 +4,7 @@
 #include "testutil_unity.hpp"
 
 #include <limits.h>
+#include <stdio.h>
 
 #ifndef _WIN32
 #include <sys/socket.h>
@@ -636,6 +637,37 @@ void test_poll_fd ()
     TEST_ASSERT_SUCCESS_ERRNO (zmq_poller_destroy (&poller));
 }
 
+void test_poll_regular_file ()
+{
+    //  Regular files are always ready, as poll () reports them.
+    FILE *file = tmpfile ();
+    TEST_ASSERT_NOT_NULL (file);
+    const fd_t fd = fileno (file);
+
+    void *poller = zmq_poller_new ();
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_poller_add_fd (poller, fd, file, ZMQ_POLLIN | ZMQ_POLLOUT));
+
+    zmq_poller_event_t event;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_poller_wait (poller, &event, -1));
+    TEST_ASSERT_NULL (event.socket);
+    TEST_ASSERT_EQUAL (fd, event.fd);
+    TEST_ASSERT_EQUAL_PTR (file, event.user_data);
+    TEST_ASSERT_EQUAL (ZMQ_POLLIN | ZMQ_POLLOUT, event.events);
+
+    //  Only the events polled for are reported.
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_poller_modify_fd (poller, fd, ZMQ_POLLOUT));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_poller_wait (poller, &event, 0));
+    TEST_ASSERT_EQUAL (ZMQ_POLLOUT, event.events);
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_poller_modify_fd (poller, fd, 0));
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN, zmq_poller_wait (poller, &event, 0));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_poller_remove_fd (poller, fd));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_poller_destroy (&poller));
+    fclose (file);
+}
+
 void test_poll_client_server ()
 {
 #if defined(ZMQ_SERVER) && defined(ZMQ_CLIENT)
@@ -690,6 +722,160 @@ void test_poll_client_server ()
 #endif
 }
 
+void test_poll_many_sockets ()
+{
+    const int count = 50;
+    void *senders[count];
+    void *receivers[count];
+    void *poller = zmq_poller_new ();
+    for (int i = 0; i < count; ++i) {
+        char endpoint[32];
+        sprintf (endpoint, "inproc://poll-many-%d", i);
+        receivers[i] = test_context_socket (ZMQ_PULL);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (receivers[i], endpoint));
+        senders[i] = test_context_socket (ZMQ_PUSH);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (senders[i], endpoint));
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_poller_add (poller, receivers[i], senders[i], ZMQ_POLLIN));
+    }
+
+    zmq_poller_event_t events[count];
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN,
+                               zmq_poller_wait_all (poller, events, count, 0));
+
+    //  Sockets are reported as long as they have messages.
+    const int step = 10;
+    for (int i = 0; i < count; i += step) {
+        send_string_expect_success (senders[i], "a", 0);
+        send_string_expect_success (senders[i], "b", 0);
+    }
+    for (int round = 0; round < 2; ++round) {
+        TEST_ASSERT_EQUAL_INT (count / step,
+                               TEST_ASSERT_SUCCESS_ERRNO (zmq_poller_wait_all (
+                                 poller, events, count, -1)));
+        for (int i = 0; i < count / step; ++i) {
+            TEST_ASSERT_EQUAL_INT (ZMQ_POLLIN, events[i].events);
+            recv_string_expect_success (events[i].socket, round ? "b" : "a",
+                                        0);
+        }
+    }
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN,
+                               zmq_poller_wait_all (poller, events, count, 0));
+
+    //  Receiving without polling does not hide the messages left.
+    send_string_expect_success (senders[1], "c", 0);
+    send_string_expect_success (senders[1], "d", 0);
+    recv_string_expect_success (receivers[1], "c", ZMQ_DONTWAIT);
+    TEST_ASSERT_EQUAL_INT (1, TEST_ASSERT_SUCCESS_ERRNO (zmq_poller_wait_all (
+                                poller, events, count, 0)));
+    TEST_ASSERT_EQUAL_PTR (receivers[1], events[0].socket);
+    TEST_ASSERT_EQUAL_PTR (senders[1], events[0].user_data);
+    recv_string_expect_success (receivers[1], "d", 0);
+
+    //  Removed sockets are not reported.
+    send_string_expect_success (senders[2], "e", 0);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_poller_remove (poller, receivers[2]));
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN,
+                               zmq_poller_wait_all (poller, events, count, 0));
+    recv_string_expect_success (receivers[2], "e", 0);
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_poller_destroy (&poller));
+    for (int i = 0; i < count; ++i) {
+        test_context_socket_close (senders[i]);
+        test_context_socket_close (receivers[i]);
+    }
+}
+
+void test_poller_poll ()
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pull, "inproc://poller_poll"));
+    void *push = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, "inproc://poller_poll"));
+
+    void *poller = zmq_poller_new ();
+    zmq_pollitem_t items[] = {{pull, 0, ZMQ_POLLIN, 0},
+                              {push, 0, ZMQ_POLLIN, 0}};
+
+    TEST_ASSERT_EQUAL_INT (0, TEST_ASSERT_SUCCESS_ERRNO (
+                                zmq_poller_poll (poller, items, 2, 0)));
+    TEST_ASSERT_EQUAL_INT (0, items[0].revents);
+    TEST_ASSERT_EQUAL_INT (2, zmq_poller_size (poller));
+
+    //  Polling the same items again keeps reporting the events they have.
+    send_string_expect_success (push, "a", 0);
+    for (int i = 0; i < 2; ++i) {
+        TEST_ASSERT_EQUAL_INT (1, TEST_ASSERT_SUCCESS_ERRNO (
+                                    zmq_poller_poll (poller, items, 2, -1)));
+        TEST_ASSERT_EQUAL_INT (ZMQ_POLLIN, items[0].revents);
+        TEST_ASSERT_EQUAL_INT (0, items[1].revents);
+    }
+    recv_string_expect_success (pull, "a", 0);
+    TEST_ASSERT_EQUAL_INT (0, TEST_ASSERT_SUCCESS_ERRNO (
+                                zmq_poller_poll (poller, items, 2, 0)));
+    TEST_ASSERT_EQUAL_INT (0, items[0].revents);
+
+    //  Changing the items replaces the ones registered.
+    items[1].events = ZMQ_POLLOUT;
+    TEST_ASSERT_EQUAL_INT (1, TEST_ASSERT_SUCCESS_ERRNO (
+                                zmq_poller_poll (poller, items, 2, 0)));
+    TEST_ASSERT_EQUAL_INT (0, items[0].revents);
+    TEST_ASSERT_EQUAL_INT (ZMQ_POLLOUT, items[1].revents);
+
+    //  Repeated sockets are reported with the events of each item.
+    zmq_pollitem_t repeated[] = {{push, 0, ZMQ_POLLIN, 0},
+                                 {pull, 0, ZMQ_POLLIN, 0},
+                                 {push, 0, ZMQ_POLLOUT, 0}};
+    TEST_ASSERT_EQUAL_INT (1, TEST_ASSERT_SUCCESS_ERRNO (
+                                zmq_poller_poll (poller, repeated, 3, 0)));
+    TEST_ASSERT_EQUAL_INT (0, repeated[0].revents);
+    TEST_ASSERT_EQUAL_INT (0, repeated[1].revents);
+    TEST_ASSERT_EQUAL_INT (ZMQ_POLLOUT, repeated[2].revents);
+    TEST_ASSERT_EQUAL_INT (2, zmq_poller_size (poller));
+
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL,
+                               zmq_poller_poll (poller, repeated, -1, 0));
+    TEST_ASSERT_FAILURE_ERRNO (EFAULT, zmq_poller_poll (poller, NULL, 1, 0));
+
+    //  An empty array unregisters the items.
+    TEST_ASSERT_EQUAL_INT (0, TEST_ASSERT_SUCCESS_ERRNO (
+                                zmq_poller_poll (poller, NULL, 0, 0)));
+    TEST_ASSERT_EQUAL_INT (0, zmq_poller_size (poller));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_poller_destroy (&poller));
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+void test_poller_poll_replaced_socket ()
+{
+    void *poller = zmq_poller_new ();
+    void *push = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (push, "inproc://replaced"));
+
+    //  Close the sockets polled and let the reaper destroy them, so that
+    //  the new ones are likely to be created at the same addresses.
+    for (int i = 0; i < 3; ++i) {
+        void *pull = test_context_socket (ZMQ_PULL);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (pull, "inproc://replaced"));
+        zmq_pollitem_t items[] = {{pull, 0, ZMQ_POLLIN, 0}};
+
+        TEST_ASSERT_EQUAL_INT (0, TEST_ASSERT_SUCCESS_ERRNO (
+                                    zmq_poller_poll (poller, items, 1, 0)));
+        send_string_expect_success (push, "a", 0);
+        TEST_ASSERT_EQUAL_INT (1, TEST_ASSERT_SUCCESS_ERRNO (
+                                    zmq_poller_poll (poller, items, 1, -1)));
+        TEST_ASSERT_EQUAL_INT (ZMQ_POLLIN, items[0].revents);
+        recv_string_expect_success (pull, "a", 0);
+
+        test_context_socket_close (pull);
+        msleep (SETTLE_TIME);
+    }
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_poller_destroy (&poller));
+    test_context_socket_close (push);
+}
+
 int main (void)
 {
     setup_test_environment ();
@@ -749,7 +935,11 @@ int main (void)
 
     RUN_TEST (test_poll_basic);
     RUN_TEST (test_poll_fd);
+    RUN_TEST (test_poll_regular_file);
     RUN_TEST (test_poll_client_server);
+    RUN_TEST (test_poll_many_sockets);
+    RUN_TEST (test_poller_poll);
+    RUN_TEST (test_poller_poll_replaced_socket);
 
     return UNITY_END ();
 }
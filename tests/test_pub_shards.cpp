@@ -0,0 +1,216 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <string.h>
+
+static const int io_threads = 4;
+
+void setUp ()
+{
+    setup_test_context ();
+    zmq_ctx_set (get_test_context (), ZMQ_IO_THREADS, io_threads);
+}
+
+void tearDown ()
+{
+    teardown_test_context ();
+}
+
+static void set_shards (void *socket_, int shards_)
+{
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (socket_, ZMQ_PUB_SHARDS, &shards_, sizeof (int)));
+}
+
+static void *create_sub (const char *topic_)
+{
+    void *sub = test_context_socket (ZMQ_SUB);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (sub, ZMQ_SUBSCRIBE, topic_, strlen (topic_)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (sub, ZMQ_SUBSCRIBE, "end", 3));
+    return sub;
+}
+
+static void publish (void *pub_)
+{
+    send_string_expect_success (pub_, "A1", ZMQ_SNDMORE);
+    send_string_expect_success (pub_, "body", 0);
+    send_string_expect_success (pub_, "B1", 0);
+    send_string_expect_success (pub_, "A2", 0);
+    send_string_expect_success (pub_, "end", 0);
+}
+
+//  Messages arrive in order, so receiving the end message last shows that
+//  no message was delivered to subscribers that did not ask for it.
+static void expect_published (void *sub_, const char *topic_)
+{
+    if (*topic_ != 'B') {
+        recv_string_expect_success (sub_, "A1", 0);
+        recv_string_expect_success (sub_, "body", 0);
+    }
+    if (*topic_ != 'A')
+        recv_string_expect_success (sub_, "B1", 0);
+    if (*topic_ != 'B')
+        recv_string_expect_success (sub_, "A2", 0);
+    recv_string_expect_success (sub_, "end", 0);
+}
+
+void test_option ()
+{
+    void *pub = test_context_socket (ZMQ_PUB);
+
+    int value = -1;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_setsockopt (pub, ZMQ_PUB_SHARDS, &value, sizeof value));
+    value = io_threads + 1;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_setsockopt (pub, ZMQ_PUB_SHARDS, &value, sizeof value));
+
+    set_shards (pub, 2);
+    value = 3;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_setsockopt (pub, ZMQ_PUB_SHARDS, &value, sizeof value));
+
+    test_context_socket_close (pub);
+
+    //  Only PUB sockets can be sharded.
+    void *xpub = test_context_socket (ZMQ_XPUB);
+    value = 2;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_setsockopt (xpub, ZMQ_PUB_SHARDS, &value, sizeof value));
+    test_context_socket_close (xpub);
+}
+
+void test_set_after_bind ()
+{
+    void *pub = test_context_socket (ZMQ_PUB);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pub, endpoint, sizeof endpoint);
+
+    int value = 2;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_setsockopt (pub, ZMQ_PUB_SHARDS, &value, sizeof value));
+
+    test_context_socket_close (pub);
+}
+
+void test_bound_publisher ()
+{
+    void *pub = test_context_socket (ZMQ_PUB);
+    set_shards (pub, io_threads);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pub, endpoint, sizeof endpoint);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pub, "inproc://shards"));
+
+    //  Enough subscribers for each I/O thread to get some, and one more
+    //  over inproc, which is served by the socket itself.
+    const char *topics[] = {"A", "B", "", "A", "B", "", "A", "B", ""};
+    const int sub_count = sizeof topics / sizeof topics[0];
+    void *subs[sub_count + 1];
+    for (int i = 0; i < sub_count; ++i) {
+        subs[i] = create_sub (topics[i]);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (subs[i], endpoint));
+    }
+    subs[sub_count] = create_sub ("A");
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (subs[sub_count], "inproc://shards"));
+    msleep (SETTLE_TIME);
+
+    publish (pub);
+    for (int i = 0; i < sub_count; ++i)
+        expect_published (subs[i], topics[i]);
+    expect_published (subs[sub_count], "A");
+
+    //  Subscriptions can be cancelled.
+    for (int i = 0; i < sub_count; ++i)
+        if (*topics[i] == 'A')
+            TEST_ASSERT_SUCCESS_ERRNO (
+              zmq_setsockopt (subs[i], ZMQ_UNSUBSCRIBE, "A", 1));
+    msleep (SETTLE_TIME);
+
+    publish (pub);
+    for (int i = 0; i < sub_count; ++i)
+        if (*topics[i] == 'A')
+            recv_string_expect_success (subs[i], "end", 0);
+        else
+            expect_published (subs[i], topics[i]);
+
+    for (int i = 0; i <= sub_count; ++i)
+        test_context_socket_close (subs[i]);
+    test_context_socket_close (pub);
+}
+
+void test_connected_publisher ()
+{
+    const char *topics[] = {"A", "B", ""};
+    const int sub_count = sizeof topics / sizeof topics[0];
+    void *subs[sub_count];
+    char endpoints[sub_count][MAX_SOCKET_STRING];
+    for (int i = 0; i < sub_count; ++i) {
+        subs[i] = create_sub (topics[i]);
+        bind_loopback_ipv4 (subs[i], endpoints[i], sizeof endpoints[i]);
+    }
+
+    void *pub = test_context_socket (ZMQ_PUB);
+    set_shards (pub, 2);
+    for (int i = 0; i < sub_count; ++i)
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (pub, endpoints[i]));
+    msleep (SETTLE_TIME);
+
+    //  Bound subscribers send their subscriptions once they process the
+    //  commands from their new sessions.
+    for (int i = 0; i < sub_count; ++i) {
+        int events;
+        size_t events_size = sizeof events;
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_getsockopt (subs[i], ZMQ_EVENTS, &events, &events_size));
+    }
+    msleep (SETTLE_TIME);
+
+    publish (pub);
+    for (int i = 0; i < sub_count; ++i)
+        expect_published (subs[i], topics[i]);
+
+    //  Disconnecting terminates the session of the subscriber.
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_disconnect (pub, endpoints[0]));
+
+    test_context_socket_close (pub);
+    for (int i = 0; i < sub_count; ++i)
+        test_context_socket_close (subs[i]);
+}
+
+void test_close_while_publishing ()
+{
+    void *pub = test_context_socket (ZMQ_PUB);
+    set_shards (pub, io_threads);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pub, endpoint, sizeof endpoint);
+
+    void *subs[8];
+    for (int i = 0; i < 8; ++i) {
+        subs[i] = create_sub ("");
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (subs[i], endpoint));
+    }
+    msleep (SETTLE_TIME);
+
+    for (int i = 0; i < 1000; ++i)
+        send_string_expect_success (pub, "A1", 0);
+    test_context_socket_close_zero_linger (pub);
+
+    for (int i = 0; i < 8; ++i)
+        test_context_socket_close_zero_linger (subs[i]);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_option);
+    RUN_TEST (test_set_after_bind);
+    RUN_TEST (test_bound_publisher);
+    RUN_TEST (test_connected_publisher);
+    RUN_TEST (test_close_while_publishing);
+    return UNITY_END ();
+}
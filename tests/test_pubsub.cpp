@@ -3,6 +3,8 @@
 #include "testutil.hpp"
 #include "testutil_unity.hpp"
 
+#include <string.h>
+
 SETUP_TEARDOWN_TESTCONTEXT
 
 void test (const char *address)
@@ -45,11 +47,60 @@ void test_norm ()
 #endif
 }
 
+void test_fan_out_tcp ()
+{
+    //  Messages published to several peers are framed once for all of them.
+    void *publisher = test_context_socket (ZMQ_PUB);
+    char my_endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (publisher, my_endpoint, sizeof my_endpoint);
+
+    const int subscriber_count = 3;
+    void *subscribers[subscriber_count];
+    for (int i = 0; i < subscriber_count; ++i) {
+        subscribers[i] = test_context_socket (ZMQ_SUB);
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_setsockopt (subscribers[i], ZMQ_SUBSCRIBE, "", 0));
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (subscribers[i], my_endpoint));
+    }
+    msleep (SETTLE_TIME);
+
+    //  Parts with short and long size encodings, and with and without more.
+    const size_t sizes[] = {100, 300, 70000, 200};
+    const int flags[] = {ZMQ_SNDMORE, ZMQ_SNDMORE, 0, 0};
+    const int part_count = sizeof sizes / sizeof sizes[0];
+    for (int i = 0; i < part_count; ++i) {
+        zmq_msg_t msg;
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_size (&msg, sizes[i]));
+        memset (zmq_msg_data (&msg), 'a' + i, sizes[i]);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_send (&msg, publisher, flags[i]));
+    }
+
+    for (int i = 0; i < subscriber_count; ++i) {
+        for (int j = 0; j < part_count; ++j) {
+            zmq_msg_t msg;
+            TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+            TEST_ASSERT_EQUAL_INT (
+              static_cast<int> (sizes[j]),
+              TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_recv (&msg, subscribers[i], 0)));
+            TEST_ASSERT_EQUAL_INT (flags[j] == ZMQ_SNDMORE, zmq_msg_more (&msg));
+            const char *data = static_cast<const char *> (zmq_msg_data (&msg));
+            TEST_ASSERT_EQUAL_INT ('a' + j, data[0]);
+            TEST_ASSERT_EQUAL_INT ('a' + j, data[sizes[j] - 1]);
+            TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+        }
+    }
+
+    for (int i = 0; i < subscriber_count; ++i)
+        test_context_socket_close (subscribers[i]);
+    test_context_socket_close (publisher);
+}
+
 int main ()
 {
     setup_test_environment ();
 
     UNITY_BEGIN ();
     RUN_TEST (test_norm);
+    RUN_TEST (test_fan_out_tcp);
     return UNITY_END ();
 }
@@ -3,6 +3,7 @@
 #include "testutil.hpp"
 #include "testutil_unity.hpp"
 
+#include <stdio.h>
 #include <string.h>
 
 #ifndef _WIN32
@@ -237,6 +238,9 @@ void test_radio_dish_udp (int ipv6_)
       zmq_setsockopt (radio, ZMQ_IPV6, &ipv6_, sizeof (int)));
     TEST_ASSERT_SUCCESS_ERRNO (
       zmq_setsockopt (dish, ZMQ_IPV6, &ipv6_, sizeof (int)));
+    int hwm = 4;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (dish, ZMQ_RCVHWM, &hwm, sizeof (int)));
 
     const char *radio_url = ipv6_ ? "udp://[::1]:5556" : "udp://127.0.0.1:5556";
 
@@ -250,6 +254,20 @@ void test_radio_dish_udp (int ipv6_)
     msg_send_expect_success (radio, "TV", "Friends");
     msg_recv_cmp (dish, "TV", "Friends");
 
+    //  Enough datagrams to be sent and received in several batches. Those
+    //  received in a batch that do not fit into the pipe are kept until
+    //  the ones before them are read.
+    const int count = 100;
+    char body[16];
+    for (int i = 0; i < count; ++i) {
+        snprintf (body, sizeof body, "Episode %d", i);
+        msg_send_expect_success (radio, "TV", body);
+    }
+    for (int i = 0; i < count; ++i) {
+        snprintf (body, sizeof body, "Episode %d", i);
+        msg_recv_cmp (dish, "TV", body);
+    }
+
     test_context_socket_close (dish);
     test_context_socket_close (radio);
 }
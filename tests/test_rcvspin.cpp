@@ -0,0 +1,220 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+static const int round_trips = 200;
+
+static void set_rcvspin (void *socket_, int rcvspin_)
+{
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (socket_, ZMQ_RCVSPIN, &rcvspin_, sizeof (int)));
+}
+
+//  Echoes round_trips messages received on the socket passed as argument.
+static void echo (void *socket_)
+{
+    char buf[32];
+    for (int i = 0; i < round_trips; ++i) {
+        const int rc =
+          TEST_ASSERT_SUCCESS_ERRNO (zmq_recv (socket_, buf, sizeof buf, 0));
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_send (socket_, buf, rc, 0));
+    }
+}
+
+static void ping_pong (void *socket_)
+{
+    char buf[32];
+    for (int i = 0; i < round_trips; ++i) {
+        send_string_expect_success (socket_, "ping", 0);
+        TEST_ASSERT_EQUAL_INT (
+          4, TEST_ASSERT_SUCCESS_ERRNO (zmq_recv (socket_, buf, sizeof buf, 0)));
+    }
+}
+
+void test_option ()
+{
+    void *socket = test_context_socket (ZMQ_PULL);
+
+    int value = -1;
+    size_t value_size = sizeof value;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_RCVSPIN, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (0, value);
+
+    set_rcvspin (socket, 100);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_RCVSPIN, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (100, value);
+
+    value = -1;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_setsockopt (socket, ZMQ_RCVSPIN, &value, sizeof value));
+
+    test_context_socket_close (socket);
+}
+
+void test_timeout ()
+{
+    //  Spinning longer than the timeout still returns EAGAIN.
+    void *pull = test_context_socket (ZMQ_PULL);
+    set_rcvspin (pull, 1000);
+    int timeout = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (pull, ZMQ_RCVTIMEO, &timeout, sizeof timeout));
+
+    char buf[32];
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN, zmq_recv (pull, buf, sizeof buf, 0));
+
+    test_context_socket_close (pull);
+}
+
+void test_spin_limited_by_timeout ()
+{
+    //  A spin far longer than the timeout stops when the timeout expires.
+    void *pull = test_context_socket (ZMQ_PULL);
+    set_rcvspin (pull, 100 * SETTLE_TIME * 1000);
+    int timeout = 10;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (pull, ZMQ_RCVTIMEO, &timeout, sizeof timeout));
+
+    char buf[32];
+    void *watch = zmq_stopwatch_start ();
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN, zmq_recv (pull, buf, sizeof buf, 0));
+    TEST_ASSERT_LESS_THAN (SETTLE_TIME * 1000UL, zmq_stopwatch_stop (watch));
+
+    test_context_socket_close (pull);
+}
+
+static void recv_ping (void *socket_)
+{
+    recv_string_expect_success (socket_, "ping", 0);
+}
+
+void test_thread_safe_not_locked ()
+{
+    //  While one thread waits on a thread-safe socket, others can use it.
+    void *server = test_context_socket (ZMQ_SERVER);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (server, "inproc://spin-locked"));
+    void *client = test_context_socket (ZMQ_CLIENT);
+    set_rcvspin (client, 100 * SETTLE_TIME * 1000);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (client, "inproc://spin-locked"));
+
+    void *thread = zmq_threadstart (&recv_ping, client);
+    msleep (SETTLE_TIME / 10);
+
+    void *watch = zmq_stopwatch_start ();
+    send_string_expect_success (client, "ping", 0);
+    TEST_ASSERT_LESS_THAN (SETTLE_TIME * 1000UL, zmq_stopwatch_stop (watch));
+
+    zmq_msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+    TEST_ASSERT_EQUAL_INT (
+      4, TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_recv (&msg, server, 0)));
+    TEST_ASSERT_EQUAL_INT (
+      4, TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_send (&msg, server, 0)));
+    zmq_threadclose (thread);
+
+    test_context_socket_close (client);
+    test_context_socket_close (server);
+}
+
+static void send_later (void *socket_)
+{
+    msleep (SETTLE_TIME / 10);
+    send_string_expect_success (socket_, "late", 0);
+}
+
+void test_message_after_spinning ()
+{
+    //  A message arriving after the socket stopped spinning wakes it up.
+    void *pull = test_context_socket (ZMQ_PULL);
+    set_rcvspin (pull, 10);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pull, "inproc://spin-late"));
+    void *push = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, "inproc://spin-late"));
+
+    void *thread = zmq_threadstart (&send_later, push);
+    recv_string_expect_success (pull, "late", 0);
+    zmq_threadclose (thread);
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+void test_round_trips ()
+{
+    void *rep = test_context_socket (ZMQ_REP);
+    set_rcvspin (rep, 50);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (rep, "inproc://spin"));
+    void *req = test_context_socket (ZMQ_REQ);
+    set_rcvspin (req, 50);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (req, "inproc://spin"));
+
+    void *thread = zmq_threadstart (&echo, rep);
+    ping_pong (req);
+    zmq_threadclose (thread);
+
+    test_context_socket_close (req);
+    test_context_socket_close (rep);
+}
+
+void test_round_trips_tcp ()
+{
+    char endpoint[MAX_SOCKET_STRING];
+    void *rep = test_context_socket (ZMQ_REP);
+    set_rcvspin (rep, 50);
+    bind_loopback_ipv4 (rep, endpoint, sizeof endpoint);
+    void *req = test_context_socket (ZMQ_REQ);
+    set_rcvspin (req, 50);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (req, endpoint));
+
+    void *thread = zmq_threadstart (&echo, rep);
+    ping_pong (req);
+    zmq_threadclose (thread);
+
+    test_context_socket_close (req);
+    test_context_socket_close (rep);
+}
+
+void test_round_trips_thread_safe ()
+{
+    void *server = test_context_socket (ZMQ_SERVER);
+    set_rcvspin (server, 50);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (server, "inproc://spin-safe"));
+    void *client = test_context_socket (ZMQ_CLIENT);
+    set_rcvspin (client, 50);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (client, "inproc://spin-safe"));
+
+    for (int i = 0; i < round_trips; ++i) {
+        send_string_expect_success (client, "ping", 0);
+        zmq_msg_t msg;
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+        TEST_ASSERT_EQUAL_INT (
+          4, TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_recv (&msg, server, 0)));
+        TEST_ASSERT_EQUAL_INT (
+          4, TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_send (&msg, server, 0)));
+        recv_string_expect_success (client, "ping", 0);
+    }
+
+    test_context_socket_close (client);
+    test_context_socket_close (server);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_option);
+    RUN_TEST (test_timeout);
+    RUN_TEST (test_spin_limited_by_timeout);
+    RUN_TEST (test_message_after_spinning);
+    RUN_TEST (test_round_trips);
+    RUN_TEST (test_round_trips_tcp);
+    RUN_TEST (test_round_trips_thread_safe);
+    RUN_TEST (test_thread_safe_not_locked);
+    return UNITY_END ();
+}
@@ -125,6 +125,208 @@ void test_curve_security_with_valid_credentials ()
     test_context_socket_close (client_mon);
 }
 
+#ifdef ZMQ_BUILD_DRAFT_API
+static void socket_config_curve_server_batch (void *server_,
+                                              void *server_secret_)
+{
+    socket_config_curve_server (server_, server_secret_);
+    const int batch = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (server_, ZMQ_CURVE_BATCH, &batch, sizeof (batch)));
+}
+
+static void socket_config_curve_client_batch (void *client_, void *data_)
+{
+    socket_config_curve_client (client_, data_);
+    const int batch = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (client_, ZMQ_CURVE_BATCH, &batch, sizeof (batch)));
+}
+
+static void socket_config_curve_client_large_batch (void *client_,
+                                                    void *data_)
+{
+    socket_config_curve_client_batch (client_, data_);
+    const int out_batch_size = 65536;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (client_, ZMQ_OUT_BATCH_SIZE,
+                                               &out_batch_size,
+                                               sizeof (out_batch_size)));
+}
+
+void test_curve_security_with_batching ()
+{
+    curve_client_data_t curve_client_data = {
+      valid_server_public, valid_client_public, valid_client_secret};
+
+    //  The server of the fixture does not batch, and ignores the offer.
+    void *client = create_and_connect_client (
+      my_endpoint, socket_config_curve_client_batch, &curve_client_data);
+    bounce (server, client);
+    test_context_socket_close (client);
+
+    void *batch_server = test_context_socket (ZMQ_DEALER);
+    socket_config_curve_server_batch (batch_server, valid_server_secret);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (batch_server, ZMQ_ROUTING_ID, "IDENT", 5));
+    char batch_endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (batch_server, batch_endpoint, sizeof batch_endpoint);
+
+    client = create_and_connect_client (
+      batch_endpoint, socket_config_curve_client_batch, &curve_client_data);
+    bounce (batch_server, client);
+
+    //  Messages queued at once are boxed together, and must come out whole
+    //  and in order at the other end, in both directions.
+    const int count = 1000;
+    for (int i = 0; i != count; i++) {
+        send_string_expect_success (client, "part 1", ZMQ_SNDMORE);
+        send_string_expect_success (client, "part 2", 0);
+    }
+    for (int i = 0; i != count; i++) {
+        recv_string_expect_success (batch_server, "part 1", 0);
+        int more;
+        size_t more_size = sizeof (more);
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_getsockopt (batch_server, ZMQ_RCVMORE, &more, &more_size));
+        TEST_ASSERT_TRUE (more);
+        recv_string_expect_success (batch_server, "part 2", 0);
+        send_string_expect_success (batch_server, "reply", 0);
+    }
+    for (int i = 0; i != count; i++)
+        recv_string_expect_success (client, "reply", 0);
+
+    //  Large messages are boxed on their own, between batches.
+    char large[4096];
+    memset (large, 'x', sizeof large);
+    send_string_expect_success (client, "small", 0);
+    TEST_ASSERT_EQUAL_INT (
+      sizeof large,
+      TEST_ASSERT_SUCCESS_ERRNO (zmq_send (client, large, sizeof large, 0)));
+    send_string_expect_success (client, "small", 0);
+    recv_string_expect_success (batch_server, "small", 0);
+    zmq_msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+    TEST_ASSERT_EQUAL_INT (
+      sizeof large,
+      TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_recv (&msg, batch_server, 0)));
+    TEST_ASSERT_EQUAL_MEMORY (large, zmq_msg_data (&msg), sizeof large);
+
+    //  The negotiation is not part of the metadata of messages.
+    TEST_ASSERT_NULL (zmq_msg_gets (&msg, "Curve-Batch"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+    recv_string_expect_success (batch_server, "small", 0);
+
+    test_context_socket_close (client);
+
+    //  Batches are as large as the output batch of the engine, which may
+    //  be much larger than the default one.
+    client = create_and_connect_client (batch_endpoint,
+                                        socket_config_curve_client_large_batch,
+                                        &curve_client_data);
+    bounce (batch_server, client);
+    char frame[1000];
+    for (int i = 0; i != count; i++) {
+        memset (frame, 'a' + i % 26, sizeof frame);
+        TEST_ASSERT_EQUAL_INT (sizeof frame,
+                               TEST_ASSERT_SUCCESS_ERRNO (zmq_send (
+                                 client, frame, sizeof frame, 0)));
+    }
+    char expected[sizeof frame];
+    for (int i = 0; i != count; i++) {
+        memset (expected, 'a' + i % 26, sizeof expected);
+        TEST_ASSERT_EQUAL_INT (sizeof frame,
+                               TEST_ASSERT_SUCCESS_ERRNO (zmq_recv (
+                                 batch_server, frame, sizeof frame, 0)));
+        TEST_ASSERT_EQUAL_MEMORY (expected, frame, sizeof frame);
+    }
+
+    test_context_socket_close (client);
+    test_context_socket_close (batch_server);
+}
+
+//  Sends messages numbered from 0 on, every third of them large, and
+//  checks that they are received whole and in order.
+static void send_numbered (void *socket_, int count_)
+{
+    char buf[16384];
+    for (int i = 0; i != count_; i++) {
+        const size_t size = i % 3 == 0 ? sizeof buf : 32;
+        memset (buf, 'a' + i % 26, size);
+        memcpy (buf, &i, sizeof i);
+        TEST_ASSERT_EQUAL_INT (
+          size, TEST_ASSERT_SUCCESS_ERRNO (zmq_send (socket_, buf, size, 0)));
+    }
+}
+
+static void recv_numbered (void *socket_, int count_)
+{
+    zmq_msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+    for (int i = 0; i != count_; i++) {
+        const size_t size = i % 3 == 0 ? 16384 : 32;
+        TEST_ASSERT_EQUAL_INT (
+          size, TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_recv (&msg, socket_, 0)));
+        const char *const data = static_cast<char *> (zmq_msg_data (&msg));
+        int number;
+        memcpy (&number, data, sizeof number);
+        TEST_ASSERT_EQUAL_INT (i, number);
+        TEST_ASSERT_EQUAL_INT ('a' + i % 26, data[size - 1]);
+    }
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+}
+
+static void test_curve_security_with_pool (bool batch_)
+{
+    //  Boxes are sealed and opened on the threads of the pool once there
+    //  are enough of them queued or received at once.
+    void *ctx = zmq_ctx_new ();
+    TEST_ASSERT_NOT_NULL (ctx);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_set (ctx, ZMQ_CURVE_THREADS, 2));
+
+    const int as_server = 1;
+    const int batch = batch_ ? 1 : 0;
+    void *pool_server = zmq_socket (ctx, ZMQ_DEALER);
+    TEST_ASSERT_NOT_NULL (pool_server);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (
+      pool_server, ZMQ_CURVE_SERVER, &as_server, sizeof (as_server)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (
+      pool_server, ZMQ_CURVE_SECRETKEY, valid_server_secret, 41));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (pool_server, ZMQ_CURVE_BATCH, &batch, sizeof (batch)));
+    char pool_endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pool_server, pool_endpoint, sizeof pool_endpoint);
+
+    curve_client_data_t curve_client_data = {
+      valid_server_public, valid_client_public, valid_client_secret};
+    void *client = zmq_socket (ctx, ZMQ_DEALER);
+    TEST_ASSERT_NOT_NULL (client);
+    socket_config_curve_client (client, &curve_client_data);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (client, ZMQ_CURVE_BATCH, &batch, sizeof (batch)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (client, pool_endpoint));
+
+    const int count = 600;
+    send_numbered (client, count);
+    recv_numbered (pool_server, count);
+    send_numbered (pool_server, count);
+    recv_numbered (client, count);
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (client));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (pool_server));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_term (ctx));
+}
+
+void test_curve_security_with_pool ()
+{
+    test_curve_security_with_pool (false);
+}
+
+void test_curve_security_with_pool_and_batching ()
+{
+    test_curve_security_with_pool (true);
+}
+#endif
+
 void test_curve_security_with_bogus_client_credentials ()
 {
     //  This must be caught by the ZAP handler
@@ -544,6 +746,11 @@ int main (void)
     RUN_TEST (test_curve_security_with_null_client_credentials);
     RUN_TEST (test_curve_security_with_plain_client_credentials);
     RUN_TEST (test_curve_security_unauthenticated_message);
+#ifdef ZMQ_BUILD_DRAFT_API
+    RUN_TEST (test_curve_security_with_batching);
+    RUN_TEST (test_curve_security_with_pool);
+    RUN_TEST (test_curve_security_with_pool_and_batching);
+#endif
 
     //  tests with misbehaving CURVE client
     RUN_TEST (test_curve_security_invalid_hello_wrong_length);
@@ -0,0 +1,121 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <stdio.h>
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+static void expect_nothing (void *socket_)
+{
+    char buf[32];
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN,
+                               zmq_recv (socket_, buf, sizeof buf, ZMQ_DONTWAIT));
+}
+
+static void echo (void *socket_)
+{
+    char buf[32];
+    const int rc =
+      TEST_ASSERT_SUCCESS_ERRNO (zmq_recv (socket_, buf, sizeof buf, 0));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_send (socket_, buf, rc, 0));
+}
+
+void test_deferred_until_flushed ()
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pull, "inproc://snddefer"));
+    void *push = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, "inproc://snddefer"));
+
+    //  Deferred messages, multi-part ones included, are not visible yet.
+    send_string_expect_success (push, "a", ZMQ_SNDDEFER);
+    send_string_expect_success (push, "b", ZMQ_SNDDEFER | ZMQ_SNDMORE);
+    send_string_expect_success (push, "c", ZMQ_SNDDEFER);
+    expect_nothing (pull);
+
+    //  The next message sent without the flag flushes them all.
+    send_string_expect_success (push, "d", 0);
+    recv_string_expect_success (pull, "a", 0);
+    recv_string_expect_success (pull, "b", 0);
+    recv_string_expect_success (pull, "c", 0);
+    recv_string_expect_success (pull, "d", 0);
+
+    //  So does a batch sent without the flag.
+    send_string_expect_success (push, "e", ZMQ_SNDDEFER);
+    zmq_msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_buffer (&msg, "f", 1));
+    TEST_ASSERT_EQUAL_INT (
+      1, TEST_ASSERT_SUCCESS_ERRNO (zmq_sendmmsg (push, &msg, 1, ZMQ_SNDDEFER)));
+    expect_nothing (pull);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_buffer (&msg, "g", 1));
+    TEST_ASSERT_EQUAL_INT (
+      1, TEST_ASSERT_SUCCESS_ERRNO (zmq_sendmmsg (push, &msg, 1, 0)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+    recv_string_expect_success (pull, "e", 0);
+    recv_string_expect_success (pull, "f", 0);
+    recv_string_expect_success (pull, "g", 0);
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+void test_flushed_by_blocking_recv ()
+{
+    void *server = test_context_socket (ZMQ_PAIR);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (server, "inproc://snddefer-echo"));
+    void *client = test_context_socket (ZMQ_PAIR);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (client, "inproc://snddefer-echo"));
+
+    void *thread = zmq_threadstart (echo, server);
+
+    //  Waiting for the reply must not leave the request unflushed.
+    send_string_expect_success (client, "ping", ZMQ_SNDDEFER);
+    recv_string_expect_success (client, "ping", 0);
+
+    zmq_threadclose (thread);
+
+    test_context_socket_close (client);
+    test_context_socket_close (server);
+}
+
+void test_tcp ()
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+    void *push = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    const int count = 100;
+    char buf[32];
+    for (int i = 0; i < count; ++i) {
+        const int size = sprintf (buf, "%d", i);
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_send (push, buf, size, i == count - 1 ? 0 : ZMQ_SNDDEFER));
+    }
+    for (int i = 0; i < count; ++i) {
+        char expected[32];
+        sprintf (expected, "%d", i);
+        recv_string_expect_success (pull, expected, 0);
+    }
+
+    //  Closing the socket flushes the messages still deferred.
+    send_string_expect_success (push, "last", ZMQ_SNDDEFER);
+    test_context_socket_close (push);
+    recv_string_expect_success (pull, "last", 0);
+
+    test_context_socket_close (pull);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_deferred_until_flushed);
+    RUN_TEST (test_flushed_by_blocking_recv);
+    RUN_TEST (test_tcp);
+    return UNITY_END ();
+}
@@ -3,6 +3,7 @@
 #include "testutil.hpp"
 #include "testutil_unity.hpp"
 
+#include <stdlib.h>
 #include <string.h>
 
 SETUP_TEARDOWN_TESTCONTEXT
@@ -265,6 +266,87 @@ static void test_stream_to_stream ()
     test_context_socket_close (client);
 }
 
+static void test_stream_adjacent_buffers ()
+{
+    //  Messages referencing adjacent slices of a buffer are written as a
+    //  single chunk, which takes one buffer of a batch but one message
+    //  reference per slice.
+    char my_endpoint[MAX_SOCKET_STRING];
+    void *server = test_context_socket (ZMQ_STREAM);
+    int value;
+#ifdef ZMQ_BUILD_DRAFT_API
+    value = 1024 * 1024;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (server, ZMQ_OUT_BATCH_SIZE, &value, sizeof (value)));
+#endif
+    value = 4096;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (server, ZMQ_SNDBUF, &value, sizeof (value)));
+    bind_loopback_ipv4 (server, my_endpoint, sizeof my_endpoint);
+
+    //  The client stops reading soon, so that the messages queue up behind
+    //  the first one and are batched.
+    void *client = test_context_socket (ZMQ_STREAM);
+    value = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (client, ZMQ_RCVHWM, &value, sizeof (value)));
+    value = 4096;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (client, ZMQ_RCVBUF, &value, sizeof (value)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (client, my_endpoint));
+
+    uint8_t id[256];
+    uint8_t buffer[256];
+    const int id_size =
+      TEST_ASSERT_SUCCESS_ERRNO (zmq_recv (server, id, 256, 0));
+    TEST_ASSERT_GREATER_THAN_INT (0, id_size);
+    TEST_ASSERT_EQUAL_INT (
+      0, TEST_ASSERT_SUCCESS_ERRNO (zmq_recv (server, buffer, 256, 0)));
+    TEST_ASSERT_GREATER_THAN_INT (
+      0, TEST_ASSERT_SUCCESS_ERRNO (zmq_recv (client, buffer, 256, 0)));
+    TEST_ASSERT_EQUAL_INT (
+      0, TEST_ASSERT_SUCCESS_ERRNO (zmq_recv (client, buffer, 256, 0)));
+
+    const size_t first_size = 256 * 1024;
+    const size_t slice_size = 2048;
+    const int slices = 64;
+    const size_t total = first_size + slices * slice_size;
+    uint8_t *data = static_cast<uint8_t *> (malloc (total));
+    TEST_ASSERT_NOT_NULL (data);
+    for (size_t i = 0; i < total; ++i)
+        data[i] = static_cast<uint8_t> (i * 7 + i / 251);
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_send (server, id, id_size, ZMQ_SNDMORE));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_send (server, data, first_size, 0));
+    msleep (SETTLE_TIME);
+
+    for (int i = 0; i < slices; ++i) {
+        zmq_msg_t msg;
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_data (
+          &msg, data + first_size + i * slice_size, slice_size, NULL, NULL));
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_send (server, id, id_size, ZMQ_SNDMORE));
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_send (&msg, server, 0));
+    }
+
+    //  The data arrives in chunks of any size, each after a routing id.
+    uint8_t *received = static_cast<uint8_t *> (malloc (total));
+    TEST_ASSERT_NOT_NULL (received);
+    size_t received_size = 0;
+    while (received_size < total) {
+        TEST_ASSERT_GREATER_THAN_INT (
+          0, TEST_ASSERT_SUCCESS_ERRNO (zmq_recv (client, buffer, 256, 0)));
+        received_size += TEST_ASSERT_SUCCESS_ERRNO (zmq_recv (
+          client, received + received_size, total - received_size, 0));
+    }
+    TEST_ASSERT_EQUAL_UINT8_ARRAY (data, received, total);
+
+    test_context_socket_close (server);
+    test_context_socket_close (client);
+    free (received);
+    free (data);
+}
+
 int main ()
 {
     setup_test_environment ();
@@ -272,5 +354,6 @@ int main ()
     UNITY_BEGIN ();
     RUN_TEST (test_stream_to_dealer);
     RUN_TEST (test_stream_to_stream);
+    RUN_TEST (test_stream_adjacent_buffers);
     return UNITY_END ();
 }
@@ -0,0 +1,168 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_monitoring.hpp"
+#include "testutil_unity.hpp"
+
+static const int io_threads = 4;
+
+void setUp ()
+{
+    setup_test_context ();
+    zmq_ctx_set (get_test_context (), ZMQ_IO_THREADS, io_threads);
+}
+
+void tearDown ()
+{
+    teardown_test_context ();
+}
+
+static void set_shards (void *socket_, int shards_)
+{
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (socket_, ZMQ_TCP_ACCEPT_SHARDS,
+                                               &shards_, sizeof shards_));
+}
+
+void test_option ()
+{
+    void *socket = test_context_socket (ZMQ_ROUTER);
+
+    int value = -1;
+    size_t value_size = sizeof value;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_TCP_ACCEPT_SHARDS, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (0, value);
+
+    set_shards (socket, io_threads);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_TCP_ACCEPT_SHARDS, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (io_threads, value);
+
+    value = -1;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL,
+      zmq_setsockopt (socket, ZMQ_TCP_ACCEPT_SHARDS, &value, sizeof value));
+
+    test_context_socket_close (socket);
+}
+
+void test_router_dealer ()
+{
+    void *server = test_context_socket (ZMQ_ROUTER);
+    //  More shards than I/O threads are limited to the I/O threads.
+    set_shards (server, 2 * io_threads);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (server, endpoint, sizeof endpoint);
+
+    const int count = 16;
+    void *clients[count];
+    for (int i = 0; i < count; ++i) {
+        clients[i] = test_context_socket (ZMQ_DEALER);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (clients[i], endpoint));
+    }
+
+    for (int i = 0; i < count; ++i) {
+        send_string_expect_success (clients[i], "hello", 0);
+        zmq_msg_t routing_id;
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&routing_id));
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_recv (&routing_id, server, 0));
+        recv_string_expect_success (server, "hello", 0);
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_msg_send (&routing_id, server, ZMQ_SNDMORE));
+        send_string_expect_success (server, "world", 0);
+        recv_string_expect_success (clients[i], "world", 0);
+    }
+
+    for (int i = 0; i < count; ++i)
+        test_context_socket_close (clients[i]);
+    test_context_socket_close (server);
+}
+
+void test_listening_events ()
+{
+    void *server = test_context_socket (ZMQ_PULL);
+    set_shards (server, io_threads);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_socket_monitor (
+      server, "inproc://monitor-shards", ZMQ_EVENT_LISTENING));
+    void *monitor = test_context_socket (ZMQ_PAIR);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_connect (monitor, "inproc://monitor-shards"));
+
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (server, endpoint, sizeof endpoint);
+
+    //  Each of the listeners reports that it listens.
+#if defined ZMQ_HAVE_LINUX
+    for (int i = 0; i < io_threads; ++i)
+#endif
+        expect_monitor_event (monitor, ZMQ_EVENT_LISTENING);
+    TEST_ASSERT_EQUAL_INT (-1, get_monitor_event_with_timeout (monitor, NULL,
+                                                               NULL, 100));
+
+    test_context_socket_close_zero_linger (monitor);
+    test_context_socket_close (server);
+}
+
+void test_unbind ()
+{
+    void *server = test_context_socket (ZMQ_PULL);
+    set_shards (server, io_threads);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (server, endpoint, sizeof endpoint);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_unbind (server, endpoint));
+    test_context_socket_close (server);
+    msleep (SETTLE_TIME);
+
+    //  Once all listeners are gone, the port can be bound without
+    //  SO_REUSEPORT again.
+    server = test_context_socket (ZMQ_PULL);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (server, endpoint));
+    void *client = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (client, endpoint));
+    send_string_expect_success (client, "hello", 0);
+    recv_string_expect_success (server, "hello", 0);
+
+    test_context_socket_close (client);
+    test_context_socket_close (server);
+}
+
+void test_pub_shards ()
+{
+    void *pub = test_context_socket (ZMQ_PUB);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (pub, ZMQ_PUB_SHARDS, &io_threads,
+                                               sizeof io_threads));
+    set_shards (pub, io_threads);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pub, endpoint, sizeof endpoint);
+
+    const int count = 8;
+    void *subs[count];
+    for (int i = 0; i < count; ++i) {
+        subs[i] = test_context_socket (ZMQ_SUB);
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_setsockopt (subs[i], ZMQ_SUBSCRIBE, "", 0));
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (subs[i], endpoint));
+    }
+    msleep (SETTLE_TIME);
+
+    send_string_expect_success (pub, "news", 0);
+    for (int i = 0; i < count; ++i)
+        recv_string_expect_success (subs[i], "news", 0);
+
+    for (int i = 0; i < count; ++i)
+        test_context_socket_close (subs[i]);
+    test_context_socket_close (pub);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_option);
+    RUN_TEST (test_router_dealer);
+    RUN_TEST (test_listening_events);
+    RUN_TEST (test_unbind);
+    RUN_TEST (test_pub_shards);
+    return UNITY_END ();
+}
@@ -0,0 +1,229 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+static const size_t msg_size = 256 * 1024;
+
+static void fill (unsigned char *data_, size_t size_, int seed_)
+{
+    for (size_t i = 0; i < size_; ++i)
+        data_[i] = static_cast<unsigned char> (i * 7 + seed_);
+}
+
+static void *setup_push (int zerocopy_)
+{
+    void *push = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (push, ZMQ_TCP_ZEROCOPY, &zerocopy_, sizeof (int)));
+    return push;
+}
+
+static void send_and_check (void *push_, void *pull_, int count_)
+{
+    unsigned char *buf = static_cast<unsigned char *> (malloc (msg_size));
+    TEST_ASSERT_NOT_NULL (buf);
+
+    //  Mix small messages in to have them interleaved with large ones.
+    for (int i = 0; i < count_; ++i) {
+        const size_t size = i % 3 == 0 ? 10 : msg_size;
+        fill (buf, size, i);
+        TEST_ASSERT_EQUAL_INT (
+          static_cast<int> (size),
+          TEST_ASSERT_SUCCESS_ERRNO (zmq_send (push_, buf, size, 0)));
+    }
+
+    unsigned char *expected = static_cast<unsigned char *> (malloc (msg_size));
+    TEST_ASSERT_NOT_NULL (expected);
+    for (int i = 0; i < count_; ++i) {
+        const size_t size = i % 3 == 0 ? 10 : msg_size;
+        fill (expected, size, i);
+        TEST_ASSERT_EQUAL_INT (
+          static_cast<int> (size),
+          TEST_ASSERT_SUCCESS_ERRNO (zmq_recv (pull_, buf, msg_size, 0)));
+        TEST_ASSERT_EQUAL_MEMORY (expected, buf, size);
+    }
+
+    free (expected);
+    free (buf);
+}
+
+void test_option ()
+{
+    void *push = test_context_socket (ZMQ_PUSH);
+
+    int value = -1;
+    size_t value_size = sizeof value;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (push, ZMQ_TCP_ZEROCOPY, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (0, value);
+
+    value = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (push, ZMQ_TCP_ZEROCOPY, &value, sizeof value));
+    value = -1;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (push, ZMQ_TCP_ZEROCOPY, &value, &value_size));
+    TEST_ASSERT_EQUAL_INT (1, value);
+
+    value = 2;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_setsockopt (push, ZMQ_TCP_ZEROCOPY, &value, sizeof value));
+
+    test_context_socket_close (push);
+}
+
+void test_large_messages ()
+{
+    char endpoint[MAX_SOCKET_STRING];
+    void *pull = test_context_socket (ZMQ_PULL);
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+
+    void *push = setup_push (1);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    send_and_check (push, pull, 60);
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+void test_large_messages_with_backpressure ()
+{
+    //  Let the receiving side stop reading while the sender still waits
+    //  for completions of its writes.
+    char endpoint[MAX_SOCKET_STRING];
+    void *push = setup_push (1);
+    bind_loopback_ipv4 (push, endpoint, sizeof endpoint);
+
+    void *pull = test_context_socket (ZMQ_PULL);
+    int hwm = 2;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (pull, ZMQ_RCVHWM, &hwm, sizeof hwm));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (pull, endpoint));
+
+    send_and_check (push, pull, 60);
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+void test_close_with_writes_pending ()
+{
+    //  The sending engine is destroyed before the receiver reads anything,
+    //  so its socket is kept until the writes complete.
+    const size_t size = 20000;
+    const int count = 20;
+    char endpoint[MAX_SOCKET_STRING];
+    void *pull = test_context_socket (ZMQ_PULL);
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+
+    void *push = setup_push (1);
+    int linger = -1;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (push, ZMQ_LINGER, &linger, sizeof linger));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    unsigned char buf[size];
+    for (int i = 0; i < count; ++i) {
+        fill (buf, size, i);
+        TEST_ASSERT_EQUAL_INT (
+          static_cast<int> (size),
+          TEST_ASSERT_SUCCESS_ERRNO (zmq_send (push, buf, size, 0)));
+    }
+    test_context_socket_close (push);
+
+    msleep (SETTLE_TIME / 3);
+
+    unsigned char expected[size];
+    for (int i = 0; i < count; ++i) {
+        fill (expected, size, i);
+        TEST_ASSERT_EQUAL_INT (
+          static_cast<int> (size),
+          TEST_ASSERT_SUCCESS_ERRNO (zmq_recv (pull, buf, size, 0)));
+        TEST_ASSERT_EQUAL_MEMORY (expected, buf, size);
+    }
+
+    test_context_socket_close (pull);
+}
+
+void test_close_with_writes_stalled ()
+{
+    //  The receiver stops reading, so the writes cannot complete once the
+    //  sending engine is gone. Waiting for them must not hold up the I/O
+    //  thread, which the context shares with another connection.
+    char endpoint[MAX_SOCKET_STRING];
+    void *pull = test_context_socket (ZMQ_PULL);
+    int hwm = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (pull, ZMQ_RCVHWM, &hwm, sizeof hwm));
+    int rcvbuf = 4096;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (pull, ZMQ_RCVBUF, &rcvbuf, sizeof rcvbuf));
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+
+    void *push = setup_push (1);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    unsigned char *buf = static_cast<unsigned char *> (malloc (msg_size));
+    TEST_ASSERT_NOT_NULL (buf);
+    for (int i = 0; i < 16; ++i) {
+        fill (buf, msg_size, i);
+        TEST_ASSERT_EQUAL_INT (
+          static_cast<int> (msg_size),
+          TEST_ASSERT_SUCCESS_ERRNO (zmq_send (push, buf, msg_size, 0)));
+    }
+    free (buf);
+    msleep (SETTLE_TIME);
+    test_context_socket_close_zero_linger (push);
+
+    void *sb = test_context_socket (ZMQ_PAIR);
+    bind_loopback_ipv4 (sb, endpoint, sizeof endpoint);
+    void *sc = test_context_socket (ZMQ_PAIR);
+    void *watch = zmq_stopwatch_start ();
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sc, endpoint));
+    bounce (sb, sc);
+    TEST_ASSERT_LESS_THAN_UINT (500000, zmq_stopwatch_stop (watch));
+
+    test_context_socket_close (sc);
+    test_context_socket_close (sb);
+    test_context_socket_close (pull);
+}
+
+void test_ipc_ignores_option ()
+{
+#if defined ZMQ_HAVE_IPC
+    char endpoint[MAX_SOCKET_STRING];
+    void *pull = test_context_socket (ZMQ_PULL);
+    bind_loopback_ipc (pull, endpoint, sizeof endpoint);
+
+    void *push = setup_push (1);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    send_and_check (push, pull, 12);
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+#else
+    TEST_IGNORE_MESSAGE ("libzmq without IPC, ignoring test");
+#endif
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_option);
+    RUN_TEST (test_large_messages);
+    RUN_TEST (test_large_messages_with_backpressure);
+    RUN_TEST (test_close_with_writes_pending);
+    RUN_TEST (test_close_with_writes_stalled);
+    RUN_TEST (test_ipc_ignores_option);
+    return UNITY_END ();
+}
@@ -4,6 +4,8 @@
 #include "testutil.hpp"
 #include "testutil_unity.hpp"
 
+#include <vector>
+
 void setUp ()
 {
 }
@@ -18,6 +20,29 @@ void handler (int timer_id_, void *arg_)
     *(static_cast<bool *> (arg_)) = true;
 }
 
+void count_handler (int timer_id_, void *arg_)
+{
+    (void) timer_id_;
+    ++*(static_cast<int *> (arg_));
+}
+
+struct cancel_arg_t
+{
+    void *timers;
+    int other_timer_id;
+    int invoked;
+};
+
+//  Cancels the other timer and then itself.
+void cancel_handler (int timer_id_, void *arg_)
+{
+    cancel_arg_t *const arg = static_cast<cancel_arg_t *> (arg_);
+    ++arg->invoked;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_timers_cancel (arg->timers, arg->other_timer_id));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_timers_cancel (arg->timers, timer_id_));
+}
+
 int sleep_and_execute (void *timers_)
 {
     int timeout = zmq_timers_timeout (timers_);
@@ -183,12 +208,116 @@ void test_timers ()
     TEST_ASSERT_SUCCESS_ERRNO (zmq_timers_destroy (&timers));
 }
 
+void test_cancel_in_handler ()
+{
+    void *timers = zmq_timers_new ();
+    TEST_ASSERT_NOT_NULL (timers);
+
+    cancel_arg_t first = {timers, 0, 0};
+    cancel_arg_t second = {timers, 0, 0};
+    const int first_id = TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_timers_add (timers, 0, cancel_handler, &first));
+    const int second_id = TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_timers_add (timers, 0, cancel_handler, &second));
+    first.other_timer_id = second_id;
+    second.other_timer_id = first_id;
+
+    //  Whichever timer runs first cancels the other one.
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_timers_execute (timers));
+    TEST_ASSERT_EQUAL_INT (1, first.invoked + second.invoked);
+    TEST_ASSERT_EQUAL_INT (-1, zmq_timers_timeout (timers));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_timers_destroy (&timers));
+}
+
+void test_many_timers ()
+{
+    void *timers = zmq_timers_new ();
+    TEST_ASSERT_NOT_NULL (timers);
+
+    const int count = 1000;
+    const int max_interval = 50;
+    int timer_ids[count];
+    int invoked[count] = {0};
+    for (int i = 0; i < count; ++i)
+        timer_ids[i] = TEST_ASSERT_SUCCESS_ERRNO (zmq_timers_add (
+          timers, i % max_interval + 1, count_handler, &invoked[i]));
+
+    //  The ids of cancelled timers stay invalid when new timers are added.
+    for (int i = 0; i < count; i += 2)
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_timers_cancel (timers, timer_ids[i]));
+    int new_invoked = 0;
+    const int new_timer_id = TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_timers_add (timers, 1, count_handler, &new_invoked));
+    for (int i = 0; i < count; i += 2) {
+        TEST_ASSERT_NOT_EQUAL (timer_ids[i], new_timer_id);
+        TEST_ASSERT_FAILURE_ERRNO (EINVAL,
+                                   zmq_timers_cancel (timers, timer_ids[i]));
+    }
+
+    msleep (max_interval + 1);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_timers_execute (timers));
+    for (int i = 0; i < count; ++i)
+        TEST_ASSERT_EQUAL_INT (i % 2, invoked[i]);
+    TEST_ASSERT_EQUAL_INT (1, new_invoked);
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_timers_destroy (&timers));
+}
+
+void test_many_live_timers ()
+{
+    void *timers = zmq_timers_new ();
+    TEST_ASSERT_NOT_NULL (timers);
+
+    //  There is no limit on the number of timers other than memory, and
+    //  each of them can be cancelled by its id.
+    const int count = 100000;
+    bool timer_invoked = false;
+    std::vector<int> timer_ids;
+    for (int i = 0; i != count; ++i)
+        timer_ids.push_back (TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_timers_add (timers, 60000, handler, &timer_invoked)));
+    for (int i = 1; i != count; ++i)
+        TEST_ASSERT_GREATER_THAN_INT (timer_ids[i - 1], timer_ids[i]);
+    for (int i = 0; i != count; ++i)
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_timers_cancel (timers, timer_ids[i]));
+    TEST_ASSERT_EQUAL_INT (-1, zmq_timers_timeout (timers));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_timers_destroy (&timers));
+}
+
+void test_reused_timer_ids ()
+{
+    void *timers = zmq_timers_new ();
+    TEST_ASSERT_NOT_NULL (timers);
+
+    //  The id of a cancelled timer is not handed out again.
+    bool timer_invoked = false;
+    const int first_id = TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_timers_add (timers, 100, handler, &timer_invoked));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_timers_cancel (timers, first_id));
+    for (int i = 0; i != 10000; ++i) {
+        const int timer_id = TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_timers_add (timers, 100, handler, &timer_invoked));
+        TEST_ASSERT_NOT_EQUAL (first_id, timer_id);
+        TEST_ASSERT_FAILURE_ERRNO (EINVAL,
+                                   zmq_timers_reset (timers, first_id));
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_timers_cancel (timers, timer_id));
+    }
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_timers_destroy (&timers));
+}
+
 int main ()
 {
     setup_test_environment ();
 
     UNITY_BEGIN ();
     RUN_TEST (test_timers);
+    RUN_TEST (test_cancel_in_handler);
+    RUN_TEST (test_many_timers);
+    RUN_TEST (test_many_live_timers);
+    RUN_TEST (test_reused_timer_ids);
     RUN_TEST (test_null_timer_pointers);
     RUN_TEST (test_corner_cases);
     return UNITY_END ();
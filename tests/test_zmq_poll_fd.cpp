@@ -4,6 +4,7 @@
 #include "testutil_unity.hpp"
 
 #include <netdb.h>
+#include <stdio.h>
 #include <string.h>
 
 #ifndef _WIN32
@@ -51,9 +52,35 @@ void test_poll_fd ()
     close (recv_socket);
 }
 
+void test_poll_regular_file ()
+{
+    //  Regular files are always ready, as poll () reports them.
+    FILE *file = tmpfile ();
+    TEST_ASSERT_NOT_NULL (file);
+
+    void *sb = test_context_socket (ZMQ_REP);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (sb, "tcp://127.0.0.1:*"));
+
+    zmq_pollitem_t pollitems[] = {
+      {sb, 0, ZMQ_POLLIN, 0},
+      {NULL, fileno (file), ZMQ_POLLIN | ZMQ_POLLOUT, 0},
+    };
+    TEST_ASSERT_EQUAL (1, zmq_poll (pollitems, 2, -1));
+    TEST_ASSERT_BITS_LOW (ZMQ_POLLIN, pollitems[0].revents);
+    TEST_ASSERT_EQUAL (ZMQ_POLLIN | ZMQ_POLLOUT, pollitems[1].revents);
+
+    //  Once no longer polled for, the file is not reported.
+    pollitems[1].events = 0;
+    TEST_ASSERT_EQUAL (0, zmq_poll (pollitems, 2, 0));
+
+    test_context_socket_close (sb);
+    fclose (file);
+}
+
 int main ()
 {
     UNITY_BEGIN ();
     RUN_TEST (test_poll_fd);
+    RUN_TEST (test_poll_regular_file);
     return UNITY_END ();
 }
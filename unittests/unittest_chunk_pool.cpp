@@ -0,0 +1,228 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../tests/testutil_unity.hpp"
+
+#include <chunk_pool.hpp>
+#include <macros.hpp>
+#include <stdint.hpp>
+#include <thread.hpp>
+
+#include <unity.h>
+
+#include <string.h>
+#include <vector>
+
+#if defined ZMQ_HAVE_LINUX
+#include <sys/mman.h>
+#endif
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+static bool is_aligned (void *chunk_, size_t align_)
+{
+    return reinterpret_cast<uintptr_t> (chunk_) % align_ == 0;
+}
+
+void test_free_null ()
+{
+    zmq::chunk_pool_free (NULL);
+}
+
+void test_disabled ()
+{
+    const size_t aligns[] = {8, 16, 64, 4096};
+    for (size_t i = 0; i < sizeof aligns / sizeof aligns[0]; ++i) {
+        void *chunk = zmq::chunk_pool_alloc (1000, aligns[i]);
+        TEST_ASSERT_NOT_NULL (chunk);
+        TEST_ASSERT_TRUE (is_aligned (chunk, aligns[i]));
+        memset (chunk, 0, 1000);
+        zmq::chunk_pool_free (chunk);
+    }
+}
+
+static void test_reuse (int features_)
+{
+    zmq::chunk_pool_enable (features_);
+
+    void *chunk = zmq::chunk_pool_alloc (5000, 64);
+    TEST_ASSERT_NOT_NULL (chunk);
+    TEST_ASSERT_TRUE (is_aligned (chunk, 64));
+    memset (chunk, 0, 5000);
+    zmq::chunk_pool_free (chunk);
+
+#if defined ZMQ_HAVE_LINUX
+    //  The chunk goes back to the free list it came from, provided the
+    //  thread did not migrate to another node in between.
+    void *again = zmq::chunk_pool_alloc (5050, 64);
+    if (features_ == zmq::chunk_pool_huge_pages)
+        TEST_ASSERT_EQUAL_PTR (chunk, again);
+    zmq::chunk_pool_free (again);
+#endif
+
+    zmq::chunk_pool_disable (features_);
+}
+
+void test_reuse_huge_pages ()
+{
+    test_reuse (zmq::chunk_pool_huge_pages);
+}
+
+void test_reuse_numa_local ()
+{
+    test_reuse (zmq::chunk_pool_numa_local);
+}
+
+void test_too_large ()
+{
+    zmq::chunk_pool_enable (zmq::chunk_pool_huge_pages);
+    const size_t size = 4 * 1024 * 1024;
+    void *chunk = zmq::chunk_pool_alloc (size);
+    TEST_ASSERT_NOT_NULL (chunk);
+    memset (chunk, 0, size);
+    zmq::chunk_pool_free (chunk);
+    zmq::chunk_pool_disable (zmq::chunk_pool_huge_pages);
+}
+
+void test_size_classes ()
+{
+    zmq::chunk_pool_enable (zmq::chunk_pool_huge_pages);
+
+    //  Chunks just above a power of two, like those of pipes, don't take
+    //  twice their size. Fresh chunks are adjacent.
+    const size_t size = 16400;
+    void *first = zmq::chunk_pool_alloc (size, 64);
+    void *second = zmq::chunk_pool_alloc (size, 64);
+    const uintptr_t distance =
+      reinterpret_cast<uintptr_t> (first) > reinterpret_cast<uintptr_t> (second)
+        ? reinterpret_cast<uintptr_t> (first)
+            - reinterpret_cast<uintptr_t> (second)
+        : reinterpret_cast<uintptr_t> (second)
+            - reinterpret_cast<uintptr_t> (first);
+    TEST_ASSERT_LESS_OR_EQUAL (size + size / 8 + 64, distance);
+    memset (first, 0, size);
+    memset (second, 0, size);
+    zmq::chunk_pool_free (first);
+    zmq::chunk_pool_free (second);
+
+    zmq::chunk_pool_disable (zmq::chunk_pool_huge_pages);
+}
+
+#if defined ZMQ_HAVE_LINUX
+static bool is_mapped (void *chunk_)
+{
+    unsigned char resident;
+    void *const page = reinterpret_cast<void *> (
+      reinterpret_cast<uintptr_t> (chunk_) & ~static_cast<uintptr_t> (4095));
+    return mincore (page, 1, &resident) == 0;
+}
+#endif
+
+void test_regions_returned ()
+{
+#if defined ZMQ_HAVE_LINUX
+    zmq::chunk_pool_enable (zmq::chunk_pool_huge_pages);
+
+    //  Enough chunks for a few regions.
+    std::vector<void *> chunks;
+    for (int i = 0; i < 100; ++i)
+        chunks.push_back (zmq::chunk_pool_alloc (60000));
+    for (size_t i = 0; i < chunks.size (); ++i)
+        zmq::chunk_pool_free (chunks[i]);
+
+    //  A single region is kept while the pool is in use.
+    int mapped = 0;
+    for (size_t i = 0; i < chunks.size (); ++i)
+        if (is_mapped (chunks[i]))
+            mapped++;
+    TEST_ASSERT_GREATER_THAN (0, mapped);
+    TEST_ASSERT_LESS_THAN (100, mapped);
+
+    zmq::chunk_pool_disable (zmq::chunk_pool_huge_pages);
+    for (size_t i = 0; i < chunks.size (); ++i)
+        TEST_ASSERT_FALSE (is_mapped (chunks[i]));
+#else
+    TEST_IGNORE_MESSAGE ("chunk pool only available on Linux, ignoring test");
+#endif
+}
+
+static void free_chunks (void *arg_)
+{
+    std::vector<void *> *chunks = static_cast<std::vector<void *> *> (arg_);
+    for (size_t i = 0; i < chunks->size (); ++i)
+        zmq::chunk_pool_free ((*chunks)[i]);
+}
+
+static void alloc_and_free_chunks (void *arg_)
+{
+    std::vector<void *> *chunks = static_cast<std::vector<void *> *> (arg_);
+    for (int i = 0; i < 100; ++i)
+        chunks->push_back (zmq::chunk_pool_alloc (60000));
+    free_chunks (chunks);
+}
+
+void test_cache_released_on_thread_exit ()
+{
+#if defined ZMQ_HAVE_LINUX
+    zmq::chunk_pool_enable (zmq::chunk_pool_huge_pages);
+
+    //  The chunks the thread keeps for itself go back to the free lists
+    //  when it exits, and the regions are returned once the pool is no
+    //  longer in use.
+    std::vector<void *> chunks;
+    zmq::thread_t thread;
+    thread.start (alloc_and_free_chunks, &chunks, "cache");
+    thread.stop ();
+
+    zmq::chunk_pool_disable (zmq::chunk_pool_huge_pages);
+    for (size_t i = 0; i < chunks.size (); ++i)
+        TEST_ASSERT_FALSE (is_mapped (chunks[i]));
+#else
+    TEST_IGNORE_MESSAGE ("chunk pool only available on Linux, ignoring test");
+#endif
+}
+
+void test_free_in_other_thread ()
+{
+    const int features =
+      zmq::chunk_pool_huge_pages | zmq::chunk_pool_numa_local;
+    zmq::chunk_pool_enable (features);
+
+    //  More chunks than fit in a single region.
+    std::vector<void *> chunks;
+    for (int i = 0; i < 1000; ++i) {
+        void *chunk = zmq::chunk_pool_alloc (4000 + i);
+        TEST_ASSERT_NOT_NULL (chunk);
+        memset (chunk, i, 4000 + i);
+        chunks.push_back (chunk);
+    }
+
+    //  Chunks can be released after the pool is no longer in use.
+    zmq::chunk_pool_disable (features);
+
+    zmq::thread_t thread;
+    thread.start (free_chunks, &chunks, "free");
+    thread.stop ();
+}
+
+int main (void)
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_free_null);
+    RUN_TEST (test_disabled);
+    RUN_TEST (test_reuse_huge_pages);
+    RUN_TEST (test_reuse_numa_local);
+    RUN_TEST (test_too_large);
+    RUN_TEST (test_size_classes);
+    RUN_TEST (test_regions_returned);
+    RUN_TEST (test_free_in_other_thread);
+    RUN_TEST (test_cache_released_on_thread_exit);
+
+    return UNITY_END ();
+}
@@ -23,18 +23,10 @@ void tearDown ()
 {
 }
 
-void test_roundtrip (zmq::msg_t *msg_)
-{
 #ifdef ZMQ_HAVE_CURVE
-    const std::vector<uint8_t> original (static_cast<uint8_t *> (msg_->data ()),
-                                         static_cast<uint8_t *> (msg_->data ())
-                                           + msg_->size ());
-
-    zmq::curve_encoding_t encoding_client ("CurveZMQMESSAGEC",
-                                           "CurveZMQMESSAGES", false);
-    zmq::curve_encoding_t encoding_server ("CurveZMQMESSAGES",
-                                           "CurveZMQMESSAGEC", false);
-
+void setup_encodings (zmq::curve_encoding_t *encoding_client_,
+                      zmq::curve_encoding_t *encoding_server_)
+{
     uint8_t client_public[32];
     uint8_t client_secret[32];
     TEST_ASSERT_SUCCESS_ERRNO (
@@ -46,11 +38,26 @@ void test_roundtrip (zmq::msg_t *msg_)
       crypto_box_keypair (server_public, server_secret));
 
     TEST_ASSERT_SUCCESS_ERRNO (
-      crypto_box_beforenm (encoding_client.get_writable_precom_buffer (),
+      crypto_box_beforenm (encoding_client_->get_writable_precom_buffer (),
                            server_public, client_secret));
     TEST_ASSERT_SUCCESS_ERRNO (
-      crypto_box_beforenm (encoding_server.get_writable_precom_buffer (),
+      crypto_box_beforenm (encoding_server_->get_writable_precom_buffer (),
                            client_public, server_secret));
+}
+#endif
+
+void test_roundtrip (zmq::msg_t *msg_)
+{
+#ifdef ZMQ_HAVE_CURVE
+    const std::vector<uint8_t> original (static_cast<uint8_t *> (msg_->data ()),
+                                         static_cast<uint8_t *> (msg_->data ())
+                                           + msg_->size ());
+
+    zmq::curve_encoding_t encoding_client ("CurveZMQMESSAGEC",
+                                           "CurveZMQMESSAGES", false);
+    zmq::curve_encoding_t encoding_server ("CurveZMQMESSAGES",
+                                           "CurveZMQMESSAGEC", false);
+    setup_encodings (&encoding_client, &encoding_server);
 
     TEST_ASSERT_SUCCESS_ERRNO (encoding_client.encode (msg_));
 
@@ -129,6 +136,99 @@ void test_roundtrip_empty_more ()
     msg.close ();
 }
 
+void test_roundtrip_batch ()
+{
+#ifndef ZMQ_HAVE_CURVE
+    TEST_IGNORE_MESSAGE ("CURVE support is disabled");
+#else
+    zmq::curve_encoding_t encoding_client ("CurveZMQMESSAGEC",
+                                           "CurveZMQMESSAGES", false);
+    zmq::curve_encoding_t encoding_server ("CurveZMQMESSAGES",
+                                           "CurveZMQMESSAGEC", false);
+    setup_encodings (&encoding_client, &encoding_server);
+    encoding_client.enable_batching ();
+    encoding_server.enable_batching ();
+
+    //  Messages of 0 to 3 bytes, all but the last with the more flag, go
+    //  in a single box.
+    const char data[] = "abc";
+    zmq::msg_t msg;
+    for (size_t size = 0; size != 3; size++) {
+        msg.init_size (size);
+        memcpy (msg.data (), data, size);
+        msg.set_flags (zmq::msg_t::more);
+        encoding_client.add_to_batch (&msg);
+        msg.close ();
+    }
+    msg.init_size (3);
+    memcpy (msg.data (), data, 3);
+    TEST_ASSERT_SUCCESS_ERRNO (encoding_client.encode (&msg));
+
+    encoding_server.set_peer_nonce (0);
+    int error_event_code;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      encoding_server.decode (&msg, &error_event_code));
+    for (size_t size = 0; size != 4; size++) {
+        if (size > 0) {
+            TEST_ASSERT_TRUE (encoding_server.decode_next (&msg));
+            TEST_ASSERT_EQUAL_MEMORY (data, msg.data (), size);
+        }
+        TEST_ASSERT_EQUAL_INT (size, msg.size ());
+        TEST_ASSERT_EQUAL (size != 3, (msg.flags () & zmq::msg_t::more) != 0);
+    }
+    TEST_ASSERT_FALSE (encoding_server.decode_next (&msg));
+
+    msg.close ();
+#endif
+}
+
+void test_roundtrip_batch_large ()
+{
+#ifndef ZMQ_HAVE_CURVE
+    TEST_IGNORE_MESSAGE ("CURVE support is disabled");
+#else
+    zmq::curve_encoding_t encoding_client ("CurveZMQMESSAGEC",
+                                           "CurveZMQMESSAGES", false);
+    zmq::curve_encoding_t encoding_server ("CurveZMQMESSAGES",
+                                           "CurveZMQMESSAGEC", false);
+    setup_encodings (&encoding_client, &encoding_server);
+    encoding_client.enable_batching ();
+    encoding_server.enable_batching ();
+
+    //  A large message is not copied into the batch, and goes in a box of
+    //  its own, after the batch.
+    zmq::msg_t msg;
+    msg.init_size (1);
+    memcpy (msg.data (), "a", 1);
+    msg.set_flags (zmq::msg_t::more);
+    encoding_client.add_to_batch (&msg);
+    msg.close ();
+    msg.init_size (2048);
+    memset (msg.data (), 'b', 2048);
+    TEST_ASSERT_SUCCESS_ERRNO (encoding_client.encode (&msg));
+    zmq::msg_t large_box;
+    large_box.init ();
+    TEST_ASSERT_TRUE (encoding_client.encode_next (&large_box));
+    TEST_ASSERT_FALSE (encoding_client.encode_next (&large_box));
+
+    encoding_server.set_peer_nonce (0);
+    int error_event_code;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      encoding_server.decode (&msg, &error_event_code));
+    TEST_ASSERT_EQUAL_INT (1, msg.size ());
+    TEST_ASSERT_FALSE (encoding_server.decode_next (&msg));
+
+    TEST_ASSERT_SUCCESS_ERRNO (
+      encoding_server.decode (&large_box, &error_event_code));
+    TEST_ASSERT_EQUAL_INT (2048, large_box.size ());
+    TEST_ASSERT_EQUAL_INT ('b', static_cast<char *> (large_box.data ())[2047]);
+    TEST_ASSERT_FALSE (encoding_server.decode_next (&large_box));
+
+    large_box.close ();
+    msg.close ();
+#endif
+}
+
 int main ()
 {
     setup_test_environment ();
@@ -141,6 +241,8 @@ int main ()
     RUN_TEST (test_roundtrip_large);
 
     RUN_TEST (test_roundtrip_empty_more);
+    RUN_TEST (test_roundtrip_batch);
+    RUN_TEST (test_roundtrip_batch_large);
 
     zmq::random_close ();
 
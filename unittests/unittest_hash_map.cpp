@@ -0,0 +1,181 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../tests/testutil.hpp"
+
+#include <hash_map.hpp>
+
+#include <unity.h>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+static zmq::blob_t make_key (uint32_t value_)
+{
+    unsigned char buf[5];
+    buf[0] = 0;
+    memcpy (buf + 1, &value_, sizeof value_);
+    return zmq::blob_t (buf, sizeof buf);
+}
+
+void test_create ()
+{
+    zmq::hash_map_t<zmq::blob_t, int> map;
+    TEST_ASSERT_TRUE (map.empty ());
+    TEST_ASSERT_EQUAL_UINT (0, map.size ());
+}
+
+void test_find_empty ()
+{
+    zmq::hash_map_t<zmq::blob_t, int> map;
+    TEST_ASSERT_NULL (map.find (make_key (1)));
+    TEST_ASSERT_FALSE (map.erase (make_key (1)));
+}
+
+void test_insert_find_erase ()
+{
+    zmq::hash_map_t<zmq::blob_t, int> map;
+    TEST_ASSERT_TRUE (map.insert (make_key (1), 42));
+    TEST_ASSERT_EQUAL_UINT (1, map.size ());
+
+    int *value = map.find (make_key (1));
+    TEST_ASSERT_NOT_NULL (value);
+    TEST_ASSERT_EQUAL_INT (42, *value);
+    TEST_ASSERT_NULL (map.find (make_key (2)));
+
+    int erased = 0;
+    TEST_ASSERT_TRUE (map.erase (make_key (1), &erased));
+    TEST_ASSERT_EQUAL_INT (42, erased);
+    TEST_ASSERT_TRUE (map.empty ());
+    TEST_ASSERT_NULL (map.find (make_key (1)));
+}
+
+void test_insert_duplicate ()
+{
+    zmq::hash_map_t<zmq::blob_t, int> map;
+    TEST_ASSERT_TRUE (map.insert (make_key (1), 42));
+    TEST_ASSERT_FALSE (map.insert (make_key (1), 43));
+    TEST_ASSERT_EQUAL_UINT (1, map.size ());
+    TEST_ASSERT_EQUAL_INT (42, *map.find (make_key (1)));
+}
+
+void test_empty_key ()
+{
+    zmq::hash_map_t<zmq::blob_t, int> map;
+    TEST_ASSERT_TRUE (map.insert (zmq::blob_t (), 1));
+    TEST_ASSERT_TRUE (map.insert (make_key (0), 2));
+    TEST_ASSERT_EQUAL_INT (1, *map.find (zmq::blob_t ()));
+    TEST_ASSERT_EQUAL_INT (2, *map.find (make_key (0)));
+}
+
+void test_many_keys_survive_rehash ()
+{
+    const uint32_t count = 10000;
+    zmq::hash_map_t<uint32_t, uint32_t> map;
+    for (uint32_t i = 0; i < count; ++i)
+        TEST_ASSERT_TRUE (map.insert (i, i * 2));
+    TEST_ASSERT_EQUAL_UINT (count, map.size ());
+
+    for (uint32_t i = 0; i < count; ++i) {
+        const uint32_t *value = map.find (i);
+        TEST_ASSERT_NOT_NULL (value);
+        TEST_ASSERT_EQUAL_UINT32 (i * 2, *value);
+    }
+
+    for (uint32_t i = 0; i < count; i += 2)
+        TEST_ASSERT_TRUE (map.erase (i));
+    TEST_ASSERT_EQUAL_UINT (count / 2, map.size ());
+    for (uint32_t i = 0; i < count; ++i)
+        TEST_ASSERT_EQUAL (i % 2 == 1, map.contains (i));
+}
+
+void test_value_address_is_stable ()
+{
+    zmq::hash_map_t<uint32_t, int> map;
+    map.insert (0, 0);
+    const int *const value = map.find (0);
+    for (uint32_t i = 1; i < 1000; ++i)
+        map.insert (i, 0);
+    TEST_ASSERT_EQUAL_PTR (value, map.find (0));
+}
+
+void test_siphash_reference_vectors ()
+{
+    //  Key 00 01 .. 0f; messages 00 01 .. of increasing length.
+    zmq::hash_seed_t seed;
+    seed.k0 = static_cast<uint64_t> (0x07060504u) << 32 | 0x03020100u;
+    seed.k1 = static_cast<uint64_t> (0x0f0e0d0cu) << 32 | 0x0b0a0908u;
+    unsigned char data[15];
+    for (unsigned char i = 0; i < sizeof data; ++i)
+        data[i] = i;
+
+    TEST_ASSERT_EQUAL_HEX64 (
+      static_cast<uint64_t> (0x726fdb47u) << 32 | 0xdd0e0e31u,
+      zmq::siphash (seed, data, 0));
+    TEST_ASSERT_EQUAL_HEX64 (
+      static_cast<uint64_t> (0x74f839c5u) << 32 | 0x93dc67fdu,
+      zmq::siphash (seed, data, 1));
+    TEST_ASSERT_EQUAL_HEX64 (
+      static_cast<uint64_t> (0xa129ca61u) << 32 | 0x49be45e5u,
+      zmq::siphash (seed, data, 15));
+}
+
+void test_buckets_shrink ()
+{
+    zmq::hash_map_t<zmq::blob_t, int> map;
+    for (uint32_t i = 0; i < 1000; ++i)
+        map.insert (make_key (i), 0);
+    const size_t full = map.bucket_count ();
+
+    for (uint32_t i = 10; i < 1000; ++i)
+        TEST_ASSERT_TRUE (map.erase (make_key (i)));
+    TEST_ASSERT_LESS_THAN_UINT (full, map.bucket_count ());
+    for (uint32_t i = 0; i < 10; ++i)
+        TEST_ASSERT_TRUE (map.contains (make_key (i)));
+
+    for (uint32_t i = 0; i < 10; ++i)
+        TEST_ASSERT_TRUE (map.erase (make_key (i)));
+    TEST_ASSERT_EQUAL_UINT (0, map.bucket_count ());
+
+    TEST_ASSERT_TRUE (map.insert (make_key (1), 1));
+    TEST_ASSERT_EQUAL_INT (1, *map.find (make_key (1)));
+}
+
+struct equals_t
+{
+    equals_t (int value_) : value (value_) {}
+    bool operator() (int other_) const { return other_ == value; }
+    int value;
+};
+
+void test_any_of ()
+{
+    zmq::hash_map_t<uint32_t, int> map;
+    TEST_ASSERT_FALSE (map.any_of (equals_t (7)));
+    for (uint32_t i = 0; i < 100; ++i)
+        map.insert (i, static_cast<int> (i));
+    TEST_ASSERT_TRUE (map.any_of (equals_t (7)));
+    TEST_ASSERT_FALSE (map.any_of (equals_t (100)));
+}
+
+int main (void)
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_create);
+    RUN_TEST (test_find_empty);
+    RUN_TEST (test_insert_find_erase);
+    RUN_TEST (test_insert_duplicate);
+    RUN_TEST (test_empty_key);
+    RUN_TEST (test_many_keys_survive_rehash);
+    RUN_TEST (test_value_address_is_stable);
+    RUN_TEST (test_any_of);
+    RUN_TEST (test_siphash_reference_vectors);
+    RUN_TEST (test_buckets_shrink);
+
+    return UNITY_END ();
+}
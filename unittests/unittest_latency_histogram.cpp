@@ -0,0 +1,115 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../tests/testutil_unity.hpp"
+
+#include <latency_histogram.hpp>
+
+#include <unity.h>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+void test_empty ()
+{
+    zmq::latency_histogram_t histogram;
+    zmq::latency_summary_t summary;
+    histogram.summarize_and_reset (&summary);
+    TEST_ASSERT_EQUAL_UINT64 (0, summary.count);
+    TEST_ASSERT_EQUAL_UINT64 (0, summary.p50);
+    TEST_ASSERT_EQUAL_UINT64 (0, summary.p99);
+    TEST_ASSERT_EQUAL_UINT64 (0, summary.max);
+}
+
+void test_small_values_exact ()
+{
+    zmq::latency_histogram_t histogram;
+    for (uint64_t i = 0; i < 8; ++i)
+        histogram.record (i);
+
+    zmq::latency_summary_t summary;
+    histogram.summarize_and_reset (&summary);
+    TEST_ASSERT_EQUAL_UINT64 (8, summary.count);
+    TEST_ASSERT_EQUAL_UINT64 (3, summary.p50);
+    TEST_ASSERT_EQUAL_UINT64 (7, summary.p90);
+    TEST_ASSERT_EQUAL_UINT64 (7, summary.max);
+}
+
+void test_percentiles ()
+{
+    zmq::latency_histogram_t histogram;
+    for (uint64_t i = 1; i <= 1000; ++i)
+        histogram.record (i);
+
+    zmq::latency_summary_t summary;
+    histogram.summarize_and_reset (&summary);
+    TEST_ASSERT_EQUAL_UINT64 (1000, summary.count);
+    TEST_ASSERT_EQUAL_UINT64 (1000, summary.max);
+
+    //  Reported percentiles are not below the exact ones and exceed them
+    //  by 12.5% at most.
+    TEST_ASSERT_TRUE (summary.p50 >= 500 && summary.p50 <= 500 * 9 / 8);
+    TEST_ASSERT_TRUE (summary.p90 >= 900 && summary.p90 <= 900 * 9 / 8);
+    TEST_ASSERT_TRUE (summary.p99 >= 990 && summary.p99 <= 1000);
+}
+
+void test_outlier ()
+{
+    zmq::latency_histogram_t histogram;
+    for (int i = 0; i < 999; ++i)
+        histogram.record (10);
+    histogram.record (1000000);
+
+    zmq::latency_summary_t summary;
+    histogram.summarize_and_reset (&summary);
+    TEST_ASSERT_EQUAL_UINT64 (10, summary.p50);
+    TEST_ASSERT_EQUAL_UINT64 (10, summary.p99);
+    TEST_ASSERT_EQUAL_UINT64 (1000000, summary.max);
+}
+
+void test_huge_values ()
+{
+    //  Values beyond the last bucket are reported as the maximum.
+    zmq::latency_histogram_t histogram;
+    const uint64_t huge = static_cast<uint64_t> (1) << 50;
+    histogram.record (huge);
+
+    zmq::latency_summary_t summary;
+    histogram.summarize_and_reset (&summary);
+    TEST_ASSERT_EQUAL_UINT64 (1, summary.count);
+    TEST_ASSERT_EQUAL_UINT64 (huge, summary.p50);
+    TEST_ASSERT_EQUAL_UINT64 (huge, summary.max);
+}
+
+void test_reset ()
+{
+    zmq::latency_histogram_t histogram;
+    histogram.record (100);
+
+    zmq::latency_summary_t summary;
+    histogram.summarize_and_reset (&summary);
+    TEST_ASSERT_EQUAL_UINT64 (1, summary.count);
+
+    histogram.record (5);
+    histogram.summarize_and_reset (&summary);
+    TEST_ASSERT_EQUAL_UINT64 (1, summary.count);
+    TEST_ASSERT_EQUAL_UINT64 (5, summary.p50);
+    TEST_ASSERT_EQUAL_UINT64 (5, summary.max);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_empty);
+    RUN_TEST (test_small_values_exact);
+    RUN_TEST (test_percentiles);
+    RUN_TEST (test_outlier);
+    RUN_TEST (test_huge_values);
+    RUN_TEST (test_reset);
+    return UNITY_END ();
+}
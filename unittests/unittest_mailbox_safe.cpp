@@ -0,0 +1,93 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../tests/testutil_unity.hpp"
+
+#include <ctx.hpp>
+#include <mailbox_safe.hpp>
+#include <mutex.hpp>
+
+#include <unity.h>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+static const int sender_count = 4;
+static const int commands_per_sender = 10000;
+
+struct sender_t
+{
+    zmq::mailbox_safe_t *mailbox;
+    int index;
+};
+
+//  Each command tells the sender and the sequence number through its
+//  destination.
+static void send_commands (void *sender_)
+{
+    const sender_t *const sender = static_cast<sender_t *> (sender_);
+    for (int i = 0; i != commands_per_sender; i++) {
+        zmq::command_t cmd;
+        cmd.destination = reinterpret_cast<zmq::object_t *> (
+          static_cast<uintptr_t> (sender->index * commands_per_sender + i));
+        cmd.type = zmq::command_t::stop;
+        sender->mailbox->send (cmd);
+    }
+}
+
+void test_senders ()
+{
+    zmq::thread_ctx_t thread_ctx;
+
+    //  Destroying the mailbox right after the last command is taken waits
+    //  for senders still leaving send.
+    for (int round = 0; round != 10; round++) {
+        zmq::mutex_t sync;
+        zmq::mailbox_safe_t *mailbox = new zmq::mailbox_safe_t (&sync);
+
+        sender_t senders[sender_count];
+        zmq::thread_t threads[sender_count];
+        for (int i = 0; i != sender_count; i++) {
+            senders[i].mailbox = mailbox;
+            senders[i].index = i;
+            thread_ctx.start_thread (threads[i], send_commands, &senders[i]);
+        }
+
+        //  Commands of each sender arrive in order. Like sockets, retry
+        //  when woken up before the next command is linked.
+        int next[sender_count] = {0};
+        bool in_order = true;
+        sync.lock ();
+        for (int i = 0; i != sender_count * commands_per_sender; i++) {
+            zmq::command_t cmd;
+            while (mailbox->recv (&cmd, -1) == -1)
+                TEST_ASSERT_TRUE (errno == EAGAIN || errno == EINTR);
+            const int seq =
+              static_cast<int> (reinterpret_cast<uintptr_t> (cmd.destination));
+            const int sender = seq / commands_per_sender;
+            in_order = in_order && seq % commands_per_sender == next[sender];
+            next[sender]++;
+        }
+        zmq::command_t cmd;
+        TEST_ASSERT_EQUAL_INT (-1, mailbox->recv (&cmd, 0));
+        TEST_ASSERT_EQUAL_INT (EAGAIN, errno);
+        sync.unlock ();
+        TEST_ASSERT_TRUE (in_order);
+
+        delete mailbox;
+        for (int i = 0; i != sender_count; i++)
+            threads[i].stop ();
+    }
+}
+
+int main (void)
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_senders);
+    return UNITY_END ();
+}
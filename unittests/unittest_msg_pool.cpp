@@ -0,0 +1,140 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../tests/testutil_unity.hpp"
+
+#include <msg_pool.hpp>
+#include <msg.hpp>
+#include <thread.hpp>
+
+#include <unity.h>
+
+#include <vector>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+void test_disabled ()
+{
+    void *pool = NULL;
+    TEST_ASSERT_NULL (zmq::msg_pool_alloc (100, &pool));
+}
+
+void test_too_large ()
+{
+    zmq::msg_pool_enable ();
+    void *pool = NULL;
+    TEST_ASSERT_NULL (zmq::msg_pool_alloc (1024 * 1024, &pool));
+    zmq::msg_pool_disable ();
+}
+
+void test_reuse ()
+{
+    zmq::msg_pool_enable ();
+
+    void *pool = NULL;
+    void *block = zmq::msg_pool_alloc (200, &pool);
+    TEST_ASSERT_NOT_NULL (block);
+    TEST_ASSERT_NOT_NULL (pool);
+    memset (block, 0, 200);
+    zmq::msg_pool_free (block, pool);
+
+    //  The block is served again from the thread's cache.
+    void *other_pool = NULL;
+    TEST_ASSERT_EQUAL_PTR (block, zmq::msg_pool_alloc (150, &other_pool));
+    TEST_ASSERT_EQUAL_PTR (pool, other_pool);
+    zmq::msg_pool_free (block, pool);
+
+    zmq::msg_pool_disable ();
+}
+
+struct blocks_t
+{
+    std::vector<void *> blocks;
+    void *pool;
+};
+
+static void free_blocks (void *arg_)
+{
+    blocks_t *blocks = static_cast<blocks_t *> (arg_);
+    for (size_t i = 0; i < blocks->blocks.size (); ++i)
+        zmq::msg_pool_free (blocks->blocks[i], blocks->pool);
+}
+
+void test_free_in_other_thread ()
+{
+    zmq::msg_pool_enable ();
+
+    //  Enough blocks for the other thread to pass some of them on to the
+    //  shared depot, and to keep the rest until it exits.
+    const int count = 1000;
+    blocks_t blocks;
+    for (int i = 0; i < count; ++i) {
+        void *block = zmq::msg_pool_alloc (1000, &blocks.pool);
+        TEST_ASSERT_NOT_NULL (block);
+        memset (block, i, 1000);
+        blocks.blocks.push_back (block);
+    }
+
+    zmq::thread_t thread;
+    thread.start (free_blocks, &blocks, "free");
+    thread.stop ();
+
+    //  Blocks released by the other thread are available here.
+    bool reused = false;
+    std::vector<void *> again;
+    for (int i = 0; i < count; ++i) {
+        void *pool = NULL;
+        void *block = zmq::msg_pool_alloc (1000, &pool);
+        TEST_ASSERT_NOT_NULL (block);
+        for (int j = 0; j < count && !reused; ++j)
+            reused = blocks.blocks[j] == block;
+        again.push_back (block);
+    }
+    TEST_ASSERT_TRUE (reused);
+    for (size_t i = 0; i < again.size (); ++i)
+        zmq::msg_pool_free (again[i], blocks.pool);
+
+    zmq::msg_pool_disable ();
+}
+
+void test_msg_roundtrip ()
+{
+    zmq::msg_pool_enable ();
+
+    //  Pooled and shared message content is released once.
+    zmq::msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (msg.init_size (500));
+    memset (msg.data (), 'x', 500);
+    zmq::msg_t copy;
+    TEST_ASSERT_SUCCESS_ERRNO (copy.init ());
+    TEST_ASSERT_SUCCESS_ERRNO (copy.copy (msg));
+    TEST_ASSERT_SUCCESS_ERRNO (msg.close ());
+    TEST_ASSERT_EQUAL_INT ('x', static_cast<char *> (copy.data ())[499]);
+    TEST_ASSERT_SUCCESS_ERRNO (copy.close ());
+
+    zmq::msg_pool_disable ();
+
+    //  Content allocated while the pool was in use can be released after.
+    zmq::msg_pool_enable ();
+    TEST_ASSERT_SUCCESS_ERRNO (msg.init_size (500));
+    zmq::msg_pool_disable ();
+    TEST_ASSERT_SUCCESS_ERRNO (msg.close ());
+}
+
+int main (void)
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_disabled);
+    RUN_TEST (test_too_large);
+    RUN_TEST (test_reuse);
+    RUN_TEST (test_free_in_other_thread);
+    RUN_TEST (test_msg_roundtrip);
+
+    return UNITY_END ();
+}
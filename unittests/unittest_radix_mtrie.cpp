@@ -0,0 +1,239 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../tests/testutil.hpp"
+
+#if defined(min)
+#undef min
+#endif
+
+#include <generic_mtrie_impl.hpp>
+#include <generic_radix_mtrie_impl.hpp>
+
+#include <unity.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+typedef zmq::generic_radix_mtrie_t<int> radix_mtrie_t;
+
+static radix_mtrie_t::prefix_t to_prefix (const char *name_)
+{
+    return reinterpret_cast<radix_mtrie_t::prefix_t> (name_);
+}
+
+static void collect (int *value_, std::vector<int *> *values_)
+{
+    values_->push_back (value_);
+}
+
+static std::vector<int *> match (radix_mtrie_t &mtrie_, const char *data_)
+{
+    std::vector<int *> values;
+    mtrie_.match (to_prefix (data_), strlen (data_), collect, &values);
+    std::sort (values.begin (), values.end ());
+    return values;
+}
+
+void test_match_prefixes ()
+{
+    int pipes[4];
+    radix_mtrie_t mtrie;
+    TEST_ASSERT_TRUE (mtrie.add (to_prefix ("foobar"), 6, &pipes[0]));
+    TEST_ASSERT_TRUE (mtrie.add (to_prefix ("foo"), 3, &pipes[1]));
+    TEST_ASSERT_TRUE (mtrie.add (to_prefix ("fox"), 3, &pipes[2]));
+    TEST_ASSERT_TRUE (mtrie.add (NULL, 0, &pipes[3]));
+    TEST_ASSERT_EQUAL_UINT32 (4, mtrie.num_prefixes ());
+
+    TEST_ASSERT_EQUAL_UINT (3, match (mtrie, "foobarbaz").size ());
+    TEST_ASSERT_EQUAL_UINT (3, match (mtrie, "foobar").size ());
+    //  Data ending within a compressed prefix does not match it.
+    TEST_ASSERT_EQUAL_UINT (2, match (mtrie, "foob").size ());
+    TEST_ASSERT_EQUAL_UINT (2, match (mtrie, "fox").size ());
+    TEST_ASSERT_EQUAL_UINT (1, match (mtrie, "fo").size ());
+    TEST_ASSERT_EQUAL_UINT (1, match (mtrie, "").size ());
+}
+
+void test_add_duplicate ()
+{
+    int pipes[2];
+    radix_mtrie_t mtrie;
+    TEST_ASSERT_TRUE (mtrie.add (to_prefix ("foo"), 3, &pipes[0]));
+    TEST_ASSERT_FALSE (mtrie.add (to_prefix ("foo"), 3, &pipes[1]));
+    TEST_ASSERT_FALSE (mtrie.add (to_prefix ("foo"), 3, &pipes[1]));
+    TEST_ASSERT_EQUAL_UINT32 (1, mtrie.num_prefixes ());
+    TEST_ASSERT_EQUAL_UINT (2, match (mtrie, "foo").size ());
+}
+
+void test_rm ()
+{
+    int pipes[2];
+    radix_mtrie_t mtrie;
+    mtrie.add (to_prefix ("foo"), 3, &pipes[0]);
+    mtrie.add (to_prefix ("foo"), 3, &pipes[1]);
+    mtrie.add (to_prefix ("foobar"), 6, &pipes[0]);
+
+    TEST_ASSERT_EQUAL_INT (radix_mtrie_t::not_found,
+                           mtrie.rm (to_prefix ("fo"), 2, &pipes[0]));
+    TEST_ASSERT_EQUAL_INT (radix_mtrie_t::not_found,
+                           mtrie.rm (to_prefix ("foob"), 4, &pipes[0]));
+    TEST_ASSERT_EQUAL_INT (radix_mtrie_t::not_found,
+                           mtrie.rm (to_prefix ("foobar"), 6, &pipes[1]));
+    TEST_ASSERT_EQUAL_INT (radix_mtrie_t::values_remain,
+                           mtrie.rm (to_prefix ("foo"), 3, &pipes[0]));
+    TEST_ASSERT_EQUAL_INT (radix_mtrie_t::last_value_removed,
+                           mtrie.rm (to_prefix ("foo"), 3, &pipes[1]));
+    TEST_ASSERT_EQUAL_UINT32 (1, mtrie.num_prefixes ());
+    TEST_ASSERT_EQUAL_UINT (1, match (mtrie, "foobar").size ());
+
+    TEST_ASSERT_EQUAL_INT (radix_mtrie_t::last_value_removed,
+                           mtrie.rm (to_prefix ("foobar"), 6, &pipes[0]));
+    TEST_ASSERT_EQUAL_UINT32 (0, mtrie.num_prefixes ());
+    TEST_ASSERT_EQUAL_UINT (0, match (mtrie, "foobar").size ());
+
+    //  The compacted trie can be filled again.
+    TEST_ASSERT_TRUE (mtrie.add (to_prefix ("fob"), 3, &pipes[0]));
+    TEST_ASSERT_EQUAL_UINT (1, match (mtrie, "fob").size ());
+}
+
+void test_many_edges ()
+{
+    //  Every byte value under the root and under a deeper node.
+    int pipes[256];
+    radix_mtrie_t mtrie;
+    for (int i = 0; i < 256; ++i) {
+        const unsigned char key[2] = {'a', static_cast<unsigned char> (i)};
+        TEST_ASSERT_TRUE (mtrie.add (key + 1, 1, &pipes[i]));
+        TEST_ASSERT_TRUE (mtrie.add (key, 2, &pipes[i]));
+    }
+    TEST_ASSERT_EQUAL_UINT32 (512, mtrie.num_prefixes ());
+
+    for (int i = 0; i < 256; ++i) {
+        const unsigned char key[2] = {'a', static_cast<unsigned char> (i)};
+        std::vector<int *> values;
+        mtrie.match (key, 2, collect, &values);
+        TEST_ASSERT_EQUAL_UINT (2, values.size ());
+        TEST_ASSERT_TRUE (values[0] == &pipes['a'] || values[1] == &pipes['a']);
+        TEST_ASSERT_TRUE (values[0] == &pipes[i] || values[1] == &pipes[i]);
+    }
+
+    for (int i = 0; i < 256; ++i) {
+        const unsigned char key[2] = {'a', static_cast<unsigned char> (i)};
+        TEST_ASSERT_EQUAL_INT (radix_mtrie_t::last_value_removed,
+                               mtrie.rm (key, 2, &pipes[i]));
+    }
+    TEST_ASSERT_EQUAL_UINT32 (256, mtrie.num_prefixes ());
+}
+
+static void collect_name (const unsigned char *data_,
+                          size_t size_,
+                          std::vector<std::string> *names_)
+{
+    names_->push_back (
+      std::string (reinterpret_cast<const char *> (data_), size_));
+}
+
+void test_rm_value_with_callback ()
+{
+    int pipes[2];
+    radix_mtrie_t mtrie;
+    mtrie.add (to_prefix ("foo"), 3, &pipes[0]);
+    mtrie.add (to_prefix ("foobar"), 6, &pipes[0]);
+    mtrie.add (to_prefix ("fox"), 3, &pipes[0]);
+    mtrie.add (to_prefix ("fox"), 3, &pipes[1]);
+
+    std::vector<std::string> names;
+    mtrie.rm (&pipes[0], collect_name, &names, true);
+    std::sort (names.begin (), names.end ());
+    TEST_ASSERT_EQUAL_UINT (2, names.size ());
+    TEST_ASSERT_EQUAL_STRING ("foo", names[0].c_str ());
+    TEST_ASSERT_EQUAL_STRING ("foobar", names[1].c_str ());
+    TEST_ASSERT_EQUAL_UINT32 (1, mtrie.num_prefixes ());
+    TEST_ASSERT_EQUAL_UINT (1, match (mtrie, "foxtrot").size ());
+    TEST_ASSERT_EQUAL_UINT (0, match (mtrie, "foobar").size ());
+
+    names.clear ();
+    mtrie.rm (&pipes[1], collect_name, &names, false);
+    TEST_ASSERT_EQUAL_UINT (1, names.size ());
+    TEST_ASSERT_EQUAL_STRING ("fox", names[0].c_str ());
+    TEST_ASSERT_EQUAL_UINT32 (0, mtrie.num_prefixes ());
+}
+
+static void collect_generic (int *value_, std::vector<int *> *values_)
+{
+    values_->push_back (value_);
+}
+
+void test_same_as_generic_mtrie ()
+{
+    //  Random operations on keys over a small alphabet, so that prefixes
+    //  are shared and split a lot, must give the same results as with the
+    //  uncompressed trie.
+    const int pipes_count = 8;
+    int pipes[pipes_count];
+    radix_mtrie_t radix_mtrie;
+    zmq::generic_mtrie_t<int> mtrie;
+
+    unsigned int seed = 12345;
+    for (int i = 0; i < 20000; ++i) {
+        seed = seed * 1103515245 + 12345;
+        const unsigned int r = seed >> 8;
+        char key[8];
+        const size_t size = r % 7;
+        for (size_t j = 0; j < size; ++j)
+            key[j] = "abc"[(r >> (4 + 2 * j)) % 3];
+        key[size] = 0;
+        int *pipe = &pipes[(r >> 20) % pipes_count];
+
+        switch ((r >> 24) % 4) {
+            case 0:
+            case 1:
+                TEST_ASSERT_EQUAL (
+                  mtrie.add (to_prefix (key), size, pipe),
+                  radix_mtrie.add (to_prefix (key), size, pipe));
+                break;
+            case 2:
+                TEST_ASSERT_EQUAL_INT (
+                  mtrie.rm (to_prefix (key), size, pipe),
+                  radix_mtrie.rm (to_prefix (key), size, pipe));
+                break;
+            default:
+                if (r % 64 == 0) {
+                    std::vector<std::string> names;
+                    std::vector<std::string> radix_names;
+                    mtrie.rm (pipe, collect_name, &names, true);
+                    radix_mtrie.rm (pipe, collect_name, &radix_names, true);
+                    std::sort (names.begin (), names.end ());
+                    std::sort (radix_names.begin (), radix_names.end ());
+                    TEST_ASSERT_TRUE (names == radix_names);
+                }
+                break;
+        }
+
+        std::vector<int *> expected;
+        mtrie.match (to_prefix (key), size, collect_generic, &expected);
+        std::sort (expected.begin (), expected.end ());
+        TEST_ASSERT_TRUE (expected == match (radix_mtrie, key));
+    }
+}
+
+int main (void)
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_match_prefixes);
+    RUN_TEST (test_add_duplicate);
+    RUN_TEST (test_rm);
+    RUN_TEST (test_many_edges);
+    RUN_TEST (test_rm_value_with_callback);
+    RUN_TEST (test_same_as_generic_mtrie);
+    return UNITY_END ();
+}
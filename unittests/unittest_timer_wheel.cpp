@@ -0,0 +1,170 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../tests/testutil_unity.hpp"
+
+#include <timer_wheel.hpp>
+
+#include <unity.h>
+
+#include <map>
+#include <stdlib.h>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+static int sinks[4];
+
+static void expect_expired (zmq::timer_wheel_t &wheel_,
+                            uint64_t now_,
+                            void *sink_,
+                            int id_)
+{
+    void *sink = NULL;
+    int id = -1;
+    TEST_ASSERT_TRUE (wheel_.expire (now_, &sink, &id));
+    TEST_ASSERT_EQUAL_PTR (sink_, sink);
+    TEST_ASSERT_EQUAL_INT (id_, id);
+}
+
+static void expect_none_expired (zmq::timer_wheel_t &wheel_, uint64_t now_)
+{
+    void *sink;
+    int id;
+    TEST_ASSERT_FALSE (wheel_.expire (now_, &sink, &id));
+}
+
+void test_empty ()
+{
+    zmq::timer_wheel_t wheel;
+    TEST_ASSERT_TRUE (wheel.empty ());
+    expect_none_expired (wheel, 1000);
+    TEST_ASSERT_FALSE (wheel.cancel (&sinks[0], 1));
+}
+
+void test_order ()
+{
+    zmq::timer_wheel_t wheel;
+    const uint64_t start = 123456789;
+    wheel.add (start, start + 300, &sinks[0], 3);
+    wheel.add (start, start + 100, &sinks[0], 1);
+    wheel.add (start, start + 200000, &sinks[1], 4);
+    wheel.add (start, start + 200, &sinks[0], 2);
+    wheel.add (start, start, &sinks[1], 0);
+    TEST_ASSERT_EQUAL_UINT (5, wheel.size ());
+
+    expect_expired (wheel, start, &sinks[1], 0);
+    expect_none_expired (wheel, start + 99);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT64 (start + 100, wheel.next_due ());
+    TEST_ASSERT_GREATER_THAN_UINT64 (start + 99, wheel.next_due ());
+
+    expect_expired (wheel, start + 250, &sinks[0], 1);
+    expect_expired (wheel, start + 250, &sinks[0], 2);
+    expect_none_expired (wheel, start + 250);
+    expect_expired (wheel, start + 199999, &sinks[0], 3);
+    expect_none_expired (wheel, start + 199999);
+    expect_expired (wheel, start + 200000, &sinks[1], 4);
+    TEST_ASSERT_TRUE (wheel.empty ());
+}
+
+void test_cancel ()
+{
+    zmq::timer_wheel_t wheel;
+    wheel.add (0, 10, &sinks[0], 1);
+    wheel.add (0, 5000, &sinks[0], 1);
+    wheel.add (0, 20, &sinks[1], 1);
+
+    //  Of the timers with the same sink and id, the first to expire goes.
+    TEST_ASSERT_TRUE (wheel.cancel (&sinks[0], 1));
+    TEST_ASSERT_FALSE (wheel.cancel (&sinks[0], 2));
+    expect_expired (wheel, 100, &sinks[1], 1);
+    expect_none_expired (wheel, 4999);
+    expect_expired (wheel, 5000, &sinks[0], 1);
+    TEST_ASSERT_FALSE (wheel.cancel (&sinks[0], 1));
+    TEST_ASSERT_TRUE (wheel.empty ());
+}
+
+void test_long_range ()
+{
+    zmq::timer_wheel_t wheel;
+
+    //  Beyond the range of the wheel, and after idling for a long time.
+    const uint64_t day = 24 * 3600 * 1000;
+    wheel.add (0, 1000 * day, &sinks[0], 1);
+    wheel.add (0, 2 * day + 1, &sinks[0], 2);
+    expect_none_expired (wheel, 2 * day);
+    expect_expired (wheel, 2 * day + 1, &sinks[0], 2);
+    expect_none_expired (wheel, 1000 * day - 1);
+    expect_expired (wheel, 1000 * day, &sinks[0], 1);
+
+    //  Adding to an empty wheel after a while starts from the present.
+    wheel.add (2000 * day, 2000 * day + 1, &sinks[0], 3);
+    expect_none_expired (wheel, 2000 * day);
+    expect_expired (wheel, 2000 * day + 1, &sinks[0], 3);
+}
+
+void test_random ()
+{
+    //  Compare with a sorted map, ticking forward by random amounts while
+    //  adding and cancelling timers.
+    zmq::timer_wheel_t wheel;
+    typedef std::multimap<uint64_t, int> model_t;
+    model_t model;
+    srand (12345);
+    uint64_t now = 1000;
+    int next_id = 0;
+    for (int round = 0; round < 20000; ++round) {
+        const int action = rand () % 10;
+        if (action < 5) {
+            static const int ranges[] = {10, 1000, 100000, 10000000};
+            const uint64_t expiration =
+              now + static_cast<uint64_t> (rand ()) % ranges[rand () % 4];
+            wheel.add (now, expiration, &sinks[0], next_id);
+            model.insert (model_t::value_type (expiration, next_id));
+            ++next_id;
+        } else if (action < 7 && !model.empty ()) {
+            model_t::iterator it = model.begin ();
+            std::advance (it, rand () % model.size ());
+            TEST_ASSERT_TRUE (wheel.cancel (&sinks[0], it->second));
+            model.erase (it);
+        } else {
+            now += rand () % (action == 9 ? 100000 : 100);
+            void *sink;
+            int id;
+            uint64_t last = 0;
+            while (wheel.expire (now, &sink, &id)) {
+                model_t::iterator it = model.begin ();
+                while (it->second != id)
+                    ++it;
+                TEST_ASSERT_LESS_OR_EQUAL_UINT64 (now, it->first);
+                TEST_ASSERT_LESS_OR_EQUAL_UINT64 (it->first, last);
+                last = it->first;
+                model.erase (it);
+            }
+            TEST_ASSERT_TRUE (model.empty () || model.begin ()->first > now);
+            if (!model.empty ()) {
+                TEST_ASSERT_GREATER_THAN_UINT64 (now, wheel.next_due ());
+                TEST_ASSERT_LESS_OR_EQUAL_UINT64 (model.begin ()->first,
+                                                  wheel.next_due ());
+            }
+        }
+        TEST_ASSERT_EQUAL_UINT (model.size (), wheel.size ());
+    }
+}
+
+int main (void)
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_empty);
+    RUN_TEST (test_order);
+    RUN_TEST (test_cancel);
+    RUN_TEST (test_long_range);
+    RUN_TEST (test_random);
+
+    return UNITY_END ();
+}
@@ -0,0 +1,223 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../tests/testutil.hpp"
+
+#include <uring.hpp>
+#include <i_poll_events.hpp>
+#include <ip.hpp>
+
+#include <unity.h>
+
+#if defined ZMQ_HAVE_IO_URING
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+#if defined ZMQ_HAVE_IO_URING
+//  io_uring may be disabled by the kernel or forbidden by a seccomp
+//  profile, in which case the tests are skipped.
+static bool uring_available ()
+{
+    io_uring_params params;
+    memset (&params, 0, sizeof params);
+    const long fd = syscall (__NR_io_uring_setup, 1, &params);
+    if (fd == -1)
+        return false;
+    close (static_cast<int> (fd));
+    return true;
+}
+
+#define SKIP_IF_UNAVAILABLE                                                    \
+    if (!uring_available ())                                                   \
+    TEST_IGNORE_MESSAGE ("io_uring is not available, ignoring test")
+
+struct test_events_t : zmq::i_poll_events
+{
+    test_events_t (zmq::uring_t &poller_) :
+        _poller (poller_),
+        _handle (NULL)
+    {
+    }
+
+    void in_event () ZMQ_OVERRIDE
+    {
+        remove ();
+        in_events.add (1);
+    }
+
+    void out_event () ZMQ_OVERRIDE
+    {
+        remove ();
+        out_events.add (1);
+    }
+
+    void timer_event (int id_) ZMQ_OVERRIDE
+    {
+        LIBZMQ_UNUSED (id_);
+        remove ();
+        timer_events.add (1);
+    }
+
+    void set_handle (zmq::uring_t::handle_t handle_) { _handle = handle_; }
+
+    zmq::atomic_counter_t in_events, out_events, timer_events;
+
+  private:
+    void remove ()
+    {
+        if (_handle) {
+            _poller.rm_fd (_handle);
+            _handle = NULL;
+        }
+    }
+
+    zmq::uring_t &_poller;
+    zmq::uring_t::handle_t _handle;
+};
+
+//  The stopwatch counts microseconds, SETTLE_TIME milliseconds.
+static void wait_for (zmq::atomic_counter_t &counter_)
+{
+    void *watch = zmq_stopwatch_start ();
+    while (counter_.get () < 1) {
+        msleep (1);
+        TEST_ASSERT_LESS_OR_EQUAL_MESSAGE (SETTLE_TIME * 1000UL,
+                                           zmq_stopwatch_intermediate (watch),
+                                           "Timeout waiting for event");
+    }
+    zmq_stopwatch_stop (watch);
+}
+
+static void create_nonblocking_fdpair (zmq::fd_t *r_, zmq::fd_t *w_)
+{
+    TEST_ASSERT_EQUAL_INT (0, zmq::make_fdpair (r_, w_));
+    zmq::unblock_socket (*r_);
+    zmq::unblock_socket (*w_);
+}
+
+static void send_signal (zmq::fd_t w_)
+{
+#if defined ZMQ_HAVE_EVENTFD
+    const uint64_t inc = 1;
+    TEST_ASSERT_EQUAL_INT (sizeof inc, write (w_, &inc, sizeof inc));
+#else
+    const char msg[] = "test";
+    TEST_ASSERT_EQUAL_INT (sizeof msg, send (w_, msg, sizeof msg, 0));
+#endif
+}
+
+static void close_fdpair (zmq::fd_t w_, zmq::fd_t r_)
+{
+    TEST_ASSERT_EQUAL_INT (0, close (w_));
+    if (r_ != w_)
+        TEST_ASSERT_EQUAL_INT (0, close (r_));
+}
+
+void test_reset_pollin ()
+{
+    SKIP_IF_UNAVAILABLE;
+
+    zmq::fd_t r, w;
+    create_nonblocking_fdpair (&r, &w);
+    send_signal (w);
+
+    //  The reading end is readable, but only its writability is asked for
+    //  in the end.
+    zmq::thread_ctx_t thread_ctx;
+    zmq::uring_t poller (thread_ctx);
+    test_events_t events (poller);
+    const zmq::uring_t::handle_t handle = poller.add_fd (r, &events);
+    events.set_handle (handle);
+    poller.set_pollin (handle);
+    poller.reset_pollin (handle);
+    poller.set_pollout (handle);
+    poller.start ();
+
+    wait_for (events.out_events);
+    TEST_ASSERT_EQUAL_INT (0, events.in_events.get ());
+
+    close_fdpair (w, r);
+}
+
+void test_set_pollin ()
+{
+    SKIP_IF_UNAVAILABLE;
+
+    zmq::fd_t r, w;
+    create_nonblocking_fdpair (&r, &w);
+
+    zmq::thread_ctx_t thread_ctx;
+    zmq::uring_t poller (thread_ctx);
+    test_events_t events (poller);
+    const zmq::uring_t::handle_t handle = poller.add_fd (r, &events);
+    events.set_handle (handle);
+    poller.set_pollin (handle);
+    poller.start ();
+
+    send_signal (w);
+    wait_for (events.in_events);
+
+    close_fdpair (w, r);
+}
+
+void test_set_pollout ()
+{
+    SKIP_IF_UNAVAILABLE;
+
+    zmq::fd_t r, w;
+    create_nonblocking_fdpair (&r, &w);
+
+    zmq::thread_ctx_t thread_ctx;
+    zmq::uring_t poller (thread_ctx);
+    test_events_t events (poller);
+    const zmq::uring_t::handle_t handle = poller.add_fd (w, &events);
+    events.set_handle (handle);
+    poller.set_pollout (handle);
+    poller.start ();
+
+    wait_for (events.out_events);
+    TEST_ASSERT_EQUAL_INT (0, events.in_events.get ());
+
+    close_fdpair (w, r);
+}
+
+void test_timer ()
+{
+    SKIP_IF_UNAVAILABLE;
+
+    zmq::fd_t r, w;
+    create_nonblocking_fdpair (&r, &w);
+
+    zmq::thread_ctx_t thread_ctx;
+    zmq::uring_t poller (thread_ctx);
+    test_events_t events (poller);
+    events.set_handle (poller.add_fd (r, &events));
+    poller.add_timer (50, &events, 0);
+    poller.start ();
+
+    wait_for (events.timer_events);
+
+    close_fdpair (w, r);
+}
+#endif
+
+int main (void)
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+#if defined ZMQ_HAVE_IO_URING
+    RUN_TEST (test_reset_pollin);
+    RUN_TEST (test_set_pollin);
+    RUN_TEST (test_set_pollout);
+    RUN_TEST (test_timer);
+#endif
+    return UNITY_END ();
+}
@@ -0,0 +1,176 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../tests/testutil.hpp"
+
+#include <atomic_counter.hpp>
+#include <ctx.hpp>
+#include <worker_pool.hpp>
+
+#include <unity.h>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+static const int task_count = 100;
+
+struct counters_t
+{
+    int runs[task_count];
+    void *args[task_count];
+};
+
+static void init_counters (counters_t *counters_)
+{
+    for (int i = 0; i != task_count; i++) {
+        counters_->runs[i] = 0;
+        counters_->args[i] = &counters_->runs[i];
+    }
+}
+
+static void count_run (void *arg_)
+{
+    ++*static_cast<int *> (arg_);
+}
+
+static bool all_run_once (const counters_t &counters_)
+{
+    for (int i = 0; i != task_count; i++)
+        if (counters_.runs[i] != 1)
+            return false;
+    return true;
+}
+
+//  Job counting its completions, called by the thread which ran its last
+//  task since none is given to hand it back to.
+struct test_job_t : zmq::worker_pool_t::job_t
+{
+    counters_t counters;
+    zmq::atomic_counter_t completions;
+};
+
+static void count_completion (void *job_)
+{
+    static_cast<test_job_t *> (static_cast<zmq::worker_pool_t::job_t *> (job_))
+      ->completions.add (1);
+}
+
+static void init_job (test_job_t *job_, int count_)
+{
+    init_counters (&job_->counters);
+    job_->fn = count_run;
+    job_->args = job_->counters.args;
+    job_->count = count_;
+    job_->done = count_completion;
+    job_->thread = NULL;
+}
+
+//  The stopwatch counts microseconds, SETTLE_TIME milliseconds.
+static bool wait_for_completion (const test_job_t &job_)
+{
+    void *watch = zmq_stopwatch_start ();
+    while (job_.completions.get () == 0) {
+        if (zmq_stopwatch_intermediate (watch) > SETTLE_TIME * 1000UL) {
+            zmq_stopwatch_stop (watch);
+            return false;
+        }
+        msleep (1);
+    }
+    zmq_stopwatch_stop (watch);
+    return true;
+}
+
+void test_submit_without_workers ()
+{
+    zmq::worker_pool_t pool;
+    TEST_ASSERT_EQUAL_INT (0, pool.workers ());
+
+    //  The tasks are run, and the job completed, before submit returns.
+    test_job_t job;
+    init_job (&job, task_count);
+    pool.submit (&job);
+    TEST_ASSERT_EQUAL_INT (1, job.completions.get ());
+    TEST_ASSERT_TRUE (all_run_once (job.counters));
+}
+
+void test_submit ()
+{
+    zmq::thread_ctx_t thread_ctx;
+    zmq::worker_pool_t pool;
+    pool.start (thread_ctx, 3);
+    TEST_ASSERT_EQUAL_INT (3, pool.workers ());
+
+    //  Jobs are handed over without waiting for the ones before them.
+    const int job_count = 10;
+    test_job_t jobs[job_count];
+    for (int i = 0; i != job_count; i++) {
+        init_job (&jobs[i], task_count);
+        pool.submit (&jobs[i]);
+    }
+    for (int i = 0; i != job_count; i++) {
+        TEST_ASSERT_TRUE (wait_for_completion (jobs[i]));
+        TEST_ASSERT_EQUAL_INT (1, jobs[i].completions.get ());
+        TEST_ASSERT_TRUE (all_run_once (jobs[i].counters));
+    }
+
+    //  A job without tasks completes right away.
+    test_job_t empty;
+    init_job (&empty, 0);
+    pool.submit (&empty);
+    TEST_ASSERT_EQUAL_INT (1, empty.completions.get ());
+}
+
+static zmq::worker_pool_t *shared_pool;
+
+struct caller_t
+{
+    test_job_t job;
+    bool all_run;
+};
+
+//  Unity assertions are only made from the main thread.
+static void submit_from_thread (void *caller_)
+{
+    caller_t *const caller = static_cast<caller_t *> (caller_);
+    caller->all_run = true;
+    for (int round = 0; round != 10; round++) {
+        init_job (&caller->job, task_count);
+        caller->job.completions.set (0);
+        shared_pool->submit (&caller->job);
+        caller->all_run = caller->all_run
+                          && wait_for_completion (caller->job)
+                          && all_run_once (caller->job.counters);
+    }
+}
+
+void test_submit_from_several_threads ()
+{
+    zmq::thread_ctx_t thread_ctx;
+    zmq::worker_pool_t pool;
+    pool.start (thread_ctx, 2);
+    shared_pool = &pool;
+
+    const int thread_count = 4;
+    caller_t callers[thread_count];
+    zmq::thread_t threads[thread_count];
+    for (int i = 0; i != thread_count; i++)
+        thread_ctx.start_thread (threads[i], submit_from_thread, &callers[i]);
+    for (int i = 0; i != thread_count; i++) {
+        threads[i].stop ();
+        TEST_ASSERT_TRUE (callers[i].all_run);
+    }
+}
+
+int main (void)
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_submit_without_workers);
+    RUN_TEST (test_submit);
+    RUN_TEST (test_submit_from_several_threads);
+    return UNITY_END ();
+}